@@ -874,6 +874,8 @@ void argonnite_help(struct thorium_actor *actor)
                     CORE_DEFAULT_OUTPUT);
     printf("-print-load                         display load, memory usage, actor count, active requests\n");
     printf("-print-counters                     print node-level biosal counters\n");
+    printf("-enable-control-bytes               probe the kmer tables with 16-byte groups of control bytes\n");
+    printf("-shared-kmer-table-buckets count    count local kmers in a shared table of this many buckets in each store\n");
     printf("\n");
 
     printf("Output\n");
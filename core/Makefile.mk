@@ -41,6 +41,9 @@ CORE_OBJECTS += core/file_storage/output/buffered_file_writer.o
 CORE_OBJECTS += core/file_storage/input/buffered_reader.o
 CORE_OBJECTS += core/file_storage/input/raw_buffered_reader.o
 CORE_OBJECTS += core/file_storage/input/gzip_buffered_reader.o
+CORE_OBJECTS += core/file_storage/input/mapped_buffered_reader.o
+CORE_OBJECTS += core/file_storage/input/gzip_index.o
+CORE_OBJECTS += core/file_storage/input/gzip_index_reader.o
 CORE_OBJECTS += core/file_storage/directory.o
 CORE_OBJECTS += core/file_storage/file.o
 
@@ -3,6 +3,7 @@
 
 #include "raw_buffered_reader.h"
 #include "gzip_buffered_reader.h"
+#include "mapped_buffered_reader.h"
 
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
@@ -21,6 +22,11 @@
 
 /*#define CORE_BUFFERED_READER_BUFFER_SIZE 4194304*/
 
+/*
+ * Map uncompressed files in memory instead of reading them with fread.
+ */
+#define CORE_BUFFERED_READER_USE_MAPPED_READER
+
 #define MEMORY_READER 0x5fb8b2cc
 
 void core_buffered_reader_init(struct core_buffered_reader *self,
@@ -64,6 +70,34 @@ int core_buffered_reader_read_line(struct core_buffered_reader *self,
     return return_value;
 }
 
+int core_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line)
+{
+    return self->interface->read_line_view(self, line);
+}
+
+int core_buffered_reader_copy_line(char *buffer, int length, const char *line, int read)
+{
+    if (length <= 0) {
+        return 0;
+    }
+
+    /*
+     * Keep room for the null character.
+     */
+    if (read > length - 1) {
+        printf("Warning: line of %d bytes truncated to %d bytes\n", read, length - 1);
+
+        read = length - 1;
+    }
+
+    if (read > 0)
+        core_memory_copy(buffer, line, read);
+    buffer[read] = '\0';
+
+    return read;
+}
+
 void *core_buffered_reader_get_concrete_self(struct core_buffered_reader *self)
 {
     return self->concrete_self;
@@ -71,9 +105,15 @@ void *core_buffered_reader_get_concrete_self(struct core_buffered_reader *self)
 
 void core_buffered_reader_select(struct core_buffered_reader *self, const char *file)
 {
-    if (core_gzip_buffered_reader_implementation.detect(self, file)) {
+    if (core_gzip_buffered_reader_implementation.detect(file)) {
 
         self->interface = &core_gzip_buffered_reader_implementation;
+
+#ifdef CORE_BUFFERED_READER_USE_MAPPED_READER
+    } else if (core_mapped_buffered_reader_implementation.detect(file)) {
+
+        self->interface = &core_mapped_buffered_reader_implementation;
+#endif
     } else {
 
         self->interface = &core_raw_buffered_reader_implementation;
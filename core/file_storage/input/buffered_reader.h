@@ -30,10 +30,30 @@ void core_buffered_reader_destroy(struct core_buffered_reader *self);
 /*
  * \return number of bytes copied in buffer
  * This does include the \n, if any
+ *
+ * length is the size of buffer. A line that does not fit is truncated
+ * to length - 1 bytes, with a warning.
  */
 int core_buffered_reader_read_line(struct core_buffered_reader *self,
                 char *buffer, int length);
 
+/*
+ * Get the next line without copying it. The view is not
+ * null-terminated and it stays valid until the next call on the reader.
+ *
+ * \return number of bytes in the view, 0 at the end of the file.
+ * Like core_buffered_reader_read_line, the view ends with the \n when the
+ * implementation keeps it.
+ */
+int core_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line);
+
+/*
+ * Copy a line view of read bytes for read_line in the implementations.
+ * \return number of bytes copied in buffer
+ */
+int core_buffered_reader_copy_line(char *buffer, int length, const char *line, int read);
+
 void *core_buffered_reader_get_concrete_self(struct core_buffered_reader *self);
 void core_buffered_reader_select(struct core_buffered_reader *self, const char *file);
 uint64_t core_buffered_reader_get_offset(struct core_buffered_reader *self);
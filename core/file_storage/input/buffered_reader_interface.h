@@ -14,9 +14,10 @@ struct core_buffered_reader_interface {
     void (*destroy)(struct core_buffered_reader *self);
     int (*read_line)(struct core_buffered_reader *self, char *buffer, int length);
     int size;
-    int (*detect)(struct core_buffered_reader *self, const char *file);
+    int (*detect)(const char *file);
     uint64_t (*get_offset)(struct core_buffered_reader *self);
     int (*get_previous_bytes)(struct core_buffered_reader *self, char *buffer, int length);
+    int (*read_line_view)(struct core_buffered_reader *self, char **line);
 };
 
 #endif
@@ -2,6 +2,7 @@
 #include "gzip_buffered_reader.h"
 
 #include "buffered_reader.h"
+#include "gzip_index.h"
 
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
@@ -31,6 +32,7 @@ struct core_buffered_reader_interface core_gzip_buffered_reader_implementation =
     .init = core_gzip_buffered_reader_init,
     .destroy = core_gzip_buffered_reader_destroy,
     .read_line = core_gzip_buffered_reader_read_line,
+    .read_line_view = core_gzip_buffered_reader_read_line_view,
     .detect = core_gzip_buffered_reader_detect,
     .get_offset = core_gzip_buffered_reader_get_offset,
     .get_previous_bytes = core_gzip_buffered_reader_get_previous_bytes,
@@ -90,35 +92,50 @@ void core_gzip_buffered_reader_destroy(struct core_buffered_reader *self)
         reader->got_header = 0;
     }
 #else
-    gzclose(reader->descriptor);
-    reader->descriptor = NULL;
+    if (reader->use_index) {
+        core_gzip_index_reader_close(&reader->index_reader);
+        reader->use_index = 0;
+    } else {
+        gzclose(reader->descriptor);
+        reader->descriptor = NULL;
+    }
 #endif
 }
 
 int core_gzip_buffered_reader_read_line(struct core_buffered_reader *self,
                 char *buffer, int length)
+{
+    int read;
+    char *line;
+
+    read = core_gzip_buffered_reader_read_line_view(self, &line);
+
+    return core_buffered_reader_copy_line(buffer, length, line, read);
+}
+
+int core_gzip_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line)
 {
     int read;
     struct core_gzip_buffered_reader *reader;
 
     reader = core_buffered_reader_get_concrete_self(self);
-    read = core_gzip_buffered_reader_read_line_private(self, buffer, length);
+    read = core_gzip_buffered_reader_read_line_view_private(self, line);
 
     reader->offset += read;
 
     return read;
 }
 
-int core_gzip_buffered_reader_read_line_private(struct core_buffered_reader *self,
-                char *buffer, int length)
+int core_gzip_buffered_reader_read_line_view_private(struct core_buffered_reader *self,
+                char **line)
 {
     struct core_gzip_buffered_reader *reader;
 
     reader = core_buffered_reader_get_concrete_self(self);
 
-    char new_line;
-    int position;
-    int has_new_line;
+    char *start;
+    char *new_line;
     int read;
 
     /* the last character in the buffer is '\n'
@@ -129,24 +146,13 @@ int core_gzip_buffered_reader_read_line_private(struct core_buffered_reader *sel
         reader->position_in_buffer = 0;
     }
 
-    new_line = '\n';
-    position = reader->position_in_buffer;
-    has_new_line = 0;
+    start = reader->buffer + reader->position_in_buffer;
+    new_line = memchr(start, '\n', reader->buffer_size - reader->position_in_buffer);
 
-    while (position < reader->buffer_size) {
-        if (reader->buffer[position] == new_line) {
-            has_new_line = 1;
-            break;
-        }
-        position++;
-    }
-
-    if (has_new_line) {
+    if (new_line != NULL) {
 
-        read = position - reader->position_in_buffer;
-        core_memory_copy(buffer, reader->buffer + reader->position_in_buffer,
-                        read);
-        buffer[read] = '\0';
+        read = new_line - start;
+        *line = start;
 
         reader->position_in_buffer += read;
 
@@ -154,19 +160,12 @@ int core_gzip_buffered_reader_read_line_private(struct core_buffered_reader *sel
          */
         reader->position_in_buffer++;
 
-#ifdef CORE_BUFFERED_READER_DEBUG9
-        printf("DEBUG core_buffered_reader_read_line has line"
-                        "  %i to %i-1 : %s\n", position,
-                        reader->position_in_buffer,
-                        buffer);
-#endif
-
         return read;
     } else {
         /* try to pull some data and do a recursive call
          */
         if (core_gzip_buffered_reader_pull(self)) {
-            return core_gzip_buffered_reader_read_line_private(self, buffer, length);
+            return core_gzip_buffered_reader_read_line_view_private(self, line);
         } else {
             return 0;
         }
@@ -243,6 +242,9 @@ void core_gzip_buffered_reader_open(struct core_buffered_reader *self,
                 const char *file, uint64_t offset)
 {
     struct core_gzip_buffered_reader *reader;
+#ifndef CORE_GZIP_BUFFERED_READER_USE_INFLATE
+    struct core_gzip_index index;
+#endif
 
     reader = core_buffered_reader_get_concrete_self(self);
 
@@ -265,11 +267,33 @@ void core_gzip_buffered_reader_open(struct core_buffered_reader *self,
     reader->input_buffer = core_memory_allocate(reader->input_buffer_capacity, MEMORY_GZIP);
 
 #else
-    reader->descriptor = gzopen(file, "r");
+    reader->use_index = 0;
+    reader->descriptor = NULL;
 
-    /* seek- in the file
+    /*
+     * Only a cached index is used here. It is built once by the
+     * input stream that splits the file. Without a cache (read-only
+     * directory), building it again in every stream would inflate
+     * the whole file once per stream, so gzseek is used instead.
      */
-    gzseek(reader->descriptor, offset, SEEK_SET);
+    if (offset > 0) {
+        core_gzip_index_init(&index);
+
+        if (core_gzip_index_load(&index, file)
+                    && core_gzip_index_reader_open(&reader->index_reader, &index, file, offset)) {
+            reader->use_index = 1;
+        }
+
+        core_gzip_index_destroy(&index);
+    }
+
+    if (!reader->use_index) {
+        reader->descriptor = gzopen(file, "r");
+
+        /* seek- in the file
+         */
+        gzseek(reader->descriptor, offset, SEEK_SET);
+    }
 #endif
 }
 
@@ -294,6 +318,10 @@ int core_gzip_buffered_reader_read(struct core_buffered_reader *self,
 
     reader = core_buffered_reader_get_concrete_self(self);
 
+    if (reader->use_index) {
+        return core_gzip_index_reader_read(&reader->index_reader, buffer, length);
+    }
+
     read = gzread(reader->descriptor, buffer, length);
 
     return read;
@@ -493,8 +521,7 @@ int core_gzip_buffered_reader_read_with_inflate(struct core_buffered_reader *sel
 
 #endif
 
-int core_gzip_buffered_reader_detect(struct core_buffered_reader *self,
-                const char *file)
+int core_gzip_buffered_reader_detect(const char *file)
 {
     const char *pointer;
 
@@ -4,6 +4,7 @@
 
 
 #include "buffered_reader_interface.h"
+#include "gzip_index_reader.h"
 
 #include <zlib.h>
 #include <stdio.h>
@@ -49,6 +50,14 @@ struct core_gzip_buffered_reader {
 #else
 
     gzFile descriptor;
+
+    /*
+     * When the starting offset is not 0, inflation resumes at the
+     * nearest access point of a core_gzip_index instead of
+     * inflating everything before the offset with gzseek.
+     */
+    int use_index;
+    struct core_gzip_index_reader index_reader;
 #endif
 
 };
@@ -66,6 +75,12 @@ void core_gzip_buffered_reader_destroy(struct core_buffered_reader *reader);
 int core_gzip_buffered_reader_read_line(struct core_buffered_reader *reader,
                 char *buffer, int length);
 
+/*
+ * The view does not include the \n.
+ */
+int core_gzip_buffered_reader_read_line_view(struct core_buffered_reader *reader,
+                char **line);
+
 /* \return number of bytes copied in buffer
  */
 int core_gzip_buffered_reader_pull(struct core_buffered_reader *reader);
@@ -83,13 +98,12 @@ int core_gzip_buffered_reader_read_with_inflate(struct core_buffered_reader *sel
                 char *buffer, int length);
 #endif
 
-int core_gzip_buffered_reader_detect(struct core_buffered_reader *self,
-                const char *file);
+int core_gzip_buffered_reader_detect(const char *file);
 
 uint64_t core_gzip_buffered_reader_get_offset(struct core_buffered_reader *self);
 
-int core_gzip_buffered_reader_read_line_private(struct core_buffered_reader *self,
-                char *buffer, int length);
+int core_gzip_buffered_reader_read_line_view_private(struct core_buffered_reader *self,
+                char **line);
 int core_gzip_buffered_reader_get_previous_bytes(struct core_buffered_reader *self,
                 char *buffer, int length);
 
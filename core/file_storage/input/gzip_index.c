@@ -0,0 +1,608 @@
+
+#include "gzip_index.h"
+
+#include <core/file_storage/file.h>
+
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <zlib.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+/*
+#define CORE_GZIP_INDEX_DEBUG
+*/
+
+#define MEMORY_GZIP_INDEX 0x7e0b1c5d
+
+#define CHUNK_SIZE 65536
+
+#define CACHE_MAGIC "BIOSALGZ"
+#define CACHE_MAGIC_SIZE 8
+#define CACHE_VERSION 1
+
+#define BGZF_HEADER_SIZE 18
+#define BGZF_FOOTER_SIZE 8
+
+/*
+ * inflateInit2 with 32 + MAX_WBITS detects the gzip header.
+ */
+#define GZIP_WINDOW_BITS (32 + MAX_WBITS)
+
+#define GZ_FILE_EXTENSION ".gz"
+
+static void core_gzip_index_clear(struct core_gzip_index *self);
+static void core_gzip_index_add_point(struct core_gzip_index *self, uint64_t uncompressed_offset,
+                uint64_t compressed_offset, int bits, unsigned char *window, int window_available);
+static int core_gzip_index_build_bgzf(struct core_gzip_index *self, const char *file, uint64_t span);
+static int core_gzip_index_build_with_inflate(struct core_gzip_index *self, const char *file, uint64_t span);
+static void core_gzip_index_get_cache_name(const char *file, char *name, int length);
+
+void core_gzip_index_init(struct core_gzip_index *self)
+{
+    core_vector_init(&self->points, sizeof(struct core_gzip_access_point));
+
+    self->compressed_size = 0;
+    self->uncompressed_size = 0;
+    self->bgzf = 0;
+}
+
+void core_gzip_index_destroy(struct core_gzip_index *self)
+{
+    core_gzip_index_clear(self);
+
+    core_vector_destroy(&self->points);
+}
+
+int core_gzip_index_get(struct core_gzip_index *self, const char *file)
+{
+    if (core_gzip_index_load(self, file)) {
+        return 1;
+    }
+
+    if (!core_gzip_index_build(self, file, CORE_GZIP_INDEX_DEFAULT_SPAN)) {
+        return 0;
+    }
+
+    /*
+     * The directory may be read-only, in which case the index
+     * is only in memory.
+     */
+    core_gzip_index_save(self, file);
+
+    return 1;
+}
+
+int core_gzip_index_build(struct core_gzip_index *self, const char *file, uint64_t span)
+{
+    core_gzip_index_clear(self);
+
+    if (core_gzip_index_build_bgzf(self, file, span)) {
+        return 1;
+    }
+
+    core_gzip_index_clear(self);
+
+    return core_gzip_index_build_with_inflate(self, file, span);
+}
+
+/*
+ * In BGZF, each block is a gzip member with a 'BC' extra field
+ * giving the block size, and the last 4 bytes of a block are the
+ * uncompressed size. Every block start is an access point without window.
+ */
+static int core_gzip_index_build_bgzf(struct core_gzip_index *self, const char *file, uint64_t span)
+{
+    FILE *descriptor;
+    unsigned char header[BGZF_HEADER_SIZE];
+    unsigned char footer[4];
+    uint64_t compressed_offset;
+    uint64_t uncompressed_offset;
+    uint64_t last;
+    uint64_t block_size;
+    uint64_t block_uncompressed_size;
+    uint64_t file_size;
+    int valid;
+
+    descriptor = fopen(file, "rb");
+
+    if (descriptor == NULL) {
+        return 0;
+    }
+
+    file_size = core_file_get_size(file);
+    compressed_offset = 0;
+    uncompressed_offset = 0;
+    last = 0;
+    valid = 1;
+
+    while (compressed_offset < file_size) {
+
+        if (fseeko(descriptor, compressed_offset, SEEK_SET) != 0
+                        || fread(header, 1, BGZF_HEADER_SIZE, descriptor) != BGZF_HEADER_SIZE) {
+            valid = 0;
+            break;
+        }
+
+        if (header[0] != 31 || header[1] != 139 || header[2] != 8
+                        || !(header[3] & 4)
+                        || header[10] != 6 || header[11] != 0
+                        || header[12] != 'B' || header[13] != 'C'
+                        || header[14] != 2 || header[15] != 0) {
+            valid = 0;
+            break;
+        }
+
+        block_size = (header[16] | (header[17] << 8)) + 1;
+
+        if (block_size < BGZF_HEADER_SIZE + BGZF_FOOTER_SIZE
+                        || compressed_offset + block_size > file_size) {
+            valid = 0;
+            break;
+        }
+
+        if (fseeko(descriptor, compressed_offset + block_size - 4, SEEK_SET) != 0
+                        || fread(footer, 1, 4, descriptor) != 4) {
+            valid = 0;
+            break;
+        }
+
+        block_uncompressed_size = footer[0] | (footer[1] << 8) | (footer[2] << 16)
+                | ((uint64_t)footer[3] << 24);
+
+        if (core_vector_size(&self->points) == 0
+                        || uncompressed_offset - last >= span) {
+            core_gzip_index_add_point(self, uncompressed_offset, compressed_offset, 0, NULL, 0);
+            last = uncompressed_offset;
+        }
+
+        uncompressed_offset += block_uncompressed_size;
+        compressed_offset += block_size;
+    }
+
+    fclose(descriptor);
+
+    if (!valid || core_vector_size(&self->points) == 0) {
+        return 0;
+    }
+
+    self->bgzf = 1;
+    self->compressed_size = file_size;
+    self->uncompressed_size = uncompressed_offset;
+
+    return 1;
+}
+
+/*
+ * Inflate the whole file and save the window every span bytes at
+ * a deflate block boundary (zran.c). A new gzip member is also an
+ * access point.
+ */
+static int core_gzip_index_build_with_inflate(struct core_gzip_index *self, const char *file, uint64_t span)
+{
+    FILE *descriptor;
+    z_stream stream;
+    unsigned char *input;
+    unsigned char *window;
+    uint64_t total_in;
+    uint64_t total_out;
+    uint64_t last;
+    int return_value;
+    int valid;
+
+    descriptor = fopen(file, "rb");
+
+    if (descriptor == NULL) {
+        return 0;
+    }
+
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.avail_in = 0;
+    stream.next_in = Z_NULL;
+
+    if (inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK) {
+        fclose(descriptor);
+        return 0;
+    }
+
+    input = core_memory_allocate(CHUNK_SIZE, MEMORY_GZIP_INDEX);
+    window = core_memory_allocate(CORE_GZIP_INDEX_WINDOW_SIZE, MEMORY_GZIP_INDEX);
+
+    stream.avail_out = 0;
+
+    total_in = 0;
+    total_out = 0;
+    last = 0;
+    valid = 1;
+
+    core_gzip_index_add_point(self, 0, 0, 0, NULL, 0);
+
+    while (1) {
+
+        if (stream.avail_in == 0) {
+            stream.avail_in = fread(input, 1, CHUNK_SIZE, descriptor);
+            stream.next_in = input;
+
+            if (stream.avail_in == 0) {
+
+                /*
+                 * The file must end between 2 members.
+                 */
+                if (stream.total_out != 0) {
+                    valid = 0;
+                }
+                break;
+            }
+        }
+
+        if (stream.avail_out == 0) {
+            stream.avail_out = CORE_GZIP_INDEX_WINDOW_SIZE;
+            stream.next_out = window;
+        }
+
+        total_in += stream.avail_in;
+        total_out += stream.avail_out;
+
+        return_value = inflate(&stream, Z_BLOCK);
+
+        total_in -= stream.avail_in;
+        total_out -= stream.avail_out;
+
+        if (return_value == Z_STREAM_END) {
+
+            /*
+             * Another gzip member may follow.
+             */
+            inflateReset(&stream);
+
+            if (total_out - last >= span) {
+                core_gzip_index_add_point(self, total_out, total_in, 0, NULL, 0);
+                last = total_out;
+            }
+
+            continue;
+        }
+
+        if (return_value == Z_DATA_ERROR || return_value == Z_NEED_DICT
+                        || return_value == Z_MEM_ERROR || return_value == Z_STREAM_ERROR) {
+
+            /*
+             * Like gzip, ignore trailing garbage after a member.
+             */
+            if (stream.total_out != 0 || total_out == 0) {
+                valid = 0;
+            }
+            break;
+        }
+
+        if ((stream.data_type & 128) && !(stream.data_type & 64)
+                        && total_out - last >= span) {
+
+            core_gzip_index_add_point(self, total_out, total_in, stream.data_type & 7,
+                            window, stream.avail_out);
+            last = total_out;
+        }
+    }
+
+    inflateEnd(&stream);
+    fclose(descriptor);
+
+    core_memory_free(input, MEMORY_GZIP_INDEX);
+    core_memory_free(window, MEMORY_GZIP_INDEX);
+
+    if (!valid) {
+        core_gzip_index_clear(self);
+        return 0;
+    }
+
+    self->bgzf = 0;
+    self->compressed_size = core_file_get_size(file);
+    self->uncompressed_size = total_out;
+
+#ifdef CORE_GZIP_INDEX_DEBUG
+    printf("DEBUG core_gzip_index %s has %d access points for %" PRIu64 " bytes\n",
+                    file, core_gzip_index_size(self), total_out);
+#endif
+
+    return 1;
+}
+
+/*
+ * The window is circular: the oldest bytes start at
+ * CORE_GZIP_INDEX_WINDOW_SIZE - window_available.
+ */
+static void core_gzip_index_add_point(struct core_gzip_index *self, uint64_t uncompressed_offset,
+                uint64_t compressed_offset, int bits, unsigned char *window, int window_available)
+{
+    struct core_gzip_access_point point;
+
+    point.uncompressed_offset = uncompressed_offset;
+    point.compressed_offset = compressed_offset;
+    point.bits = bits;
+    point.window = NULL;
+
+    if (window != NULL) {
+        point.window = core_memory_allocate(CORE_GZIP_INDEX_WINDOW_SIZE, MEMORY_GZIP_INDEX);
+
+        if (window_available > 0) {
+            core_memory_copy(point.window, window + CORE_GZIP_INDEX_WINDOW_SIZE - window_available,
+                            window_available);
+        }
+
+        if (window_available < CORE_GZIP_INDEX_WINDOW_SIZE) {
+            core_memory_copy(point.window + window_available, window,
+                            CORE_GZIP_INDEX_WINDOW_SIZE - window_available);
+        }
+    }
+
+    core_vector_push_back(&self->points, &point);
+}
+
+static void core_gzip_index_clear(struct core_gzip_index *self)
+{
+    int i;
+    int size;
+    struct core_gzip_access_point *point;
+
+    size = core_vector_size(&self->points);
+
+    for (i = 0; i < size; ++i) {
+        point = core_vector_at(&self->points, i);
+
+        if (point->window != NULL) {
+            core_memory_free(point->window, MEMORY_GZIP_INDEX);
+            point->window = NULL;
+        }
+    }
+
+    core_vector_clear(&self->points);
+
+    self->compressed_size = 0;
+    self->uncompressed_size = 0;
+    self->bgzf = 0;
+}
+
+struct core_gzip_access_point *core_gzip_index_find(struct core_gzip_index *self, uint64_t offset)
+{
+    int first;
+    int last;
+    int middle;
+    struct core_gzip_access_point *point;
+
+    if (core_vector_size(&self->points) == 0) {
+        return NULL;
+    }
+
+    /*
+     * Binary search for the last point with
+     * uncompressed_offset <= offset. The first point is at 0.
+     */
+    first = 0;
+    last = core_vector_size(&self->points) - 1;
+
+    while (first < last) {
+        middle = first + (last - first + 1) / 2;
+        point = core_vector_at(&self->points, middle);
+
+        if (point->uncompressed_offset <= offset) {
+            first = middle;
+        } else {
+            last = middle - 1;
+        }
+    }
+
+    return core_vector_at(&self->points, first);
+}
+
+int core_gzip_index_detect(const char *file)
+{
+    int length;
+    int suffix_length;
+
+    length = strlen(file);
+    suffix_length = strlen(GZ_FILE_EXTENSION);
+
+    return length >= suffix_length
+            && strcmp(file + length - suffix_length, GZ_FILE_EXTENSION) == 0;
+}
+
+int core_gzip_index_size(struct core_gzip_index *self)
+{
+    return core_vector_size(&self->points);
+}
+
+uint64_t core_gzip_index_uncompressed_size(struct core_gzip_index *self)
+{
+    return self->uncompressed_size;
+}
+
+int core_gzip_index_is_bgzf(struct core_gzip_index *self)
+{
+    return self->bgzf;
+}
+
+/*
+ * The cache is written to a unique temporary file (mkstemp) and renamed,
+ * so that writers in the same process or on other nodes never share
+ * a temporary file and readers never see a partial index.
+ */
+int core_gzip_index_save(struct core_gzip_index *self, const char *file)
+{
+    char name[1024];
+    char temporary_name[1100];
+    FILE *descriptor;
+    struct core_gzip_access_point *point;
+    uint64_t count;
+    int32_t value;
+    int i;
+    int valid;
+    int file_descriptor;
+
+    core_gzip_index_get_cache_name(file, name, sizeof(name));
+    snprintf(temporary_name, sizeof(temporary_name), "%s.XXXXXX", name);
+
+    file_descriptor = mkstemp(temporary_name);
+
+    if (file_descriptor < 0) {
+        return 0;
+    }
+
+    /*
+     * mkstemp uses 0600, but the cache is shared like the file.
+     */
+    fchmod(file_descriptor, 0644);
+
+    descriptor = fdopen(file_descriptor, "wb");
+
+    if (descriptor == NULL) {
+        close(file_descriptor);
+        remove(temporary_name);
+        return 0;
+    }
+
+    count = core_vector_size(&self->points);
+    valid = 1;
+
+    valid &= fwrite(CACHE_MAGIC, 1, CACHE_MAGIC_SIZE, descriptor) == CACHE_MAGIC_SIZE;
+    value = CACHE_VERSION;
+    valid &= fwrite(&value, sizeof(value), 1, descriptor) == 1;
+    value = self->bgzf;
+    valid &= fwrite(&value, sizeof(value), 1, descriptor) == 1;
+    valid &= fwrite(&self->compressed_size, sizeof(self->compressed_size), 1, descriptor) == 1;
+    valid &= fwrite(&self->uncompressed_size, sizeof(self->uncompressed_size), 1, descriptor) == 1;
+    valid &= fwrite(&count, sizeof(count), 1, descriptor) == 1;
+
+    for (i = 0; valid && i < (int)count; ++i) {
+        point = core_vector_at(&self->points, i);
+
+        valid &= fwrite(&point->uncompressed_offset, sizeof(uint64_t), 1, descriptor) == 1;
+        valid &= fwrite(&point->compressed_offset, sizeof(uint64_t), 1, descriptor) == 1;
+        value = point->bits;
+        valid &= fwrite(&value, sizeof(value), 1, descriptor) == 1;
+        value = point->window != NULL;
+        valid &= fwrite(&value, sizeof(value), 1, descriptor) == 1;
+
+        if (point->window != NULL) {
+            valid &= fwrite(point->window, 1, CORE_GZIP_INDEX_WINDOW_SIZE, descriptor)
+                    == CORE_GZIP_INDEX_WINDOW_SIZE;
+        }
+    }
+
+    if (fclose(descriptor) != 0) {
+        valid = 0;
+    }
+
+    if (valid && rename(temporary_name, name) == 0) {
+        return 1;
+    }
+
+    remove(temporary_name);
+
+    return 0;
+}
+
+/*
+ * A cached index is used only if it is newer than the file
+ * and if the file size did not change.
+ */
+int core_gzip_index_load(struct core_gzip_index *self, const char *file)
+{
+    char name[1024];
+    char magic[CACHE_MAGIC_SIZE];
+    FILE *descriptor;
+    struct stat file_status;
+    struct stat cache_status;
+    uint64_t count;
+    uint64_t i;
+    int32_t version;
+    int32_t bgzf;
+    int32_t bits;
+    int32_t has_window;
+    uint64_t uncompressed_offset;
+    uint64_t compressed_offset;
+    unsigned char *window;
+    int valid;
+
+    core_gzip_index_clear(self);
+    core_gzip_index_get_cache_name(file, name, sizeof(name));
+
+    if (stat(file, &file_status) != 0 || stat(name, &cache_status) != 0
+                    || cache_status.st_mtime < file_status.st_mtime) {
+        return 0;
+    }
+
+    descriptor = fopen(name, "rb");
+
+    if (descriptor == NULL) {
+        return 0;
+    }
+
+    valid = 1;
+
+    valid &= fread(magic, 1, CACHE_MAGIC_SIZE, descriptor) == CACHE_MAGIC_SIZE
+            && memcmp(magic, CACHE_MAGIC, CACHE_MAGIC_SIZE) == 0;
+    valid &= fread(&version, sizeof(version), 1, descriptor) == 1 && version == CACHE_VERSION;
+    valid &= fread(&bgzf, sizeof(bgzf), 1, descriptor) == 1;
+    valid &= fread(&self->compressed_size, sizeof(uint64_t), 1, descriptor) == 1
+            && self->compressed_size == (uint64_t)file_status.st_size;
+    valid &= fread(&self->uncompressed_size, sizeof(uint64_t), 1, descriptor) == 1;
+    valid &= fread(&count, sizeof(count), 1, descriptor) == 1;
+
+    for (i = 0; valid && i < count; ++i) {
+
+        valid &= fread(&uncompressed_offset, sizeof(uint64_t), 1, descriptor) == 1;
+        valid &= fread(&compressed_offset, sizeof(uint64_t), 1, descriptor) == 1;
+        valid &= fread(&bits, sizeof(bits), 1, descriptor) == 1;
+        valid &= fread(&has_window, sizeof(has_window), 1, descriptor) == 1;
+
+        if (!valid) {
+            break;
+        }
+
+        window = NULL;
+
+        if (has_window) {
+            window = core_memory_allocate(CORE_GZIP_INDEX_WINDOW_SIZE, MEMORY_GZIP_INDEX);
+            valid &= fread(window, 1, CORE_GZIP_INDEX_WINDOW_SIZE, descriptor)
+                    == CORE_GZIP_INDEX_WINDOW_SIZE;
+        }
+
+        /*
+         * The window is copied in place (nothing is available
+         * at the end of the circular buffer).
+         */
+        core_gzip_index_add_point(self, uncompressed_offset, compressed_offset, bits,
+                        window, 0);
+
+        if (window != NULL) {
+            core_memory_free(window, MEMORY_GZIP_INDEX);
+        }
+    }
+
+    fclose(descriptor);
+
+    if (!valid || core_vector_size(&self->points) == 0) {
+        core_gzip_index_clear(self);
+        return 0;
+    }
+
+    self->bgzf = bgzf;
+    self->compressed_size = file_status.st_size;
+
+    return 1;
+}
+
+static void core_gzip_index_get_cache_name(const char *file, char *name, int length)
+{
+    snprintf(name, length, "%s%s", file, CORE_GZIP_INDEX_SUFFIX);
+}
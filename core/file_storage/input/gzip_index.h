@@ -0,0 +1,85 @@
+
+#ifndef CORE_GZIP_INDEX_H
+#define CORE_GZIP_INDEX_H
+
+#include <core/structures/vector.h>
+
+#include <stdint.h>
+
+/*
+ * Size of the deflate history needed to resume inflation.
+ */
+#define CORE_GZIP_INDEX_WINDOW_SIZE 32768
+
+/*
+ * Distance between 2 access points, in uncompressed bytes.
+ */
+#define CORE_GZIP_INDEX_DEFAULT_SPAN 16777216
+
+/*
+ * An access point in a gzip file.
+ *
+ * An access point at the start of a gzip member (for example a BGZF
+ * block) has no window. Otherwise, the window contains the last
+ * CORE_GZIP_INDEX_WINDOW_SIZE uncompressed bytes, and bits is the number
+ * of bits of the byte before compressed_offset that are still to be
+ * inflated.
+ */
+struct core_gzip_access_point {
+    uint64_t uncompressed_offset;
+    uint64_t compressed_offset;
+    int bits;
+    unsigned char *window;
+};
+
+/*
+ * An index of access points for random access in a gzip file, like zran.c
+ * in the zlib examples. Files with many members are supported, and BGZF
+ * files are indexed from their block headers without inflating them.
+ *
+ * The index is cached next to the file (file + CORE_GZIP_INDEX_SUFFIX)
+ * when the directory is writable.
+ *
+ * \see https://github.com/madler/zlib/blob/master/examples/zran.c
+ * \see http://samtools.github.io/hts-specs/SAMv1.pdf (BGZF)
+ */
+struct core_gzip_index {
+    struct core_vector points;
+    uint64_t compressed_size;
+    uint64_t uncompressed_size;
+    int bgzf;
+};
+
+#define CORE_GZIP_INDEX_SUFFIX ".biosal_gzip_index"
+
+void core_gzip_index_init(struct core_gzip_index *self);
+void core_gzip_index_destroy(struct core_gzip_index *self);
+
+/*
+ * Load the cached index, or build it and try to cache it.
+ * \return 1 if the index is ready
+ */
+int core_gzip_index_get(struct core_gzip_index *self, const char *file);
+
+/*
+ * \return 1 on success
+ */
+int core_gzip_index_build(struct core_gzip_index *self, const char *file, uint64_t span);
+int core_gzip_index_load(struct core_gzip_index *self, const char *file);
+int core_gzip_index_save(struct core_gzip_index *self, const char *file);
+
+/*
+ * Get the last access point at or before offset.
+ */
+struct core_gzip_access_point *core_gzip_index_find(struct core_gzip_index *self, uint64_t offset);
+
+/*
+ * \return 1 if the file name has the gzip suffix
+ */
+int core_gzip_index_detect(const char *file);
+
+int core_gzip_index_size(struct core_gzip_index *self);
+uint64_t core_gzip_index_uncompressed_size(struct core_gzip_index *self);
+int core_gzip_index_is_bgzf(struct core_gzip_index *self);
+
+#endif
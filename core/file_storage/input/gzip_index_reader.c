@@ -0,0 +1,216 @@
+
+#include "gzip_index_reader.h"
+
+#include "gzip_index.h"
+
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <sys/types.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define MEMORY_GZIP_INDEX_READER 0x1a55c0e7
+
+#define INPUT_BUFFER_SIZE 65536
+
+/*
+ * The gzip trailer contains the CRC-32 and the size.
+ */
+#define GZIP_TRAILER_SIZE 8
+
+#define RAW_WINDOW_BITS (-MAX_WBITS)
+#define GZIP_WINDOW_BITS (32 + MAX_WBITS)
+
+static int core_gzip_index_reader_fill(struct core_gzip_index_reader *self);
+static int core_gzip_index_reader_skip_trailer(struct core_gzip_index_reader *self);
+
+int core_gzip_index_reader_open(struct core_gzip_index_reader *self, struct core_gzip_index *index,
+                const char *file, uint64_t offset)
+{
+    struct core_gzip_access_point *point;
+    uint64_t skip;
+    int byte;
+    int read;
+    int length;
+    char *discarded;
+
+    self->descriptor = NULL;
+    self->input = NULL;
+    self->input_capacity = 0;
+    self->end = 0;
+
+    point = core_gzip_index_find(index, offset);
+
+    if (point == NULL) {
+        return 0;
+    }
+
+    self->descriptor = fopen(file, "rb");
+
+    if (self->descriptor == NULL) {
+        return 0;
+    }
+
+    self->stream.zalloc = Z_NULL;
+    self->stream.zfree = Z_NULL;
+    self->stream.opaque = Z_NULL;
+    self->stream.avail_in = 0;
+    self->stream.next_in = Z_NULL;
+
+    self->raw = point->window != NULL;
+
+    if (inflateInit2(&self->stream, self->raw ? RAW_WINDOW_BITS : GZIP_WINDOW_BITS) != Z_OK) {
+        fclose(self->descriptor);
+        self->descriptor = NULL;
+        return 0;
+    }
+
+    self->input_capacity = INPUT_BUFFER_SIZE;
+    self->input = core_memory_allocate(self->input_capacity, MEMORY_GZIP_INDEX_READER);
+
+    fseeko(self->descriptor, point->compressed_offset - (point->bits ? 1 : 0), SEEK_SET);
+
+    /*
+     * Resume in the middle of a deflate stream (zran.c).
+     */
+    if (self->raw) {
+
+        if (point->bits) {
+            byte = getc(self->descriptor);
+
+            if (byte == EOF) {
+                core_gzip_index_reader_close(self);
+                return 0;
+            }
+
+            inflatePrime(&self->stream, point->bits, byte >> (8 - point->bits));
+        }
+
+        inflateSetDictionary(&self->stream, point->window, CORE_GZIP_INDEX_WINDOW_SIZE);
+    }
+
+    /*
+     * Inflate and discard the bytes between the access point
+     * and the offset.
+     */
+    skip = offset - point->uncompressed_offset;
+    discarded = core_memory_allocate(INPUT_BUFFER_SIZE, MEMORY_GZIP_INDEX_READER);
+
+    while (skip > 0) {
+        length = INPUT_BUFFER_SIZE;
+
+        if (skip < (uint64_t)length) {
+            length = skip;
+        }
+
+        read = core_gzip_index_reader_read(self, discarded, length);
+
+        if (read == 0) {
+            break;
+        }
+
+        skip -= read;
+    }
+
+    core_memory_free(discarded, MEMORY_GZIP_INDEX_READER);
+
+    return 1;
+}
+
+void core_gzip_index_reader_close(struct core_gzip_index_reader *self)
+{
+    if (self->descriptor == NULL) {
+        return;
+    }
+
+    inflateEnd(&self->stream);
+    fclose(self->descriptor);
+    self->descriptor = NULL;
+
+    core_memory_free(self->input, MEMORY_GZIP_INDEX_READER);
+    self->input = NULL;
+    self->input_capacity = 0;
+}
+
+int core_gzip_index_reader_read(struct core_gzip_index_reader *self, char *buffer, int length)
+{
+    int return_value;
+
+    self->stream.avail_out = length;
+    self->stream.next_out = (unsigned char *)buffer;
+
+    while (self->stream.avail_out > 0 && !self->end) {
+
+        if (self->stream.avail_in == 0 && !core_gzip_index_reader_fill(self)) {
+            self->end = 1;
+            break;
+        }
+
+        return_value = inflate(&self->stream, Z_NO_FLUSH);
+
+        if (return_value == Z_STREAM_END) {
+
+            /*
+             * A raw deflate stream is followed by the gzip trailer
+             * of its member. Then, the next member (if any) has a
+             * gzip header.
+             */
+            if (self->raw) {
+                if (!core_gzip_index_reader_skip_trailer(self)) {
+                    self->end = 1;
+                    break;
+                }
+
+                inflateReset2(&self->stream, GZIP_WINDOW_BITS);
+                self->raw = 0;
+            } else {
+                inflateReset(&self->stream);
+            }
+
+        /*
+         * Trailing garbage, or a corrupted file.
+         */
+        } else if (return_value != Z_OK && return_value != Z_BUF_ERROR) {
+            self->end = 1;
+        }
+    }
+
+    return length - self->stream.avail_out;
+}
+
+static int core_gzip_index_reader_fill(struct core_gzip_index_reader *self)
+{
+    self->stream.avail_in = fread(self->input, 1, self->input_capacity, self->descriptor);
+    self->stream.next_in = self->input;
+
+    return self->stream.avail_in > 0;
+}
+
+static int core_gzip_index_reader_skip_trailer(struct core_gzip_index_reader *self)
+{
+    int remaining;
+    int count;
+
+    remaining = GZIP_TRAILER_SIZE;
+
+    while (remaining > 0) {
+
+        if (self->stream.avail_in == 0 && !core_gzip_index_reader_fill(self)) {
+            return 0;
+        }
+
+        count = remaining;
+
+        if ((int)self->stream.avail_in < count) {
+            count = self->stream.avail_in;
+        }
+
+        self->stream.next_in += count;
+        self->stream.avail_in -= count;
+        remaining -= count;
+    }
+
+    return 1;
+}
@@ -0,0 +1,45 @@
+
+#ifndef CORE_GZIP_INDEX_READER_H
+#define CORE_GZIP_INDEX_READER_H
+
+#include <zlib.h>
+
+#include <stdio.h>
+#include <stdint.h>
+
+struct core_gzip_index;
+
+/*
+ * Inflate a gzip file starting at any uncompressed offset, using
+ * the nearest access point of a core_gzip_index.
+ *
+ * Only the access point is needed, so the index can be destroyed
+ * after core_gzip_index_reader_open.
+ */
+struct core_gzip_index_reader {
+    FILE *descriptor;
+    z_stream stream;
+    unsigned char *input;
+    int input_capacity;
+
+    /*
+     * 1 while inflating raw deflate data from an access point with
+     * a window, 0 while inflating gzip members.
+     */
+    int raw;
+    int end;
+};
+
+/*
+ * \return 1 on success
+ */
+int core_gzip_index_reader_open(struct core_gzip_index_reader *self, struct core_gzip_index *index,
+                const char *file, uint64_t offset);
+void core_gzip_index_reader_close(struct core_gzip_index_reader *self);
+
+/*
+ * \return number of bytes copied in buffer, 0 at the end of the file
+ */
+int core_gzip_index_reader_read(struct core_gzip_index_reader *self, char *buffer, int length);
+
+#endif
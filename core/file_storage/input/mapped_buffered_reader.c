@@ -0,0 +1,215 @@
+
+#include "mapped_buffered_reader.h"
+
+#include "buffered_reader.h"
+
+#include <core/system/memory.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <string.h>
+
+struct core_buffered_reader_interface core_mapped_buffered_reader_implementation = {
+    .init = core_mapped_buffered_reader_init,
+    .destroy = core_mapped_buffered_reader_destroy,
+    .read_line = core_mapped_buffered_reader_read_line,
+    .read_line_view = core_mapped_buffered_reader_read_line_view,
+    .detect = core_mapped_buffered_reader_detect,
+    .get_offset = core_mapped_buffered_reader_get_offset,
+    .get_previous_bytes = core_mapped_buffered_reader_get_previous_bytes,
+    .size = sizeof(struct core_mapped_buffered_reader)
+};
+
+static void core_mapped_buffered_reader_release(struct core_mapped_buffered_reader *self);
+
+void core_mapped_buffered_reader_init(struct core_buffered_reader *self,
+                const char *file, uint64_t offset)
+{
+    struct core_mapped_buffered_reader *reader;
+    struct stat information;
+    void *map;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    reader->map = NULL;
+    reader->size = 0;
+    reader->position = 0;
+    reader->released = 0;
+
+    reader->descriptor = open(file, O_RDONLY);
+
+    if (reader->descriptor < 0) {
+        printf("Error: can not open file %s\n", file);
+        return;
+    }
+
+    if (fstat(reader->descriptor, &information) != 0 || information.st_size == 0) {
+        return;
+    }
+
+    map = mmap(NULL, information.st_size, PROT_READ, MAP_PRIVATE, reader->descriptor, 0);
+
+    if (map == MAP_FAILED) {
+        printf("Error: can not map file %s\n", file);
+        return;
+    }
+
+    reader->map = map;
+    reader->size = information.st_size;
+
+    /*
+     * Ask for aggressive read-ahead.
+     */
+    madvise(reader->map, reader->size, MADV_SEQUENTIAL);
+
+    if (offset > reader->size) {
+        offset = reader->size;
+    }
+
+    reader->position = offset;
+    reader->released = offset;
+}
+
+void core_mapped_buffered_reader_destroy(struct core_buffered_reader *self)
+{
+    struct core_mapped_buffered_reader *reader;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    if (reader->map != NULL) {
+        munmap(reader->map, reader->size);
+        reader->map = NULL;
+    }
+
+    if (reader->descriptor >= 0) {
+        close(reader->descriptor);
+        reader->descriptor = -1;
+    }
+
+    reader->size = 0;
+    reader->position = 0;
+    reader->released = 0;
+}
+
+int core_mapped_buffered_reader_read_line(struct core_buffered_reader *self,
+                char *buffer, int length)
+{
+    int read;
+    char *line;
+
+    read = core_mapped_buffered_reader_read_line_view(self, &line);
+
+    /*
+     * Lines are not limited by a buffer size in the mapping.
+     */
+    return core_buffered_reader_copy_line(buffer, length, line, read);
+}
+
+int core_mapped_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line)
+{
+    struct core_mapped_buffered_reader *reader;
+    char *start;
+    char *new_line;
+    uint64_t available;
+    uint64_t read;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    available = reader->size - reader->position;
+
+    if (available == 0) {
+        return 0;
+    }
+
+    start = reader->map + reader->position;
+
+    /*
+     * memchr is vectorized in the C library.
+     */
+    new_line = memchr(start, '\n', available);
+
+    if (new_line != NULL) {
+        read = new_line - start + 1;
+    } else {
+        read = available;
+    }
+
+    *line = start;
+    reader->position += read;
+
+    if (reader->position - reader->released >= CORE_MAPPED_BUFFERED_READER_RELEASE_SIZE) {
+        core_mapped_buffered_reader_release(reader);
+    }
+
+    return read;
+}
+
+int core_mapped_buffered_reader_detect(const char *file)
+{
+    struct stat information;
+
+    if (stat(file, &information) != 0) {
+        return 0;
+    }
+
+    return S_ISREG(information.st_mode) && information.st_size > 0;
+}
+
+uint64_t core_mapped_buffered_reader_get_offset(struct core_buffered_reader *self)
+{
+    struct core_mapped_buffered_reader *reader;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    return reader->position;
+}
+
+int core_mapped_buffered_reader_get_previous_bytes(struct core_buffered_reader *self,
+                char *buffer, int length)
+{
+    struct core_mapped_buffered_reader *reader;
+    uint64_t count;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    count = length;
+
+    if (reader->position < count) {
+        count = reader->position;
+    }
+
+    if (count > 0)
+        core_memory_copy(buffer, reader->map + reader->position - count, count);
+
+    return count;
+}
+
+/*
+ * Drop the pages that were consumed. They stay in the page cache, but
+ * they are no longer counted in the resident memory of the process.
+ * For a read-only file mapping, a page that is used again (for example
+ * by the last view) is simply faulted in again.
+ */
+static void core_mapped_buffered_reader_release(struct core_mapped_buffered_reader *self)
+{
+    uint64_t page_size;
+    uint64_t first;
+    uint64_t last;
+
+    page_size = sysconf(_SC_PAGESIZE);
+
+    first = self->released / page_size * page_size;
+    last = self->position / page_size * page_size;
+
+    if (last > first) {
+        madvise(self->map + first, last - first, MADV_DONTNEED);
+    }
+
+    self->released = self->position;
+}
@@ -0,0 +1,57 @@
+
+#ifndef CORE_MAPPED_BUFFERED_READER_H
+#define CORE_MAPPED_BUFFERED_READER_H
+
+#include "buffered_reader_interface.h"
+
+#include <stdint.h>
+
+struct core_buffered_reader;
+
+/*
+ * A reader for uncompressed files that maps the whole file in memory.
+ *
+ * Lines are found with memchr directly in the mapping, so a line view
+ * is a pointer in the page cache and nothing is copied. The kernel is
+ * told that the access is sequential, and pages that were already
+ * consumed are released every CORE_MAPPED_BUFFERED_READER_RELEASE_SIZE
+ * bytes.
+ */
+struct core_mapped_buffered_reader {
+
+    char *map;
+    uint64_t size;
+    uint64_t position;
+    uint64_t released;
+    int descriptor;
+};
+
+/*
+ * Release consumed pages every 64 MiB.
+ */
+#define CORE_MAPPED_BUFFERED_READER_RELEASE_SIZE 67108864
+
+extern struct core_buffered_reader_interface core_mapped_buffered_reader_implementation;
+
+void core_mapped_buffered_reader_init(struct core_buffered_reader *self,
+                const char *file, uint64_t offset);
+void core_mapped_buffered_reader_destroy(struct core_buffered_reader *self);
+
+/*
+ * \return number of bytes copied in buffer
+ * This does include the \n, if any
+ */
+int core_mapped_buffered_reader_read_line(struct core_buffered_reader *self,
+                char *buffer, int length);
+int core_mapped_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line);
+
+/*
+ * \return 1 if the file is a regular file that is not empty
+ */
+int core_mapped_buffered_reader_detect(const char *file);
+uint64_t core_mapped_buffered_reader_get_offset(struct core_buffered_reader *self);
+int core_mapped_buffered_reader_get_previous_bytes(struct core_buffered_reader *self,
+                char *buffer, int length);
+
+#endif
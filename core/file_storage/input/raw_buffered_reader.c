@@ -18,6 +18,7 @@ struct core_buffered_reader_interface core_raw_buffered_reader_implementation =
     .detect = core_raw_buffered_reader_detect,
     .get_offset = core_raw_buffered_reader_get_offset,
     .get_previous_bytes = core_raw_buffered_reader_get_previous_bytes,
+    .read_line_view = core_raw_buffered_reader_read_line_view,
     .size = sizeof(struct core_raw_buffered_reader)
 };
 
@@ -81,34 +82,45 @@ void core_raw_buffered_reader_destroy(struct core_buffered_reader *self)
 
 int core_raw_buffered_reader_read_line(struct core_buffered_reader *self,
                 char *buffer, int length)
+{
+    int read;
+    char *line;
+
+    read = core_raw_buffered_reader_read_line_view(self, &line);
+    read = core_buffered_reader_copy_line(buffer, length, line, read);
+
+#if 0
+    printf("OFFSET <%s> read %d\n", buffer, read);
+#endif
+
+    return read;
+}
+
+int core_raw_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line)
 {
     int read;
     struct core_raw_buffered_reader *reader;
 
     reader = core_buffered_reader_get_concrete_self(self);
 
-    read = core_raw_buffered_reader_read_line_private(self, buffer, length);
+    read = core_raw_buffered_reader_read_line_view_private(self, line);
 
     reader->offset += read;
 
-#if 0
-    printf("OFFSET <%s> read %d new offset %" PRIu64 "\n",
-                    buffer, read, reader->offset);
-#endif
-
     return read;
 }
 
-int core_raw_buffered_reader_read_line_private(struct core_buffered_reader *self,
-                char *buffer, int length)
+int core_raw_buffered_reader_read_line_view_private(struct core_buffered_reader *self,
+                char **line)
 {
     struct core_raw_buffered_reader *reader;
 
     reader = core_buffered_reader_get_concrete_self(self);
 
-    char new_line;
-    int position;
-    int has_new_line;
+    char *start;
+    char *new_line;
+    int available;
     int read;
     int end_of_file;
 
@@ -120,57 +132,39 @@ int core_raw_buffered_reader_read_line_private(struct core_buffered_reader *self
         reader->position_in_buffer = 0;
     }
 
-    new_line = '\n';
-    position = reader->position_in_buffer;
-    has_new_line = 0;
-
-    while (position < reader->buffer_size) {
-        if (reader->buffer[position] == new_line) {
-            has_new_line = 1;
-            break;
-        }
-        position++;
-    }
+    start = reader->buffer + reader->position_in_buffer;
+    available = reader->buffer_size - reader->position_in_buffer;
 
     /*
-     * Keep the new line if any
+     * memchr is vectorized in the C library.
      */
-
-    if (has_new_line) {
-        ++position;
-    }
+    new_line = memchr(start, '\n', available);
 
     end_of_file = feof(reader->descriptor);
 
     /*
-     * Return the line
+     * Return the line, with its new line if any
      */
-    if (has_new_line || end_of_file) {
+    if (new_line != NULL || end_of_file) {
 
-        read = position - reader->position_in_buffer;
+        if (new_line != NULL) {
+            read = new_line - start + 1;
+        } else {
+            read = available;
+        }
 
-        if (read > 0)
-            core_memory_copy(buffer, reader->buffer + reader->position_in_buffer,
-                        read);
-        buffer[read] = '\0';
+        *line = start;
 
         /* skip the line and '\n' if any
          */
         reader->position_in_buffer += read;
 
-#ifdef CORE_BUFFERED_READER_DEBUG9
-        printf("DEBUG core_buffered_reader_read_line has line"
-                        "  %i to %i-1 : %s\n", position,
-                        reader->position_in_buffer,
-                        buffer);
-#endif
-
         return read;
     } else {
         /* try to pull some data and do a recursive call
          */
         if (core_raw_buffered_reader_pull(self)) {
-            return core_raw_buffered_reader_read_line_private(self, buffer, length);
+            return core_raw_buffered_reader_read_line_view_private(self, line);
         } else {
             return 0;
         }
@@ -241,8 +235,7 @@ int core_raw_buffered_reader_pull(struct core_buffered_reader *self)
     return read;
 }
 
-int core_raw_buffered_reader_detect(struct core_buffered_reader *self,
-                const char *file)
+int core_raw_buffered_reader_detect(const char *file)
 {
     return 1;
 }
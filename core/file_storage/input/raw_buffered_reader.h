@@ -36,16 +36,18 @@ void core_raw_buffered_reader_destroy(struct core_buffered_reader *self);
 int core_raw_buffered_reader_read_line(struct core_buffered_reader *self,
                 char *buffer, int length);
 
+int core_raw_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                char **line);
+
 /* \return number of bytes copied in buffer
  */
 int core_raw_buffered_reader_pull(struct core_buffered_reader *self);
 
-int core_raw_buffered_reader_detect(struct core_buffered_reader *self,
-                const char *file);
+int core_raw_buffered_reader_detect(const char *file);
 uint64_t core_raw_buffered_reader_get_offset(struct core_buffered_reader *self);
 
-int core_raw_buffered_reader_read_line_private(struct core_buffered_reader *self,
-                char *buffer, int length);
+int core_raw_buffered_reader_read_line_view_private(struct core_buffered_reader *self,
+                char **line);
 int core_raw_buffered_reader_get_previous_bytes(struct core_buffered_reader *self,
                 char *buffer, int length);
 #endif
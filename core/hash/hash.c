@@ -7,3 +7,21 @@ uint64_t core_hash_data_uint64_t(const void *key, int length, unsigned int seed)
 {
     return core_murmur_hash_2_64_a(key, length, seed);
 }
+
+/*
+ * Integer hashing for keys that fit in a word.
+ *
+ * This is the 64-bit finalizer of MurmurHash3.
+ * \see https://code.google.com/p/smhasher/wiki/MurmurHash3
+ */
+uint64_t core_hash_uint64_t(uint64_t key, unsigned int seed)
+{
+    key ^= seed;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+
+    return key;
+}
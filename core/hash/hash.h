@@ -5,5 +5,6 @@
 #include <stdint.h>
 
 uint64_t core_hash_data_uint64_t(const void *data, int length, unsigned int seed);
+uint64_t core_hash_uint64_t(uint64_t key, unsigned int seed);
 
 #endif
@@ -5,6 +5,9 @@ CORE_OBJECTS += core/structures/string.o
 
 CORE_OBJECTS += core/structures/ring.o
 CORE_OBJECTS += core/structures/fast_ring.o
+CORE_OBJECTS += core/structures/work_stealing_deque.o
+CORE_OBJECTS += core/structures/mpsc_ring.o
+CORE_OBJECTS += core/structures/lock_free_stack.o
 
 CORE_OBJECTS += core/structures/linked_ring.o
 CORE_OBJECTS += core/structures/fast_queue.o
@@ -22,6 +25,7 @@ CORE_OBJECTS += core/structures/map_iterator.o
 CORE_OBJECTS += core/structures/set.o
 CORE_OBJECTS += core/structures/set_iterator.o
 CORE_OBJECTS += core/structures/stack.o
+CORE_OBJECTS += core/structures/concurrent_counting_table.o
 
 # ordered structures
 CORE_OBJECTS += core/structures/ordered/red_black_node.o
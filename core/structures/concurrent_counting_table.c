@@ -0,0 +1,240 @@
+
+#include "concurrent_counting_table.h"
+
+#include <core/hash/hash.h>
+
+#include <core/system/atomic.h>
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <string.h>
+
+#define MEMORY_CONCURRENT_COUNTING_TABLE 0x9a4e1d37
+
+#define CORE_CONCURRENT_COUNTING_TABLE_SEED 0x5d3c8a71
+
+/*
+ * The states of a bucket.
+ */
+#define BUCKET_EMPTY 0
+#define BUCKET_BUSY 1
+#define BUCKET_READY 2
+
+/*
+ * A bucket is a state, a counter, and then the key.
+ */
+#define BUCKET_HEADER_SIZE (2 * sizeof(int))
+
+static char *core_concurrent_counting_table_get_bucket(struct core_concurrent_counting_table *self,
+                uint64_t bucket);
+static int *core_concurrent_counting_table_state(char *bucket);
+static int *core_concurrent_counting_table_counter(char *bucket);
+static void *core_concurrent_counting_table_key(char *bucket);
+
+void core_concurrent_counting_table_init(struct core_concurrent_counting_table *self,
+                uint64_t buckets, int key_size)
+{
+    uint64_t bucket_count;
+    size_t size;
+
+    CORE_DEBUGGER_ASSERT(key_size > 0);
+
+    /*
+     * Use a power of 2 to replace the modulo by a mask.
+     */
+    bucket_count = 2;
+
+    while (bucket_count < buckets) {
+        bucket_count *= 2;
+    }
+
+    self->bucket_count = bucket_count;
+    self->bucket_count_mask = bucket_count - 1;
+    self->key_size = key_size;
+
+    /*
+     * Align the buckets on 8 bytes.
+     */
+    self->bucket_size = BUCKET_HEADER_SIZE + key_size;
+    self->bucket_size = (self->bucket_size + 7) & ~7;
+
+    size = self->bucket_count * self->bucket_size;
+    self->buckets = core_memory_allocate(size, MEMORY_CONCURRENT_COUNTING_TABLE);
+
+    /*
+     * BUCKET_EMPTY is 0.
+     */
+    memset(self->buckets, 0, size);
+
+    self->total = 0;
+}
+
+void core_concurrent_counting_table_destroy(struct core_concurrent_counting_table *self)
+{
+    if (self->buckets != NULL) {
+        core_memory_free(self->buckets, MEMORY_CONCURRENT_COUNTING_TABLE);
+        self->buckets = NULL;
+    }
+
+    self->bucket_count = 0;
+    self->bucket_count_mask = 0;
+    self->key_size = 0;
+    self->bucket_size = 0;
+    self->total = 0;
+}
+
+/*
+ * Called by any thread.
+ */
+int core_concurrent_counting_table_add(struct core_concurrent_counting_table *self,
+                void *key, int count)
+{
+    uint64_t bucket;
+    uint64_t hash;
+    char *pointer;
+    int *state;
+    int value;
+    int old_value;
+    int probe;
+
+    hash = core_hash_data_uint64_t(key, self->key_size, CORE_CONCURRENT_COUNTING_TABLE_SEED);
+    bucket = hash & self->bucket_count_mask;
+
+    for (probe = 0; probe < CORE_CONCURRENT_COUNTING_TABLE_MAXIMUM_PROBES; ++probe) {
+
+        pointer = core_concurrent_counting_table_get_bucket(self, bucket);
+        state = core_concurrent_counting_table_state(pointer);
+
+        /*
+         * core_atomic_read_int is a fetch-and-and with 1, which
+         * would change the states. Adding 0 reads the value.
+         */
+        value = core_atomic_add_int(state, 0);
+
+        if (value == BUCKET_EMPTY) {
+
+            old_value = core_atomic_compare_and_swap_int(state, BUCKET_EMPTY, BUCKET_BUSY);
+
+            /*
+             * This thread owns the bucket, so it writes the key and
+             * publishes it.
+             */
+            if (old_value == BUCKET_EMPTY) {
+                memcpy(core_concurrent_counting_table_key(pointer), key, self->key_size);
+                core_atomic_compare_and_swap_int(state, BUCKET_BUSY, BUCKET_READY);
+                core_atomic_add_int(core_concurrent_counting_table_counter(pointer), count);
+
+                return 1;
+            }
+
+            value = old_value;
+        }
+
+        /*
+         * Another thread is writing the key of this bucket.
+         */
+        while (value == BUCKET_BUSY) {
+            value = core_atomic_add_int(state, 0);
+        }
+
+        if (memcmp(core_concurrent_counting_table_key(pointer), key, self->key_size) == 0) {
+            core_atomic_add_int(core_concurrent_counting_table_counter(pointer), count);
+
+            return 1;
+        }
+
+        bucket = (bucket + 1) & self->bucket_count_mask;
+    }
+
+    return 0;
+}
+
+int core_concurrent_counting_table_get(struct core_concurrent_counting_table *self,
+                void *key)
+{
+    uint64_t bucket;
+    uint64_t hash;
+    char *pointer;
+    int probe;
+
+    hash = core_hash_data_uint64_t(key, self->key_size, CORE_CONCURRENT_COUNTING_TABLE_SEED);
+    bucket = hash & self->bucket_count_mask;
+
+    for (probe = 0; probe < CORE_CONCURRENT_COUNTING_TABLE_MAXIMUM_PROBES; ++probe) {
+
+        pointer = core_concurrent_counting_table_get_bucket(self, bucket);
+
+        if (*core_concurrent_counting_table_state(pointer) != BUCKET_READY) {
+            return 0;
+        }
+
+        if (memcmp(core_concurrent_counting_table_key(pointer), key, self->key_size) == 0) {
+            return *core_concurrent_counting_table_counter(pointer);
+        }
+
+        bucket = (bucket + 1) & self->bucket_count_mask;
+    }
+
+    return 0;
+}
+
+uint64_t core_concurrent_counting_table_buckets(struct core_concurrent_counting_table *self)
+{
+    return self->bucket_count;
+}
+
+int core_concurrent_counting_table_bucket(struct core_concurrent_counting_table *self,
+                uint64_t bucket, void **key, int *count)
+{
+    char *pointer;
+
+    CORE_DEBUGGER_ASSERT(bucket < self->bucket_count);
+
+    pointer = core_concurrent_counting_table_get_bucket(self, bucket);
+
+    if (*core_concurrent_counting_table_state(pointer) != BUCKET_READY) {
+        return 0;
+    }
+
+    *key = core_concurrent_counting_table_key(pointer);
+    *count = *core_concurrent_counting_table_counter(pointer);
+
+    return 1;
+}
+
+void core_concurrent_counting_table_increase_total(struct core_concurrent_counting_table *self,
+                int64_t value)
+{
+    core_atomic_add_int64_t(&self->total, value);
+}
+
+int64_t core_concurrent_counting_table_total(struct core_concurrent_counting_table *self)
+{
+    return core_atomic_add_int64_t(&self->total, 0);
+}
+
+int core_concurrent_counting_table_key_size(struct core_concurrent_counting_table *self)
+{
+    return self->key_size;
+}
+
+static char *core_concurrent_counting_table_get_bucket(struct core_concurrent_counting_table *self,
+                uint64_t bucket)
+{
+    return self->buckets + bucket * self->bucket_size;
+}
+
+static int *core_concurrent_counting_table_state(char *bucket)
+{
+    return (int *)bucket;
+}
+
+static int *core_concurrent_counting_table_counter(char *bucket)
+{
+    return (int *)(bucket + sizeof(int));
+}
+
+static void *core_concurrent_counting_table_key(char *bucket)
+{
+    return bucket + BUCKET_HEADER_SIZE;
+}
@@ -0,0 +1,71 @@
+
+#ifndef CORE_CONCURRENT_COUNTING_TABLE_H
+#define CORE_CONCURRENT_COUNTING_TABLE_H
+
+#include <stdint.h>
+
+/*
+ * A fixed-capacity hash table of counters with fixed-width keys
+ * that many threads can update at the same time.
+ *
+ * core_concurrent_counting_table_add is lock-free: an empty bucket is
+ * claimed with a compare-and-swap, and the counter of a bucket is
+ * increased with an atomic fetch-and-add.
+ *
+ * The table never grows. When no bucket is found within
+ * CORE_CONCURRENT_COUNTING_TABLE_MAXIMUM_PROBES buckets,
+ * core_concurrent_counting_table_add returns 0 and the caller is
+ * expected to count the key somewhere else.
+ *
+ * Entries can not be removed. The buckets must only be iterated once
+ * no thread is adding anymore.
+ */
+#define CORE_CONCURRENT_COUNTING_TABLE_MAXIMUM_PROBES 64
+
+struct core_concurrent_counting_table {
+    char *buckets;
+    uint64_t bucket_count;
+    uint64_t bucket_count_mask;
+    int key_size;
+    int bucket_size;
+
+    int64_t total;
+};
+
+void core_concurrent_counting_table_init(struct core_concurrent_counting_table *self,
+                uint64_t buckets, int key_size);
+void core_concurrent_counting_table_destroy(struct core_concurrent_counting_table *self);
+
+/*
+ * Add count to the counter of key.
+ *
+ * \return 1 if the key was counted, 0 if the table is too full.
+ */
+int core_concurrent_counting_table_add(struct core_concurrent_counting_table *self,
+                void *key, int count);
+
+/*
+ * \return the counter of key, or 0 if the key is absent.
+ */
+int core_concurrent_counting_table_get(struct core_concurrent_counting_table *self,
+                void *key);
+
+uint64_t core_concurrent_counting_table_buckets(struct core_concurrent_counting_table *self);
+
+/*
+ * \return 1 if the bucket holds a key, 0 otherwise.
+ */
+int core_concurrent_counting_table_bucket(struct core_concurrent_counting_table *self,
+                uint64_t bucket, void **key, int *count);
+
+/*
+ * A total that callers can maintain on the side, for instance the
+ * number of additions that they made.
+ */
+void core_concurrent_counting_table_increase_total(struct core_concurrent_counting_table *self,
+                int64_t value);
+int64_t core_concurrent_counting_table_total(struct core_concurrent_counting_table *self);
+
+int core_concurrent_counting_table_key_size(struct core_concurrent_counting_table *self);
+
+#endif
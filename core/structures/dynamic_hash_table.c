@@ -263,6 +263,12 @@ void core_dynamic_hash_table_start_resizing(struct core_dynamic_hash_table *self
         core_hash_table_disable_deletion_support(self->next);
     }
 
+    core_hash_table_set_layout(self->next, core_hash_table_layout(self->current));
+
+    if (core_hash_table_has_integer_keys(self->current)) {
+        core_hash_table_enable_integer_keys(self->next);
+    }
+
     /*
      * Transfer the memory pool to the new one too.
      */
@@ -525,6 +531,23 @@ void core_dynamic_hash_table_enable_deletion_support(struct core_dynamic_hash_ta
     }
 }
 
+/*
+ * \see CORE_HASH_TABLE_LAYOUT_BITMAPS and CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES
+ */
+void core_dynamic_hash_table_set_layout(struct core_dynamic_hash_table *table, int layout)
+{
+    if (table->current != NULL) {
+        core_hash_table_set_layout(table->current, layout);
+    }
+}
+
+void core_dynamic_hash_table_enable_integer_keys(struct core_dynamic_hash_table *table)
+{
+    if (table->current != NULL) {
+        core_hash_table_enable_integer_keys(table->current);
+    }
+}
+
 void core_dynamic_hash_table_set_current_size_estimate(struct core_dynamic_hash_table *table,
                 double value)
 {
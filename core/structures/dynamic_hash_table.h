@@ -70,4 +70,7 @@ int core_dynamic_hash_table_is_currently_resizing(struct core_dynamic_hash_table
 
 void core_dynamic_hash_table_clear(struct core_dynamic_hash_table *self);
 
+void core_dynamic_hash_table_set_layout(struct core_dynamic_hash_table *self, int layout);
+void core_dynamic_hash_table_enable_integer_keys(struct core_dynamic_hash_table *self);
+
 #endif
@@ -15,6 +15,30 @@
 
 #include <inttypes.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Control bytes for CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES.
+ * A bucket is occupied when the high bit of its control byte
+ * is 0. The other 7 bits are then the tag (H2) of the key.
+ */
+#define CONTROL_BYTE_EMPTY 0x80
+#define CONTROL_BYTE_DELETED 0xfe
+#define CONTROL_BYTE_TAG_MASK 0x7f
+#define CONTROL_BYTE_TAG_BITS 7
+
+static int core_hash_table_control_find_bucket(struct core_hash_table *self, void *key,
+                uint64_t hash, uint64_t *bucket, int operation);
+static void *core_hash_table_control_add(struct core_hash_table *self, void *key);
+static void *core_hash_table_control_get(struct core_hash_table *self, void *key);
+static void core_hash_table_control_delete(struct core_hash_table *self, void *key);
+static int core_hash_table_control_state(struct core_hash_table *self, uint64_t bucket);
+static void *core_hash_table_control_key(struct core_hash_table *self, uint64_t bucket);
+static void core_hash_table_control_start(struct core_hash_table *self);
+static void core_hash_table_control_destroy(struct core_hash_table *self);
+
 /* debugging options
  */
 /*
@@ -93,6 +117,12 @@ void core_hash_table_init(struct core_hash_table *table, uint64_t buckets,
     table->groups = NULL;
     core_hash_table_set_memory_pool(table, NULL);
     core_hash_table_enable_deletion_support(table);
+
+    table->layout = CORE_HASH_TABLE_LAYOUT_BITMAPS;
+    table->control_bytes = NULL;
+    table->slots = NULL;
+    table->control_group_count_mask = (buckets / CORE_HASH_TABLE_CONTROL_GROUP_SIZE) - 1;
+    table->integer_keys = 0;
 }
 
 void core_hash_table_destroy(struct core_hash_table *table)
@@ -111,6 +141,7 @@ void core_hash_table_destroy(struct core_hash_table *table)
         table->groups = NULL;
     }
 
+    core_hash_table_control_destroy(table);
 }
 
 void core_hash_table_delete(struct core_hash_table *table, void *key)
@@ -120,6 +151,11 @@ void core_hash_table_delete(struct core_hash_table *table, void *key)
     int code;
     uint64_t last_stride;
 
+    if (table->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        core_hash_table_control_delete(table, key);
+        return;
+    }
+
     if (table->groups == NULL) {
         return;
     }
@@ -153,6 +189,35 @@ int core_hash_table_get_group_bucket(struct core_hash_table *table, uint64_t buc
     return bucket & table->group_bucket_count_mask;
 }
 
+static inline int core_hash_table_keys_are_equal(struct core_hash_table *table,
+                void *key1, void *key2)
+{
+    uint64_t words1[2];
+    uint64_t words2[2];
+    int key_size;
+
+    key_size = table->key_size;
+
+    if (!table->integer_keys) {
+        return memcmp(key1, key2, key_size) == CORE_HASH_TABLE_MATCH;
+    }
+
+    if (key_size == sizeof(uint64_t)) {
+        core_memory_copy(words1, key1, sizeof(uint64_t));
+        core_memory_copy(words2, key2, sizeof(uint64_t));
+
+        return words1[0] == words2[0];
+
+    } else if (key_size == 2 * sizeof(uint64_t)) {
+        core_memory_copy(words1, key1, 2 * sizeof(uint64_t));
+        core_memory_copy(words2, key2, 2 * sizeof(uint64_t));
+
+        return words1[0] == words2[0] && words1[1] == words2[1];
+    }
+
+    return memcmp(key1, key2, key_size) == CORE_HASH_TABLE_MATCH;
+}
+
 /*
  * The hash function can be changed here.
  */
@@ -165,16 +230,40 @@ uint64_t core_hash_table_hash(void *key, int key_size, unsigned int seed)
     return core_hash_data_uint64_t(key, key_size, seed);
 }
 
+/*
+ * Tables with integer keys (see core_hash_table_enable_integer_keys)
+ * hash their 1 or 2 words with an integer finalizer.
+ */
+static inline uint64_t core_hash_table_hash_key(struct core_hash_table *table, void *key,
+                unsigned int seed)
+{
+    uint64_t words[2];
+
+    if (!table->integer_keys) {
+        return core_hash_table_hash(key, table->key_size, seed);
+    }
+
+    if (table->key_size == sizeof(uint64_t)) {
+        core_memory_copy(words, key, sizeof(uint64_t));
+
+        return core_hash_uint64_t(words[0], seed);
+    }
+
+    core_memory_copy(words, key, 2 * sizeof(uint64_t));
+
+    return core_hash_uint64_t(words[0] ^ core_hash_uint64_t(words[1], seed), seed);
+}
+
 uint64_t core_hash_table_hash1(struct core_hash_table *table, void *key)
 {
-    return core_hash_table_hash(key, table->key_size, 0x5cd902cb);
+    return core_hash_table_hash_key(table, key, 0x5cd902cb);
 }
 
 uint64_t core_hash_table_hash2(struct core_hash_table *table, void *key)
 {
     uint64_t hash2;
 
-    hash2 = core_hash_table_hash(key, table->key_size, 0x80435418);
+    hash2 = core_hash_table_hash_key(table, key, 0x80435418);
 
     /* the number of buckets and hash2 must be co-prime
      * the number of buckets is a power of 2
@@ -229,6 +318,10 @@ int core_hash_table_state(struct core_hash_table *self, uint64_t bucket)
     int bucket_in_group;
     struct core_hash_table_group *table_group;
 
+    if (self->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        return core_hash_table_control_state(self, bucket);
+    }
+
     if (self->groups == NULL) {
         return CORE_HASH_TABLE_BUCKET_EMPTY;
     }
@@ -251,6 +344,10 @@ void *core_hash_table_key(struct core_hash_table *self, uint64_t bucket)
     int bucket_in_group;
     struct core_hash_table_group *table_group;
 
+    if (self->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        return core_hash_table_control_key(self, bucket);
+    }
+
     if (self->groups == NULL) {
         return NULL;
     }
@@ -273,6 +370,17 @@ void *core_hash_table_value(struct core_hash_table *self, uint64_t bucket)
     int group;
     int bucket_in_group;
     struct core_hash_table_group *table_group;
+    void *key;
+
+    if (self->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        key = core_hash_table_control_key(self, bucket);
+
+        if (key == NULL) {
+            return NULL;
+        }
+
+        return (char *)key + self->key_size;
+    }
 
     if (self->groups == NULL) {
         return NULL;
@@ -347,6 +455,8 @@ int core_hash_table_pack_unpack(struct core_hash_table *self, void *buffer, int
 
     core_packer_process(&packer, &self->debug, sizeof(self->debug));
     core_packer_process(&packer, &self->deletion_is_enabled, sizeof(self->deletion_is_enabled));
+    core_packer_process(&packer, &self->layout, sizeof(self->layout));
+    core_packer_process(&packer, &self->integer_keys, sizeof(self->integer_keys));
 
     offset = core_packer_get_byte_count(&packer);
 
@@ -356,6 +466,26 @@ int core_hash_table_pack_unpack(struct core_hash_table *self, void *buffer, int
 
     core_packer_destroy(&packer);
 
+    if (self->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+
+        self->control_group_count_mask = (self->buckets / CORE_HASH_TABLE_CONTROL_GROUP_SIZE) - 1;
+
+        /*
+         * Like for the groups, an empty table is packed with
+         * its buckets.
+         */
+        core_hash_table_control_start(self);
+
+        core_packer_init(&packer, operation, (char *)buffer + offset);
+        core_packer_process(&packer, self->control_bytes, self->buckets);
+        core_packer_process(&packer, self->slots,
+                        self->buckets * (self->key_size + self->value_size));
+        offset += core_packer_get_byte_count(&packer);
+        core_packer_destroy(&packer);
+
+        return offset;
+    }
+
     if (operation == CORE_PACKER_OPERATION_UNPACK) {
 
 #ifdef CORE_HASH_TABLE_DEBUG
@@ -398,6 +528,11 @@ void core_hash_table_start_groups(struct core_hash_table *table)
 {
     int i;
 
+    if (table->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        core_hash_table_control_start(table);
+        return;
+    }
+
     if (table->groups != NULL) {
         return;
     }
@@ -459,6 +594,10 @@ void *core_hash_table_add(struct core_hash_table *table, void *key)
     }
 #endif
 
+    if (table->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        return core_hash_table_control_add(table, key);
+    }
+
     if (table->groups == NULL) {
         core_hash_table_start_groups(table);
     }
@@ -550,6 +689,10 @@ void *core_hash_table_get(struct core_hash_table *table, void *key)
     int code;
     uint64_t last_stride;
 
+    if (table->layout == CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES) {
+        return core_hash_table_control_get(table, key);
+    }
+
     if (table->groups == NULL) {
         return NULL;
     }
@@ -697,8 +840,7 @@ int core_hash_table_find_bucket(struct core_hash_table *table, void *key,
                         table->key_size, table->value_size);
 
 
-            if (memcmp(bucket_key, key, table->key_size) ==
-                CORE_HASH_TABLE_MATCH) {
+            if (core_hash_table_keys_are_equal(table, bucket_key, key)) {
 
 #ifdef CORE_HASH_TABLE_DEBUG_DOUBLE_HASHING_DEBUG
                 if (table->debug) {
@@ -831,11 +973,15 @@ void core_hash_table_clear(struct core_hash_table *self)
     int value_size;
     struct core_memory_pool *pool;
     uint64_t buckets;
+    int layout;
+    int integer_keys;
 
     key_size = self->key_size;
     value_size = self->value_size;
     pool = self->memory;
     buckets = self->buckets;
+    layout = self->layout;
+    integer_keys = self->integer_keys;
 
     core_hash_table_destroy(self);
 
@@ -844,9 +990,340 @@ void core_hash_table_clear(struct core_hash_table *self)
     if (pool != NULL) {
         core_hash_table_set_memory_pool(self, pool);
     }
+
+    core_hash_table_set_layout(self, layout);
+
+    if (integer_keys) {
+        core_hash_table_enable_integer_keys(self);
+    }
 }
 
 struct core_memory_pool *core_hash_table_memory_pool(struct core_hash_table *self)
 {
     return self->memory;
 }
+
+/*
+ * The layout can only be changed before the first key is added.
+ */
+void core_hash_table_set_layout(struct core_hash_table *self, int layout)
+{
+    if (self->groups != NULL || self->control_bytes != NULL) {
+        return;
+    }
+
+    self->layout = layout;
+}
+
+int core_hash_table_layout(struct core_hash_table *self)
+{
+    return self->layout;
+}
+
+/*
+ * Like the layout, this can only be changed before the first key is
+ * added. It has no effect unless keys have 1 or 2 words.
+ */
+void core_hash_table_enable_integer_keys(struct core_hash_table *self)
+{
+    if (self->groups != NULL || self->control_bytes != NULL) {
+        return;
+    }
+
+    if (self->key_size != sizeof(uint64_t)
+                    && self->key_size != 2 * sizeof(uint64_t)) {
+        return;
+    }
+
+    self->integer_keys = 1;
+}
+
+int core_hash_table_has_integer_keys(struct core_hash_table *self)
+{
+    return self->integer_keys;
+}
+
+/*
+ * \return a mask with bit i set if control byte i of the group is equal to value
+ */
+static inline int core_hash_table_match_control_group(uint8_t *group, uint8_t value)
+{
+#ifdef __SSE2__
+    __m128i control;
+
+    control = _mm_loadu_si128((__m128i *)group);
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8((char)value)));
+#else
+    int mask;
+    int i;
+
+    mask = 0;
+
+    for (i = 0; i < CORE_HASH_TABLE_CONTROL_GROUP_SIZE; i++) {
+        if (group[i] == value) {
+            mask |= 1 << i;
+        }
+    }
+
+    return mask;
+#endif
+}
+
+/*
+ * \return a mask with bit i set if bucket i of the group is empty or deleted
+ */
+static inline int core_hash_table_match_free_control_group(uint8_t *group)
+{
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_loadu_si128((__m128i *)group));
+#else
+    int mask;
+    int i;
+
+    mask = 0;
+
+    for (i = 0; i < CORE_HASH_TABLE_CONTROL_GROUP_SIZE; i++) {
+        if (group[i] & ~CONTROL_BYTE_TAG_MASK) {
+            mask |= 1 << i;
+        }
+    }
+
+    return mask;
+#endif
+}
+
+static inline int core_hash_table_first_bit(int mask)
+{
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    int bit;
+
+    bit = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
+
+/*
+ * Groups of control bytes are probed with triangular numbers, which
+ * visits every group since the number of groups is a power of 2.
+ *
+ * \return CORE_HASH_TABLE_KEY_FOUND or CORE_HASH_TABLE_KEY_NOT_FOUND or
+ * CORE_HASH_TABLE_FULL
+ */
+static int core_hash_table_control_find_bucket(struct core_hash_table *self, void *key,
+                uint64_t hash, uint64_t *bucket, int operation)
+{
+    uint64_t group;
+    uint64_t probe;
+    uint8_t tag;
+    uint8_t *control;
+    int matches;
+    uint64_t first_bucket;
+    int free_buckets;
+    int found_free_bucket;
+    uint64_t candidate;
+    int slot_size;
+
+    tag = hash & CONTROL_BYTE_TAG_MASK;
+    group = (hash >> CONTROL_BYTE_TAG_BITS) & self->control_group_count_mask;
+    slot_size = self->key_size + self->value_size;
+
+    found_free_bucket = 0;
+
+    for (probe = 0; probe <= self->control_group_count_mask; ++probe) {
+
+        first_bucket = group * CORE_HASH_TABLE_CONTROL_GROUP_SIZE;
+        control = self->control_bytes + first_bucket;
+
+        /*
+         * Only compare the keys with a matching tag.
+         */
+        matches = core_hash_table_match_control_group(control, tag);
+
+        while (matches) {
+            candidate = first_bucket + core_hash_table_first_bit(matches);
+
+            if (core_hash_table_keys_are_equal(self,
+                                    (char *)self->slots + candidate * slot_size, key)) {
+                *bucket = candidate;
+                return CORE_HASH_TABLE_KEY_FOUND;
+            }
+
+            matches &= matches - 1;
+        }
+
+        /*
+         * A deleted bucket can be reused to add a key, but the
+         * search must continue until an empty bucket is found.
+         */
+        if (operation == CORE_HASH_TABLE_OPERATION_ADD && !found_free_bucket) {
+
+            free_buckets = core_hash_table_match_free_control_group(control);
+
+            if (free_buckets) {
+                *bucket = first_bucket + core_hash_table_first_bit(free_buckets);
+                found_free_bucket = 1;
+            }
+        }
+
+        /*
+         * A key is never stored after a group with an empty bucket.
+         */
+        if (core_hash_table_match_control_group(control, CONTROL_BYTE_EMPTY)) {
+            return CORE_HASH_TABLE_KEY_NOT_FOUND;
+        }
+
+        group = (group + probe + 1) & self->control_group_count_mask;
+    }
+
+    if (found_free_bucket) {
+        return CORE_HASH_TABLE_KEY_NOT_FOUND;
+    }
+
+    if (operation == CORE_HASH_TABLE_OPERATION_ADD) {
+        return CORE_HASH_TABLE_FULL;
+    }
+
+    return CORE_HASH_TABLE_KEY_NOT_FOUND;
+}
+
+static void *core_hash_table_control_add(struct core_hash_table *self, void *key)
+{
+    uint64_t bucket;
+    uint64_t hash;
+    int code;
+    void *bucket_key;
+
+    core_hash_table_control_start(self);
+
+    hash = core_hash_table_hash1(self, key);
+    code = core_hash_table_control_find_bucket(self, key, hash, &bucket,
+                    CORE_HASH_TABLE_OPERATION_ADD);
+
+    if (code == CORE_HASH_TABLE_FULL) {
+        return NULL;
+    }
+
+    bucket_key = core_hash_table_control_key(self, bucket);
+
+    if (code == CORE_HASH_TABLE_KEY_NOT_FOUND) {
+        core_memory_copy(bucket_key, key, self->key_size);
+        self->control_bytes[bucket] = hash & CONTROL_BYTE_TAG_MASK;
+        self->elements++;
+    }
+
+    return (char *)bucket_key + self->key_size;
+}
+
+static void *core_hash_table_control_get(struct core_hash_table *self, void *key)
+{
+    uint64_t bucket;
+
+    if (self->control_bytes == NULL) {
+        return NULL;
+    }
+
+    if (core_hash_table_control_find_bucket(self, key, core_hash_table_hash1(self, key),
+                            &bucket, CORE_HASH_TABLE_OPERATION_GET) != CORE_HASH_TABLE_KEY_FOUND) {
+        return NULL;
+    }
+
+    return (char *)core_hash_table_control_key(self, bucket) + self->key_size;
+}
+
+static void core_hash_table_control_delete(struct core_hash_table *self, void *key)
+{
+    uint64_t bucket;
+    uint8_t *group;
+
+    if (self->control_bytes == NULL) {
+        return;
+    }
+
+    if (!self->deletion_is_enabled) {
+        return;
+    }
+
+    if (core_hash_table_control_find_bucket(self, key, core_hash_table_hash1(self, key),
+                            &bucket, CORE_HASH_TABLE_OPERATION_DELETE) != CORE_HASH_TABLE_KEY_FOUND) {
+        return;
+    }
+
+    group = self->control_bytes + (bucket & ~(uint64_t)(CORE_HASH_TABLE_CONTROL_GROUP_SIZE - 1));
+
+    /*
+     * If the group still has an empty bucket, no probe went past it, so
+     * the bucket can become empty instead of deleted.
+     */
+    if (core_hash_table_match_control_group(group, CONTROL_BYTE_EMPTY)) {
+        self->control_bytes[bucket] = CONTROL_BYTE_EMPTY;
+    } else {
+        self->control_bytes[bucket] = CONTROL_BYTE_DELETED;
+    }
+
+    self->elements--;
+}
+
+static int core_hash_table_control_state(struct core_hash_table *self, uint64_t bucket)
+{
+    uint8_t control;
+
+    if (self->control_bytes == NULL || bucket >= self->buckets) {
+        return CORE_HASH_TABLE_BUCKET_EMPTY;
+    }
+
+    control = self->control_bytes[bucket];
+
+    if (control == CONTROL_BYTE_EMPTY) {
+        return CORE_HASH_TABLE_BUCKET_EMPTY;
+    }
+
+    if (control == CONTROL_BYTE_DELETED) {
+        return CORE_HASH_TABLE_BUCKET_DELETED;
+    }
+
+    return CORE_HASH_TABLE_BUCKET_OCCUPIED;
+}
+
+static void *core_hash_table_control_key(struct core_hash_table *self, uint64_t bucket)
+{
+    if (self->slots == NULL || bucket >= self->buckets) {
+        return NULL;
+    }
+
+    return (char *)self->slots + bucket * (self->key_size + self->value_size);
+}
+
+static void core_hash_table_control_start(struct core_hash_table *self)
+{
+    if (self->control_bytes != NULL) {
+        return;
+    }
+
+    self->control_bytes = core_memory_pool_allocate(self->memory, self->buckets);
+    self->slots = core_memory_pool_allocate(self->memory,
+                    self->buckets * (self->key_size + self->value_size));
+
+    memset(self->control_bytes, CONTROL_BYTE_EMPTY, self->buckets);
+}
+
+static void core_hash_table_control_destroy(struct core_hash_table *self)
+{
+    if (self->control_bytes == NULL) {
+        return;
+    }
+
+    core_memory_pool_free(self->memory, self->control_bytes);
+    core_memory_pool_free(self->memory, self->slots);
+
+    self->control_bytes = NULL;
+    self->slots = NULL;
+}
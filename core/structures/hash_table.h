@@ -16,6 +16,25 @@
 
 #define CORE_HASH_TABLE_MATCH 0
 
+/*
+ * Layouts for the buckets.
+ *
+ * CORE_HASH_TABLE_LAYOUT_BITMAPS uses an occupancy bitmap, a deletion
+ * bitmap and double hashing.
+ *
+ * CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES uses one control byte per bucket
+ * (SwissTable). A control byte is either empty, deleted, or 7 bits of the
+ * hash of the key. Buckets are probed in groups of 16 control bytes that
+ * are matched at once (with SSE2 when available), and keys are only
+ * compared when their control byte matches.
+ *
+ * \see https://abseil.io/about/design/swisstables
+ */
+#define CORE_HASH_TABLE_LAYOUT_BITMAPS 0
+#define CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES 1
+
+#define CORE_HASH_TABLE_CONTROL_GROUP_SIZE 16
+
 /* only use a single group
  */
 #define CORE_HASH_TABLE_USE_ONE_GROUP
@@ -58,6 +77,20 @@ struct core_hash_table {
     struct core_memory_pool *memory;
 
     int deletion_is_enabled;
+
+    /*
+     * For CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES
+     */
+    int layout;
+    uint8_t *control_bytes;
+    void *slots;
+    uint64_t control_group_count_mask;
+
+    /*
+     * Hash keys of 1 or 2 words (like inline k-mer keys)
+     * with integer hashing.
+     */
+    int integer_keys;
 };
 
 /*
@@ -112,4 +145,10 @@ int core_hash_table_deletion_support_is_enabled(struct core_hash_table *self);
 
 void core_hash_table_clear(struct core_hash_table *self);
 
+void core_hash_table_set_layout(struct core_hash_table *self, int layout);
+int core_hash_table_layout(struct core_hash_table *self);
+
+void core_hash_table_enable_integer_keys(struct core_hash_table *self);
+int core_hash_table_has_integer_keys(struct core_hash_table *self);
+
 #endif
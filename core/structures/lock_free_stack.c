@@ -0,0 +1,90 @@
+
+#include "lock_free_stack.h"
+
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#include <stdlib.h>
+
+void core_lock_free_stack_init(struct core_lock_free_stack *self)
+{
+    self->head = NULL;
+}
+
+void core_lock_free_stack_destroy(struct core_lock_free_stack *self)
+{
+    self->head = NULL;
+}
+
+/*
+ * Called by any thread.
+ */
+void core_lock_free_stack_push(struct core_lock_free_stack *self, void *block)
+{
+    core_lock_free_stack_push_chain(self, block, block);
+}
+
+/*
+ * Called by any thread.
+ */
+void core_lock_free_stack_push_chain(struct core_lock_free_stack *self, void *first, void *last)
+{
+    void *head;
+    void *old_head;
+
+    CORE_DEBUGGER_ASSERT(first != NULL);
+    CORE_DEBUGGER_ASSERT(last != NULL);
+
+    head = self->head;
+
+    while (1) {
+        *(void **)last = head;
+
+        old_head = core_atomic_compare_and_swap_pointer(&self->head, head, first);
+
+        if (old_head == head) {
+            break;
+        }
+
+        head = old_head;
+    }
+}
+
+/*
+ * Called by the consumer.
+ */
+void *core_lock_free_stack_pop_all(struct core_lock_free_stack *self)
+{
+    void *head;
+    void *old_head;
+
+    head = self->head;
+
+    while (head != NULL) {
+
+        old_head = core_atomic_compare_and_swap_pointer(&self->head, head, NULL);
+
+        if (old_head == head) {
+            break;
+        }
+
+        head = old_head;
+    }
+
+    return head;
+}
+
+void *core_lock_free_stack_next(void *block)
+{
+    return *(void **)block;
+}
+
+void core_lock_free_stack_set_next(void *block, void *next)
+{
+    *(void **)block = next;
+}
+
+int core_lock_free_stack_empty(struct core_lock_free_stack *self)
+{
+    return self->head == NULL;
+}
@@ -0,0 +1,42 @@
+
+#ifndef CORE_LOCK_FREE_STACK_H
+#define CORE_LOCK_FREE_STACK_H
+
+/*
+ * An intrusive lock-free stack (Treiber) of memory blocks.
+ *
+ * Any thread can push a block. The link is stored in the first
+ * bytes of the block, so a block must be at least sizeof(void *) bytes
+ * and must not be used by the caller while it is in the stack.
+ *
+ * Blocks are only removed all at once with core_lock_free_stack_pop_all,
+ * which avoids the ABA problem of a single-element pop.
+ *
+ * \see http://en.wikipedia.org/wiki/Treiber_Stack
+ */
+struct core_lock_free_stack {
+    void *head;
+};
+
+void core_lock_free_stack_init(struct core_lock_free_stack *self);
+void core_lock_free_stack_destroy(struct core_lock_free_stack *self);
+
+void core_lock_free_stack_push(struct core_lock_free_stack *self, void *block);
+
+/*
+ * Push a chain of blocks with one atomic operation. The blocks from
+ * first to last are linked with core_lock_free_stack_set_next.
+ */
+void core_lock_free_stack_push_chain(struct core_lock_free_stack *self, void *first, void *last);
+
+/*
+ * Detach all the blocks and return the first one (or NULL).
+ * The other blocks are reached with core_lock_free_stack_next.
+ */
+void *core_lock_free_stack_pop_all(struct core_lock_free_stack *self);
+void *core_lock_free_stack_next(void *block);
+void core_lock_free_stack_set_next(void *block, void *next);
+
+int core_lock_free_stack_empty(struct core_lock_free_stack *self);
+
+#endif
@@ -295,6 +295,16 @@ void core_map_enable_deletion_support(struct core_map *map)
 
 }
 
+void core_map_enable_control_bytes(struct core_map *map)
+{
+    core_dynamic_hash_table_set_layout(&map->table, CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES);
+}
+
+void core_map_enable_integer_keys(struct core_map *map)
+{
+    core_dynamic_hash_table_enable_integer_keys(&map->table);
+}
+
 void core_map_set_current_size_estimate(struct core_map *map, double value)
 {
 #ifdef CORE_MAP_ENABLE_ESTIMATION
@@ -316,13 +326,22 @@ void core_map_clear(struct core_map *self)
 {
     int key_size;
     int value_size;
+    int layout;
+    int integer_keys;
 
     key_size = core_map_get_key_size(self);
     value_size = core_map_get_value_size(self);
+    layout = core_hash_table_layout(self->table.current);
+    integer_keys = core_hash_table_has_integer_keys(self->table.current);
 
     core_map_destroy(self);
 
     core_map_init(self, key_size, value_size);
+    core_dynamic_hash_table_set_layout(&self->table, layout);
+
+    if (integer_keys) {
+        core_map_enable_integer_keys(self);
+    }
     /*core_dynamic_hash_table_clear(&self->table);*/
 }
 
@@ -67,6 +67,19 @@ void core_map_set_threshold(struct core_map *self, double threshold);
 int core_map_is_currently_resizing(struct core_map *self);
 
 void core_map_clear(struct core_map *self);
+
+/*
+ * Use 16-byte groups of control bytes for probing.
+ * This must be called before the first key is added.
+ */
+void core_map_enable_control_bytes(struct core_map *self);
+
+/*
+ * Hash keys of 1 or 2 64-bit words (like inline k-mer keys) with
+ * an integer finalizer instead of hashing their bytes.
+ * This must be called before the first key is added.
+ */
+void core_map_enable_integer_keys(struct core_map *self);
 void core_map_examine(struct core_map *self);
 
 #endif
@@ -0,0 +1,189 @@
+
+#include "mpsc_ring.h"
+
+#include "fast_ring.h"
+
+#include <core/system/memory.h>
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#include <stdlib.h>
+
+#define MEMORY_MPSC_RING 0x6a3e29d1
+
+static void *core_mpsc_ring_get_cell(struct core_mpsc_ring *self, int64_t index);
+static int64_t *core_mpsc_ring_get_sequence(struct core_mpsc_ring *self, int64_t index);
+
+void core_mpsc_ring_init(struct core_mpsc_ring *self, int capacity, int cell_size)
+{
+    int64_t i;
+
+    CORE_DEBUGGER_ASSERT(capacity > 0);
+
+    self->number_of_cells = core_fast_ring_get_next_power_of_two(capacity);
+    self->mask = self->number_of_cells - 1;
+    self->cell_size = cell_size;
+
+    /*
+     * Each cell starts with its sequence number.
+     */
+    self->stride = sizeof(int64_t) + cell_size;
+
+    if (self->stride % sizeof(int64_t) != 0) {
+        self->stride += sizeof(int64_t) - self->stride % sizeof(int64_t);
+    }
+
+    self->head = 0;
+    self->tail = 0;
+    self->rejected_count = 0;
+
+    self->cells = core_memory_allocate(self->number_of_cells * self->stride,
+                    MEMORY_MPSC_RING);
+
+    for (i = 0; i < self->number_of_cells; ++i) {
+        *core_mpsc_ring_get_sequence(self, i) = i;
+    }
+}
+
+void core_mpsc_ring_destroy(struct core_mpsc_ring *self)
+{
+    core_memory_free(self->cells, MEMORY_MPSC_RING);
+
+    self->cells = NULL;
+    self->number_of_cells = 0;
+    self->mask = 0;
+    self->cell_size = 0;
+    self->stride = 0;
+    self->head = 0;
+    self->tail = 0;
+    self->rejected_count = 0;
+}
+
+/*
+ * Called by any thread.
+ */
+int core_mpsc_ring_push(struct core_mpsc_ring *self, void *element)
+{
+    int64_t tail;
+    int64_t sequence;
+    int64_t *sequence_pointer;
+    int64_t rejected_count;
+
+    tail = core_atomic_read_int64_t(&self->tail);
+
+    while (1) {
+        sequence_pointer = core_mpsc_ring_get_sequence(self, tail);
+        sequence = core_atomic_read_int64_t(sequence_pointer);
+
+        if (sequence == tail) {
+
+            /*
+             * The cell is free, try to reserve it.
+             */
+            if (core_atomic_compare_and_swap_int64_t(&self->tail, tail, tail + 1) == tail) {
+                break;
+            }
+
+        } else if (sequence < tail) {
+
+            /*
+             * The consumer has not freed this cell yet, so the ring
+             * is full.
+             */
+            do {
+                rejected_count = core_atomic_read_int64_t(&self->rejected_count);
+            } while (core_atomic_compare_and_swap_int64_t(&self->rejected_count,
+                                    rejected_count, rejected_count + 1) != rejected_count);
+
+            return 0;
+        }
+
+        tail = core_atomic_read_int64_t(&self->tail);
+    }
+
+    core_memory_copy(core_mpsc_ring_get_cell(self, tail), element, self->cell_size);
+
+    /*
+     * Publish the cell.
+     */
+    core_memory_fence();
+
+    *sequence_pointer = tail + 1;
+
+    return 1;
+}
+
+/*
+ * Called by the consumer.
+ *
+ * This returns 0 if the next cell is reserved but not published yet.
+ * In that case, core_mpsc_ring_empty returns 0, and the cell is
+ * published as soon as its producer finishes its copy.
+ */
+int core_mpsc_ring_pop(struct core_mpsc_ring *self, void *element)
+{
+    int64_t head;
+    int64_t *sequence_pointer;
+
+    head = self->head;
+    sequence_pointer = core_mpsc_ring_get_sequence(self, head);
+
+    if (core_atomic_read_int64_t(sequence_pointer) != head + 1) {
+        return 0;
+    }
+
+    core_memory_copy(element, core_mpsc_ring_get_cell(self, head), self->cell_size);
+
+    /*
+     * The copy must be done before the cell is given back
+     * to producers.
+     */
+    core_memory_fence();
+
+    *sequence_pointer = head + self->number_of_cells;
+
+    self->head = head + 1;
+
+    return 1;
+}
+
+/*
+ * This includes cells that are reserved but not published yet.
+ */
+int core_mpsc_ring_size(struct core_mpsc_ring *self)
+{
+    int64_t size;
+
+    size = core_atomic_read_int64_t(&self->tail) - core_atomic_read_int64_t(&self->head);
+
+    if (size < 0) {
+        size = 0;
+    }
+
+    return size;
+}
+
+int core_mpsc_ring_capacity(struct core_mpsc_ring *self)
+{
+    return self->number_of_cells;
+}
+
+int core_mpsc_ring_empty(struct core_mpsc_ring *self)
+{
+    return core_mpsc_ring_size(self) == 0;
+}
+
+int64_t core_mpsc_ring_rejected_count(struct core_mpsc_ring *self)
+{
+    return core_atomic_read_int64_t(&self->rejected_count);
+}
+
+static void *core_mpsc_ring_get_cell(struct core_mpsc_ring *self, int64_t index)
+{
+    return (char *)core_mpsc_ring_get_sequence(self, index) + sizeof(int64_t);
+}
+
+static int64_t *core_mpsc_ring_get_sequence(struct core_mpsc_ring *self, int64_t index)
+{
+    return (int64_t *)((char *)self->cells + (index & self->mask) * self->stride);
+}
@@ -0,0 +1,54 @@
+
+#ifndef CORE_MPSC_RING_H
+#define CORE_MPSC_RING_H
+
+#include <stdint.h>
+
+/*
+ * A lock-free bounded ring with multiple producers and a single
+ * consumer.
+ *
+ * Each cell has a sequence number. A producer reserves a cell with a
+ * compare-and-swap on the tail, writes it, and then publishes it by
+ * updating its sequence number. The consumer only reads published cells,
+ * in order.
+ *
+ * A push returns 0 when the ring is full; nothing is buffered.
+ *
+ * \see http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+struct core_mpsc_ring {
+    /*
+     * For the consumer
+     */
+    int64_t head;
+
+    /*
+     * For producers
+     */
+    int64_t tail;
+
+    /*
+     * Number of pushes that failed because the ring was full.
+     */
+    int64_t rejected_count;
+
+    void *cells;
+    int64_t number_of_cells;
+    int64_t mask;
+    int cell_size;
+    int stride;
+};
+
+void core_mpsc_ring_init(struct core_mpsc_ring *self, int capacity, int cell_size);
+void core_mpsc_ring_destroy(struct core_mpsc_ring *self);
+
+int core_mpsc_ring_push(struct core_mpsc_ring *self, void *element);
+int core_mpsc_ring_pop(struct core_mpsc_ring *self, void *element);
+
+int core_mpsc_ring_size(struct core_mpsc_ring *self);
+int core_mpsc_ring_capacity(struct core_mpsc_ring *self);
+int core_mpsc_ring_empty(struct core_mpsc_ring *self);
+int64_t core_mpsc_ring_rejected_count(struct core_mpsc_ring *self);
+
+#endif
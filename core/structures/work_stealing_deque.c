@@ -0,0 +1,169 @@
+
+#include "work_stealing_deque.h"
+
+#include "fast_ring.h"
+
+#include <core/system/memory.h>
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#include <stdlib.h>
+
+#define MEMORY_WORK_STEALING_DEQUE 0x3bd06c5a
+
+static void *core_work_stealing_deque_get_cell(struct core_work_stealing_deque *self, int64_t index);
+
+void core_work_stealing_deque_init(struct core_work_stealing_deque *self, int capacity, int cell_size)
+{
+    CORE_DEBUGGER_ASSERT(capacity > 0);
+
+    self->number_of_cells = core_fast_ring_get_next_power_of_two(capacity);
+    self->mask = self->number_of_cells - 1;
+    self->cell_size = cell_size;
+
+    self->top = 0;
+    self->bottom = 0;
+
+    self->cells = core_memory_allocate(self->number_of_cells * self->cell_size,
+                    MEMORY_WORK_STEALING_DEQUE);
+}
+
+void core_work_stealing_deque_destroy(struct core_work_stealing_deque *self)
+{
+    core_memory_free(self->cells, MEMORY_WORK_STEALING_DEQUE);
+
+    self->cells = NULL;
+    self->number_of_cells = 0;
+    self->mask = 0;
+    self->cell_size = 0;
+    self->top = 0;
+    self->bottom = 0;
+}
+
+/*
+ * Called by the owner.
+ */
+int core_work_stealing_deque_push(struct core_work_stealing_deque *self, void *element)
+{
+    int64_t bottom;
+    int64_t top;
+
+    bottom = self->bottom;
+    top = core_atomic_read_int64_t(&self->top);
+
+    /*
+     * The cell at top may still be read by a thief.
+     */
+    if (bottom - top >= self->number_of_cells) {
+        return 0;
+    }
+
+    core_memory_copy(core_work_stealing_deque_get_cell(self, bottom), element,
+                    self->cell_size);
+
+    /*
+     * The element must be visible before the new bottom.
+     */
+    core_memory_fence();
+
+    self->bottom = bottom + 1;
+
+    return 1;
+}
+
+/*
+ * Called by the owner.
+ */
+int core_work_stealing_deque_pop(struct core_work_stealing_deque *self, void *element)
+{
+    int64_t bottom;
+    int64_t top;
+
+    bottom = self->bottom - 1;
+    self->bottom = bottom;
+
+    /*
+     * The new bottom must be visible to thieves before top is read.
+     */
+    core_memory_fence();
+
+    top = core_atomic_read_int64_t(&self->top);
+
+    if (top > bottom) {
+        self->bottom = bottom + 1;
+        return 0;
+    }
+
+    core_memory_copy(element, core_work_stealing_deque_get_cell(self, bottom),
+                    self->cell_size);
+
+    if (top < bottom) {
+        return 1;
+    }
+
+    /*
+     * This is the last element, so the owner races with thieves.
+     */
+    if (core_atomic_compare_and_swap_int64_t(&self->top, top, top + 1) != top) {
+        self->bottom = bottom + 1;
+        return 0;
+    }
+
+    self->bottom = bottom + 1;
+
+    return 1;
+}
+
+/*
+ * Called by any thread.
+ */
+int core_work_stealing_deque_steal(struct core_work_stealing_deque *self, void *element)
+{
+    int64_t bottom;
+    int64_t top;
+
+    top = core_atomic_read_int64_t(&self->top);
+
+    core_memory_fence();
+
+    bottom = core_atomic_read_int64_t(&self->bottom);
+
+    if (top >= bottom) {
+        return 0;
+    }
+
+    core_memory_copy(element, core_work_stealing_deque_get_cell(self, top),
+                    self->cell_size);
+
+    if (core_atomic_compare_and_swap_int64_t(&self->top, top, top + 1) != top) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * The size is exact only for the owner when there are no thieves.
+ */
+int core_work_stealing_deque_size(struct core_work_stealing_deque *self)
+{
+    int64_t size;
+
+    size = core_atomic_read_int64_t(&self->bottom) - core_atomic_read_int64_t(&self->top);
+
+    if (size < 0) {
+        size = 0;
+    }
+
+    return size;
+}
+
+int core_work_stealing_deque_capacity(struct core_work_stealing_deque *self)
+{
+    return self->number_of_cells;
+}
+
+static void *core_work_stealing_deque_get_cell(struct core_work_stealing_deque *self, int64_t index)
+{
+    return (char *)self->cells + (index & self->mask) * self->cell_size;
+}
@@ -0,0 +1,47 @@
+
+#ifndef CORE_WORK_STEALING_DEQUE_H
+#define CORE_WORK_STEALING_DEQUE_H
+
+#include <stdint.h>
+
+/*
+ * A lock-free work-stealing deque (Chase-Lev).
+ *
+ * The owner pushes and pops at the bottom. Any thread (including the
+ * owner) can steal at the top. Only steals and the pop of the last
+ * element use a compare-and-swap.
+ *
+ * The capacity is fixed so that a thief never reads a cell array that
+ * was freed by the owner. A push returns 0 when the deque is full.
+ *
+ * \see http://dl.acm.org/citation.cfm?id=1073974
+ * \see http://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+ */
+struct core_work_stealing_deque {
+    /*
+     * For thieves
+     */
+    int64_t top;
+
+    /*
+     * For the owner
+     */
+    int64_t bottom;
+
+    void *cells;
+    int64_t number_of_cells;
+    int64_t mask;
+    int cell_size;
+};
+
+void core_work_stealing_deque_init(struct core_work_stealing_deque *self, int capacity, int cell_size);
+void core_work_stealing_deque_destroy(struct core_work_stealing_deque *self);
+
+int core_work_stealing_deque_push(struct core_work_stealing_deque *self, void *element);
+int core_work_stealing_deque_pop(struct core_work_stealing_deque *self, void *element);
+int core_work_stealing_deque_steal(struct core_work_stealing_deque *self, void *element);
+
+int core_work_stealing_deque_size(struct core_work_stealing_deque *self);
+int core_work_stealing_deque_capacity(struct core_work_stealing_deque *self);
+
+#endif
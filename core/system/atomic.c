@@ -21,4 +21,49 @@ int core_atomic_compare_and_swap_int_mock(int *pointer, int old_value, int new_v
     return old_value;
 }
 
+int64_t core_atomic_read_int64_t_mock(int64_t *pointer)
+{
+    return *pointer;
+}
+
+int64_t core_atomic_compare_and_swap_int64_t_mock(int64_t *pointer, int64_t old_value, int64_t new_value)
+{
+    if (*pointer != old_value) {
+        return *pointer;
+    }
+
+    *pointer = new_value;
+
+    return old_value;
+}
+
+void *core_atomic_compare_and_swap_pointer_mock(void **pointer, void *old_value, void *new_value)
+{
+    if (*pointer != old_value) {
+        return *pointer;
+    }
+
+    *pointer = new_value;
+
+    return old_value;
+}
+
+int core_atomic_add_int_mock(int *pointer, int value)
+{
+    int old_value;
+
+    old_value = *pointer;
+    *pointer += value;
 
+    return old_value;
+}
+
+int64_t core_atomic_add_int64_t_mock(int64_t *pointer, int64_t value)
+{
+    int64_t old_value;
+
+    old_value = *pointer;
+    *pointer += value;
+
+    return old_value;
+}
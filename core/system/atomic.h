@@ -2,6 +2,8 @@
 #ifndef CORE_ATOMIC_H
 #define CORE_ATOMIC_H
 
+#include <stdint.h>
+
 #define CORE_ATOMIC_HAS_COMPARE_AND_SWAP
 
 /*
@@ -35,6 +37,21 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         __sync_val_compare_and_swap(pointer, old_value, new_value)
 
+#define core_atomic_read_int64_t(pointer) \
+        __sync_fetch_and_add (pointer, 0)
+
+#define core_atomic_compare_and_swap_int64_t(pointer, old_value, new_value) \
+        __sync_val_compare_and_swap(pointer, old_value, new_value)
+
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        __sync_val_compare_and_swap(pointer, old_value, new_value)
+
+#define core_atomic_add_int(pointer, value) \
+        __sync_fetch_and_add(pointer, value)
+
+#define core_atomic_add_int64_t(pointer, value) \
+        __sync_fetch_and_add(pointer, value)
+
 /* \see http://docs.cray.com/cgi-bin/craydoc.cgi?mode=View;id=S-2179-74 */
 #elif defined(_CRAYC)
 
@@ -47,6 +64,21 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         __sync_val_compare_and_swap(pointer, old_value, new_value)
 
+#define core_atomic_read_int64_t(pointer) \
+        __sync_fetch_and_add (pointer, 0)
+
+#define core_atomic_compare_and_swap_int64_t(pointer, old_value, new_value) \
+        __sync_val_compare_and_swap(pointer, old_value, new_value)
+
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        __sync_val_compare_and_swap(pointer, old_value, new_value)
+
+#define core_atomic_add_int(pointer, value) \
+        __sync_fetch_and_add(pointer, value)
+
+#define core_atomic_add_int64_t(pointer, value) \
+        __sync_fetch_and_add(pointer, value)
+
 /* Intel compiler
  * \see https://software.intel.com/en-us/forums/topic/281802
  * \see https://www.cs.fsu.edu/~engelen/courses/HPC-adv/intref_cls.pdf
@@ -66,6 +98,21 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         __sync_val_compare_and_swap(pointer, old_value, new_value)
 
+#define core_atomic_read_int64_t(pointer) \
+        __sync_fetch_and_add (pointer, 0)
+
+#define core_atomic_compare_and_swap_int64_t(pointer, old_value, new_value) \
+        __sync_val_compare_and_swap(pointer, old_value, new_value)
+
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        __sync_val_compare_and_swap(pointer, old_value, new_value)
+
+#define core_atomic_add_int(pointer, value) \
+        __sync_fetch_and_add(pointer, value)
+
+#define core_atomic_add_int64_t(pointer, value) \
+        __sync_fetch_and_add(pointer, value)
+
 #else
 
 /* no atomic built in is available
@@ -80,10 +127,33 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         core_atomic_compare_and_swap_int_mock(pointer, old_value, new_value)
 
+#define core_atomic_read_int64_t(pointer) \
+        core_atomic_read_int64_t_mock(pointer)
+
+#define core_atomic_compare_and_swap_int64_t(pointer, old_value, new_value) \
+        core_atomic_compare_and_swap_int64_t_mock(pointer, old_value, new_value)
+
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        core_atomic_compare_and_swap_pointer_mock(pointer, old_value, new_value)
+
+#define core_atomic_add_int(pointer, value) \
+        core_atomic_add_int_mock(pointer, value)
+
+#define core_atomic_add_int64_t(pointer, value) \
+        core_atomic_add_int64_t_mock(pointer, value)
+
 #warning "No atomic features found for this system"
 #endif
 
 int core_atomic_read_int_mock(int *pointer);
 int core_atomic_compare_and_swap_int_mock(int *pointer, int old_value, int new_value);
 
+int64_t core_atomic_read_int64_t_mock(int64_t *pointer);
+int64_t core_atomic_compare_and_swap_int64_t_mock(int64_t *pointer, int64_t old_value, int64_t new_value);
+
+void *core_atomic_compare_and_swap_pointer_mock(void **pointer, void *old_value, void *new_value);
+
+int core_atomic_add_int_mock(int *pointer, int value);
+int64_t core_atomic_add_int64_t_mock(int64_t *pointer, int64_t value);
+
 #endif
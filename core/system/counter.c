@@ -18,6 +18,15 @@ void core_counter_reset(struct core_counter *self)
     }
 }
 
+void core_counter_merge(struct core_counter *self, struct core_counter *other)
+{
+    int i;
+
+    for (i = 0; i < CORE_COUNTER_MAXIMUM; i++) {
+        self->counters[i] += other->counters[i];
+    }
+}
+
 void core_counter_destroy(struct core_counter *self)
 {
     core_counter_reset(self);
@@ -45,6 +45,11 @@ int64_t core_counter_get(struct core_counter *self, int counter);
 void core_counter_increment(struct core_counter *self, int counter);
 void core_counter_add(struct core_counter *self, int counter, int quantity);
 void core_counter_reset(struct core_counter *self);
+
+/*
+ * Add every counter of other to the counters of self.
+ */
+void core_counter_merge(struct core_counter *self, struct core_counter *other);
 void core_counter_print(struct core_counter *self, int name);
 int64_t core_counter_difference(struct core_counter *self, int counter1, int counter2);
 int64_t core_counter_sum(struct core_counter *self, int counter1, int counter2);
@@ -8,6 +8,7 @@
 
 #include <core/structures/queue.h>
 #include <core/structures/map_iterator.h>
+#include <core/structures/set_iterator.h>
 
 #include <stdio.h>
 #include <inttypes.h>
@@ -21,14 +22,44 @@
 #define FLAG_ENABLE_SEGMENT_NORMALIZATION 2
 #define FLAG_ALIGN 3
 #define FLAG_EPHEMERAL 4
+#define FLAG_SLAB 5
 
 #define OPERATION_ALLOCATE  0
 #define OPERATION_FREE      1
 
 #define MEMORY_MEMORY_POOL 0xc170626e
 
+/*
+ * In slab mode, each segment starts with a header followed by a
+ * power-of-two payload, so finding the size on free does not need a
+ * lookup. The header is not part of the rounding: a 4096-byte buffer
+ * uses 4112 bytes, not 8192. The header is 16 bytes to keep SSE2
+ * alignment.
+ */
+struct core_memory_pool_slab_header {
+    struct core_memory_pool *pool;
+    int size_class;
+    int magic;
+};
+
+#define SLAB_HEADER_SIZE 16
+#define SLAB_MAGIC 0x51ab0c1a
+#define SLAB_MINIMUM_SIZE_CLASS 5
+#define SLAB_LARGE_SIZE_CLASS (-1)
+
+static void *core_memory_pool_allocate_slab(struct core_memory_pool *self, size_t size);
+static void core_memory_pool_free_slab(struct core_memory_pool *self, void *pointer);
+static int core_memory_pool_get_size_class(size_t size);
+
+#ifdef CORE_DEBUGGER_ENABLE_ASSERT
+static int core_memory_pool_has_slab_segment(struct core_memory_pool *self, void *header);
+#endif
+static void core_memory_pool_free_large_blocks(struct core_memory_pool *self);
+
 void core_memory_pool_init(struct core_memory_pool *self, int block_size, int name)
 {
+    int i;
+
     core_map_init(&self->recycle_bin, sizeof(size_t), sizeof(struct core_queue));
     core_map_init(&self->allocated_blocks, sizeof(void *), sizeof(size_t));
     core_set_init(&self->large_blocks, sizeof(void *));
@@ -41,6 +72,10 @@ void core_memory_pool_init(struct core_memory_pool *self, int block_size, int na
 
     self->block_size = block_size;
 
+    for (i = 0; i < CORE_MEMORY_POOL_SIZE_CLASS_COUNT; ++i) {
+        self->free_lists[i] = NULL;
+    }
+
     /*
      * Configure flags
      */
@@ -50,6 +85,7 @@ void core_memory_pool_init(struct core_memory_pool *self, int block_size, int na
     core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_ENABLE_SEGMENT_NORMALIZATION);
     core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_ALIGN);
     core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_EPHEMERAL);
+    core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_SLAB);
 
     self->profile_allocated_byte_count = 0;
     self->profile_freed_byte_count = 0;
@@ -106,6 +142,10 @@ void core_memory_pool_destroy(struct core_memory_pool *self)
         self->current_block = NULL;
     }
 
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_SLAB)) {
+        core_memory_pool_free_large_blocks(self);
+    }
+
     core_set_destroy(&self->large_blocks);
 }
 
@@ -132,6 +172,14 @@ void *core_memory_pool_allocate(struct core_memory_pool *self, size_t size)
     CORE_DEBUGGER_ASSERT(size >= CORE_MEMORY_MINIMUM);
     CORE_DEBUGGER_ASSERT(size <= CORE_MEMORY_MAXIMUM);
 
+    /*
+     * Size classes are already normalized.
+     */
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_SLAB)
+                    && !core_bitmap_get_bit_uint32_t(&self->flags, FLAG_DISABLED)) {
+        return core_memory_pool_allocate_slab(self, size);
+    }
+
     normalize = 0;
 
     /*
@@ -317,6 +365,12 @@ void core_memory_pool_free(struct core_memory_pool *self, void *pointer)
         return;
     }
 
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_SLAB)
+                    && !core_bitmap_get_bit_uint32_t(&self->flags, FLAG_DISABLED)) {
+        core_memory_pool_free_slab(self, pointer);
+        return;
+    }
+
     size = 0;
 
     core_memory_pool_free_private(self, pointer);
@@ -424,6 +478,18 @@ void core_memory_pool_free_all(struct core_memory_pool *self)
     CORE_DEBUGGER_ASSERT(!core_memory_pool_has_leaks(self));
 #endif
 
+    /*
+     * Segments in the free lists are in the blocks that are
+     * reset below.
+     */
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_SLAB)) {
+        for (i = 0; i < CORE_MEMORY_POOL_SIZE_CLASS_COUNT; ++i) {
+            self->free_lists[i] = NULL;
+        }
+
+        core_memory_pool_free_large_blocks(self);
+    }
+
     /*
      * Reset the current block
      */
@@ -498,6 +564,16 @@ void core_memory_pool_enable_ephemeral_mode(struct core_memory_pool *self)
     core_bitmap_set_bit_uint32_t(&self->flags, FLAG_EPHEMERAL);
 }
 
+/*
+ * Use power-of-two size classes with inline headers and free lists
+ * instead of the recycle bin. In this mode, normalization,
+ * alignment and tracking flags are not used.
+ */
+void core_memory_pool_enable_slab_mode(struct core_memory_pool *self)
+{
+    core_bitmap_set_bit_uint32_t(&self->flags, FLAG_SLAB);
+}
+
 void core_memory_pool_set_name(struct core_memory_pool *self, int name)
 {
     self->name = name;
@@ -614,3 +690,186 @@ int core_memory_pool_profile_balance_count(struct core_memory_pool *self)
 {
     return self->profile_allocate_calls - self->profile_free_calls;
 }
+
+static void *core_memory_pool_allocate_slab(struct core_memory_pool *self, size_t size)
+{
+    struct core_memory_pool_slab_header *header;
+    void *pointer;
+    int size_class;
+    size_t segment_size;
+
+    size_class = core_memory_pool_get_size_class(size);
+    segment_size = ((size_t)1 << size_class) + SLAB_HEADER_SIZE;
+
+    /*
+     * Large segments go to the memory system directly.
+     */
+    if (segment_size >= self->block_size) {
+        segment_size = size + SLAB_HEADER_SIZE;
+        header = core_memory_allocate(segment_size, self->name);
+        core_set_add(&self->large_blocks, &header);
+        size_class = SLAB_LARGE_SIZE_CLASS;
+
+    } else if (self->free_lists[size_class] != NULL) {
+        pointer = self->free_lists[size_class];
+        self->free_lists[size_class] = *(void **)pointer;
+        header = (struct core_memory_pool_slab_header *)((char *)pointer - SLAB_HEADER_SIZE);
+
+    } else {
+        if (self->current_block == NULL) {
+            core_memory_pool_add_block(self);
+        }
+
+        header = core_memory_block_allocate(self->current_block, segment_size);
+
+        /* the current block is exausted...
+         */
+        if (header == NULL) {
+            core_queue_enqueue(&self->dried_blocks, &self->current_block);
+            self->current_block = NULL;
+
+            core_memory_pool_add_block(self);
+
+            header = core_memory_block_allocate(self->current_block, segment_size);
+        }
+    }
+
+    header->pool = self;
+    header->size_class = size_class;
+    header->magic = SLAB_MAGIC;
+
+    core_memory_pool_profile(self, OPERATION_ALLOCATE, segment_size);
+
+    return (char *)header + SLAB_HEADER_SIZE;
+}
+
+static void core_memory_pool_free_slab(struct core_memory_pool *self, void *pointer)
+{
+    struct core_memory_pool_slab_header *header;
+    int size_class;
+
+    header = (struct core_memory_pool_slab_header *)((char *)pointer - SLAB_HEADER_SIZE);
+
+#ifdef CORE_DEBUGGER_ENABLE_ASSERT
+    /*
+     * Check that the header is in this pool before reading it.
+     */
+    if (!core_memory_pool_has_slab_segment(self, header)) {
+        printf("Error: core_memory_pool_free pointer %p is not in pool %x\n",
+                        pointer, self->name);
+    }
+
+    CORE_DEBUGGER_ASSERT(core_memory_pool_has_slab_segment(self, header));
+#endif
+
+    /*
+     * This was not allocated by this pool. Pools are not thread-safe,
+     * so the segment can not be given back to its owner from here.
+     */
+    if (header->magic != SLAB_MAGIC || header->pool != self) {
+        printf("Error: core_memory_pool_free pointer %p was allocated by pool %p, not by pool %p (%x), leaking it\n",
+                        pointer, header->magic == SLAB_MAGIC ? (void *)header->pool : NULL,
+                        (void *)self, self->name);
+
+        CORE_DEBUGGER_ASSERT(header->magic == SLAB_MAGIC);
+        CORE_DEBUGGER_ASSERT(header->pool == self);
+        return;
+    }
+
+    size_class = header->size_class;
+
+    if (size_class == SLAB_LARGE_SIZE_CLASS) {
+        core_set_delete(&self->large_blocks, &header);
+        core_memory_pool_profile(self, OPERATION_FREE, 0);
+        core_memory_free(header, self->name);
+        return;
+    }
+
+    *(void **)pointer = self->free_lists[size_class];
+    self->free_lists[size_class] = pointer;
+
+    core_memory_pool_profile(self, OPERATION_FREE, ((size_t)1 << size_class) + SLAB_HEADER_SIZE);
+}
+
+#ifdef CORE_DEBUGGER_ENABLE_ASSERT
+/*
+ * \return 1 if the header is a large segment of the pool or is in one
+ * of its blocks.
+ */
+static int core_memory_pool_has_slab_segment(struct core_memory_pool *self, void *header)
+{
+    struct core_memory_block *block;
+    int size;
+    int found;
+
+    if (core_set_find(&self->large_blocks, &header)) {
+        return 1;
+    }
+
+    found = 0;
+    block = self->current_block;
+
+    if (block != NULL && (char *)header >= (char *)block->memory
+                    && (char *)header < (char *)block->memory + block->total_bytes) {
+        found = 1;
+    }
+
+    size = core_queue_size(&self->dried_blocks);
+
+    while (size--) {
+        core_queue_dequeue(&self->dried_blocks, &block);
+
+        if ((char *)header >= (char *)block->memory
+                    && (char *)header < (char *)block->memory + block->total_bytes) {
+            found = 1;
+        }
+
+        core_queue_enqueue(&self->dried_blocks, &block);
+    }
+
+    return found;
+}
+#endif
+
+static int core_memory_pool_get_size_class(size_t size)
+{
+    int size_class;
+
+    if (size <= ((size_t)1 << SLAB_MINIMUM_SIZE_CLASS)) {
+        return SLAB_MINIMUM_SIZE_CLASS;
+    }
+
+#if defined(__GNUC__)
+    size_class = 64 - __builtin_clzll((unsigned long long)size - 1);
+#else
+    size_class = 0;
+
+    while (((size_t)1 << size_class) < size) {
+        ++size_class;
+    }
+#endif
+
+    if (size_class < SLAB_MINIMUM_SIZE_CLASS) {
+        size_class = SLAB_MINIMUM_SIZE_CLASS;
+    }
+
+    CORE_DEBUGGER_ASSERT(size_class < CORE_MEMORY_POOL_SIZE_CLASS_COUNT);
+
+    return size_class;
+}
+
+static void core_memory_pool_free_large_blocks(struct core_memory_pool *self)
+{
+    struct core_set_iterator iterator;
+    void *header;
+
+    core_set_iterator_init(&iterator, &self->large_blocks);
+
+    while (core_set_iterator_get_next_value(&iterator, &header)) {
+        core_memory_free(header, self->name);
+    }
+
+    core_set_iterator_destroy(&iterator);
+
+    core_set_clear(&self->large_blocks);
+}
@@ -34,6 +34,11 @@
  */
 #define CORE_MEMORY_POOL_MESSAGE_BUFFER_BLOCK_SIZE (2 * 1024 * 1024)
 
+/*
+ * Number of power-of-two size classes in slab mode.
+ */
+#define CORE_MEMORY_POOL_SIZE_CLASS_COUNT 48
+
 struct core_memory_pool_state {
     int test_profile_allocate_calls;
     int test_profile_free_calls;
@@ -52,6 +57,12 @@ struct core_memory_pool {
     struct core_queue ready_blocks;
     struct core_queue dried_blocks;
 
+    /*
+     * In slab mode, free segments of each size class
+     * are linked through their first bytes.
+     */
+    void *free_lists[CORE_MEMORY_POOL_SIZE_CLASS_COUNT];
+
     uint32_t flags;
     size_t block_size;
 
@@ -85,6 +96,7 @@ void core_memory_pool_add_block(struct core_memory_pool *self);
 void core_memory_pool_disable_normalization(struct core_memory_pool *self);
 void core_memory_pool_enable_normalization(struct core_memory_pool *self);
 void core_memory_pool_enable_ephemeral_mode(struct core_memory_pool *self);
+void core_memory_pool_enable_slab_mode(struct core_memory_pool *self);
 
 void core_memory_pool_disable_alignment(struct core_memory_pool *self);
 void core_memory_pool_enable_alignment(struct core_memory_pool *self);
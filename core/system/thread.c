@@ -8,6 +8,7 @@
 #include "thread.h"
 
 #include "memory.h"
+#include "atomic.h"
 
 
 #if defined(__linux__) || defined(__bgq__)
@@ -16,6 +17,11 @@
 
 #endif
 
+#ifdef CORE_THREAD_USE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
 #include <stdio.h>
 
 /* for getpid */
@@ -46,8 +52,13 @@ void core_thread_init(struct core_thread *thread, void *(*function)(void *), voi
     pthread_mutex_init(&thread->waiting_mutex, NULL);
     pthread_cond_init(&thread->waiting_condition, NULL);
 
-    thread->waiting = 0;
+    thread->state = CORE_THREAD_STATE_RUNNING;
     thread->wake_up_event_count= 0;
+
+    core_timer_init(&thread->timer);
+    thread->signal_time = 0;
+    thread->wake_up_latency = 0;
+    thread->maximum_wake_up_latency = 0;
 }
 
 void core_thread_destroy(struct core_thread *thread)
@@ -58,6 +69,8 @@ void core_thread_destroy(struct core_thread *thread)
 
     pthread_mutex_destroy(&thread->waiting_mutex);
     pthread_cond_destroy(&thread->waiting_condition);
+
+    core_timer_destroy(&thread->timer);
 }
 
 void core_thread_start(struct core_thread *thread)
@@ -185,90 +198,150 @@ void core_set_affinity(int processor)
  */
 /*
  * Based on the pseudocode at https://computing.llnl.gov/tutorials/pthreads/
+ *
+ * With CORE_THREAD_USE_FUTEX, the thread sleeps in the kernel on its
+ * state word, without any mutex.
+ *
+ * \see http://man7.org/linux/man-pages/man2/futex.2.html
+ * \see http://www.akkadia.org/drepper/futex.pdf
  */
-void core_thread_wait(struct core_thread *thread)
+void core_thread_prepare_to_wait(struct core_thread *thread)
 {
-    if (thread->waiting) {
-        /* Don't do anything since the thread is already waiting.
-         */
-        return;
-    }
-
-#ifdef CORE_THREAD_DEBUG_WAIT
-    printf("DEBUG core_thread_wait: Getting lock now\n");
-#endif
-
-    pthread_mutex_lock(&thread->waiting_mutex);
+    thread->state = CORE_THREAD_STATE_WAITING;
 
     /*
-     * Make the waiting variable visible.
+     * Make the state visible before looking for work one last time.
+     * The signal does the opposite: it makes the work visible before
+     * reading the state.
      */
-    thread->waiting = 1;
-    ++thread->wake_up_event_count;
-
     core_memory_fence();
+}
 
-#ifdef CORE_THREAD_DEBUG_WAIT
-    printf("DEBUG core_thread_wait enter pthread_cond_wait\n");
-#endif
-    /*
-     * The wait call below unlocks the mutex such that
-     * others can access it.
-     * The call will return when the thread receives the POSIX
-     * thread signal.
-     */
-    pthread_cond_wait(&thread->waiting_condition, &thread->waiting_mutex);
+void core_thread_cancel_wait(struct core_thread *thread)
+{
+    core_atomic_compare_and_swap_int(&thread->state, CORE_THREAD_STATE_WAITING,
+                    CORE_THREAD_STATE_RUNNING);
+}
+
+void core_thread_wait(struct core_thread *thread)
+{
+    uint64_t latency;
+    uint64_t time;
+
+    if (thread->state != CORE_THREAD_STATE_WAITING) {
+        core_thread_prepare_to_wait(thread);
+    }
+
+    ++thread->wake_up_event_count;
 
 #ifdef CORE_THREAD_DEBUG_WAIT
-    printf("DEBUG core_thread_wait exit pthread_cond_wait\n");
+    printf("DEBUG core_thread_wait enter wait\n");
 #endif
+
+#ifdef CORE_THREAD_USE_FUTEX
     /*
-     * OK. The thread is not waiting anymore. The thread owns the waiting mutex
-     * though now, so it needs to be unlocked somehow.
-     *
-     * Set the waiting variable to 0 and make it visible
+     * FUTEX_WAIT returns right away if the state is not
+     * CORE_THREAD_STATE_WAITING anymore.
      */
-    thread->waiting = 0;
-    core_memory_fence();
+    while (*(volatile int *)&thread->state == CORE_THREAD_STATE_WAITING) {
+        syscall(SYS_futex, &thread->state, FUTEX_WAIT_PRIVATE,
+                        CORE_THREAD_STATE_WAITING, NULL, NULL, 0);
+    }
+#else
+    pthread_mutex_lock(&thread->waiting_mutex);
 
     /*
-     * Here, the thread gets the control, and the waiting_mutex is now locked.
-     * it needs to be unlocked now.
+     * The wait call below unlocks the mutex such that
+     * others can access it. The loop handles spurious wake-ups.
      */
+    while (*(volatile int *)&thread->state == CORE_THREAD_STATE_WAITING) {
+        pthread_cond_wait(&thread->waiting_condition, &thread->waiting_mutex);
+    }
+
     pthread_mutex_unlock(&thread->waiting_mutex);
+#endif
 
 #ifdef CORE_THREAD_DEBUG_WAIT
-    printf("DEBUG core_thread_wait released lock\n");
+    printf("DEBUG core_thread_wait exit wait\n");
 #endif
+
+    time = core_timer_get_nanoseconds(&thread->timer);
+    latency = 0;
+
+    if (time > thread->signal_time) {
+        latency = time - thread->signal_time;
+    }
+
+    thread->wake_up_latency += latency;
+
+    if (latency > thread->maximum_wake_up_latency) {
+        thread->maximum_wake_up_latency = latency;
+    }
 }
 
 void core_thread_signal(struct core_thread *thread)
 {
+    /*
+     * Make the work visible before reading the state.
+     */
+    core_memory_fence();
+
     /* Don't signal if the thread is not waiting.
-     * A lock is not required since the wait call
-     * is using a memory fence.
      */
-    if (!thread->waiting) {
+    if (*(volatile int *)&thread->state != CORE_THREAD_STATE_WAITING) {
         return;
     }
 
-#ifdef CORE_THREAD_DEBUG_WAIT
-    printf("DEBUG core_thread_signal sending signal to thread.\n");
-#endif
+    thread->signal_time = core_timer_get_nanoseconds(&thread->timer);
 
-    /* Otherwise, signal the thread.
+    /*
+     * Only one signal wakes up the thread.
      */
-    pthread_mutex_lock(&thread->waiting_mutex);
+    if (core_atomic_compare_and_swap_int(&thread->state, CORE_THREAD_STATE_WAITING,
+                            CORE_THREAD_STATE_RUNNING) != CORE_THREAD_STATE_WAITING) {
+        return;
+    }
 
 #ifdef CORE_THREAD_DEBUG_WAIT
-    printf("DEBUG core_thread_signal signal got lock\n");
+    printf("DEBUG core_thread_signal sending signal to thread.\n");
 #endif
 
+#ifdef CORE_THREAD_USE_FUTEX
+    syscall(SYS_futex, &thread->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&thread->waiting_mutex);
     pthread_cond_signal(&thread->waiting_condition);
     pthread_mutex_unlock(&thread->waiting_mutex);
+#endif
+}
+
+void core_thread_pause()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __asm__ __volatile__ ("pause" ::: "memory");
+#elif defined(__GNUC__)
+    __asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+void core_thread_yield()
+{
+#if defined(__linux__) || defined(__bgq__)
+    sched_yield();
+#endif
 }
 
 uint64_t core_thread_get_wake_up_count(struct core_thread *thread)
 {
     return thread->wake_up_event_count;
 }
+
+uint64_t core_thread_get_wake_up_latency(struct core_thread *thread)
+{
+    return thread->wake_up_latency;
+}
+
+uint64_t core_thread_get_maximum_wake_up_latency(struct core_thread *thread)
+{
+    return thread->maximum_wake_up_latency;
+}
@@ -2,10 +2,23 @@
 #ifndef CORE_THREAD_H
 #define CORE_THREAD_H
 
+#include "timer.h"
+
 #include <pthread.h>
 
 #include <stdint.h>
 
+/*
+ * Park waiting threads on a futex on Linux. Elsewhere, a condition
+ * variable and its mutex are used.
+ */
+#if defined(__linux__) && !defined(__bgq__)
+#define CORE_THREAD_USE_FUTEX
+#endif
+
+#define CORE_THREAD_STATE_RUNNING 0
+#define CORE_THREAD_STATE_WAITING 1
+
 /*
  *
  * THis is a wrapper for a thread type.
@@ -25,11 +38,26 @@ struct core_thread {
     void *argument;
     int affinity;
 
-    char waiting;
+    /*
+     * The state is the futex word. A signal only changes it from
+     * CORE_THREAD_STATE_WAITING to CORE_THREAD_STATE_RUNNING, so a
+     * signal sent between core_thread_prepare_to_wait and
+     * core_thread_wait is not lost.
+     */
+    int state;
     pthread_cond_t waiting_condition;
     pthread_mutex_t waiting_mutex;
 
     uint64_t wake_up_event_count;
+
+    /*
+     * Time between a signal and the return of core_thread_wait,
+     * in nanoseconds.
+     */
+    struct core_timer timer;
+    uint64_t signal_time;
+    uint64_t wake_up_latency;
+    uint64_t maximum_wake_up_latency;
 };
 
 void core_thread_init(struct core_thread *self, void *(*function)(void *), void *argument);
@@ -40,8 +68,34 @@ void core_thread_join(struct core_thread *self);
 
 void core_set_affinity(int processor);
 
+/*
+ * A thread parks itself with:
+ *
+ * 1. core_thread_prepare_to_wait
+ * 2. check once more for work, and call core_thread_cancel_wait if
+ *    there is some;
+ * 3. core_thread_wait otherwise.
+ *
+ * core_thread_wait alone does 1. and 3.
+ */
+void core_thread_prepare_to_wait(struct core_thread *self);
+void core_thread_cancel_wait(struct core_thread *self);
 void core_thread_wait(struct core_thread *self);
 void core_thread_signal(struct core_thread *self);
+
+/*
+ * Hints for busy waiting: pause the processor for a few cycles,
+ * or give the processor to another thread.
+ */
+void core_thread_pause();
+void core_thread_yield();
+
 uint64_t core_thread_get_wake_up_count(struct core_thread *self);
 
+/*
+ * \return sum of the wake-up latencies, in nanoseconds
+ */
+uint64_t core_thread_get_wake_up_latency(struct core_thread *self);
+uint64_t core_thread_get_maximum_wake_up_latency(struct core_thread *self);
+
 #endif
@@ -28,6 +28,7 @@ THORIUM_OBJECTS += engine/thorium/scheduler/balancer.o
 THORIUM_OBJECTS += engine/thorium/scheduler/scheduler.o
 THORIUM_OBJECTS += engine/thorium/scheduler/cfs_scheduler.o
 THORIUM_OBJECTS += engine/thorium/scheduler/fifo_scheduler.o
+THORIUM_OBJECTS += engine/thorium/scheduler/work_stealing_scheduler.o
 THORIUM_OBJECTS += engine/thorium/scheduler/priority_assigner.o
 
 # transport system
@@ -14,7 +14,9 @@
 #include <core/helpers/bitmap.h>
 
 #include <core/system/memory.h>
+#include <core/system/atomic.h>
 #include <core/system/debugger.h>
+#include <core/system/thread.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -63,6 +65,7 @@
 #define FLAG_CLONING_PROGRESSED             6
 #define FLAG_SYNCHRONIZATION_STARTED        7
 #define FLAG_ENABLE_LOAD_PROFILER           8
+#define FLAG_RETAINED_MESSAGE               9
 
 void thorium_actor_init(struct thorium_actor *self, void *concrete_actor,
                 struct thorium_script *script, int name, struct thorium_node *node)
@@ -73,6 +76,8 @@ void thorium_actor_init(struct thorium_actor *self, void *concrete_actor,
     self->virtual_runtime = 0;
     core_timer_init(&self->timer);
 
+    self->scheduling_state = THORIUM_ACTOR_SCHEDULING_STATE_IDLE;
+
     thorium_load_profiler_init(&self->profiler);
 
     thorium_actor_set_priority(self, THORIUM_PRIORITY_NORMAL);
@@ -146,7 +151,8 @@ void thorium_actor_init(struct thorium_actor *self, void *concrete_actor,
     core_queue_init(&self->enqueued_messages, sizeof(struct thorium_message));
 
     capacity = THORIUM_ACTOR_MAILBOX_SIZE;
-    core_fast_ring_init(&self->mailbox, capacity, sizeof(struct thorium_message));
+    core_mpsc_ring_init(&self->mailbox, capacity, sizeof(struct thorium_message));
+    self->assigned_worker = -1;
 
     /* call the concrete initializer
      * this must be the last call.
@@ -213,7 +219,7 @@ void thorium_actor_destroy(struct thorium_actor *self)
 
     core_queue_destroy(&self->enqueued_messages);
 
-    CORE_DEBUGGER_ASSERT(core_fast_ring_empty(&self->mailbox));
+    CORE_DEBUGGER_ASSERT(core_mpsc_ring_empty(&self->mailbox));
 
     self->name = -1;
 
@@ -234,7 +240,7 @@ void thorium_actor_destroy(struct thorium_actor *self)
      * and destroyed too
      */
 
-    core_fast_ring_destroy(&self->mailbox);
+    core_mpsc_ring_destroy(&self->mailbox);
 }
 
 int thorium_actor_name(struct thorium_actor *self)
@@ -1638,9 +1644,13 @@ void thorium_actor_forward_messages(struct thorium_actor *self, struct thorium_m
 
         thorium_actor_pack_proxy_message(self, &new_message,
                         thorium_message_source(&new_message));
-        thorium_actor_send(self, destination, &new_message);
 
+        /*
+         * Sending replaces the buffer of the message with an outbound copy.
+         */
         buffer_to_release = thorium_message_buffer(&new_message);
+        thorium_actor_send(self, destination, &new_message);
+
         core_memory_pool_free(ephemeral_memory, buffer_to_release);
 
         /* recursive actor call
@@ -1864,14 +1874,17 @@ struct core_map *thorium_actor_get_sent_messages(struct thorium_actor *self)
 #endif
 }
 
+/*
+ * This is called by the node and by the workers.
+ */
 int thorium_actor_enqueue_mailbox_message(struct thorium_actor *self, struct thorium_message *message)
 {
-    return core_fast_ring_push_from_producer(&self->mailbox, message);
+    return core_mpsc_ring_push(&self->mailbox, message);
 }
 
 int thorium_actor_dequeue_mailbox_message(struct thorium_actor *self, struct thorium_message *message)
 {
-    return core_fast_ring_pop_from_consumer(&self->mailbox, message);
+    return core_mpsc_ring_pop(&self->mailbox, message);
 }
 
 int thorium_actor_work(struct thorium_actor *self)
@@ -1881,11 +1894,19 @@ int thorium_actor_work(struct thorium_actor *self)
     int source_worker;
     struct core_memory_pool *ephemeral_memory;
 
-    if (!thorium_actor_dequeue_mailbox_message(self, &message)) {
-        printf("Error, no message...\n");
-        thorium_actor_print(self);
+    /*
+     * The next cell may be claimed by a producer that is still
+     * copying its message. A producer never blocks between the claim
+     * and the publication, so wait for it instead of relying on a
+     * new scheduling of the actor.
+     */
+    while (!thorium_actor_dequeue_mailbox_message(self, &message)) {
 
-        return 0;
+        if (core_mpsc_ring_empty(&self->mailbox)) {
+            return 0;
+        }
+
+        core_thread_yield();
     }
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
@@ -1938,12 +1959,16 @@ int thorium_actor_work(struct thorium_actor *self)
     thorium_message_set_worker(&message, source_worker);
 
     /*
-     * Send the buffer back to the source to be recycled.
+     * Send the buffer back to the source to be recycled, unless
+     * the actor kept it with thorium_actor_retain_message.
      *
      * The buffer may be NULL in some specific cases.
      */
 
-    if (buffer != NULL) {
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_RETAINED_MESSAGE)) {
+        core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_RETAINED_MESSAGE);
+
+    } else if (buffer != NULL) {
         CORE_DEBUGGER_ASSERT(thorium_message_buffer(&message) != NULL);
         thorium_worker_free_message(self->worker, &message);
     }
@@ -1970,7 +1995,58 @@ int thorium_actor_get_mailbox_size(struct thorium_actor *self)
     if (thorium_actor_dead(self)) {
         return 0;
     }
-    return core_fast_ring_size_from_producer(&self->mailbox);
+    return core_mpsc_ring_size(&self->mailbox);
+}
+
+/*
+ * Messages that did not fit in the mailbox. They were buffered
+ * by the node or sent through the node by a worker.
+ */
+int64_t thorium_actor_get_rejected_mailbox_message_count(struct thorium_actor *self)
+{
+    return core_mpsc_ring_rejected_count(&self->mailbox);
+}
+
+int thorium_actor_get_assigned_worker(struct thorium_actor *self)
+{
+    return core_atomic_read_int(&self->assigned_worker);
+}
+
+/*
+ * This is called by the node.
+ */
+void thorium_actor_set_assigned_worker(struct thorium_actor *self, int worker)
+{
+    core_memory_fence();
+
+    self->assigned_worker = worker;
+}
+
+int thorium_actor_get_scheduling_state(struct thorium_actor *self)
+{
+    return core_atomic_read_int(&self->scheduling_state);
+}
+
+void thorium_actor_set_scheduling_state(struct thorium_actor *self, int state)
+{
+    /*
+     * Make previous writes (the mailbox, the actor state) visible
+     * before the new scheduling state.
+     */
+    core_memory_fence();
+
+    self->scheduling_state = state;
+
+    core_memory_fence();
+}
+
+/*
+ * Returns 1 if the state was changed from old_state to new_state.
+ */
+int thorium_actor_change_scheduling_state(struct thorium_actor *self, int old_state, int new_state)
+{
+    return core_atomic_compare_and_swap_int(&self->scheduling_state,
+                    old_state, new_state) == old_state;
 }
 
 int thorium_actor_get_sum_of_received_messages(struct thorium_actor *self)
@@ -2196,3 +2272,17 @@ void *thorium_actor_allocate(struct thorium_actor *self, size_t count)
 {
     return thorium_worker_allocate(self->worker, count);
 }
+
+void thorium_actor_retain_message(struct thorium_actor *self, struct thorium_message *message)
+{
+    CORE_DEBUGGER_ASSERT(thorium_message_buffer(message) != NULL);
+
+    core_bitmap_set_bit_uint32_t(&self->flags, FLAG_RETAINED_MESSAGE);
+}
+
+void thorium_actor_release_message(struct thorium_actor *self, struct thorium_message *message)
+{
+    CORE_DEBUGGER_ASSERT(thorium_message_buffer(message) != NULL);
+
+    thorium_worker_free_message(self->worker, message);
+}
@@ -18,6 +18,7 @@
 #include <core/structures/map.h>
 #include <core/structures/queue.h>
 #include <core/structures/fast_ring.h>
+#include <core/structures/mpsc_ring.h>
 
 #include <core/system/lock.h>
 #include <core/system/counter.h>
@@ -184,6 +185,14 @@ new name.
 #define THORIUM_ACTOR_STATUS_NOT_STARTED 2
 #define THORIUM_ACTOR_STATUS_STARTED 3
 
+/*
+ * Scheduling states, used when workers steal actors
+ * from each other.
+ */
+#define THORIUM_ACTOR_SCHEDULING_STATE_IDLE 0
+#define THORIUM_ACTOR_SCHEDULING_STATE_QUEUED 1
+#define THORIUM_ACTOR_SCHEDULING_STATE_RUNNING 2
+
 /* special names */
 #define THORIUM_ACTOR_SELF 0
 #define THORIUM_ACTOR_SUPERVISOR 1
@@ -204,7 +213,7 @@ struct core_memory_pool;
 
 /*
  * The mailbox size of an actor.
- * When it is full, messages are buffered upstream.
+ * When it is full, messages are buffered upstream (by the node).
  */
 /*
 #define THORIUM_ACTOR_MAILBOX_SIZE 4
@@ -226,7 +235,16 @@ struct thorium_actor {
      */
     int priority;
     uint32_t flags;
-    struct core_fast_ring mailbox;
+    /*
+     * The node and the workers push messages in the mailbox.
+     */
+    struct core_mpsc_ring mailbox;
+
+    /*
+     * The worker of the actor, as assigned by the balancer
+     * (or -1).
+     */
+    int assigned_worker;
 
 #ifdef THORIUM_ACTOR_GATHER_MESSAGE_METADATA
     struct core_map received_messages;
@@ -292,6 +310,12 @@ struct thorium_actor {
      */
     uint64_t virtual_runtime;
     struct core_timer timer;
+
+    /*
+     * THORIUM_ACTOR_SCHEDULING_STATE_IDLE, _QUEUED or _RUNNING.
+     * Only used by workers with work stealing.
+     */
+    int scheduling_state;
 };
 
 void thorium_actor_init(struct thorium_actor *self, void *state,
@@ -426,6 +450,14 @@ struct thorium_worker *thorium_actor_get_last_worker(struct thorium_actor *self)
 int thorium_actor_enqueue_mailbox_message(struct thorium_actor *self, struct thorium_message *message);
 int thorium_actor_dequeue_mailbox_message(struct thorium_actor *self, struct thorium_message *message);
 int thorium_actor_get_mailbox_size(struct thorium_actor *self);
+int64_t thorium_actor_get_rejected_mailbox_message_count(struct thorium_actor *self);
+
+int thorium_actor_get_assigned_worker(struct thorium_actor *self);
+void thorium_actor_set_assigned_worker(struct thorium_actor *self, int worker);
+
+int thorium_actor_get_scheduling_state(struct thorium_actor *self);
+void thorium_actor_set_scheduling_state(struct thorium_actor *self, int state);
+int thorium_actor_change_scheduling_state(struct thorium_actor *self, int old_state, int new_state);
 
 int thorium_actor_get_sum_of_received_messages(struct thorium_actor *self);
 int thorium_actor_work(struct thorium_actor *self);
@@ -460,6 +492,23 @@ void thorium_actor_write_profile(struct thorium_actor *self,
 
 #endif
 
+/*
+ * Allocate a buffer for an outbound message.
+ *
+ * The actor owns the buffer until it sends it. Sending the buffer
+ * transfers its ownership to the runtime without a copy, even if other
+ * buffers were allocated in the meantime. The buffer must not be used
+ * after that.
+ */
 void *thorium_actor_allocate(struct thorium_actor *self, size_t count);
 
+/*
+ * Keep the buffer of the message being received instead of
+ * copying its content. The runtime does not recycle the buffer when
+ * the receive function returns. The actor keeps a copy of the message
+ * and gives the buffer back later with thorium_actor_release_message.
+ */
+void thorium_actor_retain_message(struct thorium_actor *self, struct thorium_message *message);
+void thorium_actor_release_message(struct thorium_actor *self, struct thorium_message *message);
+
 #endif
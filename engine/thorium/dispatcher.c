@@ -5,12 +5,27 @@
 #include "actor.h"
 #include "route.h"
 
-#include <core/structures/map.h>
 #include <core/structures/vector.h>
-#include <core/structures/map_iterator.h>
+
+#include <core/system/memory.h>
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+
+#define MEMORY_DISPATCHER_KEY 0x5d2c8f31
+
+/*
+ * The table is at most half full.
+ */
+#define MINIMUM_ENTRY_COUNT 8
+
+static void thorium_dispatcher_compile(struct thorium_dispatcher *self);
+static void thorium_dispatcher_free_table(struct thorium_dispatcher *self);
+static struct thorium_dispatcher_entry *thorium_dispatcher_find(struct thorium_dispatcher *self,
+                int tag, int claim);
+static thorium_actor_receive_fn_t thorium_dispatcher_select(struct thorium_dispatcher *self,
+                struct thorium_dispatcher_entry *entry, int source);
 
 /*
 #define THORIUM_DISPATCHER_DEBUG_10335
@@ -18,44 +33,20 @@
 
 void thorium_dispatcher_init(struct thorium_dispatcher *self)
 {
-    core_map_init(&self->routes, sizeof(int), sizeof(struct core_map));
+    core_vector_init(&self->routes, sizeof(struct thorium_dispatcher_route));
+
+    self->compiled = 0;
+    self->shift = 0;
+    self->mask = 0;
+    self->entries = NULL;
+    self->compiled_routes = NULL;
 }
 
 void thorium_dispatcher_destroy(struct thorium_dispatcher *self)
 {
-    struct core_map_iterator iterator;
-    struct core_map_iterator iterator2;
-    struct core_map *map;
-    struct core_vector *vector;
-
-    core_map_iterator_init(&iterator, &self->routes);
-
-    /*
-     * For each tag, iterate over each source and destroy each vector
-     * of routes.
-     */
-    while (core_map_iterator_has_next(&iterator)) {
-        core_map_iterator_next(&iterator, NULL, (void **)&map);
-
-        core_map_iterator_init(&iterator2, map);
-
-        while (core_map_iterator_has_next(&iterator2)) {
-            core_map_iterator_next(&iterator2, NULL, (void **)&vector);
-
-            /*
-             * Destroy routes
-             */
-            core_vector_destroy(vector);
-        }
-
-        core_map_iterator_destroy(&iterator2);
+    core_vector_destroy(&self->routes);
 
-        core_map_destroy(map);
-    }
-
-    core_map_iterator_destroy(&iterator);
-
-    core_map_destroy(&self->routes);
+    thorium_dispatcher_free_table(self);
 }
 
 void thorium_dispatcher_add_action(struct thorium_dispatcher *self, int tag,
@@ -64,61 +55,38 @@ void thorium_dispatcher_add_action(struct thorium_dispatcher *self, int tag,
                int *actual,
                int expected)
 {
-    struct core_map *map;
-    struct core_vector *vector;
-    struct thorium_route *route;
-    struct thorium_route new_route;
+    struct thorium_dispatcher_route *route;
+    struct thorium_dispatcher_route new_route;
     int size;
     int i;
-    int found;
-
-    map = core_map_get(&self->routes, &tag);
-
-    /*
-     * Initialize the map if it does not exist
-     */
-    if (map == NULL) {
-        map = core_map_add(&self->routes, &tag);
-
-        core_map_init(map, sizeof(int), sizeof(struct core_vector));
-    }
-
-    vector = core_map_get(map, &source);
-
-    /*
-     * Create the bucket if it is not there.
-     */
-    if (vector == NULL) {
-        vector = core_map_add(map, &source);
-
-        core_vector_init(vector, sizeof(struct thorium_route));
-    }
 
     /* Add the route in the vector
      */
 
-    thorium_route_init(&new_route, actual, expected, handler);
+    new_route.tag = tag;
+    new_route.source = source;
+    thorium_route_init(&new_route.route, actual, expected, handler);
 
     /* Check if it is there already
      */
 
-    size = core_vector_size(vector);
-    found = 0;
+    size = core_vector_size(&self->routes);
 
     for (i = 0; i < size; i++) {
-        route = core_vector_at(vector, i);
+        route = core_vector_at(&self->routes, i);
 
-        if (thorium_route_equals(route, &new_route)) {
-            found = 1;
-            break;
+        if (route->tag == tag && route->source == source
+                        && thorium_route_equals(&route->route, &new_route.route)) {
+            return;
         }
     }
 
-    if (!found) {
-        core_vector_push_back(vector, &new_route);
-    }
+    core_vector_push_back(&self->routes, &new_route);
 
-    thorium_route_destroy(&new_route);
+    /*
+     * The table is compiled again on the next dispatch.
+     */
+    self->compiled = 0;
 }
 
 int thorium_dispatcher_dispatch(struct thorium_dispatcher *self, struct thorium_actor *actor,
@@ -152,20 +120,10 @@ int thorium_dispatcher_dispatch(struct thorium_dispatcher *self, struct thorium_
      *
      * If that does not work, try with the tag and
      * with the source wildcard THORIUM_ACTOR_ANYBODY
+     * (this is done by thorium_dispatcher_get).
      */
     handler = thorium_dispatcher_get(self, tag, source);
 
-    /*
-     * If there is no route for this source,
-     * try with the wild card THORIUM_ACTOR_ANYBODY to see
-     * if this is registered.
-     *
-     */
-    if (handler == NULL) {
-
-        handler = thorium_dispatcher_get(self, tag, THORIUM_ACTOR_ANYBODY);
-    }
-
     if (handler == NULL) {
 
         /*
@@ -191,70 +149,242 @@ int thorium_dispatcher_dispatch(struct thorium_dispatcher *self, struct thorium_
 
 thorium_actor_receive_fn_t thorium_dispatcher_get(struct thorium_dispatcher *self, int tag, int source)
 {
-    struct core_map *map;
-    struct core_vector *vector;
-    struct thorium_route *route;
-    int i;
-    int size;
-    thorium_actor_receive_fn_t handler_with_condition;
-    thorium_actor_receive_fn_t handler_without_condition;
+    struct thorium_dispatcher_entry *entry;
 
-    handler_with_condition = NULL;
-    handler_without_condition = NULL;
+    if (!self->compiled) {
+        thorium_dispatcher_compile(self);
+    }
 
-    map = core_map_get(&self->routes, &tag);
+    /*
+     * No route at all.
+     */
+    if (self->entries == NULL) {
+        return NULL;
+    }
+
+    entry = thorium_dispatcher_find(self, tag, 0);
 
     /*
      * This tag is not configured
      */
-    if (map == NULL) {
+    if (entry == NULL) {
         return NULL;
     }
 
-    vector = core_map_get(map, &source);
+    if (entry->handler != NULL) {
+        return entry->handler;
+    }
+
+    return thorium_dispatcher_select(self, entry, source);
+}
+
+/*
+ * Pick up the route for a source: first the routes for the source,
+ * then the routes for THORIUM_ACTOR_ANYBODY.
+ *
+ * For a given source, the last route with a satisfied condition has
+ * priority, then the last route without condition.
+ */
+static thorium_actor_receive_fn_t thorium_dispatcher_select(struct thorium_dispatcher *self,
+                struct thorium_dispatcher_entry *entry, int source)
+{
+    struct thorium_dispatcher_route *route;
+    thorium_actor_receive_fn_t handler_with_condition;
+    thorium_actor_receive_fn_t handler_without_condition;
+    int test;
+    int pass;
+    int i;
+
+    for (pass = 0; pass < 2; ++pass) {
+
+        handler_with_condition = NULL;
+        handler_without_condition = NULL;
+
+        for (i = 0; i < entry->route_count; ++i) {
+            route = self->compiled_routes + entry->first_route + i;
+
+            if (route->source != source) {
+                continue;
+            }
+
+            test = thorium_route_test(&route->route);
+
+            if (test == THORIUM_ROUTE_CONDITION_TRUE) {
+                handler_with_condition = thorium_route_handler(&route->route);
+            } else if (test == THORIUM_ROUTE_CONDITION_NONE) {
+                handler_without_condition = thorium_route_handler(&route->route);
+            }
+
+            /* Otherwise it is THORIUM_ROUTE_CONDITION_FALSE
+             */
+        }
+
+        /*
+         * THORIUM_ROUTE_CONDITION_TRUE has priority
+         */
+        if (handler_with_condition != NULL) {
+            return handler_with_condition;
+        }
+
+        if (handler_without_condition != NULL) {
+            return handler_without_condition;
+        }
+
+        if (source == THORIUM_ACTOR_ANYBODY) {
+            break;
+        }
+
+        source = THORIUM_ACTOR_ANYBODY;
+    }
+
+    return NULL;
+}
+
+/*
+ * Build the flat table from the list of routes.
+ */
+static void thorium_dispatcher_compile(struct thorium_dispatcher *self)
+{
+    struct thorium_dispatcher_entry *entry;
+    struct thorium_dispatcher_route *route;
+    int route_count;
+    int entry_count;
+    int bits;
+    int first_route;
+    int i;
+
+    thorium_dispatcher_free_table(self);
+    self->compiled = 1;
+
+    route_count = core_vector_size(&self->routes);
+
+    if (route_count == 0) {
+        return;
+    }
 
     /*
-     * This source is not
-     * configured
+     * There are at most route_count tags.
      */
-    if (vector == NULL) {
+    entry_count = MINIMUM_ENTRY_COUNT;
+    bits = 3;
 
-        return NULL;
+    while (entry_count < 2 * route_count) {
+        entry_count *= 2;
+        ++bits;
+    }
+
+    self->shift = 32 - bits;
+    self->mask = entry_count - 1;
+
+    self->entries = core_memory_allocate(entry_count * sizeof(struct thorium_dispatcher_entry),
+                    MEMORY_DISPATCHER_KEY);
+
+    for (i = 0; i < entry_count; ++i) {
+        self->entries[i].tag = 0;
+        self->entries[i].first_route = 0;
+        self->entries[i].route_count = 0;
+        self->entries[i].handler = NULL;
     }
 
     /*
-     * Pick up the first route with a satisfied condition
+     * Count the routes of each tag.
      */
+    for (i = 0; i < route_count; ++i) {
+        route = core_vector_at(&self->routes, i);
+        entry = thorium_dispatcher_find(self, route->tag, 1);
+        ++entry->route_count;
+    }
 
-    size = core_vector_size(vector);
+    /*
+     * The routes of a tag are contiguous.
+     */
+    first_route = 0;
 
-    for (i = 0; i < size; i++) {
+    for (i = 0; i < entry_count; ++i) {
+        entry = self->entries + i;
+        entry->first_route = first_route;
+        first_route += entry->route_count;
+    }
 
-        route = core_vector_at(vector, i);
+    self->compiled_routes = core_memory_allocate(route_count * sizeof(struct thorium_dispatcher_route),
+                    MEMORY_DISPATCHER_KEY);
 
-        if (thorium_route_test(route) == THORIUM_ROUTE_CONDITION_TRUE) {
-            handler_with_condition = thorium_route_handler(route);
-        } else if (thorium_route_test(route) == THORIUM_ROUTE_CONDITION_NONE) {
-            handler_without_condition = thorium_route_handler(route);
-        }
+    /*
+     * Keep the order of registration for each tag. first_route is
+     * used as a cursor here.
+     */
+    for (i = 0; i < route_count; ++i) {
+        route = core_vector_at(&self->routes, i);
+        entry = thorium_dispatcher_find(self, route->tag, 0);
 
-        /* Otherwise it is THORIUM_ROUTE_CONDITION_FALSE
-         */
+        self->compiled_routes[entry->first_route] = *route;
+        ++entry->first_route;
     }
 
     /*
-     * THORIUM_ROUTE_CONDITION_TRUE has priority
+     * The common case needs no search.
      */
+    for (i = 0; i < entry_count; ++i) {
+        entry = self->entries + i;
+        entry->first_route -= entry->route_count;
+        route = self->compiled_routes + entry->first_route;
+
+        if (entry->route_count == 1
+                        && route->source == THORIUM_ACTOR_ANYBODY
+                        && thorium_route_test(&route->route) == THORIUM_ROUTE_CONDITION_NONE) {
+            entry->handler = thorium_route_handler(&route->route);
+        }
+    }
+}
 
-    if (handler_with_condition != NULL) {
-        return handler_with_condition;
+/*
+ * Find the slot of a tag.
+ *
+ * While counting the routes, the slot is claimed if the tag is not
+ * there. A claimed slot is not empty once its routes are counted.
+ */
+static struct thorium_dispatcher_entry *thorium_dispatcher_find(struct thorium_dispatcher *self,
+                int tag, int claim)
+{
+    struct thorium_dispatcher_entry *entry;
+    uint32_t index;
+
+    index = ((uint32_t)tag * 2654435761u) >> self->shift;
+
+    while (1) {
+        entry = self->entries + index;
+
+        if (entry->route_count == 0) {
+
+            if (!claim) {
+                return NULL;
+            }
+
+            entry->tag = tag;
+            return entry;
+        }
+
+        if (entry->tag == tag) {
+            return entry;
+        }
+
+        index = (index + 1) & self->mask;
     }
+}
 
-    if (handler_without_condition != NULL) {
-        return handler_without_condition;
+static void thorium_dispatcher_free_table(struct thorium_dispatcher *self)
+{
+    if (self->entries != NULL) {
+        core_memory_free(self->entries, MEMORY_DISPATCHER_KEY);
+        self->entries = NULL;
     }
 
-    return NULL;
+    if (self->compiled_routes != NULL) {
+        core_memory_free(self->compiled_routes, MEMORY_DISPATCHER_KEY);
+        self->compiled_routes = NULL;
+    }
+
+    self->compiled = 0;
 }
 
 void thorium_dispatcher_print(struct thorium_dispatcher *self)
@@ -3,8 +3,34 @@
 #define THORIUM_DISPATCHER_H
 
 #include "script.h"
+#include "route.h"
 
-#include <core/structures/map.h>
+#include <core/structures/vector.h>
+
+/*
+ * A registered route.
+ */
+struct thorium_dispatcher_route {
+    int tag;
+    int source;
+    struct thorium_route route;
+};
+
+/*
+ * A tag in the compiled dispatch table.
+ *
+ * handler is set when the tag has only one route, for any source
+ * and without condition, which is the common case. Otherwise, the
+ * routes of the tag are in a short list that starts at first_route.
+ *
+ * A slot without routes is empty.
+ */
+struct thorium_dispatcher_entry {
+    int tag;
+    int first_route;
+    int route_count;
+    thorium_actor_receive_fn_t handler;
+};
 
 /*
  * A message dispatcher.
@@ -15,9 +41,18 @@
  * Check source
  * return handler
  *
+ * Routes are registered in a list. On the first dispatch after a
+ * registration, they are compiled into a flat open-addressed table
+ * indexed by tag, so that a lookup usually reads only one entry.
  */
 struct thorium_dispatcher {
-    struct core_map routes;
+    struct core_vector routes;
+
+    int compiled;
+    int shift;
+    int mask;
+    struct thorium_dispatcher_entry *entries;
+    struct thorium_dispatcher_route *compiled_routes;
 };
 
 void thorium_dispatcher_init(struct thorium_dispatcher *self);
@@ -28,6 +63,11 @@ void thorium_dispatcher_add_action(struct thorium_dispatcher *self, int tag, tho
 
 int thorium_dispatcher_dispatch(struct thorium_dispatcher *self, struct thorium_actor *actor,
                 struct thorium_message *message);
+
+/*
+ * \return the handler for a tag and a source, or for the tag and
+ * THORIUM_ACTOR_ANYBODY if the source has no route
+ */
 thorium_actor_receive_fn_t thorium_dispatcher_get(struct thorium_dispatcher *self, int tag, int source);
 
 void thorium_dispatcher_print(struct thorium_dispatcher *self);
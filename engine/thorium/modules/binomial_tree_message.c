@@ -78,12 +78,14 @@ void thorium_actor_receive_binomial_tree_send(struct thorium_actor *actor, struc
         CORE_DEBUGGER_LEAK_DETECTION_BEGIN(ephemeral_memory, send_range);
         thorium_actor_pack_proxy_message(actor, &new_message,
                         real_source);
-        thorium_actor_send_range_loop(actor, &actors, 0, core_vector_size(&actors) - 1, &new_message);
 
         /*
-         * Free the buffer for the proxy message.
+         * Sending replaces the buffer of the message with an outbound
+         * copy, so keep the buffer for the proxy message to free it.
          */
         new_buffer = thorium_message_buffer(&new_message);
+        thorium_actor_send_range_loop(actor, &actors, 0, core_vector_size(&actors) - 1, &new_message);
+
         core_memory_pool_free(ephemeral_memory, new_buffer);
 
         CORE_DEBUGGER_LEAK_DETECTION_END(ephemeral_memory, send_range);
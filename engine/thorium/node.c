@@ -13,6 +13,7 @@
 #include <core/structures/map_iterator.h>
 #include <core/structures/vector_iterator.h>
 #include <core/structures/set_iterator.h>
+#include <core/structures/lock_free_stack.h>
 
 #include <core/helpers/vector_helper.h>
 #include <core/helpers/bitmap.h>
@@ -30,6 +31,7 @@
 #include <unistd.h>
 
 #include <inttypes.h>
+#include <limits.h>
 
 #if 1
 #undef CORE_DEBUGGER_JITTER_DETECTION_START
@@ -49,10 +51,6 @@
 */
 #define THORIUM_NODE_REUSE_DEAD_INDICES
 
-/*
-#define USE_RANDOM_ACTOR_NAMES
-*/
-
 /* debugging options */
 /*
 #define THORIUM_NODE_DEBUG
@@ -64,7 +62,6 @@
 */
 
 /*
-#define THORIUM_NODE_SIMPLE_INITIAL_ACTOR_NAMES
 #define THORIUM_NODE_DEBUG_SPAWN
 
 #define THORIUM_NODE_DEBUG_ACTOR_COUNTERS
@@ -90,6 +87,13 @@
 #define FLAG_EXAMINE                    9
 #define FLAG_ENABLE_ACTOR_LOAD_PROFILES 10
 #define FLAG_MULTIPLEXER_IS_DISABLED    11
+
+/*
+ * Maximum number of send requests tested in one call to
+ * thorium_node_test_requests.
+ */
+#define THORIUM_NODE_MAXIMUM_TESTED_REQUESTS 64
+
 struct thorium_node *thorium_node_global_self;
 
 void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
@@ -100,6 +104,7 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
     char *required_threads;
     int detected;
     int actor_capacity;
+    int actor_local_bits;
     int processor;
 
     core_timer_init(&node->timer);
@@ -146,10 +151,6 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
     node->last_report_time = 0;
     node->last_auto_scaling = node->start_time;
 
-#ifdef THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES
-    node->current_actor_name = THORIUM_ACTOR_NOBODY;
-#endif
-
     /*
      * Build memory pools
      */
@@ -161,6 +162,7 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
                     CORE_MEMORY_POOL_MESSAGE_BUFFER_BLOCK_SIZE, MEMORY_POOL_NAME_NODE_INBOUND);
     core_memory_pool_enable_normalization(&node->inbound_message_memory_pool);
     core_memory_pool_enable_alignment(&node->inbound_message_memory_pool);
+    core_memory_pool_enable_slab_mode(&node->inbound_message_memory_pool);
 
 #ifdef CORE_MEMORY_POOL_DISABLE_MESSAGE_BUFFER_POOL
     core_memory_pool_disable(&node->inbound_message_memory_pool);
@@ -171,6 +173,7 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
 
     core_memory_pool_enable_normalization(&node->outbound_message_memory_pool);
     core_memory_pool_enable_alignment(&node->outbound_message_memory_pool);
+    core_memory_pool_enable_slab_mode(&node->outbound_message_memory_pool);
 
 #ifdef CORE_MEMORY_POOL_DISABLE_MESSAGE_BUFFER_POOL
     core_memory_pool_disable(&node->outbound_message_memory_pool);
@@ -352,10 +355,54 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
 
     thorium_worker_pool_init(&node->worker_pool, workers, node);
 
-    actor_capacity = 131072;
+    actor_capacity = THORIUM_NODE_ACTOR_CAPACITY;
     node->dead_actors = 0;
     node->alive_actors = 0;
 
+    /*
+     * Actor names are positive integers, so the index and the generation
+     * share the bits that are not used by the node. The index gets enough
+     * bits for the capacity, unless this leaves less than
+     * THORIUM_NODE_ACTOR_GENERATION_BITS bits for the generation. Then,
+     * the capacity is lowered (down to THORIUM_NODE_MINIMUM_ACTOR_INDEX_BITS)
+     * so that large jobs still start.
+     */
+    actor_local_bits = thorium_node_get_actor_local_bits(node);
+
+    if (actor_local_bits < 2) {
+        printf("Error: too many nodes (%d), actor names do not fit in an int\n",
+                        node->nodes);
+        exit(1);
+    }
+
+    node->actor_index_bits = 0;
+
+    while ((1 << node->actor_index_bits) < actor_capacity) {
+        ++node->actor_index_bits;
+    }
+
+    if (node->actor_index_bits > actor_local_bits - THORIUM_NODE_ACTOR_GENERATION_BITS) {
+        node->actor_index_bits = actor_local_bits - THORIUM_NODE_ACTOR_GENERATION_BITS;
+
+        if (node->actor_index_bits < THORIUM_NODE_MINIMUM_ACTOR_INDEX_BITS) {
+            node->actor_index_bits = THORIUM_NODE_MINIMUM_ACTOR_INDEX_BITS;
+        }
+    }
+
+    /*
+     * At least 1 bit is left for the generation.
+     */
+    if (node->actor_index_bits > actor_local_bits - 1) {
+        node->actor_index_bits = actor_local_bits - 1;
+    }
+
+    if (actor_capacity > (1 << node->actor_index_bits)) {
+        actor_capacity = 1 << node->actor_index_bits;
+    }
+
+    node->actor_index_mask = (1 << node->actor_index_bits) - 1;
+    node->maximum_actor_generation = (1 << (actor_local_bits - node->actor_index_bits)) - 1;
+
     core_vector_init(&node->actors, sizeof(struct thorium_actor));
 
     /* it is necessary to reserve because work units will point
@@ -363,10 +410,8 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
      */
     core_vector_reserve(&node->actors, actor_capacity);
 
-    /*
-     * Multiply by 2 to avoid resizing
-     */
-    core_map_init_with_capacity(&node->actor_names, sizeof(int), sizeof(int), actor_capacity * 2);
+    core_vector_init(&node->actor_generations, sizeof(int));
+    core_vector_reserve(&node->actor_generations, actor_capacity);
 
     core_vector_init(&node->initial_actors, sizeof(int));
 
@@ -408,7 +453,7 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
 #endif
     }
 
-    thorium_multiplexer_policy_init(&node->multiplexer_policy);
+    thorium_multiplexer_policy_init(&node->multiplexer_policy, node->argc, node->argv);
     thorium_message_multiplexer_init(&node->multiplexer, node,
                     &node->multiplexer_policy);
 
@@ -459,7 +504,7 @@ void thorium_node_destroy(struct thorium_node *node)
 
     core_set_destroy(&node->auto_scaling_actors);
 
-    core_map_destroy(&node->actor_names);
+    core_vector_destroy(&node->actor_generations);
 
     /*printf("BEFORE DESTROY\n");*/
     core_vector_destroy(&node->initial_actors);
@@ -658,7 +703,6 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
 {
     struct thorium_actor *actor;
     int name;
-    int *bucket;
     int index;
 
     /* can not spawn any more actor
@@ -677,10 +721,7 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
     index = thorium_node_allocate_actor_index(node);
     actor = (struct thorium_actor *)core_vector_at(&node->actors, index);
 
-    /* actors have random names to enforce
-     * the acquaintance paradigm
-     */
-    name = thorium_node_generate_name(node);
+    name = thorium_node_generate_name(node, index);
 
     thorium_actor_init(actor, state, script, name, node);
 
@@ -688,20 +729,14 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
         thorium_actor_enable_profiler(actor);
     }
 
-    /* register the actor name
-     */
-    bucket = core_map_add(&node->actor_names, &name);
-    *bucket = index;
-
     /*
-     * Make the name visible to all threads
+     * Make the actor visible to all threads
      */
 
     core_memory_fence();
 
 #ifdef THORIUM_NODE_DEBUG_SPAWN
-    printf("DEBUG added Actor %d, index is %d, bucket: %p\n", name, index,
-                    (void *)bucket);
+    printf("DEBUG added Actor %d, index is %d\n", name, index);
 #endif
 
     node->alive_actors++;
@@ -709,9 +744,29 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
     return name;
 }
 
+/*
+ * \return the number of bits b such that every local name below 2^b
+ * gives an actor name (node + nodes * local name) that fits in an int.
+ */
+int thorium_node_get_actor_local_bits(struct thorium_node *node)
+{
+    int64_t maximum_local_name;
+    int bits;
+
+    maximum_local_name = ((int64_t)INT_MAX - node->name) / node->nodes;
+    bits = 0;
+
+    while (((int64_t)1 << (bits + 1)) - 1 <= maximum_local_name) {
+        ++bits;
+    }
+
+    return bits;
+}
+
 int thorium_node_allocate_actor_index(struct thorium_node *node)
 {
     int index;
+    int generation;
 
 #ifdef THORIUM_NODE_REUSE_DEAD_INDICES
     if (core_queue_dequeue(&node->dead_indices, &index)) {
@@ -727,73 +782,28 @@ int thorium_node_allocate_actor_index(struct thorium_node *node)
 #endif
 
     index = (int)core_vector_size(&node->actors);
+    generation = THORIUM_NODE_FIRST_ACTOR_GENERATION;
+    core_vector_push_back(&node->actor_generations, &generation);
     core_vector_resize(&node->actors, core_vector_size(&node->actors) + 1);
 
     return index;
 }
 
-int thorium_node_generate_name(struct thorium_node *node)
+int thorium_node_generate_name(struct thorium_node *node, int index)
 {
-    int minimal_value;
-    int maximum_value;
+    int generation;
     int name;
-    struct thorium_actor *actor;
-    int node_name;
-    int difference;
-    int nodes;
-
-#ifdef THORIUM_NODE_DEBUG
-    printf("DEBUG thorium_node_generate_name\n");
-#endif
-
-#ifdef THORIUM_NODE_SIMPLE_INITIAL_ACTOR_NAMES
-    if (thorium_node_actors(node) == 0) {
-        return thorium_node_name(node);
-    }
-#endif
-
-    node_name = thorium_node_name(node);
-    actor = NULL;
-    name = THORIUM_ACTOR_NOBODY;
-
-    /* reserve  the first numbers
-     */
-    minimal_value = 4 * thorium_node_nodes(node) + thorium_node_name(node) + 1000000;
-    maximum_value = 2000000000;
-
-#ifdef THORIUM_NODE_DEBUG
-    printf("DEBUG assigning name\n");
-#endif
-
-    nodes = thorium_node_nodes(node);
-
-    /*
-     * Find a name that is not already used.
-     */
-    while (actor != NULL || name < 0) {
-        name = thorium_node_generate_random_name(node, minimal_value, maximum_value);
 
-        difference = node_name - name % node->nodes;
-        /* add the difference */
-        name += difference;
+    generation = *(int *)core_vector_at(&node->actor_generations, index);
 
-        /* disallow names between 0 and nodes - 1
-         */
-        if (name < nodes) {
-            continue;
-        }
-
-        actor = thorium_node_get_actor_from_name(node, name);
-
-        /*printf("DEBUG trying %d... %p\n", name, (void *)actor);*/
-    }
+    name = node->name + node->nodes *
+            ((generation << node->actor_index_bits) | index);
 
 #ifdef THORIUM_NODE_DEBUG_SPAWN
-    printf("DEBUG node %d assigned name %d\n", node->name, name);
+    printf("DEBUG node %d assigned name %d (index %d, generation %d)\n",
+                    node->name, name, index, generation);
 #endif
 
-    /*return node->name + node->nodes * thorium_node_actors(node);*/
-
     return name;
 }
 
@@ -1178,9 +1188,20 @@ void thorium_node_send_to_node(struct thorium_node *node, int destination,
      * this is why the value is count and not new_count
      */
     thorium_message_init(&new_message, tag, count, new_buffer);
-    thorium_message_set_source(&new_message, thorium_node_name(node));
-    thorium_message_set_destination(&new_message, destination);
-    thorium_message_write_metadata(&new_message);
+
+    thorium_node_send_outbound_node_message(node, destination, &new_message);
+}
+
+/*
+ * Send a message with a buffer from the outbound memory pool of the node.
+ * The buffer must have room for the metadata.
+ */
+void thorium_node_send_outbound_node_message(struct thorium_node *node, int destination,
+                struct thorium_message *message)
+{
+    thorium_message_set_source(message, thorium_node_name(node));
+    thorium_message_set_destination(message, destination);
+    thorium_message_write_metadata(message);
 
 #ifdef THORIUM_NODE_DEBUG
     printf("DEBUG thorium_node_send_to_node %d\n", destination);
@@ -1190,9 +1211,9 @@ void thorium_node_send_to_node(struct thorium_node *node, int destination,
      * Mark the message.
      */
 
-    thorium_message_set_type(&new_message, THORIUM_MESSAGE_TYPE_NODE_OUTBOUND);
+    thorium_message_set_type(message, THORIUM_MESSAGE_TYPE_NODE_OUTBOUND);
 
-    thorium_node_send(node, &new_message);
+    thorium_node_send(node, message);
 }
 
 int thorium_node_has_actor(struct thorium_node *self, int name)
@@ -1290,7 +1311,12 @@ void thorium_node_send(struct thorium_node *node, struct thorium_message *messag
 
         if (!thorium_message_multiplexer_multiplex(&node->multiplexer, message)) {
             thorium_node_send_with_transport(node, message);
-        } else {
+
+        /*
+         * In zero-copy mode, the multiplexer gives the buffer back
+         * once it is flushed.
+         */
+        } else if (!thorium_message_multiplexer_is_zero_copy(&node->multiplexer)) {
 
             /*
              * There is now a copy of the buffer.
@@ -1323,10 +1349,6 @@ struct thorium_actor *thorium_node_get_actor_from_name(struct thorium_node *node
     printf("DEBUG thorium_node_get_actor_from_name %d\n", name);
 #endif
 
-    if (name < 0) {
-        return NULL;
-    }
-
     index = thorium_node_actor_index(node, name);
 
     if (index < 0) {
@@ -1358,7 +1380,17 @@ void thorium_node_dispatch_message(struct thorium_node *node, struct thorium_mes
              * Also, this system buffer needs to be freed now anyway because there is no other
              * place where it will have the change to be freed.
              */
-            core_memory_pool_free(&node->inbound_message_memory_pool, buffer);
+            if (thorium_message_worker(message) == THORIUM_MESSAGE_MULTIPLEXER_VIEW_WORKER) {
+                thorium_message_multiplexer_free_view(&node->multiplexer, buffer);
+
+            /*
+             * A node message that this node sent to itself.
+             */
+            } else if (thorium_message_type(message) == THORIUM_MESSAGE_TYPE_NODE_OUTBOUND) {
+                core_memory_pool_free(&node->outbound_message_memory_pool, buffer);
+            } else {
+                core_memory_pool_free(&node->inbound_message_memory_pool, buffer);
+            }
         }
 
         return;
@@ -1427,25 +1459,35 @@ void thorium_node_inject_message_in_worker_pool(struct thorium_node *node, struc
 
 int thorium_node_actor_index(struct thorium_node *node, int name)
 {
-    int *bucket;
+    int local_name;
     int index;
+    int generation;
 
-#ifdef THORIUM_NODE_DEBUG
-    printf("DEBUG calling core_map with pointer to %d, entries %d\n",
-                    name, (int)core_map_table_size(&node->actor_names));
-#endif
+    /*
+     * Node names and special names (THORIUM_ACTOR_NOBODY, ...)
+     * are not actor names.
+     */
+    if (name < node->nodes || name % node->nodes != node->name) {
+        return -1;
+    }
 
-    bucket = core_map_get(&node->actor_names, &name);
+    local_name = name / node->nodes;
+    index = local_name & node->actor_index_mask;
+    generation = local_name >> node->actor_index_bits;
+
+    /*
+     * The slot is either not allocated yet, or it was used by
+     * another actor since the name was given.
+     */
+    if (index >= (int)core_vector_size(&node->actor_generations)
+                    || *(int *)core_vector_at(&node->actor_generations, index) != generation) {
 
 #ifdef THORIUM_NODE_DEBUG
-    printf("DEBUG thorium_node_actor_index %d %p\n", name, (void *)bucket);
+        printf("DEBUG thorium_node_actor_index %d is stale\n", name);
 #endif
-
-    if (bucket == NULL) {
         return -1;
     }
 
-    index = *bucket;
     return index;
 }
 
@@ -1469,9 +1511,8 @@ void thorium_node_notify_death(struct thorium_node *node, struct thorium_actor *
     void *state;
     int name;
 
-#ifdef THORIUM_NODE_REUSE_DEAD_INDICES
     int index;
-#endif
+    int *generation;
 
     /* int name; */
     /*int index;*/
@@ -1494,14 +1535,11 @@ void thorium_node_notify_death(struct thorium_node *node, struct thorium_actor *
                     thorium_actor_script(actor));
 #endif
 
-#ifdef THORIUM_NODE_REUSE_DEAD_INDICES
     index = thorium_node_actor_index(node, name);
 
 #ifdef THORIUM_NODE_DEBUG_SPAWN
-    printf("DEBUG node/%d THORIUM_NODE_REUSE_DEAD_INDICES push index %d\n",
-                   thorium_node_name(node), index);
-#endif
-
+    printf("DEBUG node/%d actor/%d has index %d\n",
+                   thorium_node_name(node), name, index);
 #endif
 
     state = thorium_actor_concrete_actor(actor);
@@ -1530,12 +1568,16 @@ void thorium_node_notify_death(struct thorium_node *node, struct thorium_actor *
     core_memory_pool_free(&node->actor_memory_pool, state);
     state = NULL;
 
-    /* remove the name from the registry */
-    /* maybe a lock is needed for this
-     * because spawn also access this attribute
+    /* retire the name: the next actor in this slot
+     * gets the next generation
      */
+    generation = core_vector_at(&node->actor_generations, index);
 
-    core_map_delete(&node->actor_names, &name);
+    if (*generation == node->maximum_actor_generation) {
+        *generation = THORIUM_NODE_FIRST_ACTOR_GENERATION;
+    } else {
+        ++*generation;
+    }
 
     /*
      * Make this change visible
@@ -1656,6 +1698,18 @@ struct thorium_script *thorium_node_find_script(struct thorium_node *node, int i
 #ifdef THORIUM_NODE_USE_COUNTERS
 void thorium_node_print_counters(struct thorium_node *node)
 {
+    int i;
+    struct thorium_worker *worker;
+
+    /*
+     * Add the messages that workers delivered directly.
+     */
+    for (i = 0; i < thorium_worker_pool_worker_count(&node->worker_pool); ++i) {
+        worker = thorium_worker_pool_get_worker(&node->worker_pool, i);
+        core_counter_merge(&node->counter, thorium_worker_counter(worker));
+        core_counter_reset(thorium_worker_counter(worker));
+    }
+
     printf("----------------------------------------------\n");
     printf("thorium_node: counters for node/%d\n",
                     thorium_node_name(node));
@@ -1810,6 +1864,11 @@ struct thorium_worker_pool *thorium_node_get_worker_pool(struct thorium_node *se
     return &self->worker_pool;
 }
 
+struct thorium_transport *thorium_node_get_transport(struct thorium_node *self)
+{
+    return &self->transport;
+}
+
 void thorium_node_toggle_debug_mode(struct thorium_node *self)
 {
     if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_DEBUG)) {
@@ -1822,19 +1881,25 @@ void thorium_node_toggle_debug_mode(struct thorium_node *self)
 
 void thorium_node_reset_actor_counters(struct thorium_node *node)
 {
-    struct core_map_iterator iterator;
-    int *name;
+    int i;
+    int size;
     struct thorium_actor *actor;
 
-    core_map_iterator_init(&iterator, &node->actor_names);
+    size = core_vector_size(&node->actors);
 
-    while (core_map_iterator_next(&iterator, (void **)&name, NULL)) {
+    for (i = 0; i < size; ++i) {
 
-        actor = thorium_node_get_actor_from_name(node, *name);
+        actor = core_vector_at(&node->actors, i);
+
+        /*
+         * Skip dead actors.
+         */
+        if (thorium_node_get_actor_from_name(node, thorium_actor_name(actor)) != actor) {
+            continue;
+        }
 
         thorium_actor_reset_counters(actor);
     }
-    core_map_iterator_destroy(&iterator);
 }
 
 int64_t thorium_node_get_counter(struct thorium_node *node, int counter)
@@ -1848,16 +1913,17 @@ int64_t thorium_node_get_counter(struct thorium_node *node, int counter)
 
 int thorium_node_send_system(struct thorium_node *node, struct thorium_message *message)
 {
-    int destination;
     int tag;
     int source;
 
+    if (!thorium_node_is_system_message(message)) {
+        return 0;
+    }
+
     tag = thorium_message_action(message);
-    destination = thorium_message_destination(message);
     source = thorium_message_source(message);
 
-    if (source == destination
-            && tag == ACTION_ENABLE_AUTO_SCALING) {
+    if (tag == ACTION_ENABLE_AUTO_SCALING) {
 
         printf("AUTO-SCALING node/%d enables auto-scaling for actor %d (ACTION_ENABLE_AUTO_SCALING)\n",
                        thorium_node_name(node),
@@ -1869,21 +1935,34 @@ int thorium_node_send_system(struct thorium_node *node, struct thorium_message *
 
         core_lock_unlock(&node->auto_scaling_lock);
 
-        return 1;
-
-    } else if (source == destination
-           && tag == ACTION_DISABLE_AUTO_SCALING) {
+    } else if (tag == ACTION_DISABLE_AUTO_SCALING) {
 
         core_lock_lock(&node->auto_scaling_lock);
 
         core_set_delete(&node->auto_scaling_actors, &source);
 
         core_lock_unlock(&node->auto_scaling_lock);
+    }
 
-        return 1;
+    return 1;
+}
+
+/*
+ * System messages are handled by thorium_node_send_system.
+ * This is also called by workers, which leave these messages to the node.
+ */
+int thorium_node_is_system_message(struct thorium_message *message)
+{
+    int tag;
+
+    tag = thorium_message_action(message);
+
+    if (thorium_message_source(message) != thorium_message_destination(message)) {
+        return 0;
     }
 
-    return 0;
+    return tag == ACTION_ENABLE_AUTO_SCALING
+            || tag == ACTION_DISABLE_AUTO_SCALING;
 }
 
 
@@ -2067,7 +2146,12 @@ void thorium_node_run_loop(struct thorium_node *node)
 
             if (!thorium_message_multiplexer_demultiplex(&node->multiplexer, &message)) {
                 thorium_node_dispatch_message(node, &message);
-            } else {
+
+            /*
+             * In zero-copy mode, the buffer is freed with its
+             * last view.
+             */
+            } else if (!thorium_message_multiplexer_is_zero_copy(&node->multiplexer)) {
                 /*
                  * Don't leak memory
                  */
@@ -2202,14 +2286,12 @@ void thorium_node_send_message(struct thorium_node *node)
 
 void thorium_node_test_requests(struct thorium_node *node)
 {
+    struct thorium_worker_buffer worker_buffers[THORIUM_NODE_MAXIMUM_TESTED_REQUESTS];
     struct thorium_worker_buffer worker_buffer;
     int requests;
     int requests_to_test;
-    int i;
+    int count;
     int maximum;
-    /*
-    int worker;
-    */
 
     /*
      * Use a half-life approach
@@ -2227,25 +2309,16 @@ void thorium_node_test_requests(struct thorium_node *node)
     /*
      * Make sure the amount is within the bounds.
      */
-    maximum = 64;
+    maximum = THORIUM_NODE_MAXIMUM_TESTED_REQUESTS;
     if (requests_to_test > maximum)
         requests_to_test = maximum;
 
-    /* Test active buffer requests
+    /* Test active buffer requests in one batch and give the buffers
+     * back to their owners.
      */
-    i = 0;
-    while (i < requests_to_test) {
-        if (thorium_transport_test(&node->transport, &worker_buffer)) {
+    count = thorium_transport_test_some(&node->transport, worker_buffers, requests_to_test);
 
-#if 0
-            worker = thorium_worker_buffer_get_worker(&worker_buffer);
-#endif
-
-            thorium_node_inject_outbound_buffer(node, &worker_buffer);
-        }
-
-        ++i;
-    }
+    thorium_node_inject_outbound_buffers(node, worker_buffers, count);
 
 #ifdef THORIUM_NODE_INJECT_CLEAN_WORKER_BUFFERS
     /* Check if there are queued buffers to give to workers
@@ -2355,11 +2428,18 @@ void thorium_node_recycle_message(struct thorium_node *self, struct thorium_mess
 
     CORE_DEBUGGER_ASSERT(buffer != NULL);
 
+    /*
+     * This is a view into a multiplexed buffer.
+     */
+    if (worker_name == THORIUM_MESSAGE_MULTIPLEXER_VIEW_WORKER) {
+
+        thorium_message_multiplexer_free_view(&self->multiplexer, buffer);
+
     /*
      * Otherwise, free the buffer here directly since this is a Thorium core
      * buffer for startup.
      */
-    if (worker_name < 0) {
+    } else if (worker_name < 0) {
 
         core_memory_pool_free(&self->inbound_message_memory_pool, buffer);
 #ifdef THORIUM_NODE_DEBUG_INJECTION
@@ -2416,49 +2496,6 @@ void thorium_node_resolve(struct thorium_node *self, struct thorium_message *mes
     thorium_message_set_destination_node(message, node_name);
 }
 
-int thorium_node_generate_random_name(struct thorium_node *self,
-                int minimal_value, int maximum_value)
-{
-#if defined(THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES)
-
-    int name;
-    int stride;
-
-    if (self->current_actor_name < minimal_value
-                    || self->current_actor_name > maximum_value
-                    || self->current_actor_name == THORIUM_ACTOR_NOBODY) {
-
-        self->current_actor_name = minimal_value;
-    }
-
-    stride = thorium_node_nodes(self);
-
-    name = self->current_actor_name;
-    self->current_actor_name += stride;
-
-    return name;
-
-#elif defined(USE_RANDOM_ACTOR_NAMES)
-    /*
-     * On BGQ, RAND_MAX is:
-     *
-     * > [harms@vestalac1 ~]$ echo -e "#include <stdlib.h>\nunsigned long long
-     * > rand_max = RAND_MAX;" | powerpc64-bgq-linux-gcc -E - | tail -1
-     * > unsigned long long rand_max = 2147483647;Q
-     *
-     * (thanks to Harms, Kevin N. at ALCF)
-     */
-    int name;
-    int range;
-
-    range = maximum_value - minimal_value;
-    name = rand() % range + minimal_value;
-    return name;
-
-
-#endif
-}
-
 void thorium_node_send_with_transport(struct thorium_node *self, struct thorium_message *message)
 {
     thorium_transport_send(&self->transport, message);
@@ -2475,6 +2512,11 @@ struct core_memory_pool *thorium_node_inbound_memory_pool(struct thorium_node *s
     return &self->inbound_message_memory_pool;
 }
 
+struct core_memory_pool *thorium_node_outbound_memory_pool(struct thorium_node *self)
+{
+    return &self->outbound_message_memory_pool;
+}
+
 void thorium_node_examine(struct thorium_node *self)
 {
     printf("DEBUG_NODE Name= %d WorkerCount= %d\n",
@@ -2492,6 +2534,71 @@ void thorium_node_examine(struct thorium_node *self)
     thorium_worker_pool_examine(&self->worker_pool);
 }
 
+/*
+ * The buffers of each worker are linked together and returned
+ * to the worker with one atomic operation.
+ */
+void thorium_node_inject_outbound_buffers(struct thorium_node *self, struct thorium_worker_buffer *worker_buffers,
+                int count)
+{
+    int i;
+    int j;
+    int worker_name;
+    void *first;
+    void *last;
+    void *buffer;
+    struct thorium_worker *worker;
+
+    for (i = 0; i < count; ++i) {
+
+        worker_name = thorium_worker_buffer_get_worker(worker_buffers + i);
+        first = thorium_worker_buffer_get_buffer(worker_buffers + i);
+
+        /*
+         * Already returned with the buffers of an earlier entry.
+         */
+        if (first == NULL) {
+            continue;
+        }
+
+        if (worker_name < 0) {
+            thorium_node_inject_outbound_buffer(self, worker_buffers + i);
+            continue;
+        }
+
+        last = first;
+
+        for (j = i + 1; j < count; ++j) {
+
+            buffer = thorium_worker_buffer_get_buffer(worker_buffers + j);
+
+            if (buffer == NULL
+                            || thorium_worker_buffer_get_worker(worker_buffers + j) != worker_name) {
+                continue;
+            }
+
+            core_lock_free_stack_set_next(last, buffer);
+            last = buffer;
+
+            thorium_worker_buffer_init(worker_buffers + j, worker_name, NULL);
+
+#ifdef THORIUM_NODE_DEBUG_INJECTION
+            ++self->counter_injected_transport_outbound_buffer_for_workers;
+#endif
+        }
+
+        worker = thorium_worker_pool_get_worker(&self->worker_pool, worker_name);
+
+        CORE_DEBUGGER_ASSERT(worker != NULL);
+
+        thorium_worker_return_outbound_buffers(worker, first, last);
+
+#ifdef THORIUM_NODE_DEBUG_INJECTION
+        ++self->counter_injected_transport_outbound_buffer_for_workers;
+#endif
+    }
+}
+
 void thorium_node_inject_outbound_buffer(struct thorium_node *self, struct thorium_worker_buffer *worker_buffer)
 {
     int worker;
@@ -32,9 +32,28 @@
 #define ACTION_THORIUM_NODE_START 0x0000082c
 
 /*
- * Use deterministic actor names.
+ * Actor names.
+ *
+ * The name of an actor encodes the node, the slot of the actor in
+ * the node and the generation of that slot:
+ *
+ *   name = node + nodes * ((generation << index bits) | index)
+ *
+ * so thorium_node_actor_node is a modulo and resolving a local name
+ * is a division, a shift, a mask and a generation check. The generation
+ * of a slot is incremented when its actor dies, so messages sent
+ * to a dead actor are rejected even if the slot is used again.
+ */
+#define THORIUM_NODE_FIRST_ACTOR_GENERATION 1
+
+/*
+ * Actors per node, and the bits wanted for the generation. With many
+ * nodes, the capacity is lowered to keep these bits, but the index
+ * keeps at least THORIUM_NODE_MINIMUM_ACTOR_INDEX_BITS bits.
  */
-#define THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES
+#define THORIUM_NODE_ACTOR_CAPACITY 131072
+#define THORIUM_NODE_ACTOR_GENERATION_BITS 4
+#define THORIUM_NODE_MINIMUM_ACTOR_INDEX_BITS 10
 
 /*
  * Thorium product branding.
@@ -91,7 +110,7 @@ struct thorium_node {
     struct core_vector actors;
     struct core_set auto_scaling_actors;
     struct thorium_worker_pool worker_pool;
-    struct core_map actor_names;
+    struct core_vector actor_generations;
     struct core_vector initial_actors;
     int received_initial_actors;
     int ready;
@@ -210,9 +229,9 @@ struct thorium_node {
     time_t last_auto_scaling;
     time_t last_transport_event_time;
 
-#ifdef THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES
-    int current_actor_name;
-#endif
+    int actor_index_bits;
+    int actor_index_mask;
+    int maximum_actor_generation;
 
 #ifdef THORIUM_NODE_DEBUG_INJECTION
     int counter_allocated_node_inbound_buffers;
@@ -239,7 +258,7 @@ int thorium_node_spawn(struct thorium_node *self, int script);
 void thorium_node_send(struct thorium_node *self, struct thorium_message *message);
 void thorium_node_send_with_transport(struct thorium_node *self, struct thorium_message *message);
 
-int thorium_node_generate_name(struct thorium_node *self);
+int thorium_node_generate_name(struct thorium_node *self, int index);
 
 int thorium_node_actor_node(struct thorium_node *self, int name);
 int thorium_node_actor_index(struct thorium_node *self, int name);
@@ -278,10 +297,13 @@ int thorium_node_has_script(struct thorium_node *self, struct thorium_script *sc
 void thorium_node_send_to_node(struct thorium_node *self, int destination,
                 struct thorium_message *message);
 void thorium_node_send_to_node_empty(struct thorium_node *self, int destination, int tag);
+void thorium_node_send_outbound_node_message(struct thorium_node *self, int destination,
+                struct thorium_message *message);
 int thorium_node_receive_system(struct thorium_node *self, struct thorium_message *message);
 void thorium_node_dispatch_message(struct thorium_node *self, struct thorium_message *message);
 void thorium_node_set_initial_actor(struct thorium_node *self, int node_name, int actor);
 int thorium_node_allocate_actor_index(struct thorium_node *self);
+int thorium_node_get_actor_local_bits(struct thorium_node *self);
 
 #ifdef THORIUM_NODE_USE_COUNTERS
 void thorium_node_print_event_counters(struct thorium_node *self);
@@ -295,6 +317,7 @@ void thorium_node_print_structure(struct thorium_node *self, struct thorium_acto
 int thorium_node_has_actor(struct thorium_node *self, int name);
 
 struct thorium_worker_pool *thorium_node_get_worker_pool(struct thorium_node *self);
+struct thorium_transport *thorium_node_get_transport(struct thorium_node *self);
 
 void thorium_node_toggle_debug_mode(struct thorium_node *self);
 
@@ -309,6 +332,7 @@ void thorium_node_free_worker_buffer(struct thorium_node *self,
 void thorium_node_send_to_actor(struct thorium_node *self, int name, struct thorium_message *message);
 void thorium_node_check_efficiency(struct thorium_node *self);
 int thorium_node_send_system(struct thorium_node *self, struct thorium_message *message);
+int thorium_node_is_system_message(struct thorium_message *message);
 
 void thorium_node_do_message_triage(struct thorium_node *self);
 void thorium_node_recycle_message(struct thorium_node *self, struct thorium_message *message);
@@ -316,15 +340,12 @@ void thorium_node_recycle_message(struct thorium_node *self, struct thorium_mess
 void thorium_node_prepare_received_message(struct thorium_node *self, struct thorium_message *message);
 void thorium_node_resolve(struct thorium_node *self, struct thorium_message *message);
 
-/*
- * Generate an actor name.
- */
-int thorium_node_generate_random_name(struct thorium_node *self,
-                int minimal_value, int maximum_value);
-
 struct core_memory_pool *thorium_node_inbound_memory_pool(struct thorium_node *self);
+struct core_memory_pool *thorium_node_outbound_memory_pool(struct thorium_node *self);
 
 void thorium_node_examine(struct thorium_node *self);
 void thorium_node_inject_outbound_buffer(struct thorium_node *self, struct thorium_worker_buffer *worker_buffer);
+void thorium_node_inject_outbound_buffers(struct thorium_node *self, struct thorium_worker_buffer *worker_buffers,
+                int count);
 
 #endif
@@ -661,6 +661,7 @@ void thorium_balancer_migrate(struct thorium_balancer *self, struct thorium_migr
      * new worker
      */
     core_map_update_value(&self->actor_affinities, &actor_name, &new_worker);
+    thorium_actor_set_assigned_worker(actor, new_worker);
 
 #ifdef THORIUM_WORKER_POOL_DEBUG_MIGRATION
     printf("ROUTE actor %d ->  worker %d\n", actor_name, new_worker);
@@ -3,6 +3,7 @@
 
 #include "cfs_scheduler.h"
 #include "fifo_scheduler.h"
+#include "work_stealing_scheduler.h"
 
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
@@ -14,12 +15,18 @@
  *
  * - THORIUM_CFS_SCHEDULER
  * - THORIUM_FIFO_SCHEDULER
+ * - THORIUM_WORK_STEALING_SCHEDULER (with -enable-work-stealing)
  */
 #define THORIUM_DEFAULT_SCHEDULER THORIUM_CFS_SCHEDULER
 
-void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker)
+void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker, int type)
 {
-    self->scheduler = THORIUM_DEFAULT_SCHEDULER;
+    self->scheduler = type;
+
+    if (self->scheduler == THORIUM_SCHEDULER_DEFAULT) {
+        self->scheduler = THORIUM_DEFAULT_SCHEDULER;
+    }
+
     self->node = node;
     self->worker = worker;
 
@@ -33,6 +40,8 @@ void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker
         self->implementation = &thorium_fifo_scheduler_implementation;
     } else if (self->scheduler == thorium_cfs_scheduler_implementation.identifier) {
         self->implementation = &thorium_cfs_scheduler_implementation;
+    } else if (self->scheduler == thorium_work_stealing_scheduler_implementation.identifier) {
+        self->implementation = &thorium_work_stealing_scheduler_implementation;
     }
 
     CORE_DEBUGGER_ASSERT(self->implementation != NULL);
@@ -67,6 +76,21 @@ int thorium_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_act
     return self->implementation->dequeue(self, actor);
 }
 
+int thorium_scheduler_supports_stealing(struct thorium_scheduler *self)
+{
+    return self->implementation->steal != NULL;
+}
+
+int thorium_scheduler_steal(struct thorium_scheduler *self, struct thorium_scheduler *victim,
+                struct thorium_actor **actor)
+{
+    if (self->implementation->steal == NULL) {
+        return 0;
+    }
+
+    return self->implementation->steal(self, victim, actor);
+}
+
 int thorium_scheduler_size(struct thorium_scheduler *self)
 {
     return self->implementation->size(self);
@@ -28,12 +28,21 @@ struct thorium_scheduler {
     int worker;
 };
 
-void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker);
+/*
+ * Use the default scheduler.
+ */
+#define THORIUM_SCHEDULER_DEFAULT (-1)
+
+void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker, int type);
 void thorium_scheduler_destroy(struct thorium_scheduler *self);
 
 int thorium_scheduler_enqueue(struct thorium_scheduler *self, struct thorium_actor *actor);
 int thorium_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_actor **actor);
 
+int thorium_scheduler_supports_stealing(struct thorium_scheduler *self);
+int thorium_scheduler_steal(struct thorium_scheduler *self, struct thorium_scheduler *victim,
+                struct thorium_actor **actor);
+
 int thorium_scheduler_size(struct thorium_scheduler *self);
 
 void thorium_scheduler_print(struct thorium_scheduler *self);
@@ -16,6 +16,13 @@ struct thorium_scheduler_interface {
     void (*destroy)(struct thorium_scheduler *self);
     int (*enqueue)(struct thorium_scheduler *self, struct thorium_actor *actor);
     int (*dequeue)(struct thorium_scheduler *self, struct thorium_actor **actor);
+
+    /*
+     * steal is optional. It takes an actor from the scheduler of
+     * another worker of the same node.
+     */
+    int (*steal)(struct thorium_scheduler *self, struct thorium_scheduler *victim,
+                    struct thorium_actor **actor);
     int (*size)(struct thorium_scheduler *self);
     void (*print)(struct thorium_scheduler *self);
 };
@@ -0,0 +1,138 @@
+
+#include "work_stealing_scheduler.h"
+
+#include "scheduler.h"
+
+#include <engine/thorium/actor.h>
+
+#include <core/system/debugger.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+struct thorium_scheduler_interface thorium_work_stealing_scheduler_implementation = {
+    .identifier = THORIUM_WORK_STEALING_SCHEDULER,
+    .name = "work_stealing_scheduler",
+    .object_size = sizeof(struct thorium_work_stealing_scheduler),
+    .init = thorium_work_stealing_scheduler_init,
+    .destroy = thorium_work_stealing_scheduler_destroy,
+    .enqueue = thorium_work_stealing_scheduler_enqueue,
+    .dequeue = thorium_work_stealing_scheduler_dequeue,
+    .steal = thorium_work_stealing_scheduler_steal,
+    .size = thorium_work_stealing_scheduler_size,
+    .print = thorium_work_stealing_scheduler_print
+};
+
+void thorium_work_stealing_scheduler_init(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    core_work_stealing_deque_init(&concrete_self->deque, THORIUM_WORK_STEALING_SCHEDULER_CAPACITY,
+                    sizeof(struct thorium_actor *));
+    core_fast_queue_init(&concrete_self->overflow_queue, sizeof(struct thorium_actor *));
+
+    concrete_self->stolen_actor_count = 0;
+}
+
+void thorium_work_stealing_scheduler_destroy(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    core_work_stealing_deque_destroy(&concrete_self->deque);
+    core_fast_queue_destroy(&concrete_self->overflow_queue);
+}
+
+int thorium_work_stealing_scheduler_enqueue(struct thorium_scheduler *self, struct thorium_actor *actor)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    CORE_DEBUGGER_ASSERT(actor != NULL);
+
+    concrete_self = self->concrete_self;
+
+    /*
+     * Keep the FIFO order if some actors are already in the
+     * overflow queue.
+     */
+    if (core_fast_queue_empty(&concrete_self->overflow_queue)
+                    && core_work_stealing_deque_push(&concrete_self->deque, &actor)) {
+        return 1;
+    }
+
+    return core_fast_queue_enqueue(&concrete_self->overflow_queue, &actor);
+}
+
+int thorium_work_stealing_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_actor **actor)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+    struct thorium_actor *other_actor;
+
+    concrete_self = self->concrete_self;
+
+    /*
+     * Move overflowed actors in the deque so that other workers
+     * can see them.
+     */
+    while (!core_fast_queue_empty(&concrete_self->overflow_queue)
+                    && core_work_stealing_deque_size(&concrete_self->deque)
+                        < core_work_stealing_deque_capacity(&concrete_self->deque)) {
+
+        core_fast_queue_dequeue(&concrete_self->overflow_queue, &other_actor);
+        core_work_stealing_deque_push(&concrete_self->deque, &other_actor);
+    }
+
+    /*
+     * The owner takes actors at the top too. The race with the
+     * thieves is resolved by the deque.
+     */
+    return core_work_stealing_deque_steal(&concrete_self->deque, actor);
+}
+
+int thorium_work_stealing_scheduler_steal(struct thorium_scheduler *self, struct thorium_scheduler *victim,
+                struct thorium_actor **actor)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+    struct thorium_work_stealing_scheduler *concrete_victim;
+
+    CORE_DEBUGGER_ASSERT(victim->implementation == self->implementation);
+
+    concrete_self = self->concrete_self;
+    concrete_victim = victim->concrete_self;
+
+    if (!core_work_stealing_deque_steal(&concrete_victim->deque, actor)) {
+        return 0;
+    }
+
+    ++concrete_self->stolen_actor_count;
+
+    return 1;
+}
+
+int thorium_work_stealing_scheduler_size(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    return core_work_stealing_deque_size(&concrete_self->deque)
+            + core_fast_queue_size(&concrete_self->overflow_queue);
+}
+
+void thorium_work_stealing_scheduler_print(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    printf("node/%d worker/%d work_stealing_scheduler actors: %d (deque: %d, overflow: %d)"
+                    " stolen actors: %" PRIu64 "\n",
+                    self->node, self->worker,
+                    thorium_work_stealing_scheduler_size(self),
+                    core_work_stealing_deque_size(&concrete_self->deque),
+                    core_fast_queue_size(&concrete_self->overflow_queue),
+                    concrete_self->stolen_actor_count);
+}
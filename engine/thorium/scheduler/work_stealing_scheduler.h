@@ -0,0 +1,58 @@
+
+#ifndef THORIUM_WORK_STEALING_SCHEDULER_H
+#define THORIUM_WORK_STEALING_SCHEDULER_H
+
+#include <core/structures/work_stealing_deque.h>
+#include <core/structures/fast_queue.h>
+
+#include <stdint.h>
+
+#define THORIUM_WORK_STEALING_SCHEDULER 3
+
+#define THORIUM_WORK_STEALING_SCHEDULER_CAPACITY 4096
+
+struct thorium_scheduler;
+struct thorium_actor;
+
+/*
+ * A work-stealing scheduler.
+ *
+ * Each worker owns a Chase-Lev deque of runnable actors. The owner
+ * enqueues at the bottom and dequeues at the top, so that actors
+ * are served in FIFO order like with the fifo_scheduler. Idle workers
+ * of the same node steal actors at the top of the deque of busy workers
+ * with thorium_scheduler_steal.
+ *
+ * Actors that don't fit in the deque are kept in a private
+ * overflow queue until there is room.
+ *
+ * Actors that are not in the deque (in the overflow queue, or still in
+ * the actors_to_schedule ring of a worker that is running an actor)
+ * can not be stolen.
+ *
+ * Priorities are not used.
+ *
+ * \see http://supertech.csail.mit.edu/papers/steal.pdf
+ */
+struct thorium_work_stealing_scheduler {
+    struct core_work_stealing_deque deque;
+    struct core_fast_queue overflow_queue;
+
+    uint64_t stolen_actor_count;
+};
+
+extern struct thorium_scheduler_interface thorium_work_stealing_scheduler_implementation;
+
+void thorium_work_stealing_scheduler_init(struct thorium_scheduler *self);
+void thorium_work_stealing_scheduler_destroy(struct thorium_scheduler *self);
+
+int thorium_work_stealing_scheduler_enqueue(struct thorium_scheduler *self, struct thorium_actor *actor);
+int thorium_work_stealing_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_actor **actor);
+int thorium_work_stealing_scheduler_steal(struct thorium_scheduler *self, struct thorium_scheduler *victim,
+                struct thorium_actor **actor);
+
+int thorium_work_stealing_scheduler_size(struct thorium_scheduler *self);
+
+void thorium_work_stealing_scheduler_print(struct thorium_scheduler *self);
+
+#endif
@@ -3,6 +3,7 @@
 #include "multiplexed_buffer.h"
 
 #include <engine/thorium/node.h>
+#include <engine/thorium/worker_buffer.h>
 
 #include <core/helpers/bitmap.h>
 
@@ -10,6 +11,7 @@
 #include <core/system/memory.h>
 
 #include <core/structures/vector.h>
+#include <core/helpers/vector_helper.h>
 #include <core/helpers/set_helper.h>
 #include <core/structures/set_iterator.h>
 
@@ -17,9 +19,30 @@
 
 #define FORCE_NO 0
 #define FORCE_YES_SIZE 1
-#define FORCE_YES_TIME 1
+#define FORCE_YES_TIME 2
+#define FORCE_YES_IDLE 3
 
 #define FLAG_DISABLED 0
+#define FLAG_ZERO_COPY 1
+
+/*
+ * Sizes for the zero-copy layout.
+ */
+#define ZERO_COPY_HEADER_SIZE 8
+#define ZERO_COPY_RECORD_HEADER_SIZE (2 * sizeof(int))
+#define ZERO_COPY_ALIGN(size) (((size) + 7) & ~7)
+
+static void thorium_message_multiplexer_flush_references(struct thorium_message_multiplexer *self,
+                int index, struct thorium_multiplexed_buffer *multiplexed_buffer);
+static void thorium_message_multiplexer_demultiplex_views(struct thorium_message_multiplexer *self,
+                struct thorium_message *message);
+static void thorium_message_multiplexer_release(struct thorium_message_multiplexer *self,
+                char *parent);
+static void thorium_message_multiplexer_observe(struct thorium_message_multiplexer *self,
+                struct thorium_multiplexed_buffer *multiplexed_buffer, int size);
+static void thorium_message_multiplexer_test_dynamic(struct thorium_message_multiplexer *self);
+static void thorium_message_multiplexer_profile_flush(struct thorium_message_multiplexer *self,
+                struct thorium_multiplexed_buffer *multiplexed_buffer, int force);
 
 /*
 #define DEBUG_MULTIPLEXER
@@ -42,6 +65,11 @@ void thorium_message_multiplexer_init(struct thorium_message_multiplexer *self,
 
     self->flags = 0;
     core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_DISABLED);
+    core_bitmap_clear_bit_uint32_t(&self->flags, FLAG_ZERO_COPY);
+
+    if (thorium_multiplexer_policy_is_zero_copy(self->policy)) {
+        core_bitmap_set_bit_uint32_t(&self->flags, FLAG_ZERO_COPY);
+    }
 
     core_set_init(&self->buffers_with_content, sizeof(int));
 
@@ -50,6 +78,8 @@ void thorium_message_multiplexer_init(struct thorium_message_multiplexer *self,
     self->buffer_size_in_bytes = thorium_multiplexer_policy_size_threshold(self->policy);
     self->timeout_in_nanoseconds = thorium_multiplexer_policy_time_threshold(self->policy);
 
+    self->dynamic_timeout = self->timeout_in_nanoseconds == THORIUM_DYNAMIC_TIMEOUT;
+
     self->node = node;
 
     core_vector_init(&self->buffers, sizeof(struct thorium_multiplexed_buffer));
@@ -63,13 +93,26 @@ void thorium_message_multiplexer_init(struct thorium_message_multiplexer *self,
     printf("DEBUG_MULTIPLEXER size %d bytes %d\n", size, bytes);
 #endif
 
-    self->big_buffer = core_memory_allocate(bytes, MEMORY_MULTIPLEXER);
+    /*
+     * There is no staging buffer in zero-copy mode.
+     */
+    self->big_buffer = NULL;
+
+    if (!core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY)) {
+        self->big_buffer = core_memory_allocate(bytes, MEMORY_MULTIPLEXER);
+    }
+
     position = 0;
 
     for (i = 0; i < size; ++i) {
         multiplexed_buffer = core_vector_at(&self->buffers, i);
 
-        multiplexed_buffer->buffer = self->big_buffer + position;
+        multiplexed_buffer->buffer = NULL;
+
+        if (self->big_buffer != NULL) {
+            multiplexed_buffer->buffer = self->big_buffer + position;
+        }
+
         position += self->buffer_size_in_bytes;
 
 #ifdef DEBUG_MULTIPLEXER
@@ -84,6 +127,29 @@ void thorium_message_multiplexer_init(struct thorium_message_multiplexer *self,
         multiplexed_buffer->current_size = 0;
         multiplexed_buffer->message_count = 0;
         multiplexed_buffer->maximum_size = self->buffer_size_in_bytes;
+
+        core_vector_init(&multiplexed_buffer->references,
+                        sizeof(struct thorium_multiplexed_reference));
+
+        /*
+         * Destinations are considered idle until traffic is observed.
+         */
+        multiplexed_buffer->first_message_time = 0;
+        multiplexed_buffer->last_message_time = 0;
+        multiplexed_buffer->average_interval = thorium_multiplexer_policy_maximum_time(self->policy);
+        multiplexed_buffer->average_message_size = 0;
+        multiplexed_buffer->timeout = self->timeout_in_nanoseconds;
+
+        if (self->dynamic_timeout) {
+            multiplexed_buffer->timeout = 0;
+        }
+
+        /*
+         * The header is added when the buffer is flushed.
+         */
+        if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY)) {
+            multiplexed_buffer->maximum_size -= ZERO_COPY_HEADER_SIZE;
+        }
     }
 
     self->last_flush = core_timer_get_nanoseconds(&self->timer);
@@ -102,6 +168,9 @@ void thorium_message_multiplexer_init(struct thorium_message_multiplexer *self,
                             core_bitmap_get_bit_uint32_t(&self->flags, FLAG_DISABLED),
                         self->buffer_size_in_bytes, self->timeout_in_nanoseconds);
         }
+
+        printf("thorium_message_multiplexer: zero_copy=%d\n",
+                        core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY));
     }
 }
 
@@ -132,8 +201,10 @@ void thorium_message_multiplexer_destroy(struct thorium_message_multiplexer *sel
         multiplexed_buffer = core_vector_at(&self->buffers, i);
 
         CORE_DEBUGGER_ASSERT(multiplexed_buffer->current_size == 0);
+        CORE_DEBUGGER_ASSERT(core_vector_size(&multiplexed_buffer->references) == 0);
 
         multiplexed_buffer->buffer = 0;
+        core_vector_destroy(&multiplexed_buffer->references);
     }
 
     core_vector_destroy(&self->buffers);
@@ -143,8 +214,10 @@ void thorium_message_multiplexer_destroy(struct thorium_message_multiplexer *sel
     self->buffer_size_in_bytes = -1;
     self->timeout_in_nanoseconds = -1;
 
-    core_memory_free(self->big_buffer, MEMORY_MULTIPLEXER);
-    self->big_buffer = NULL;
+    if (self->big_buffer != NULL) {
+        core_memory_free(self->big_buffer, MEMORY_MULTIPLEXER);
+        self->big_buffer = NULL;
+    }
 
     self->last_flush = 0;
 
@@ -183,6 +256,7 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
     void *destination_in_buffer;
     int required_size;
     struct thorium_multiplexed_buffer *real_multiplexed_buffer;
+    struct thorium_multiplexed_reference reference;
 
     ++self->original_message_count;
 
@@ -203,6 +277,11 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
 
     count = thorium_message_count(message);
     required_size = sizeof(count) + count;
+
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY)) {
+        required_size = ZERO_COPY_RECORD_HEADER_SIZE + ZERO_COPY_ALIGN(count);
+    }
+
     buffer = thorium_message_buffer(message);
     destination_actor = thorium_message_destination(message);
 
@@ -260,15 +339,33 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
         CORE_DEBUGGER_ASSERT(current_size == 0);
     }
 
-    multiplexed_buffer = real_multiplexed_buffer->buffer;
-    destination_in_buffer = ((char *)multiplexed_buffer) + current_size;
+    if (self->dynamic_timeout) {
+        thorium_message_multiplexer_observe(self, real_multiplexed_buffer, required_size);
+    }
 
-    /*
-     * Append <count><buffer> to the <multiplexed_buffer>
-     */
-    core_memory_copy(destination_in_buffer, &count, sizeof(count));
-    core_memory_copy((char *)destination_in_buffer + sizeof(count),
-                    buffer, count);
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY)) {
+
+        /*
+         * Keep a reference. The buffer is given back when the
+         * multiplexed buffer is flushed.
+         */
+        reference.buffer = buffer;
+        reference.count = count;
+        reference.worker = thorium_message_worker(message);
+
+        core_vector_push_back(&real_multiplexed_buffer->references, &reference);
+
+    } else {
+        multiplexed_buffer = real_multiplexed_buffer->buffer;
+        destination_in_buffer = ((char *)multiplexed_buffer) + current_size;
+
+        /*
+         * Append <count><buffer> to the <multiplexed_buffer>
+         */
+        core_memory_copy(destination_in_buffer, &count, sizeof(count));
+        core_memory_copy((char *)destination_in_buffer + sizeof(count),
+                        buffer, count);
+    }
 
     current_size += required_size;
 
@@ -338,6 +435,11 @@ int thorium_message_multiplexer_demultiplex(struct thorium_message_multiplexer *
         return 0;
     }
 
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY)) {
+        thorium_message_multiplexer_demultiplex_views(self, message);
+        return 1;
+    }
+
     source_node = thorium_message_source_node(message);
     destination_node = thorium_message_destination_node(message);
     count = thorium_message_count(message);
@@ -397,6 +499,11 @@ void thorium_message_multiplexer_test(struct thorium_message_multiplexer *self)
         return;
     }
 
+    if (self->dynamic_timeout) {
+        thorium_message_multiplexer_test_dynamic(self);
+        return;
+    }
+
     time = core_timer_get_nanoseconds(&self->timer);
 
     duration = time - self->last_flush;
@@ -448,6 +555,13 @@ void thorium_message_multiplexer_flush(struct thorium_message_multiplexer *self,
         return;
     }
 
+    thorium_message_multiplexer_profile_flush(self, multiplexed_buffer, force);
+
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY)) {
+        thorium_message_multiplexer_flush_references(self, index, multiplexed_buffer);
+        return;
+    }
+
     count = current_size;
     tag = ACTION_MULTIPLEXER_MESSAGE;
     buffer = multiplexed_buffer->buffer;
@@ -474,3 +588,290 @@ int thorium_message_multiplexer_is_disabled(struct thorium_message_multiplexer *
 {
     return core_bitmap_get_bit_uint32_t(&self->flags, FLAG_DISABLED);
 }
+
+int thorium_message_multiplexer_is_zero_copy(struct thorium_message_multiplexer *self)
+{
+    return core_bitmap_get_bit_uint32_t(&self->flags, FLAG_ZERO_COPY);
+}
+
+/*
+ * Gather the referenced buffers directly in a node outbound buffer.
+ * This is the only copy of these messages on the sending side.
+ */
+static void thorium_message_multiplexer_flush_references(struct thorium_message_multiplexer *self,
+                int index, struct thorium_multiplexed_buffer *multiplexed_buffer)
+{
+    char *buffer;
+    struct thorium_message message;
+    int count;
+    int size;
+    int i;
+    int position;
+    int payload_offset;
+    int reference_count;
+    struct thorium_multiplexed_reference *reference;
+    struct thorium_worker_buffer worker_buffer;
+
+    count = ZERO_COPY_HEADER_SIZE + multiplexed_buffer->current_size;
+
+    /*
+     * The metadata is written at the end by the node.
+     */
+    thorium_message_init(&message, ACTION_MULTIPLEXER_MESSAGE, count, NULL);
+    buffer = core_memory_pool_allocate(thorium_node_outbound_memory_pool(self->node),
+                    count + thorium_message_metadata_size(&message));
+    thorium_message_set_buffer(&message, buffer);
+
+    reference_count = 0;
+    core_memory_copy(buffer, &reference_count, sizeof(reference_count));
+
+    position = ZERO_COPY_HEADER_SIZE;
+    size = core_vector_size(&multiplexed_buffer->references);
+
+    for (i = 0; i < size; ++i) {
+        reference = core_vector_at(&multiplexed_buffer->references, i);
+
+        payload_offset = position + ZERO_COPY_RECORD_HEADER_SIZE;
+
+        core_memory_copy(buffer + position, &reference->count, sizeof(reference->count));
+        core_memory_copy(buffer + position + sizeof(reference->count), &payload_offset,
+                        sizeof(payload_offset));
+        core_memory_copy(buffer + payload_offset, reference->buffer, reference->count);
+
+        position = payload_offset + ZERO_COPY_ALIGN(reference->count);
+
+        /*
+         * Give the buffer back to its owner.
+         */
+        thorium_worker_buffer_init(&worker_buffer, reference->worker, reference->buffer);
+        thorium_node_inject_outbound_buffer(self->node, &worker_buffer);
+        thorium_worker_buffer_destroy(&worker_buffer);
+    }
+
+    CORE_DEBUGGER_ASSERT(position == count);
+
+    core_vector_clear(&multiplexed_buffer->references);
+
+    thorium_node_send_outbound_node_message(self->node, index, &message);
+
+    ++self->real_message_count;
+    thorium_message_destroy(&message);
+
+    multiplexed_buffer->current_size = 0;
+    multiplexed_buffer->message_count = 0;
+
+    core_set_delete(&self->buffers_with_content, &index);
+}
+
+/*
+ * Deliver the enclosed messages as views into the multiplexed buffer.
+ *
+ * The reference count is only changed by the node thread, so it does not need
+ * to be atomic. The demultiplexer holds a reference during the loop because
+ * some messages (system messages for instance) are freed right away.
+ */
+static void thorium_message_multiplexer_demultiplex_views(struct thorium_message_multiplexer *self,
+                struct thorium_message *message)
+{
+    int count;
+    char *buffer;
+    struct thorium_message new_message;
+    int new_count;
+    int payload_offset;
+    int position;
+    int *reference_count;
+    int source_node;
+    int destination_node;
+
+    source_node = thorium_message_source_node(message);
+    destination_node = thorium_message_destination_node(message);
+    count = thorium_message_count(message);
+    buffer = thorium_message_buffer(message);
+
+    reference_count = (int *)buffer;
+    *reference_count = 1;
+
+    position = ZERO_COPY_HEADER_SIZE;
+
+    while (position < count) {
+        core_memory_copy(&new_count, buffer + position, sizeof(new_count));
+        core_memory_copy(&payload_offset, buffer + position + sizeof(new_count),
+                        sizeof(payload_offset));
+
+        thorium_message_init_with_nodes(&new_message, new_count, buffer + payload_offset,
+                        source_node, destination_node);
+
+        /*
+         * thorium_message_set_worker changes the type.
+         */
+        thorium_message_set_worker(&new_message, THORIUM_MESSAGE_MULTIPLEXER_VIEW_WORKER);
+        thorium_message_set_type(&new_message, THORIUM_MESSAGE_TYPE_NODE_INBOUND);
+
+        ++(*reference_count);
+
+        thorium_node_prepare_received_message(self->node, &new_message);
+        thorium_node_dispatch_message(self->node, &new_message);
+
+        thorium_message_destroy(&new_message);
+
+        position = payload_offset + ZERO_COPY_ALIGN(new_count);
+    }
+
+    thorium_message_multiplexer_release(self, buffer);
+}
+
+void thorium_message_multiplexer_free_view(struct thorium_message_multiplexer *self, void *buffer)
+{
+    int payload_offset;
+
+    /*
+     * The offset of the payload is just before it.
+     */
+    core_memory_copy(&payload_offset, (char *)buffer - sizeof(payload_offset),
+                    sizeof(payload_offset));
+
+    thorium_message_multiplexer_release(self, (char *)buffer - payload_offset);
+}
+
+static void thorium_message_multiplexer_release(struct thorium_message_multiplexer *self,
+                char *parent)
+{
+    int *reference_count;
+
+    reference_count = (int *)parent;
+
+    CORE_DEBUGGER_ASSERT(*reference_count > 0);
+
+    --(*reference_count);
+
+    if (*reference_count == 0) {
+        core_memory_pool_free(thorium_node_inbound_memory_pool(self->node), parent);
+    }
+}
+
+/*
+ * Update the traffic observed for a destination. The averages are
+ * exponential moving averages with a weight of 1/8 for the new value.
+ */
+static void thorium_message_multiplexer_observe(struct thorium_message_multiplexer *self,
+                struct thorium_multiplexed_buffer *multiplexed_buffer, int size)
+{
+    uint64_t time;
+    uint64_t interval;
+
+    time = core_timer_get_nanoseconds(&self->timer);
+
+    if (multiplexed_buffer->last_message_time != 0) {
+        interval = time - multiplexed_buffer->last_message_time;
+        multiplexed_buffer->average_interval =
+                (7 * multiplexed_buffer->average_interval + interval) / 8;
+    }
+
+    if (multiplexed_buffer->average_message_size == 0) {
+        multiplexed_buffer->average_message_size = size;
+    } else {
+        multiplexed_buffer->average_message_size =
+                (7 * multiplexed_buffer->average_message_size + size) / 8;
+    }
+
+    multiplexed_buffer->last_message_time = time;
+
+    /*
+     * This message is the first one in the buffer.
+     */
+    if (multiplexed_buffer->message_count == 0) {
+        multiplexed_buffer->first_message_time = time;
+    }
+}
+
+/*
+ * With the dynamic timeout, each destination has its own timeout
+ * that is computed by the policy from the observed traffic.
+ * A buffer is also flushed when its destination becomes idle.
+ */
+static void thorium_message_multiplexer_test_dynamic(struct thorium_message_multiplexer *self)
+{
+    uint64_t time;
+    struct core_set_iterator iterator;
+    struct core_vector indices;
+    struct core_vector reasons;
+    struct thorium_multiplexed_buffer *multiplexed_buffer;
+    int index;
+    int reason;
+    int size;
+    int i;
+
+    if (core_set_empty(&self->buffers_with_content)) {
+        return;
+    }
+
+    time = core_timer_get_nanoseconds(&self->timer);
+
+    core_vector_init(&indices, sizeof(int));
+    core_vector_init(&reasons, sizeof(int));
+
+    /*
+     * The buffers are flushed after the iteration because a flush
+     * removes its index from the set.
+     */
+    core_set_iterator_init(&iterator, &self->buffers_with_content);
+
+    while (core_set_iterator_get_next_value(&iterator, &index)) {
+
+        multiplexed_buffer = core_vector_at(&self->buffers, index);
+
+        multiplexed_buffer->timeout = thorium_multiplexer_policy_dynamic_timeout(self->policy,
+                        multiplexed_buffer->average_interval,
+                        multiplexed_buffer->average_message_size,
+                        multiplexed_buffer->current_size,
+                        multiplexed_buffer->maximum_size);
+
+        if (time - multiplexed_buffer->first_message_time >= (uint64_t)multiplexed_buffer->timeout) {
+            reason = FORCE_YES_TIME;
+
+        } else if (thorium_multiplexer_policy_is_idle(self->policy,
+                                time - multiplexed_buffer->last_message_time,
+                                multiplexed_buffer->average_interval)) {
+            reason = FORCE_YES_IDLE;
+
+        } else {
+            continue;
+        }
+
+        core_vector_push_back(&indices, &index);
+        core_vector_push_back(&reasons, &reason);
+    }
+
+    core_set_iterator_destroy(&iterator);
+
+    size = core_vector_size(&indices);
+
+    for (i = 0; i < size; ++i) {
+        index = core_vector_at_as_int(&indices, i);
+        reason = core_vector_at_as_int(&reasons, i);
+
+        thorium_message_multiplexer_flush(self, index, reason);
+    }
+
+    core_vector_destroy(&indices);
+    core_vector_destroy(&reasons);
+
+    self->last_flush = time;
+}
+
+static void thorium_message_multiplexer_profile_flush(struct thorium_message_multiplexer *self,
+                struct thorium_multiplexed_buffer *multiplexed_buffer, int force)
+{
+    int reason;
+
+    reason = THORIUM_MULTIPLEXER_FLUSH_SIZE;
+
+    if (force == FORCE_YES_TIME) {
+        reason = THORIUM_MULTIPLEXER_FLUSH_TIMEOUT;
+    } else if (force == FORCE_YES_IDLE) {
+        reason = THORIUM_MULTIPLEXER_FLUSH_IDLE;
+    }
+
+    thorium_transport_profile_multiplexer_flush(thorium_node_get_transport(self->node),
+                    reason, multiplexed_buffer->message_count, multiplexed_buffer->timeout);
+}
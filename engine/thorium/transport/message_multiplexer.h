@@ -18,6 +18,13 @@ struct thorium_message;
  */
 #define ACTION_MULTIPLEXER_MESSAGE 0x0024afc9
 
+/*
+ * In zero-copy mode, demultiplexed messages are views into the
+ * multiplexed inbound buffer. They have this worker value so that
+ * the node gives them back with thorium_message_multiplexer_free_view.
+ */
+#define THORIUM_MESSAGE_MULTIPLEXER_VIEW_WORKER (-2)
+
 /*
  * Genomic graph traversal is characterized by:
  *
@@ -42,6 +49,19 @@ struct thorium_message;
  *
  * buffer_size_in_bytes
  * timeout_in_nanoseconds
+ *
+ * In zero-copy mode (-enable-zero-copy-multiplexer), small messages are
+ * kept by reference (scatter) and copied once in the outbound buffer
+ * when they are flushed (gather). On the receiving side, the enclosed
+ * messages are delivered as views into the received buffer, which is
+ * freed when the last view is freed.
+ *
+ * Layout in zero-copy mode:
+ *
+ * <reference_count> <padding>
+ * (<count> <payload_offset> <payload> <padding>)+
+ *
+ * Each payload starts on a 8-byte boundary.
  */
 struct thorium_message_multiplexer {
     struct core_timer timer;
@@ -71,6 +91,10 @@ struct thorium_message_multiplexer {
      */
     int timeout_in_nanoseconds;
 
+    /*
+     * With -enable-adaptive-multiplexer, the timeout is THORIUM_DYNAMIC_TIMEOUT
+     * and each destination node gets its own timeout from the policy.
+     */
     int dynamic_timeout;
 
     int original_message_count;
@@ -107,5 +131,12 @@ void thorium_message_multiplexer_test(struct thorium_message_multiplexer *self);
 void thorium_message_multiplexer_flush(struct thorium_message_multiplexer *self, int index, int force);
 
 int thorium_message_multiplexer_is_disabled(struct thorium_message_multiplexer *self);
+int thorium_message_multiplexer_is_zero_copy(struct thorium_message_multiplexer *self);
+
+/*
+ * Free a message buffer with the worker THORIUM_MESSAGE_MULTIPLEXER_VIEW_WORKER.
+ * This is called by the node thread.
+ */
+void thorium_message_multiplexer_free_view(struct thorium_message_multiplexer *self, void *buffer);
 
 #endif
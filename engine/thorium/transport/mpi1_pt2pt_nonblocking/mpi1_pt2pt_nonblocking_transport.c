@@ -7,6 +7,7 @@
 #include <engine/thorium/worker_buffer.h>
 #include <engine/thorium/message.h>
 
+#include <core/system/command.h>
 #include <core/system/memory.h>
 #include <core/system/memory_pool.h>
 #include <core/system/debugger.h>
@@ -41,6 +42,22 @@
  */
 #define TAG_BIG_START_VALUE 2
 
+#define PERSISTENT_RECEIVES_OPTION "-enable-persistent-receives"
+#define PERSISTENT_RECEIVE_COUNT_OPTION "-persistent-receive-count"
+#define DEFAULT_PERSISTENT_RECEIVE_COUNT 16
+
+#define MEMORY_MPI1_PT2PT_NONBLOCKING 0x2d6f90b3
+
+/*
+ * Maximum number of send requests given to one MPI_Testsome call.
+ */
+#define MAXIMUM_TESTED_SEND_REQUESTS 64
+
+static void thorium_mpi1_pt2pt_nonblocking_transport_start_persistent_receives(struct thorium_transport *self);
+static void thorium_mpi1_pt2pt_nonblocking_transport_stop_persistent_receives(struct thorium_transport *self);
+static int thorium_mpi1_pt2pt_nonblocking_transport_receive_persistent(struct thorium_transport *self,
+                struct thorium_message *message);
+
 struct thorium_transport_interface thorium_mpi1_pt2pt_nonblocking_transport_implementation = {
     .name = "mpi1_pt2pt_nonblocking_transport",
     .size = sizeof(struct thorium_mpi1_pt2pt_nonblocking_transport),
@@ -48,7 +65,8 @@ struct thorium_transport_interface thorium_mpi1_pt2pt_nonblocking_transport_impl
     .destroy = thorium_mpi1_pt2pt_nonblocking_transport_destroy,
     .send = thorium_mpi1_pt2pt_nonblocking_transport_send,
     .receive = thorium_mpi1_pt2pt_nonblocking_transport_receive,
-    .test = thorium_mpi1_pt2pt_nonblocking_transport_test
+    .test = thorium_mpi1_pt2pt_nonblocking_transport_test,
+    .test_some = thorium_mpi1_pt2pt_nonblocking_transport_test_some
 };
 
 /*
@@ -104,6 +122,38 @@ void thorium_mpi1_pt2pt_nonblocking_transport_init(struct thorium_transport *sel
     core_fast_queue_init(&concrete_self->send_requests, sizeof(struct thorium_mpi1_request));
     core_fast_queue_init(&concrete_self->receive_requests, sizeof(struct thorium_mpi1_request));
 
+    concrete_self->use_persistent_receives = core_command_has_argument(*argc, *argv,
+                    PERSISTENT_RECEIVES_OPTION);
+    concrete_self->persistent_receives_started = 0;
+    concrete_self->persistent_request_count = 0;
+    concrete_self->current_sequence = 0;
+    concrete_self->completed_count = 0;
+    concrete_self->completed_position = 0;
+
+    if (concrete_self->use_persistent_receives) {
+        concrete_self->persistent_request_count = DEFAULT_PERSISTENT_RECEIVE_COUNT;
+
+        if (core_command_has_argument(*argc, *argv, PERSISTENT_RECEIVE_COUNT_OPTION)) {
+            concrete_self->persistent_request_count = core_command_get_argument_value_int(*argc, *argv,
+                            PERSISTENT_RECEIVE_COUNT_OPTION);
+        }
+
+        if (concrete_self->persistent_request_count < 1) {
+            concrete_self->persistent_request_count = 1;
+        }
+
+        concrete_self->persistent_requests = core_memory_allocate(concrete_self->persistent_request_count * sizeof(MPI_Request),
+                        MEMORY_MPI1_PT2PT_NONBLOCKING);
+        concrete_self->persistent_buffers = core_memory_allocate(concrete_self->persistent_request_count * sizeof(void *),
+                        MEMORY_MPI1_PT2PT_NONBLOCKING);
+        concrete_self->persistent_sequences = core_memory_allocate(concrete_self->persistent_request_count * sizeof(uint64_t),
+                        MEMORY_MPI1_PT2PT_NONBLOCKING);
+        concrete_self->completed_indices = core_memory_allocate(concrete_self->persistent_request_count * sizeof(int),
+                        MEMORY_MPI1_PT2PT_NONBLOCKING);
+        concrete_self->completed_statuses = core_memory_allocate(concrete_self->persistent_request_count * sizeof(MPI_Status),
+                        MEMORY_MPI1_PT2PT_NONBLOCKING);
+    }
+
     /*
     required = MPI_THREAD_MULTIPLE;
     */
@@ -211,6 +261,16 @@ void thorium_mpi1_pt2pt_nonblocking_transport_destroy(struct thorium_transport *
 
     core_fast_queue_destroy(&concrete_self->receive_requests);
 
+    if (concrete_self->use_persistent_receives) {
+        thorium_mpi1_pt2pt_nonblocking_transport_stop_persistent_receives(self);
+
+        core_memory_free(concrete_self->persistent_requests, MEMORY_MPI1_PT2PT_NONBLOCKING);
+        core_memory_free(concrete_self->persistent_buffers, MEMORY_MPI1_PT2PT_NONBLOCKING);
+        core_memory_free(concrete_self->persistent_sequences, MEMORY_MPI1_PT2PT_NONBLOCKING);
+        core_memory_free(concrete_self->completed_indices, MEMORY_MPI1_PT2PT_NONBLOCKING);
+        core_memory_free(concrete_self->completed_statuses, MEMORY_MPI1_PT2PT_NONBLOCKING);
+    }
+
     /*
      * \see http://www.mpich.org/static/docs/v3.1/www3/MPI_Comm_free.html
      */
@@ -342,10 +402,23 @@ int thorium_mpi1_pt2pt_nonblocking_transport_receive(struct thorium_transport *s
     concrete_self = thorium_transport_get_concrete_transport(self);
 
     /*
-     * If the number of requests is below the maximum, add some of them.
+     * With persistent receives, the small payloads never
+     * use the request queue.
      */
+    if (concrete_self->use_persistent_receives) {
 
-    if (concrete_self->small_request_count < concrete_self->maximum_receive_request_count) {
+        if (!concrete_self->persistent_receives_started) {
+            thorium_mpi1_pt2pt_nonblocking_transport_start_persistent_receives(self);
+        }
+
+        if (thorium_mpi1_pt2pt_nonblocking_transport_receive_persistent(self, message)) {
+            return 1;
+        }
+
+    /*
+     * If the number of requests is below the maximum, add some of them.
+     */
+    } else if (concrete_self->small_request_count < concrete_self->maximum_receive_request_count) {
 
         size = concrete_self->maximum_buffer_size;
         request_tag = TAG_SMALL_PAYLOAD;
@@ -533,6 +606,99 @@ int thorium_mpi1_pt2pt_nonblocking_transport_test(struct thorium_transport *self
     return 0;
 }
 
+/*
+ * Test the oldest send requests with one MPI_Testsome call instead
+ * of one MPI_Test call per request.
+ *
+ * \see http://www.mpich.org/static/docs/v3.1/www3/MPI_Testsome.html
+ */
+int thorium_mpi1_pt2pt_nonblocking_transport_test_some(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                int maximum)
+{
+    struct thorium_mpi1_pt2pt_nonblocking_transport *concrete_self;
+    struct thorium_mpi1_request active_requests[MAXIMUM_TESTED_SEND_REQUESTS];
+    MPI_Request requests[MAXIMUM_TESTED_SEND_REQUESTS];
+    int indices[MAXIMUM_TESTED_SEND_REQUESTS];
+    char completed[MAXIMUM_TESTED_SEND_REQUESTS];
+    struct thorium_mpi1_request *active_request;
+    int request_count;
+    int outcount;
+    int count;
+    int i;
+    void *buffer;
+    int worker;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    if (maximum > MAXIMUM_TESTED_SEND_REQUESTS) {
+        maximum = MAXIMUM_TESTED_SEND_REQUESTS;
+    }
+
+    request_count = 0;
+
+    while (request_count < maximum
+                    && core_fast_queue_dequeue(&concrete_self->send_requests,
+                            active_requests + request_count)) {
+
+        requests[request_count] = *thorium_mpi1_request_request(active_requests + request_count);
+        completed[request_count] = 0;
+        ++request_count;
+    }
+
+    if (request_count == 0) {
+        return 0;
+    }
+
+    MPI_Testsome(request_count, requests, &outcount, indices, MPI_STATUSES_IGNORE);
+
+    if (outcount == MPI_UNDEFINED) {
+        outcount = 0;
+    }
+
+    for (i = 0; i < outcount; ++i) {
+        completed[indices[i]] = 1;
+    }
+
+    count = 0;
+
+    for (i = 0; i < request_count; ++i) {
+
+        active_request = active_requests + i;
+
+        /*
+         * Put it back in the FIFO for later.
+         */
+        if (!completed[i]) {
+            core_fast_queue_enqueue(&concrete_self->send_requests, active_request);
+            continue;
+        }
+
+        /*
+         * MPI_Testsome set the completed handle to MPI_REQUEST_NULL.
+         */
+        *thorium_mpi1_request_request(active_request) = requests[i];
+
+        worker = thorium_mpi1_request_worker(active_request);
+        buffer = thorium_mpi1_request_buffer(active_request);
+
+        /*
+         * Like in the test operation, handshake buffers stay
+         * inside this implementation.
+         */
+        if (thorium_mpi1_request_has_mark(active_request)) {
+            core_memory_pool_free(self->outbound_message_memory_pool, buffer);
+
+        } else {
+            thorium_worker_buffer_init(worker_buffers + count, worker, buffer);
+            ++count;
+        }
+
+        thorium_mpi1_request_destroy(active_request);
+    }
+
+    return count;
+}
+
 void thorium_mpi1_pt2pt_nonblocking_transport_add_receive_request(struct thorium_transport *self,
                 int tag, int count, int source)
 {
@@ -604,3 +770,157 @@ int thorium_mpi1_pt2pt_nonblocking_transport_get_big_tag(struct thorium_transpor
 
     return tag;
 }
+
+/*
+ * This is called in the first receive operation since the
+ * inbound_message_memory_pool is not available in the init operation.
+ *
+ * \see http://www.mpich.org/static/docs/v3.1/www3/MPI_Recv_init.html
+ * \see http://www.mpich.org/static/docs/v3.1/www3/MPI_Startall.html
+ */
+static void thorium_mpi1_pt2pt_nonblocking_transport_start_persistent_receives(struct thorium_transport *self)
+{
+    struct thorium_mpi1_pt2pt_nonblocking_transport *concrete_self;
+    int i;
+    void *buffer;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    CORE_DEBUGGER_ASSERT(self->inbound_message_memory_pool != NULL);
+
+    for (i = 0; i < concrete_self->persistent_request_count; ++i) {
+
+        buffer = core_memory_pool_allocate(self->inbound_message_memory_pool,
+                    concrete_self->maximum_buffer_size);
+
+        concrete_self->persistent_buffers[i] = buffer;
+        concrete_self->persistent_sequences[i] = concrete_self->current_sequence++;
+
+        MPI_Recv_init(buffer, concrete_self->maximum_buffer_size, concrete_self->datatype,
+                        MPI_ANY_SOURCE, TAG_SMALL_PAYLOAD, concrete_self->communicator,
+                        concrete_self->persistent_requests + i);
+    }
+
+    MPI_Startall(concrete_self->persistent_request_count, concrete_self->persistent_requests);
+
+    concrete_self->persistent_receives_started = 1;
+}
+
+static void thorium_mpi1_pt2pt_nonblocking_transport_stop_persistent_receives(struct thorium_transport *self)
+{
+    struct thorium_mpi1_pt2pt_nonblocking_transport *concrete_self;
+    MPI_Request *request;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    if (!concrete_self->persistent_receives_started) {
+        return;
+    }
+
+    /*
+     * Harvested requests are inactive. Start them again so that
+     * all the requests can be cancelled the same way.
+     */
+    for (i = concrete_self->completed_position; i < concrete_self->completed_count; ++i) {
+        MPI_Start(concrete_self->persistent_requests + concrete_self->completed_indices[i]);
+    }
+
+    for (i = 0; i < concrete_self->persistent_request_count; ++i) {
+
+        request = concrete_self->persistent_requests + i;
+
+        MPI_Cancel(request);
+        MPI_Wait(request, MPI_STATUS_IGNORE);
+        MPI_Request_free(request);
+
+        core_memory_pool_free(self->inbound_message_memory_pool,
+                        concrete_self->persistent_buffers[i]);
+    }
+
+    concrete_self->completed_count = 0;
+    concrete_self->completed_position = 0;
+    concrete_self->persistent_receives_started = 0;
+}
+
+/*
+ * \see http://www.mpich.org/static/docs/v3.1/www3/MPI_Testsome.html
+ */
+static int thorium_mpi1_pt2pt_nonblocking_transport_receive_persistent(struct thorium_transport *self,
+                struct thorium_message *message)
+{
+    struct thorium_mpi1_pt2pt_nonblocking_transport *concrete_self;
+    MPI_Status *status;
+    MPI_Status saved_status;
+    char *buffer;
+    int count;
+    int source;
+    int index;
+    int saved_index;
+    int outcount;
+    int i;
+    int j;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    /*
+     * Harvest a new batch only when the previous one is consumed.
+     */
+    if (concrete_self->completed_position == concrete_self->completed_count) {
+
+        concrete_self->completed_position = 0;
+        concrete_self->completed_count = 0;
+
+        MPI_Testsome(concrete_self->persistent_request_count, concrete_self->persistent_requests,
+                        &outcount, concrete_self->completed_indices, concrete_self->completed_statuses);
+
+        if (outcount == MPI_UNDEFINED || outcount == 0) {
+            return 0;
+        }
+
+        /*
+         * MPI_Testsome returns the requests by index. Sort them by start
+         * order (insertion sort, the batch is small).
+         */
+        for (i = 1; i < outcount; ++i) {
+            saved_index = concrete_self->completed_indices[i];
+            saved_status = concrete_self->completed_statuses[i];
+            j = i - 1;
+
+            while (j >= 0 && concrete_self->persistent_sequences[concrete_self->completed_indices[j]]
+                            > concrete_self->persistent_sequences[saved_index]) {
+                concrete_self->completed_indices[j + 1] = concrete_self->completed_indices[j];
+                concrete_self->completed_statuses[j + 1] = concrete_self->completed_statuses[j];
+                --j;
+            }
+
+            concrete_self->completed_indices[j + 1] = saved_index;
+            concrete_self->completed_statuses[j + 1] = saved_status;
+        }
+
+        concrete_self->completed_count = outcount;
+    }
+
+    index = concrete_self->completed_indices[concrete_self->completed_position];
+    status = concrete_self->completed_statuses + concrete_self->completed_position;
+    ++concrete_self->completed_position;
+
+    MPI_Get_count(status, concrete_self->datatype, &count);
+    source = status->MPI_SOURCE;
+
+    /*
+     * The persistent buffer stays with its request, so the payload
+     * is copied to a buffer that will be given back to
+     * the inbound_message_memory_pool.
+     */
+    buffer = core_memory_pool_allocate(self->inbound_message_memory_pool, count);
+    core_memory_copy(buffer, concrete_self->persistent_buffers[index], count);
+
+    concrete_self->persistent_sequences[index] = concrete_self->current_sequence++;
+    MPI_Start(concrete_self->persistent_requests + index);
+
+    thorium_message_init_with_nodes(message, count, buffer, source,
+                    thorium_transport_get_rank(self));
+
+    return 1;
+}
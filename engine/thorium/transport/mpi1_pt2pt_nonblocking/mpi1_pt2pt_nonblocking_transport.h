@@ -9,6 +9,8 @@
 
 #include <mpi.h>
 
+#include <stdint.h>
+
 struct thorium_node;
 struct thorium_message;
 struct biosal_active_buffer;
@@ -39,6 +41,32 @@ struct thorium_mpi1_pt2pt_nonblocking_transport {
 
     int current_big_tag;
     int mpi_tag_ub;
+
+    /*
+     * Persistent receives for small payloads (-enable-persistent-receives).
+     *
+     * The requests are created once with MPI_Recv_init and restarted with
+     * MPI_Start after their payload is copied to a buffer from the
+     * inbound_message_memory_pool. Completions are harvested in batches
+     * with MPI_Testsome.
+     */
+    int use_persistent_receives;
+    int persistent_receives_started;
+    int persistent_request_count;
+    MPI_Request *persistent_requests;
+    void **persistent_buffers;
+
+    /*
+     * Order in which the requests were started. Completions are returned
+     * in this order since MPI matches messages in the same order.
+     */
+    uint64_t *persistent_sequences;
+    uint64_t current_sequence;
+
+    int *completed_indices;
+    MPI_Status *completed_statuses;
+    int completed_count;
+    int completed_position;
 };
 
 extern struct thorium_transport_interface thorium_mpi1_pt2pt_nonblocking_transport_implementation;
@@ -50,6 +78,8 @@ int thorium_mpi1_pt2pt_nonblocking_transport_send(struct thorium_transport *self
 int thorium_mpi1_pt2pt_nonblocking_transport_receive(struct thorium_transport *self, struct thorium_message *message);
 
 int thorium_mpi1_pt2pt_nonblocking_transport_test(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer);
+int thorium_mpi1_pt2pt_nonblocking_transport_test_some(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                int maximum);
 
 void thorium_mpi1_pt2pt_nonblocking_transport_add_receive_request(struct thorium_transport *self, int tag, int count, int source);
 
@@ -2,14 +2,44 @@
 #ifndef THORIUM_MULTIPLEXED_BUFFER_H
 #define THORIUM_MULTIPLEXED_BUFFER_H
 
+#include <core/structures/vector.h>
+
+#include <stdint.h>
+
+/*
+ * A message buffer referenced by a multiplexed buffer in
+ * zero-copy mode. It is copied only once, directly in the
+ * outbound buffer, when the multiplexed buffer is flushed.
+ */
+struct thorium_multiplexed_reference {
+    void *buffer;
+    int count;
+    int worker;
+};
+
 /*
  * A multiplexed buffer.
+ *
+ * In zero-copy mode, buffer is not used and the messages are in
+ * references instead.
  */
 struct thorium_multiplexed_buffer {
     void *buffer;
     int current_size;
     int maximum_size;
     int message_count;
+
+    struct core_vector references;
+
+    /*
+     * Traffic observed for this destination node
+     * (with the dynamic timeout).
+     */
+    uint64_t first_message_time;
+    uint64_t last_message_time;
+    uint64_t average_interval;
+    int average_message_size;
+    int timeout;
 };
 
 #endif
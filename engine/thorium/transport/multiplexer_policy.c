@@ -5,6 +5,8 @@
 
 #include <core/helpers/set_helper.h>
 
+#include <core/system/command.h>
+
 #include <engine/thorium/node.h>
 #include <engine/thorium/actor.h>
 
@@ -25,7 +27,25 @@
 #define TIMEOUT_IN_MICRO_SECONDS 0
 #define THORIUM_MESSAGE_MULTIPLEXER_TIME_THRESHOLD_IN_NANOSECONDS ( TIMEOUT_IN_MICRO_SECONDS * 1000)
 
-void thorium_multiplexer_policy_init(struct thorium_multiplexer_policy *self)
+/*
+ * Upper bound for the dynamic timeout (512 us).
+ */
+#define THORIUM_MESSAGE_MULTIPLEXER_MAXIMUM_TIME_IN_NANOSECONDS (512 * 1000)
+
+/*
+ * A destination is idle when nothing arrived for this many
+ * average intervals.
+ */
+#define THORIUM_MESSAGE_MULTIPLEXER_IDLE_FACTOR 4
+
+/*
+ * The multiplexer is disabled unless one of these options is provided.
+ */
+#define OPTION_ENABLE_MULTIPLEXER "-enable-multiplexer"
+#define OPTION_ENABLE_ZERO_COPY_MULTIPLEXER "-enable-zero-copy-multiplexer"
+#define OPTION_ENABLE_ADAPTIVE_MULTIPLEXER "-enable-adaptive-multiplexer"
+
+void thorium_multiplexer_policy_init(struct thorium_multiplexer_policy *self, int argc, char **argv)
 {
     self->threshold_buffer_size_in_bytes = THORIUM_MESSAGE_MULTIPLEXER_SIZE_THRESHOLD_IN_BYTES;
     /*self->threshold_time_in_nanoseconds = THORIUM_DYNAMIC_TIMEOUT;*/
@@ -47,6 +67,31 @@ void thorium_multiplexer_policy_init(struct thorium_multiplexer_policy *self)
     core_set_add_int(&self->actions_to_skip, ACTION_SPAWN_REPLY);
 
     self->disabled = 1;
+    self->zero_copy = 0;
+
+    self->maximum_time_in_nanoseconds = THORIUM_MESSAGE_MULTIPLEXER_MAXIMUM_TIME_IN_NANOSECONDS;
+    self->idle_factor = THORIUM_MESSAGE_MULTIPLEXER_IDLE_FACTOR;
+
+    if (core_command_has_argument(argc, argv, OPTION_ENABLE_MULTIPLEXER)) {
+        self->disabled = 0;
+    }
+
+    /*
+     * Messages are multiplexed by reference and demultiplexed
+     * as views.
+     */
+    if (core_command_has_argument(argc, argv, OPTION_ENABLE_ZERO_COPY_MULTIPLEXER)) {
+        self->disabled = 0;
+        self->zero_copy = 1;
+    }
+
+    /*
+     * The timeout of each destination follows its traffic.
+     */
+    if (core_command_has_argument(argc, argv, OPTION_ENABLE_ADAPTIVE_MULTIPLEXER)) {
+        self->disabled = 0;
+        self->threshold_time_in_nanoseconds = THORIUM_DYNAMIC_TIMEOUT;
+    }
 }
 
 void thorium_multiplexer_policy_destroy(struct thorium_multiplexer_policy *self)
@@ -67,6 +112,11 @@ int thorium_multiplexer_policy_is_disabled(struct thorium_multiplexer_policy *se
     return self->disabled;
 }
 
+int thorium_multiplexer_policy_is_zero_copy(struct thorium_multiplexer_policy *self)
+{
+    return self->zero_copy;
+}
+
 int thorium_multiplexer_policy_size_threshold(struct thorium_multiplexer_policy *self)
 {
     return self->threshold_buffer_size_in_bytes;
@@ -77,4 +127,42 @@ int thorium_multiplexer_policy_time_threshold(struct thorium_multiplexer_policy
     return self->threshold_time_in_nanoseconds;
 }
 
+/*
+ * At low load, messages are further apart than the maximum time, so
+ * waiting would only add latency: the timeout is 0.
+ *
+ * At high load, wait for the time that the buffer needs to fill up
+ * at the observed rate, up to the maximum time.
+ */
+int thorium_multiplexer_policy_dynamic_timeout(struct thorium_multiplexer_policy *self,
+                uint64_t average_interval, int average_message_size,
+                int current_size, int maximum_size)
+{
+    uint64_t timeout;
+    int remaining_messages;
+
+    if (average_interval >= (uint64_t)self->maximum_time_in_nanoseconds
+                    || average_message_size <= 0) {
+        return 0;
+    }
+
+    remaining_messages = (maximum_size - current_size) / average_message_size;
+    timeout = remaining_messages * average_interval;
 
+    if (timeout > (uint64_t)self->maximum_time_in_nanoseconds) {
+        timeout = self->maximum_time_in_nanoseconds;
+    }
+
+    return timeout;
+}
+
+int thorium_multiplexer_policy_is_idle(struct thorium_multiplexer_policy *self,
+                uint64_t elapsed_time, uint64_t average_interval)
+{
+    return elapsed_time > self->idle_factor * average_interval;
+}
+
+int thorium_multiplexer_policy_maximum_time(struct thorium_multiplexer_policy *self)
+{
+    return self->maximum_time_in_nanoseconds;
+}
@@ -4,6 +4,8 @@
 
 #include <core/structures/set.h>
 
+#include <stdint.h>
+
 #define THORIUM_DYNAMIC_TIMEOUT (-789)
 
 /*
@@ -17,14 +19,39 @@ struct thorium_multiplexer_policy {
     int threshold_time_in_nanoseconds;
     struct core_set actions_to_skip;
     int disabled;
+    int zero_copy;
+
+    /*
+     * Bounds for the dynamic timeout.
+     */
+    int maximum_time_in_nanoseconds;
+    int idle_factor;
 };
 
-void thorium_multiplexer_policy_init(struct thorium_multiplexer_policy *self);
+void thorium_multiplexer_policy_init(struct thorium_multiplexer_policy *self, int argc, char **argv);
 void thorium_multiplexer_policy_destroy(struct thorium_multiplexer_policy *self);
 
 int thorium_multiplexer_policy_is_action_to_skip(struct thorium_multiplexer_policy *self, int action);
 int thorium_multiplexer_policy_is_disabled(struct thorium_multiplexer_policy *self);
+int thorium_multiplexer_policy_is_zero_copy(struct thorium_multiplexer_policy *self);
 int thorium_multiplexer_policy_size_threshold(struct thorium_multiplexer_policy *self);
 int thorium_multiplexer_policy_time_threshold(struct thorium_multiplexer_policy *self);
 
+/*
+ * Dynamic timeout for a destination, from the traffic observed
+ * by the multiplexer.
+ */
+int thorium_multiplexer_policy_dynamic_timeout(struct thorium_multiplexer_policy *self,
+                uint64_t average_interval, int average_message_size,
+                int current_size, int maximum_size);
+
+/*
+ * Returns 1 if no message arrived for a destination for long enough to
+ * consider that its burst is over.
+ */
+int thorium_multiplexer_policy_is_idle(struct thorium_multiplexer_policy *self,
+                uint64_t elapsed_time, uint64_t average_interval);
+
+int thorium_multiplexer_policy_maximum_time(struct thorium_multiplexer_policy *self);
+
 #endif
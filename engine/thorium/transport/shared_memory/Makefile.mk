@@ -0,0 +1,5 @@
+THORIUM_OBJECTS += engine/thorium/transport/shared_memory/shared_memory_transport.o
+THORIUM_OBJECTS += engine/thorium/transport/shared_memory/shared_memory_ring.o
+
+# shm_open is in librt with older C libraries
+LDFLAGS += -lrt
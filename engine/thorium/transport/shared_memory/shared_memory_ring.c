@@ -0,0 +1,168 @@
+
+#include "shared_memory_ring.h"
+
+#include <core/system/atomic.h>
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <stdlib.h>
+
+#define RECORD_HEADER_SIZE (2 * sizeof(int))
+#define RECORD_ALIGNMENT 8
+#define PADDING_MARKER (-1)
+
+static int thorium_shared_memory_ring_record_size(int count);
+
+int thorium_shared_memory_ring_footprint(int capacity)
+{
+    return sizeof(struct thorium_shared_memory_ring_header) + capacity;
+}
+
+void thorium_shared_memory_ring_init(struct thorium_shared_memory_ring *self, void *memory, int capacity)
+{
+    CORE_DEBUGGER_ASSERT(capacity > 0);
+    CORE_DEBUGGER_ASSERT((capacity & (capacity - 1)) == 0);
+
+    self->header = memory;
+    self->data = (char *)memory + sizeof(struct thorium_shared_memory_ring_header);
+    self->capacity = capacity;
+}
+
+void thorium_shared_memory_ring_destroy(struct thorium_shared_memory_ring *self)
+{
+    self->header = NULL;
+    self->data = NULL;
+    self->capacity = 0;
+}
+
+void thorium_shared_memory_ring_clear(struct thorium_shared_memory_ring *self)
+{
+    self->header->head = 0;
+    self->header->tail = 0;
+}
+
+/*
+ * With records of at most half of the ring, a record always fits
+ * either before the end of the ring or after a padding marker.
+ */
+int thorium_shared_memory_ring_maximum_count(struct thorium_shared_memory_ring *self)
+{
+    return self->capacity / 2 - RECORD_HEADER_SIZE;
+}
+
+int thorium_shared_memory_ring_push(struct thorium_shared_memory_ring *self, void *buffer, int count)
+{
+    int64_t head;
+    int64_t tail;
+    int position;
+    int record_size;
+    int padding;
+    char *record;
+
+    CORE_DEBUGGER_ASSERT(count >= 0);
+
+    if (count > thorium_shared_memory_ring_maximum_count(self)) {
+        return 0;
+    }
+
+    record_size = thorium_shared_memory_ring_record_size(count);
+
+    /*
+     * Only the producer writes head.
+     */
+    head = self->header->head;
+    tail = core_atomic_add_int64_t(&self->header->tail, 0);
+
+    position = head & (self->capacity - 1);
+    padding = 0;
+
+    if (position + record_size > self->capacity) {
+        padding = self->capacity - position;
+    }
+
+    if (head + padding + record_size - tail > self->capacity) {
+        return 0;
+    }
+
+    if (padding > 0) {
+        *(int *)(self->data + position) = PADDING_MARKER;
+        position = 0;
+    }
+
+    record = self->data + position;
+    *(int *)record = count;
+
+    if (count > 0) {
+        core_memory_copy(record + RECORD_HEADER_SIZE, buffer, count);
+    }
+
+    /*
+     * The atomic operation is a full barrier, so the record is visible
+     * before the new head.
+     */
+    core_atomic_add_int64_t(&self->header->head, padding + record_size);
+
+    return 1;
+}
+
+int thorium_shared_memory_ring_peek(struct thorium_shared_memory_ring *self)
+{
+    int64_t head;
+    int64_t tail;
+    int position;
+    int count;
+
+    head = core_atomic_add_int64_t(&self->header->head, 0);
+
+    /*
+     * Only the consumer writes tail.
+     */
+    tail = self->header->tail;
+
+    while (tail != head) {
+        position = tail & (self->capacity - 1);
+        count = *(int *)(self->data + position);
+
+        if (count != PADDING_MARKER) {
+            return count;
+        }
+
+        core_atomic_add_int64_t(&self->header->tail, self->capacity - position);
+        tail += self->capacity - position;
+    }
+
+    return -1;
+}
+
+void thorium_shared_memory_ring_pop(struct thorium_shared_memory_ring *self, void *buffer)
+{
+    int position;
+    int count;
+    char *record;
+
+    position = self->header->tail & (self->capacity - 1);
+    record = self->data + position;
+    count = *(int *)record;
+
+    CORE_DEBUGGER_ASSERT(count >= 0);
+
+    if (count > 0) {
+        core_memory_copy(buffer, record + RECORD_HEADER_SIZE, count);
+    }
+
+    core_atomic_add_int64_t(&self->header->tail,
+                    thorium_shared_memory_ring_record_size(count));
+}
+
+static int thorium_shared_memory_ring_record_size(int count)
+{
+    int size;
+
+    size = RECORD_HEADER_SIZE + count;
+
+    if (size % RECORD_ALIGNMENT != 0) {
+        size += RECORD_ALIGNMENT - size % RECORD_ALIGNMENT;
+    }
+
+    return size;
+}
@@ -0,0 +1,77 @@
+
+#ifndef THORIUM_SHARED_MEMORY_RING_H
+#define THORIUM_SHARED_MEMORY_RING_H
+
+#include <stdint.h>
+
+#define THORIUM_SHARED_MEMORY_RING_CACHE_LINE 64
+
+/*
+ * The part of a ring that lives in the shared memory segment.
+ *
+ * head and tail are byte counters that only grow. head is written by the
+ * producer and tail by the consumer, and they are on different cache
+ * lines to avoid false sharing between the two processes.
+ */
+struct thorium_shared_memory_ring_header {
+    int64_t head;
+    char head_padding[THORIUM_SHARED_MEMORY_RING_CACHE_LINE - sizeof(int64_t)];
+    int64_t tail;
+    char tail_padding[THORIUM_SHARED_MEMORY_RING_CACHE_LINE - sizeof(int64_t)];
+};
+
+/*
+ * A single-producer single-consumer ring of variable-size records
+ * placed in memory shared by 2 processes.
+ *
+ * A record is [int count][int unused][payload], padded to 8 bytes.
+ * A record never wraps around: when it does not fit before the end of the
+ * ring, the producer writes a padding marker and starts again at offset 0.
+ *
+ * This structure is local to a process; only the header and the data
+ * are shared.
+ */
+struct thorium_shared_memory_ring {
+    struct thorium_shared_memory_ring_header *header;
+    char *data;
+    int capacity;
+};
+
+/*
+ * Return the number of bytes needed in the segment for a ring.
+ * The capacity must be a power of 2.
+ */
+int thorium_shared_memory_ring_footprint(int capacity);
+
+/*
+ * Attach a ring to memory. Only one of the 2 processes
+ * (the one that owns the segment) must call
+ * thorium_shared_memory_ring_clear.
+ */
+void thorium_shared_memory_ring_init(struct thorium_shared_memory_ring *self, void *memory, int capacity);
+void thorium_shared_memory_ring_destroy(struct thorium_shared_memory_ring *self);
+void thorium_shared_memory_ring_clear(struct thorium_shared_memory_ring *self);
+
+/*
+ * Largest payload that can ever be pushed.
+ */
+int thorium_shared_memory_ring_maximum_count(struct thorium_shared_memory_ring *self);
+
+/*
+ * Called by the producer. Returns 0 if the ring is full.
+ */
+int thorium_shared_memory_ring_push(struct thorium_shared_memory_ring *self, void *buffer, int count);
+
+/*
+ * Called by the consumer. Returns the count of the next record,
+ * or -1 if the ring is empty.
+ */
+int thorium_shared_memory_ring_peek(struct thorium_shared_memory_ring *self);
+
+/*
+ * Called by the consumer after a successful peek. Copy the
+ * payload to buffer and release the record.
+ */
+void thorium_shared_memory_ring_pop(struct thorium_shared_memory_ring *self, void *buffer);
+
+#endif
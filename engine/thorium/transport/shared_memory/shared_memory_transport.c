@@ -0,0 +1,742 @@
+
+#include "shared_memory_transport.h"
+
+#include <engine/thorium/transport/transport.h>
+
+#include <engine/thorium/worker_buffer.h>
+#include <engine/thorium/message.h>
+
+#include <core/system/command.h>
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+#include <core/system/timer.h>
+
+#include <mpi.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+#define DEBUG_SHARED_MEMORY_TRANSPORT
+*/
+
+#define MEMORY_SHARED_MEMORY_TRANSPORT 0x4c1f3a6e
+
+#define RING_SIZE_OPTION "-shared-memory-ring-size"
+
+#define DEFAULT_RING_CAPACITY (1 << 20)
+#define MINIMUM_RING_CAPACITY 4096
+
+#define SEGMENT_NAME_LENGTH 64
+
+/*
+ * The first cache line of a segment holds the token of its owner.
+ */
+#define SEGMENT_HEADER_SIZE THORIUM_SHARED_MEMORY_RING_CACHE_LINE
+
+struct thorium_transport_interface thorium_shared_memory_transport_implementation = {
+    .name = "shared_memory_transport",
+    .size = sizeof(struct thorium_shared_memory_transport),
+    .init = thorium_shared_memory_transport_init,
+    .destroy = thorium_shared_memory_transport_destroy,
+    .send = thorium_shared_memory_transport_send,
+    .receive = thorium_shared_memory_transport_receive,
+    .test = thorium_shared_memory_transport_test,
+    .test_some = thorium_shared_memory_transport_test_some
+};
+
+static void thorium_shared_memory_transport_find_peers(struct thorium_transport *self);
+static int thorium_shared_memory_transport_map_segments(struct thorium_transport *self);
+static void thorium_shared_memory_transport_unmap_segments(struct thorium_transport *self);
+static void thorium_shared_memory_transport_get_segment_name(char *name, int *identifiers, int rank);
+static uint64_t thorium_shared_memory_transport_generate_token(struct thorium_transport *self,
+                void *segment);
+static void thorium_shared_memory_transport_drop_peers(struct thorium_transport *self,
+                int *reachable, int *peer_reachable);
+static void thorium_shared_memory_transport_flush_pending_sends(struct thorium_transport *self);
+static int thorium_shared_memory_transport_receive_local(struct thorium_transport *self,
+                struct thorium_message *message);
+
+void thorium_shared_memory_transport_init(struct thorium_transport *self, int *argc, char ***argv)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    int capacity;
+    int requested_capacity;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    /*
+     * Initialize MPI first since the rank, the size and the communicator
+     * are needed to find co-located ranks.
+     */
+    thorium_mpi1_pt2pt_nonblocking_transport_init(self, argc, argv);
+
+    concrete_self->peer_indices = NULL;
+    concrete_self->peers = NULL;
+    concrete_self->peer_count = 0;
+    concrete_self->inbound_rings = NULL;
+    concrete_self->outbound_rings = NULL;
+    concrete_self->pending_sends = NULL;
+    concrete_self->pending_send_count = 0;
+    concrete_self->segment = NULL;
+    concrete_self->peer_segments = NULL;
+    concrete_self->segment_size = 0;
+    concrete_self->current_ring = 0;
+    concrete_self->poll_mpi = 0;
+
+    core_fast_queue_init(&concrete_self->completed_sends, sizeof(struct thorium_worker_buffer));
+
+    capacity = DEFAULT_RING_CAPACITY;
+
+    if (core_command_has_argument(*argc, *argv, RING_SIZE_OPTION)) {
+        requested_capacity = core_command_get_argument_value_int(*argc, *argv, RING_SIZE_OPTION);
+
+        capacity = MINIMUM_RING_CAPACITY;
+
+        while (capacity < requested_capacity) {
+            capacity *= 2;
+        }
+    }
+
+    concrete_self->ring_capacity = capacity;
+
+    thorium_shared_memory_transport_find_peers(self);
+
+    if (!thorium_shared_memory_transport_map_segments(self)) {
+
+        if (self->rank == 0) {
+            printf("thorium_shared_memory_transport: shared memory is not available, using MPI\n");
+        }
+
+        for (i = 0; i < self->size; ++i) {
+            concrete_self->peer_indices[i] = -1;
+        }
+
+        concrete_self->peer_count = 0;
+    }
+
+    concrete_self->maximum_message_size = 0;
+
+    if (concrete_self->peer_count > 0) {
+        concrete_self->maximum_message_size =
+                thorium_shared_memory_ring_maximum_count(concrete_self->inbound_rings + 0);
+
+        concrete_self->pending_sends = core_memory_allocate(concrete_self->peer_count * sizeof(struct core_fast_queue),
+                        MEMORY_SHARED_MEMORY_TRANSPORT);
+
+        for (i = 0; i < concrete_self->peer_count; ++i) {
+            core_fast_queue_init(concrete_self->pending_sends + i, sizeof(struct thorium_shared_memory_send));
+        }
+    }
+
+#ifdef DEBUG_SHARED_MEMORY_TRANSPORT
+    printf("DEBUG rank %d has %d co-located ranks, ring capacity %d\n",
+                    self->rank, concrete_self->peer_count, concrete_self->ring_capacity);
+#endif
+}
+
+void thorium_shared_memory_transport_destroy(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    CORE_DEBUGGER_ASSERT(concrete_self->pending_send_count == 0);
+
+    if (concrete_self->pending_sends != NULL) {
+        for (i = 0; i < concrete_self->peer_count; ++i) {
+            core_fast_queue_destroy(concrete_self->pending_sends + i);
+        }
+
+        core_memory_free(concrete_self->pending_sends, MEMORY_SHARED_MEMORY_TRANSPORT);
+        concrete_self->pending_sends = NULL;
+    }
+
+    core_fast_queue_destroy(&concrete_self->completed_sends);
+
+    thorium_shared_memory_transport_unmap_segments(self);
+
+    core_memory_free(concrete_self->peer_indices, MEMORY_SHARED_MEMORY_TRANSPORT);
+    concrete_self->peer_indices = NULL;
+
+    core_memory_free(concrete_self->peers, MEMORY_SHARED_MEMORY_TRANSPORT);
+    concrete_self->peers = NULL;
+    concrete_self->peer_count = 0;
+
+    /*
+     * This calls MPI_Finalize, so it is done last.
+     */
+    thorium_mpi1_pt2pt_nonblocking_transport_destroy(self);
+}
+
+int thorium_shared_memory_transport_send(struct thorium_transport *self, struct thorium_message *message)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_send send;
+    struct thorium_worker_buffer worker_buffer;
+    struct core_fast_queue *pending_sends;
+    int destination;
+    int index;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    destination = thorium_message_destination_node(message);
+    index = concrete_self->peer_indices[destination];
+
+    send.buffer = thorium_message_buffer(message);
+    send.count = thorium_message_count(message);
+    send.worker = thorium_message_worker(message);
+
+    /*
+     * Messages to other hosts and messages that are too large for a ring
+     * use MPI. Like with the big messages of the MPI transport, such a
+     * message may be delivered before smaller ones sent earlier.
+     */
+    if (index < 0 || send.count > concrete_self->maximum_message_size) {
+        return thorium_mpi1_pt2pt_nonblocking_transport_send(self, message);
+    }
+
+    pending_sends = concrete_self->pending_sends + index;
+
+    /*
+     * The ring is tried only if no earlier message is waiting, to keep
+     * the order of messages between 2 ranks.
+     */
+    if (core_fast_queue_empty(pending_sends)
+                    && thorium_shared_memory_ring_push(concrete_self->outbound_rings + index,
+                            send.buffer, send.count)) {
+
+        /*
+         * The payload is in the ring already, so the buffer can be
+         * returned by the next test operation.
+         */
+        thorium_worker_buffer_init(&worker_buffer, send.worker, send.buffer);
+        core_fast_queue_enqueue(&concrete_self->completed_sends, &worker_buffer);
+
+        return 1;
+    }
+
+    core_fast_queue_enqueue(pending_sends, &send);
+    ++concrete_self->pending_send_count;
+
+    return 1;
+}
+
+int thorium_shared_memory_transport_receive(struct thorium_transport *self, struct thorium_message *message)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    thorium_shared_memory_transport_flush_pending_sends(self);
+
+    /*
+     * Alternate between the rings and MPI so that a busy co-located rank
+     * does not starve the ranks on other hosts.
+     */
+    concrete_self->poll_mpi = !concrete_self->poll_mpi;
+
+    if (concrete_self->poll_mpi) {
+        if (thorium_mpi1_pt2pt_nonblocking_transport_receive(self, message)) {
+            return 1;
+        }
+
+        return thorium_shared_memory_transport_receive_local(self, message);
+    }
+
+    if (thorium_shared_memory_transport_receive_local(self, message)) {
+        return 1;
+    }
+
+    return thorium_mpi1_pt2pt_nonblocking_transport_receive(self, message);
+}
+
+int thorium_shared_memory_transport_test(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    thorium_shared_memory_transport_flush_pending_sends(self);
+
+    if (core_fast_queue_dequeue(&concrete_self->completed_sends, worker_buffer)) {
+        return 1;
+    }
+
+    return thorium_mpi1_pt2pt_nonblocking_transport_test(self, worker_buffer);
+}
+
+int thorium_shared_memory_transport_test_some(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                int maximum)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    int count;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    thorium_shared_memory_transport_flush_pending_sends(self);
+
+    count = 0;
+
+    while (count < maximum
+                    && core_fast_queue_dequeue(&concrete_self->completed_sends, worker_buffers + count)) {
+        ++count;
+    }
+
+    if (count < maximum) {
+        count += thorium_mpi1_pt2pt_nonblocking_transport_test_some(self, worker_buffers + count,
+                        maximum - count);
+    }
+
+    return count;
+}
+
+static int thorium_shared_memory_transport_receive_local(struct thorium_transport *self,
+                struct thorium_message *message)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_ring *ring;
+    int i;
+    int index;
+    int count;
+    void *buffer;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    for (i = 0; i < concrete_self->peer_count; ++i) {
+
+        index = (concrete_self->current_ring + i) % concrete_self->peer_count;
+        ring = concrete_self->inbound_rings + index;
+
+        count = thorium_shared_memory_ring_peek(ring);
+
+        if (count < 0) {
+            continue;
+        }
+
+        buffer = NULL;
+
+        if (count > 0) {
+            buffer = core_memory_pool_allocate(self->inbound_message_memory_pool, count);
+        }
+
+        thorium_shared_memory_ring_pop(ring, buffer);
+
+        concrete_self->current_ring = (index + 1) % concrete_self->peer_count;
+
+        /*
+         * Like for MPI, the worker is -1 and the buffer goes back
+         * to the inbound_message_memory_pool.
+         */
+        thorium_message_init_with_nodes(message, count, buffer, concrete_self->peers[index],
+                        thorium_transport_get_rank(self));
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Move waiting messages to the rings. The first message that does not fit
+ * stops the copy for its ring, and the remaining messages are put back in
+ * the queue in the same order.
+ */
+static void thorium_shared_memory_transport_flush_pending_sends(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_send send;
+    struct thorium_worker_buffer worker_buffer;
+    struct core_fast_queue *pending_sends;
+    int i;
+    int size;
+    int blocked;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    if (concrete_self->pending_send_count == 0) {
+        return;
+    }
+
+    for (i = 0; i < concrete_self->peer_count; ++i) {
+
+        pending_sends = concrete_self->pending_sends + i;
+        size = core_fast_queue_size(pending_sends);
+        blocked = 0;
+
+        while (size-- > 0) {
+            core_fast_queue_dequeue(pending_sends, &send);
+
+            if (!blocked && thorium_shared_memory_ring_push(concrete_self->outbound_rings + i,
+                                    send.buffer, send.count)) {
+
+                thorium_worker_buffer_init(&worker_buffer, send.worker, send.buffer);
+                core_fast_queue_enqueue(&concrete_self->completed_sends, &worker_buffer);
+                --concrete_self->pending_send_count;
+
+            } else {
+                blocked = 1;
+                core_fast_queue_enqueue(pending_sends, &send);
+            }
+        }
+    }
+}
+
+/*
+ * Ranks with the same MPI processor name are on the same host.
+ */
+static void thorium_shared_memory_transport_find_peers(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    char name[MPI_MAX_PROCESSOR_NAME];
+    char *names;
+    int length;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    memset(name, 0, sizeof(name));
+    MPI_Get_processor_name(name, &length);
+
+    names = core_memory_allocate(self->size * MPI_MAX_PROCESSOR_NAME, MEMORY_SHARED_MEMORY_TRANSPORT);
+
+    MPI_Allgather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                    names, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                    concrete_self->mpi_transport.communicator);
+
+    concrete_self->peer_indices = core_memory_allocate(self->size * sizeof(int), MEMORY_SHARED_MEMORY_TRANSPORT);
+    concrete_self->peers = core_memory_allocate(self->size * sizeof(int), MEMORY_SHARED_MEMORY_TRANSPORT);
+    concrete_self->peer_count = 0;
+
+    for (i = 0; i < self->size; ++i) {
+
+        concrete_self->peer_indices[i] = -1;
+
+        if (i == self->rank
+                        || strcmp(name, names + i * MPI_MAX_PROCESSOR_NAME) != 0) {
+            continue;
+        }
+
+        concrete_self->peers[concrete_self->peer_count] = i;
+        concrete_self->peer_indices[i] = concrete_self->peer_count;
+        ++concrete_self->peer_count;
+    }
+
+    core_memory_free(names, MEMORY_SHARED_MEMORY_TRANSPORT);
+}
+
+/*
+ * Each rank creates its segment, then maps the segments of its peers,
+ * then unlinks its segment. The collective operations are called by every
+ * rank, including those without peers, and return 0 everywhere if any rank
+ * could not create its segment.
+ *
+ * In the segment of a rank, the ring for a peer is at the index of the peer
+ * in the co-located ranks of that rank (sorted, without itself).
+ *
+ * The same processor name does not imply the same /dev/shm (for example
+ * with containers). So each rank writes a token in its segment, and a peer
+ * is kept only if both ranks found the token of the other one.
+ */
+static int thorium_shared_memory_transport_map_segments(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    MPI_Comm communicator;
+    char name[SEGMENT_NAME_LENGTH];
+    int identifiers[2];
+    int footprint;
+    int ok;
+    int all_ok;
+    int created;
+    int position;
+    int slot;
+    int peer;
+    int fd;
+    int i;
+    void *memory;
+    uint64_t token;
+    uint64_t *tokens;
+    int *reachable;
+    int *peer_reachable;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+    communicator = concrete_self->mpi_transport.communicator;
+
+    /*
+     * Segment names must be unique for the job.
+     */
+    identifiers[0] = getpid();
+    identifiers[1] = time(NULL);
+
+    MPI_Bcast(identifiers, 2, MPI_INT, 0, communicator);
+
+    footprint = thorium_shared_memory_ring_footprint(concrete_self->ring_capacity);
+    concrete_self->segment_size = SEGMENT_HEADER_SIZE + (size_t)footprint * concrete_self->peer_count;
+
+    ok = 1;
+    created = 0;
+    token = 0;
+
+    if (concrete_self->peer_count > 0) {
+
+        concrete_self->inbound_rings = core_memory_allocate(concrete_self->peer_count * sizeof(struct thorium_shared_memory_ring),
+                        MEMORY_SHARED_MEMORY_TRANSPORT);
+        concrete_self->outbound_rings = core_memory_allocate(concrete_self->peer_count * sizeof(struct thorium_shared_memory_ring),
+                        MEMORY_SHARED_MEMORY_TRANSPORT);
+        concrete_self->peer_segments = core_memory_allocate(concrete_self->peer_count * sizeof(void *),
+                        MEMORY_SHARED_MEMORY_TRANSPORT);
+
+        for (i = 0; i < concrete_self->peer_count; ++i) {
+            concrete_self->peer_segments[i] = NULL;
+        }
+
+        thorium_shared_memory_transport_get_segment_name(name, identifiers, self->rank);
+
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+        if (fd < 0) {
+            ok = 0;
+        } else {
+            created = 1;
+
+            if (ftruncate(fd, concrete_self->segment_size) != 0) {
+                ok = 0;
+            } else {
+                memory = mmap(NULL, concrete_self->segment_size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+
+                if (memory == MAP_FAILED) {
+                    ok = 0;
+                } else {
+                    concrete_self->segment = memory;
+                }
+            }
+
+            close(fd);
+        }
+
+        if (ok) {
+            token = thorium_shared_memory_transport_generate_token(self, concrete_self->segment);
+            *(uint64_t *)concrete_self->segment = token;
+        }
+
+        for (i = 0; ok && i < concrete_self->peer_count; ++i) {
+            thorium_shared_memory_ring_init(concrete_self->inbound_rings + i,
+                            (char *)concrete_self->segment + SEGMENT_HEADER_SIZE + (size_t)i * footprint,
+                            concrete_self->ring_capacity);
+            thorium_shared_memory_ring_clear(concrete_self->inbound_rings + i);
+        }
+    }
+
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, communicator);
+
+    tokens = core_memory_allocate(self->size * sizeof(uint64_t), MEMORY_SHARED_MEMORY_TRANSPORT);
+    reachable = core_memory_allocate(self->size * sizeof(int), MEMORY_SHARED_MEMORY_TRANSPORT);
+    peer_reachable = core_memory_allocate(self->size * sizeof(int), MEMORY_SHARED_MEMORY_TRANSPORT);
+
+    MPI_Allgather(&token, sizeof(token), MPI_BYTE,
+                    tokens, sizeof(token), MPI_BYTE, communicator);
+
+    for (i = 0; i < self->size; ++i) {
+        reachable[i] = 0;
+    }
+
+    if (all_ok && concrete_self->peer_count > 0) {
+
+        /*
+         * Number of co-located ranks before this one.
+         */
+        position = 0;
+
+        while (position < concrete_self->peer_count
+                        && concrete_self->peers[position] < self->rank) {
+            ++position;
+        }
+
+        for (i = 0; i < concrete_self->peer_count; ++i) {
+
+            peer = concrete_self->peers[i];
+            thorium_shared_memory_transport_get_segment_name(name, identifiers, peer);
+
+            fd = shm_open(name, O_RDWR, S_IRUSR | S_IWUSR);
+
+            if (fd < 0) {
+                continue;
+            }
+
+            memory = mmap(NULL, concrete_self->segment_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (memory == MAP_FAILED) {
+                continue;
+            }
+
+            /*
+             * Another segment with the same name in another /dev/shm.
+             */
+            if (*(uint64_t *)memory != tokens[peer]) {
+                munmap(memory, concrete_self->segment_size);
+                continue;
+            }
+
+            concrete_self->peer_segments[i] = memory;
+            reachable[peer] = 1;
+
+            slot = position;
+
+            if (peer < self->rank) {
+                --slot;
+            }
+
+            thorium_shared_memory_ring_init(concrete_self->outbound_rings + i,
+                            (char *)memory + SEGMENT_HEADER_SIZE + (size_t)slot * footprint,
+                            concrete_self->ring_capacity);
+        }
+    }
+
+    /*
+     * A rank enters this operation after it has tried to map the
+     * segments of its peers.
+     */
+    MPI_Alltoall(reachable, 1, MPI_INT, peer_reachable, 1, MPI_INT, communicator);
+
+    /*
+     * Every peer has mapped the segment (or given up), so the name can
+     * be removed. The memory is released when the last mapping is removed,
+     * even if a rank crashes.
+     */
+    if (created) {
+        thorium_shared_memory_transport_get_segment_name(name, identifiers, self->rank);
+        shm_unlink(name);
+    }
+
+    if (!all_ok) {
+        thorium_shared_memory_transport_unmap_segments(self);
+    } else {
+        thorium_shared_memory_transport_drop_peers(self, reachable, peer_reachable);
+    }
+
+    core_memory_free(tokens, MEMORY_SHARED_MEMORY_TRANSPORT);
+    core_memory_free(reachable, MEMORY_SHARED_MEMORY_TRANSPORT);
+    core_memory_free(peer_reachable, MEMORY_SHARED_MEMORY_TRANSPORT);
+
+    return all_ok;
+}
+
+/*
+ * Send to MPI the peers that did not map the segment of this rank, or
+ * whose segment was not mapped by this rank. Their rings stay in the
+ * segments, unused, so that the slots of the other peers do not move.
+ */
+static void thorium_shared_memory_transport_drop_peers(struct thorium_transport *self,
+                int *reachable, int *peer_reachable)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    int active_peers;
+    int peer;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    active_peers = 0;
+
+    for (i = 0; i < concrete_self->peer_count; ++i) {
+
+        peer = concrete_self->peers[i];
+
+        if (reachable[peer] && peer_reachable[peer]) {
+            ++active_peers;
+            continue;
+        }
+
+        printf("thorium_shared_memory_transport: rank %d does not share memory with rank %d, using MPI\n",
+                        self->rank, peer);
+
+        concrete_self->peer_indices[peer] = -1;
+
+        if (concrete_self->peer_segments[i] != NULL) {
+            munmap(concrete_self->peer_segments[i], concrete_self->segment_size);
+            concrete_self->peer_segments[i] = NULL;
+        }
+    }
+
+    if (active_peers == 0) {
+        thorium_shared_memory_transport_unmap_segments(self);
+        concrete_self->peer_count = 0;
+    }
+}
+
+/*
+ * The token only needs to differ from the tokens of other jobs that
+ * could use the same segment name.
+ */
+static uint64_t thorium_shared_memory_transport_generate_token(struct thorium_transport *self,
+                void *segment)
+{
+    struct core_timer timer;
+    uint64_t token;
+
+    core_timer_init(&timer);
+    token = core_timer_get_nanoseconds(&timer);
+    core_timer_destroy(&timer);
+
+    token ^= (uint64_t)getpid() << 32;
+    token ^= (uint64_t)(uintptr_t)segment;
+    token ^= (uint64_t)self->rank << 48;
+
+    /*
+     * 0 is the token of ranks without a segment.
+     */
+    return token | 1;
+}
+
+static void thorium_shared_memory_transport_unmap_segments(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    if (concrete_self->peer_segments != NULL) {
+        for (i = 0; i < concrete_self->peer_count; ++i) {
+            if (concrete_self->peer_segments[i] != NULL) {
+                munmap(concrete_self->peer_segments[i], concrete_self->segment_size);
+            }
+        }
+
+        core_memory_free(concrete_self->peer_segments, MEMORY_SHARED_MEMORY_TRANSPORT);
+        concrete_self->peer_segments = NULL;
+    }
+
+    if (concrete_self->segment != NULL) {
+        munmap(concrete_self->segment, concrete_self->segment_size);
+        concrete_self->segment = NULL;
+    }
+
+    if (concrete_self->inbound_rings != NULL) {
+        core_memory_free(concrete_self->inbound_rings, MEMORY_SHARED_MEMORY_TRANSPORT);
+        concrete_self->inbound_rings = NULL;
+    }
+
+    if (concrete_self->outbound_rings != NULL) {
+        core_memory_free(concrete_self->outbound_rings, MEMORY_SHARED_MEMORY_TRANSPORT);
+        concrete_self->outbound_rings = NULL;
+    }
+}
+
+static void thorium_shared_memory_transport_get_segment_name(char *name, int *identifiers, int rank)
+{
+    snprintf(name, SEGMENT_NAME_LENGTH, "/thorium-%x-%x-%d",
+                    (unsigned int)identifiers[0], (unsigned int)identifiers[1], rank);
+}
@@ -0,0 +1,88 @@
+
+#ifndef THORIUM_SHARED_MEMORY_TRANSPORT_H
+#define THORIUM_SHARED_MEMORY_TRANSPORT_H
+
+#include "shared_memory_ring.h"
+
+#include <engine/thorium/transport/mpi1_pt2pt_nonblocking/mpi1_pt2pt_nonblocking_transport.h>
+#include <engine/thorium/transport/transport_interface.h>
+
+#include <core/structures/fast_queue.h>
+
+#include <stddef.h>
+
+struct thorium_transport;
+struct thorium_message;
+struct thorium_worker_buffer;
+
+/*
+ * A message waiting for room in the ring of a co-located rank.
+ */
+struct thorium_shared_memory_send {
+    void *buffer;
+    int count;
+    int worker;
+};
+
+/*
+ * Transport for runs with more than one rank per host.
+ *
+ * Ranks on the same host (same MPI processor name) exchange messages
+ * through single-producer single-consumer rings in POSIX shared memory.
+ * Each rank owns one segment with one inbound ring per co-located rank.
+ * A token written in each segment confirms that 2 ranks really share it.
+ * Messages to other hosts, and messages too large for a ring, use the
+ * MPI 1 nonblocking transport.
+ *
+ * Select it with -transport shared_memory_transport
+ */
+struct thorium_shared_memory_transport {
+
+    /*
+     * This must be the first member since the MPI functions
+     * receive the same concrete transport.
+     */
+    struct thorium_mpi1_pt2pt_nonblocking_transport mpi_transport;
+
+    /*
+     * For each rank, the index of the rank in the local peers,
+     * or -1 if the rank is on another host.
+     */
+    int *peer_indices;
+    int *peers;
+    int peer_count;
+
+    struct thorium_shared_memory_ring *inbound_rings;
+    struct thorium_shared_memory_ring *outbound_rings;
+    struct core_fast_queue *pending_sends;
+    int pending_send_count;
+
+    /*
+     * Sends that were copied in a ring. Their buffers
+     * are returned by the test operation.
+     */
+    struct core_fast_queue completed_sends;
+
+    void *segment;
+    void **peer_segments;
+    size_t segment_size;
+
+    int ring_capacity;
+    int maximum_message_size;
+    int current_ring;
+    int poll_mpi;
+};
+
+extern struct thorium_transport_interface thorium_shared_memory_transport_implementation;
+
+void thorium_shared_memory_transport_init(struct thorium_transport *self, int *argc, char ***argv);
+void thorium_shared_memory_transport_destroy(struct thorium_transport *self);
+
+int thorium_shared_memory_transport_send(struct thorium_transport *self, struct thorium_message *message);
+int thorium_shared_memory_transport_receive(struct thorium_transport *self, struct thorium_message *message);
+
+int thorium_shared_memory_transport_test(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer);
+int thorium_shared_memory_transport_test_some(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                int maximum);
+
+#endif
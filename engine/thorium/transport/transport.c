@@ -11,6 +11,7 @@
 
 #include "mpi1_pt2pt/mpi1_pt2pt_transport.h"
 #include "mpi1_pt2pt_nonblocking/mpi1_pt2pt_nonblocking_transport.h"
+#include "shared_memory/shared_memory_transport.h"
 
 #include <core/system/command.h>
 #include <core/helpers/bitmap.h>
@@ -231,6 +232,37 @@ int thorium_transport_test(struct thorium_transport *self, struct thorium_worker
     return value;
 }
 
+int thorium_transport_test_some(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                int maximum)
+{
+    int count;
+    int i;
+
+    if (self->transport_interface == NULL) {
+        return 0;
+    }
+
+    count = 0;
+
+    if (self->transport_interface->test_some != NULL) {
+        count = self->transport_interface->test_some(self, worker_buffers, maximum);
+
+    /*
+     * Otherwise, test one request at a time.
+     */
+    } else {
+        for (i = 0; i < maximum; ++i) {
+            if (self->transport_interface->test(self, worker_buffers + count)) {
+                ++count;
+            }
+        }
+    }
+
+    self->active_request_count -= count;
+
+    return count;
+}
+
 void *thorium_transport_get_concrete_transport(struct thorium_transport *self)
 {
     return self->concrete_transport;
@@ -260,6 +292,12 @@ void thorium_transport_select_implementation(struct thorium_transport *self, int
     component = &thorium_mpi1_pt2pt_transport_implementation;
     core_vector_push_back(&implementations, &component);
 
+    /*
+     * Shared memory between ranks on the same host, MPI for the others.
+     */
+    component = &thorium_shared_memory_transport_implementation;
+    core_vector_push_back(&implementations, &component);
+
     /*
      * Only enable the pami thing on Blue Gene/Q.
      */
@@ -355,3 +393,12 @@ void thorium_transport_print_event(struct thorium_transport *self, int type, str
                     time, description,
                     source_rank, destination_rank, count);
 }
+
+void thorium_transport_profile_multiplexer_flush(struct thorium_transport *self,
+                int reason, int message_count, int timeout)
+{
+    if (core_bitmap_get_bit_uint32_t(&self->flags, FLAG_PROFILE)) {
+        thorium_transport_profiler_multiplexer_flush(&self->transport_profiler, reason,
+                        message_count, timeout);
+    }
+}
@@ -64,6 +64,13 @@ const char *thorium_transport_get_name(struct thorium_transport *self);
 
 int thorium_transport_test(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer);
 
+/*
+ * Get up to maximum completed worker buffers.
+ * \returns the number of worker buffers.
+ */
+int thorium_transport_test_some(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                int maximum);
+
 int thorium_transport_get_active_request_count(struct thorium_transport *self);
 
 void *thorium_transport_get_concrete_transport(struct thorium_transport *self);
@@ -72,4 +79,10 @@ void thorium_transport_select_implementation(struct thorium_transport *self, int
 void thorium_transport_print(struct thorium_transport *self);
 void thorium_transport_print_event(struct thorium_transport *self, int type, struct thorium_message *message);
 
+/*
+ * Record a decision of the message multiplexer in the profiler.
+ */
+void thorium_transport_profile_multiplexer_flush(struct thorium_transport *self,
+                int reason, int message_count, int timeout);
+
 #endif
@@ -42,6 +42,14 @@ struct thorium_transport_interface {
      * and buffer pointer.
      */
     int (*test)(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer);
+
+    /*
+     * Optional. Test many requests at once and store up to maximum
+     * worker buffers to recycle.
+     * \returns the number of worker buffers stored.
+     */
+    int (*test_some)(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffers,
+                    int maximum);
 };
 
 #endif
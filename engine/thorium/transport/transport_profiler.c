@@ -8,57 +8,103 @@
 #include <core/structures/map_iterator.h>
 
 #include <stdio.h>
+#include <inttypes.h>
+
+static void thorium_transport_profiler_print_map(struct core_map *map);
 
 void thorium_transport_profiler_init(struct thorium_transport_profiler *self)
 {
+    int i;
+
     self->rank = -1;
     core_map_init(&self->buffer_sizes, sizeof(int), sizeof(int));
+
+    for (i = 0; i < THORIUM_MULTIPLEXER_FLUSH_REASONS; ++i) {
+        self->multiplexer_flushes[i] = 0;
+    }
+
+    self->multiplexer_timeout_sum = 0;
+    core_map_init(&self->multiplexed_message_counts, sizeof(int), sizeof(int));
 }
 
 void thorium_transport_profiler_destroy(struct thorium_transport_profiler *self)
 {
     self->rank = -1;
     core_map_destroy(&self->buffer_sizes);
+    core_map_destroy(&self->multiplexed_message_counts);
 }
 
 void thorium_transport_profiler_print_report(struct thorium_transport_profiler *self)
 {
-    struct core_map_iterator iterator;
-    struct core_vector_iterator vector_iterator;
-    int buffer_size;
-    int frequency;
-    struct core_vector sizes;
+    uint64_t flushes;
+    int i;
 
     printf("Thorium Transport Profiler Report, node/%d\n",
                     self->rank);
 
-    core_vector_init(&sizes, sizeof(int));
-    core_map_iterator_init(&iterator, &self->buffer_sizes);
+    printf("Buffer sizes:\n");
+    printf("ByteCount\tFrequency\n");
+
+    thorium_transport_profiler_print_map(&self->buffer_sizes);
+
+    flushes = 0;
+
+    for (i = 0; i < THORIUM_MULTIPLEXER_FLUSH_REASONS; ++i) {
+        flushes += self->multiplexer_flushes[i];
+    }
+
+    if (flushes == 0) {
+        return;
+    }
+
+    printf("Multiplexer flushes:\n");
+    printf("Reason\tFrequency\n");
+    printf("size\t%" PRIu64 "\n", self->multiplexer_flushes[THORIUM_MULTIPLEXER_FLUSH_SIZE]);
+    printf("timeout\t%" PRIu64 "\n", self->multiplexer_flushes[THORIUM_MULTIPLEXER_FLUSH_TIMEOUT]);
+    printf("idle\t%" PRIu64 "\n", self->multiplexer_flushes[THORIUM_MULTIPLEXER_FLUSH_IDLE]);
+    printf("Average timeout: %" PRIu64 " ns\n", self->multiplexer_timeout_sum / flushes);
+
+    printf("Multiplexed messages per flush:\n");
+    printf("MessageCount\tFrequency\n");
+
+    thorium_transport_profiler_print_map(&self->multiplexed_message_counts);
+}
+
+/*
+ * Print a map of int frequencies sorted by key.
+ */
+static void thorium_transport_profiler_print_map(struct core_map *map)
+{
+    struct core_map_iterator iterator;
+    struct core_vector_iterator vector_iterator;
+    int key;
+    int frequency;
+    struct core_vector keys;
+
+    core_vector_init(&keys, sizeof(int));
+    core_map_iterator_init(&iterator, map);
 
     while (core_map_iterator_get_next_key_and_value(&iterator,
-                            &buffer_size, NULL)) {
+                            &key, NULL)) {
 
-        core_vector_push_back(&sizes, &buffer_size);
+        core_vector_push_back(&keys, &key);
     }
 
-    core_vector_sort_int(&sizes);
+    core_vector_sort_int(&keys);
     core_map_iterator_destroy(&iterator);
 
-    core_vector_iterator_init(&vector_iterator, &sizes);
-
-    printf("Buffer sizes:\n");
-    printf("ByteCount\tFrequency\n");
+    core_vector_iterator_init(&vector_iterator, &keys);
 
     while (core_vector_iterator_get_next_value(&vector_iterator,
-                            &buffer_size)) {
+                            &key)) {
 
-        core_map_get_value(&self->buffer_sizes, &buffer_size, &frequency);
+        core_map_get_value(map, &key, &frequency);
 
-        printf("%d\t%d\n", buffer_size, frequency);
+        printf("%d\t%d\n", key, frequency);
     }
 
     core_vector_iterator_destroy(&vector_iterator);
-    core_vector_destroy(&sizes);
+    core_vector_destroy(&keys);
 }
 
 void thorium_transport_profiler_send_mock(struct thorium_transport_profiler *self,
@@ -84,3 +130,21 @@ void thorium_transport_profiler_send_mock(struct thorium_transport_profiler *sel
 
     ++(*bucket);
 }
+
+void thorium_transport_profiler_multiplexer_flush(struct thorium_transport_profiler *self,
+                int reason, int message_count, int timeout)
+{
+    int *bucket;
+
+    ++self->multiplexer_flushes[reason];
+    self->multiplexer_timeout_sum += timeout;
+
+    bucket = core_map_get(&self->multiplexed_message_counts, &message_count);
+
+    if (bucket == NULL) {
+        bucket = core_map_add(&self->multiplexed_message_counts, &message_count);
+        *bucket = 0;
+    }
+
+    ++(*bucket);
+}
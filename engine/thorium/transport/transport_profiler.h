@@ -4,8 +4,18 @@
 
 #include <core/structures/map.h>
 
+#include <stdint.h>
+
 struct thorium_message;
 
+/*
+ * Reasons for the flush of a multiplexed buffer.
+ */
+#define THORIUM_MULTIPLEXER_FLUSH_SIZE 0
+#define THORIUM_MULTIPLEXER_FLUSH_TIMEOUT 1
+#define THORIUM_MULTIPLEXER_FLUSH_IDLE 2
+#define THORIUM_MULTIPLEXER_FLUSH_REASONS 3
+
 /*
  * A profiler for the Thorium transport
  * component.
@@ -13,6 +23,13 @@ struct thorium_message;
 struct thorium_transport_profiler {
     struct core_map buffer_sizes;
     int rank;
+
+    /*
+     * Decisions of the message multiplexer.
+     */
+    uint64_t multiplexer_flushes[THORIUM_MULTIPLEXER_FLUSH_REASONS];
+    uint64_t multiplexer_timeout_sum;
+    struct core_map multiplexed_message_counts;
 };
 
 void thorium_transport_profiler_init(struct thorium_transport_profiler *self);
@@ -20,5 +37,7 @@ void thorium_transport_profiler_destroy(struct thorium_transport_profiler *self)
 void thorium_transport_profiler_print_report(struct thorium_transport_profiler *self);
 void thorium_transport_profiler_send_mock(struct thorium_transport_profiler *self,
                 struct thorium_message *message);
+void thorium_transport_profiler_multiplexer_flush(struct thorium_transport_profiler *self,
+                int reason, int message_count, int timeout);
 
 #endif
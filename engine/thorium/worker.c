@@ -3,8 +3,10 @@
 
 #include "message.h"
 #include "node.h"
+#include "worker_pool.h"
 
 #include "scheduler/balancer.h"
+#include "scheduler/work_stealing_scheduler.h"
 
 #include <core/structures/map.h>
 #include <core/structures/vector.h>
@@ -23,6 +25,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 /*#define THORIUM_WORKER_DEBUG
   */
@@ -53,20 +56,11 @@
 #define THORIUM_GRANULARITY_WARNING_THRESHOLD (500 * 1000)
 
 /*
- * The amount required idle time to go to sleep
- * for a worker.
- *
- * The current value is high because it is assumed
- * that they are usually busy.
- *
- * TODO lower this value.
- */
-/*#define THORIUM_WORKER_UNPRODUCTIVE_MICROSECONDS_FOR_WAIT (64 * 1000)*/
-
-/*
- * 30 seconds.
+ * The default spin before parking is high because it is assumed
+ * that workers are usually busy (30 seconds).
  */
-#define THORIUM_WORKER_UNPRODUCTIVE_MICROSECONDS_FOR_WAIT (30 * 1000 * 1000)
+#define DEFAULT_SPIN_MICROSECONDS (30 * 1000 * 1000)
+#define DEFAULT_YIELD_MICROSECONDS 0
 
 /*
  * Worker flags.
@@ -76,9 +70,25 @@
 #define FLAG_DEBUG                      2
 #define FLAG_BUSY                       3
 #define FLAG_ENABLE_ACTOR_LOAD_PROFILER 4
+#define FLAG_ENABLE_WORK_STEALING       5
+#define FLAG_REQUEUE_ACTOR              6
 
 #define DEBUG_WORKER_OPTION "-debug-worker"
 
+/*
+ * Use the work-stealing scheduler instead of the default one.
+ */
+#define WORK_STEALING_OPTION "-enable-work-stealing"
+
+/*
+ * Quantum of an actor activation, in messages and in nanoseconds.
+ */
+#define QUANTUM_MESSAGES_OPTION "-actor-quantum-messages"
+#define QUANTUM_NANOSECONDS_OPTION "-actor-quantum-nanoseconds"
+
+#define DEFAULT_QUANTUM_MESSAGES 1
+#define DEFAULT_QUANTUM_NANOSECONDS 0
+
 /*
 #define THORIUM_WORKER_DEBUG_WAIT_SIGNAL
 */
@@ -96,6 +106,22 @@
 #define THORIUM_WORKER_DEBUG_SYMMETRIC_PLACEMENT
 */
 
+static int thorium_worker_dequeue_actor_with_stealing(struct thorium_worker *worker,
+                struct thorium_actor **actor);
+static int thorium_worker_steal_actor(struct thorium_worker *worker, struct thorium_actor **actor);
+static void thorium_worker_release_actor(struct thorium_worker *worker, struct thorium_actor *actor);
+static void thorium_worker_requeue_actor(struct thorium_worker *worker, struct thorium_actor *actor);
+static int thorium_worker_has_quantum(struct thorium_worker *worker);
+
+#ifdef THORIUM_WORKER_ENABLE_DIRECT_DELIVERY
+static int thorium_worker_deliver_message(struct thorium_worker *worker, struct thorium_message *message);
+#endif
+static int thorium_worker_push_actor(struct thorium_worker *worker, struct thorium_actor *actor);
+static int thorium_worker_take_transferable_buffer(struct thorium_worker *worker, void *buffer);
+static void thorium_worker_free_returned_outbound_buffers(struct thorium_worker *self);
+static void thorium_worker_idle(struct thorium_worker *self);
+static int thorium_worker_has_pending_work(struct thorium_worker *self);
+
 void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium_node *node)
 {
     int capacity;
@@ -103,6 +129,10 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
     int injected_buffer_ring_size;
     int argc;
     char **argv;
+    int scheduler_type;
+    int quantum_nanoseconds;
+    int spin_microseconds;
+    int yield_microseconds;
 
     worker->tick_count = 0;
 
@@ -141,6 +171,7 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
      * 2. Use volatile head and tail.
      */
     core_fast_ring_init(&worker->actors_to_schedule, capacity, sizeof(struct thorium_actor *));
+    core_lock_init(&worker->actors_to_schedule_lock);
 
 #ifdef THORIUM_NODE_INJECT_CLEAN_WORKER_BUFFERS
     injected_buffer_ring_size = capacity;
@@ -155,8 +186,17 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
                     sizeof(struct thorium_message));
 #endif
 
+    core_lock_free_stack_init(&worker->returned_outbound_buffers);
+
+    scheduler_type = THORIUM_SCHEDULER_DEFAULT;
+
+    if (core_command_has_argument(argc, argv, WORK_STEALING_OPTION)) {
+        scheduler_type = THORIUM_WORK_STEALING_SCHEDULER;
+    }
+
     thorium_scheduler_init(&worker->scheduler, thorium_node_name(worker->node),
-                    worker->name);
+                    worker->name, scheduler_type);
+    worker->victim = worker->name;
     core_map_init(&worker->actors, sizeof(int), sizeof(int));
     core_map_iterator_init(&worker->actor_iterator, &worker->actors);
 
@@ -171,6 +211,65 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
     worker->flags = 0;
     core_bitmap_clear_bit_uint32_t(&worker->flags, FLAG_DEBUG_ACTORS);
 
+    if (thorium_scheduler_supports_stealing(&worker->scheduler)) {
+        core_bitmap_set_bit_uint32_t(&worker->flags, FLAG_ENABLE_WORK_STEALING);
+    }
+
+    worker->quantum_messages = DEFAULT_QUANTUM_MESSAGES;
+    worker->quantum_nanoseconds = DEFAULT_QUANTUM_NANOSECONDS;
+
+    if (core_command_has_argument(argc, argv, QUANTUM_MESSAGES_OPTION)) {
+        worker->quantum_messages = core_command_get_argument_value_int(argc, argv,
+                        QUANTUM_MESSAGES_OPTION);
+
+        if (worker->quantum_messages < 1) {
+            worker->quantum_messages = 1;
+        }
+    }
+
+    if (core_command_has_argument(argc, argv, QUANTUM_NANOSECONDS_OPTION)) {
+        quantum_nanoseconds = core_command_get_argument_value_int(argc, argv,
+                        QUANTUM_NANOSECONDS_OPTION);
+
+        if (quantum_nanoseconds > 0) {
+            worker->quantum_nanoseconds = quantum_nanoseconds;
+
+            /*
+             * Only the time limits the quantum.
+             */
+            if (!core_command_has_argument(argc, argv, QUANTUM_MESSAGES_OPTION)) {
+                worker->quantum_messages = INT_MAX;
+            }
+        }
+    }
+
+    spin_microseconds = DEFAULT_SPIN_MICROSECONDS;
+    yield_microseconds = DEFAULT_YIELD_MICROSECONDS;
+
+    if (core_command_has_argument(argc, argv, THORIUM_WORKER_SPIN_MICROSECONDS_OPTION)) {
+        spin_microseconds = core_command_get_argument_value_int(argc, argv,
+                        THORIUM_WORKER_SPIN_MICROSECONDS_OPTION);
+    }
+
+    if (core_command_has_argument(argc, argv, THORIUM_WORKER_YIELD_MICROSECONDS_OPTION)) {
+        yield_microseconds = core_command_get_argument_value_int(argc, argv,
+                        THORIUM_WORKER_YIELD_MICROSECONDS_OPTION);
+    }
+
+    if (spin_microseconds < 0) {
+        spin_microseconds = 0;
+    }
+
+    if (yield_microseconds < 0) {
+        yield_microseconds = 0;
+    }
+
+    /*
+     * There are 1000 nanoseconds in 1 microsecond.
+     */
+    worker->spin_nanoseconds = (uint64_t)spin_microseconds * 1000;
+    worker->yield_nanoseconds = (uint64_t)yield_microseconds * 1000;
+
     if (core_command_has_argument(argc, argv, DEBUG_WORKER_OPTION)) {
 
 #if 0
@@ -208,6 +307,7 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
 
     core_memory_pool_disable_tracking(&worker->ephemeral_memory);
     core_memory_pool_enable_ephemeral_mode(&worker->ephemeral_memory);
+    core_memory_pool_enable_slab_mode(&worker->ephemeral_memory);
 
 #ifdef THORIUM_WORKER_ENABLE_LOCK
     core_lock_init(&worker->lock);
@@ -215,6 +315,13 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
 
     core_set_init(&worker->evicted_actors, sizeof(int));
 
+#ifdef THORIUM_NODE_USE_COUNTERS
+    core_counter_init(&worker->counter);
+#endif
+
+    worker->zero_copy_buffer = NULL;
+    core_set_init(&worker->transferable_buffers, sizeof(void *));
+
     core_memory_pool_init(&worker->outbound_message_memory_pool,
                     CORE_MEMORY_POOL_MESSAGE_BUFFER_BLOCK_SIZE, MEMORY_POOL_NAME_WORKER_OUTBOUND);
 
@@ -232,6 +339,7 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
      */
     core_memory_pool_enable_normalization(&worker->outbound_message_memory_pool);
     core_memory_pool_enable_alignment(&worker->outbound_message_memory_pool);
+    core_memory_pool_enable_slab_mode(&worker->outbound_message_memory_pool);
 
     worker->ticks_without_production = 0;
 
@@ -269,6 +377,8 @@ void thorium_worker_destroy(struct thorium_worker *worker)
     /*
     thorium_worker_print_balance(worker);
     */
+    thorium_worker_free_returned_outbound_buffers(worker);
+
     while (thorium_worker_fetch_clean_outbound_buffer(worker, &buffer)) {
 
         core_memory_pool_free(&worker->outbound_message_memory_pool, buffer);
@@ -297,6 +407,7 @@ void thorium_worker_destroy(struct thorium_worker *worker)
 #endif
 
     core_fast_ring_destroy(&worker->actors_to_schedule);
+    core_lock_destroy(&worker->actors_to_schedule_lock);
 
 #ifdef THORIUM_NODE_INJECT_CLEAN_WORKER_BUFFERS
     core_fast_ring_destroy(&worker->injected_clean_outbound_buffers);
@@ -305,6 +416,8 @@ void thorium_worker_destroy(struct thorium_worker *worker)
     core_fast_queue_destroy(&worker->clean_message_queue_for_triage);
 #endif
 
+    core_lock_free_stack_destroy(&worker->returned_outbound_buffers);
+
     thorium_scheduler_destroy(&worker->scheduler);
     core_fast_ring_destroy(&worker->outbound_message_queue);
     core_fast_queue_destroy(&worker->outbound_message_queue_buffer);
@@ -313,6 +426,11 @@ void thorium_worker_destroy(struct thorium_worker *worker)
     core_map_iterator_destroy(&worker->actor_iterator);
     core_set_destroy(&worker->evicted_actors);
 
+#ifdef THORIUM_NODE_USE_COUNTERS
+    core_counter_destroy(&worker->counter);
+#endif
+    core_set_destroy(&worker->transferable_buffers);
+
     worker->node = NULL;
 
     worker->name = -1;
@@ -339,10 +457,12 @@ void thorium_worker_send(struct thorium_worker *worker, struct thorium_message *
 
     /*
      * Allocate a buffer if the actor provided a NULL buffer or if it
-     * provided its own buffer.
+     * provided its own buffer. Buffers allocated by thorium_worker_allocate
+     * are sent as is: the ownership goes to the runtime.
      */
     if (old_buffer == NULL
-                    || old_buffer != worker->zero_copy_buffer) {
+                    || (old_buffer != worker->zero_copy_buffer
+                        && !thorium_worker_take_transferable_buffer(worker, old_buffer))) {
 
         count = thorium_message_count(message);
         /* use slab allocator */
@@ -406,11 +526,139 @@ void thorium_worker_send(struct thorium_worker *worker, struct thorium_message *
      * handle that directly here to avoid locking things
      * with the node.
      */
+    /*
+     * The last allocated buffer is kept if another buffer
+     * was sent.
+     */
+    if (thorium_message_buffer(message) == worker->zero_copy_buffer) {
+        worker->zero_copy_buffer = NULL;
+    }
+
+#ifdef THORIUM_WORKER_ENABLE_DIRECT_DELIVERY
+    if (thorium_worker_deliver_message(worker, message)) {
+        return;
+    }
+#endif
 
     thorium_worker_enqueue_message(worker, message);
-    worker->zero_copy_buffer = NULL;
 }
 
+/*
+ * \return 1 if the buffer was allocated by this worker for an actor
+ * and not sent yet.
+ */
+static int thorium_worker_take_transferable_buffer(struct thorium_worker *worker, void *buffer)
+{
+    if (core_set_size(&worker->transferable_buffers) == 0) {
+        return 0;
+    }
+
+    return core_set_delete(&worker->transferable_buffers, &buffer);
+}
+
+#ifdef THORIUM_WORKER_ENABLE_DIRECT_DELIVERY
+/*
+ * Give a message to a live local actor without going through
+ * the node thread.
+ *
+ * Remote messages, system messages, messages for actors that are dead or that
+ * do not have a worker yet, and messages that do not fit
+ * are left to the node (returns 0).
+ */
+static int thorium_worker_deliver_message(struct thorium_worker *worker, struct thorium_message *message)
+{
+    int destination;
+    int worker_index;
+    int other_worker_index;
+    struct thorium_actor *actor;
+    struct thorium_worker *affinity_worker;
+
+    destination = thorium_message_destination(message);
+
+    if (thorium_node_actor_node(worker->node, destination) != thorium_node_name(worker->node)) {
+        return 0;
+    }
+
+    if (thorium_node_is_system_message(message)) {
+        return 0;
+    }
+
+    actor = thorium_node_get_actor_from_name(worker->node, destination);
+
+    if (actor == NULL || thorium_actor_dead(actor)) {
+        return 0;
+    }
+
+    worker_index = thorium_actor_get_assigned_worker(actor);
+
+    if (worker_index < 0) {
+        return 0;
+    }
+
+    /*
+     * This is done by the node otherwise.
+     */
+    thorium_message_set_worker(message, worker->name);
+    thorium_node_resolve(worker->node, message);
+
+    affinity_worker = thorium_worker_pool_get_worker(thorium_node_get_worker_pool(worker->node),
+                    worker_index);
+
+    /*
+     * Once the message is in the mailbox, scheduling the actor must
+     * not fail.
+     */
+    core_lock_lock(&affinity_worker->actors_to_schedule_lock);
+
+    if (core_fast_ring_is_full_from_producer(&affinity_worker->actors_to_schedule)
+                    || !thorium_actor_enqueue_mailbox_message(actor, message)) {
+
+        core_lock_unlock(&affinity_worker->actors_to_schedule_lock);
+        return 0;
+    }
+
+    thorium_worker_push_actor(affinity_worker, actor);
+
+    core_lock_unlock(&affinity_worker->actors_to_schedule_lock);
+
+    /*
+     * The balancer may have migrated the actor in the meantime.
+     * In that case, the old worker skips the actor since it is evicted,
+     * and the new worker may have run it before the message was in the
+     * mailbox. Hand the actor to the new worker too; the balancer sets
+     * the assigned worker after evicting the actor from the old worker.
+     */
+    other_worker_index = thorium_actor_get_assigned_worker(actor);
+
+    if (other_worker_index != worker_index) {
+        affinity_worker = thorium_worker_pool_get_worker(thorium_node_get_worker_pool(worker->node),
+                    other_worker_index);
+
+        core_lock_lock(&affinity_worker->actors_to_schedule_lock);
+
+        /*
+         * If the ring is full, the new worker finds the actor when it
+         * pokes its actors for inactivity.
+         */
+        thorium_worker_push_actor(affinity_worker, actor);
+
+        core_lock_unlock(&affinity_worker->actors_to_schedule_lock);
+    }
+
+#ifdef THORIUM_NODE_USE_COUNTERS
+    core_counter_add(&worker->counter, CORE_COUNTER_SENT_MESSAGES_TO_SELF, 1);
+    core_counter_add(&worker->counter, CORE_COUNTER_SENT_BYTES_TO_SELF,
+                    thorium_message_count(message));
+
+    core_counter_add(&worker->counter, CORE_COUNTER_RECEIVED_MESSAGES_FROM_SELF, 1);
+    core_counter_add(&worker->counter, CORE_COUNTER_RECEIVED_BYTES_FROM_SELF,
+                    thorium_message_count(message));
+#endif
+
+    return 1;
+}
+#endif
+
 void thorium_worker_start(struct thorium_worker *worker, int processor)
 {
     core_thread_init(&worker->thread, thorium_worker_main, worker);
@@ -592,6 +840,10 @@ int thorium_worker_dequeue_actor(struct thorium_worker *worker, struct thorium_a
     int status;
     int mailbox_size;
 
+    if (core_bitmap_get_bit_uint32_t(&worker->flags, FLAG_ENABLE_WORK_STEALING)) {
+        return thorium_worker_dequeue_actor_with_stealing(worker, actor);
+    }
+
     operations = 4;
     other_actor = NULL;
 
@@ -704,9 +956,18 @@ int thorium_worker_dequeue_actor(struct thorium_worker *worker, struct thorium_a
                         thorium_actor_get_mailbox_size(*actor));
 #endif
 
-            /* The status is still STATUS_QUEUED
+            /* The status is still STATUS_QUEUED.
+             *
+             * With a quantum, the actor may process all its messages
+             * now, and the scheduler must see the virtual runtime
+             * of the whole activation, so the actor is queued again
+             * after it ran.
              */
-            thorium_scheduler_enqueue(&worker->scheduler, *actor);
+            if (thorium_worker_has_quantum(worker)) {
+                core_bitmap_set_bit_uint32_t(&worker->flags, FLAG_REQUEUE_ACTOR);
+            } else {
+                thorium_scheduler_enqueue(&worker->scheduler, *actor);
+            }
 
 
         /* The actor is scheduled to run, but the new tail is not
@@ -731,12 +992,202 @@ int thorium_worker_dequeue_actor(struct thorium_worker *worker, struct thorium_a
     return value;
 }
 
-/* This can only be called from the PRODUCER
+/*
+ * With work stealing, the actor map of the worker is only used for
+ * bookkeeping (production, balancer). The scheduling state lives in
+ * the actor so that any worker of the node can run it, but only one
+ * at a time.
+ *
+ * Thieves only see the deque, not the actors_to_schedule ring, which
+ * has a single consumer. So the whole ring is moved to the deque here,
+ * before an actor runs. Actors that are pushed in the ring while
+ * the actor runs can only be stolen once it returns, which the
+ * quantum bounds.
+ */
+static int thorium_worker_dequeue_actor_with_stealing(struct thorium_worker *worker,
+                struct thorium_actor **actor)
+{
+    int value;
+    int name;
+    struct thorium_actor *other_actor;
+    int other_name;
+    int status;
+
+    other_actor = NULL;
+
+    while (core_fast_ring_pop_from_consumer(&worker->actors_to_schedule, &other_actor)) {
+
+        CORE_DEBUGGER_ASSERT(other_actor != NULL);
+
+        other_name = thorium_actor_name(other_actor);
+
+        if (core_set_find(&worker->evicted_actors, &other_name)) {
+            continue;
+        }
+
+        if (!core_map_get_value(&worker->actors, &other_name, &status)) {
+
+            status = STATUS_IDLE;
+            core_map_add_value(&worker->actors, &other_name, &status);
+
+            core_map_iterator_destroy(&worker->actor_iterator);
+            core_map_iterator_init(&worker->actor_iterator, &worker->actors);
+        }
+
+        /*
+         * Queue the actor unless it is already queued or running
+         * somewhere.
+         */
+        if (thorium_actor_change_scheduling_state(other_actor,
+                                THORIUM_ACTOR_SCHEDULING_STATE_IDLE,
+                                THORIUM_ACTOR_SCHEDULING_STATE_QUEUED)) {
+            thorium_scheduler_enqueue(&worker->scheduler, other_actor);
+        }
+    }
+
+    value = thorium_scheduler_dequeue(&worker->scheduler, actor);
+
+    if (!value) {
+        value = thorium_worker_steal_actor(worker, actor);
+    }
+
+    name = THORIUM_ACTOR_NOBODY;
+
+    if (value) {
+        name = thorium_actor_name(*actor);
+
+        thorium_actor_set_scheduling_state(*actor, THORIUM_ACTOR_SCHEDULING_STATE_RUNNING);
+
+        /*
+         * The new tail of the mailbox is not visible yet.
+         */
+        if (thorium_actor_get_mailbox_size(*actor) == 0) {
+            thorium_worker_release_actor(worker, *actor);
+            value = 0;
+        }
+    }
+
+    thorium_worker_check_production(worker, value, name);
+
+    return value;
+}
+
+/*
+ * Try each other worker of the node once, starting after the
+ * last victim.
+ */
+static int thorium_worker_steal_actor(struct thorium_worker *worker, struct thorium_actor **actor)
+{
+    struct thorium_worker_pool *pool;
+    struct thorium_worker *victim;
+    int count;
+    int i;
+
+    pool = thorium_node_get_worker_pool(worker->node);
+    count = thorium_worker_pool_worker_count(pool);
+
+    for (i = 0; i < count; ++i) {
+
+        worker->victim = (worker->victim + 1) % count;
+
+        if (worker->victim == worker->name) {
+            continue;
+        }
+
+        victim = thorium_worker_pool_get_worker(pool, worker->victim);
+
+        if (thorium_scheduler_steal(&worker->scheduler, &victim->scheduler, actor)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Called after an actor ran on this worker.
+ */
+static void thorium_worker_release_actor(struct thorium_worker *worker, struct thorium_actor *actor)
+{
+    if (thorium_actor_dead(actor)) {
+        return;
+    }
+
+    if (thorium_actor_get_mailbox_size(actor) > 0) {
+        thorium_actor_set_scheduling_state(actor, THORIUM_ACTOR_SCHEDULING_STATE_QUEUED);
+        thorium_scheduler_enqueue(&worker->scheduler, actor);
+        return;
+    }
+
+    thorium_actor_set_scheduling_state(actor, THORIUM_ACTOR_SCHEDULING_STATE_IDLE);
+
+    /*
+     * A message may have arrived after the mailbox was checked, and
+     * the producer may have seen the actor as running. In that case,
+     * nobody else will queue it.
+     */
+    if (thorium_actor_get_mailbox_size(actor) > 0
+                    && thorium_actor_change_scheduling_state(actor,
+                            THORIUM_ACTOR_SCHEDULING_STATE_IDLE,
+                            THORIUM_ACTOR_SCHEDULING_STATE_QUEUED)) {
+        thorium_scheduler_enqueue(&worker->scheduler, actor);
+    }
+}
+
+/*
+ * Called after an actor ran on this worker without work stealing,
+ * when its status was left to STATUS_QUEUED by
+ * thorium_worker_dequeue_actor.
+ *
+ * Actors that receive a message while their status is STATUS_QUEUED
+ * are ignored by thorium_worker_dequeue_actor, but this runs
+ * on the same thread before the next ring entries are processed,
+ * so no message is lost if the status goes back to STATUS_IDLE.
+ */
+static void thorium_worker_requeue_actor(struct thorium_worker *worker, struct thorium_actor *actor)
+{
+    int name;
+    int status;
+
+    if (thorium_actor_dead(actor)) {
+        return;
+    }
+
+    if (thorium_actor_get_mailbox_size(actor) > 0) {
+        thorium_scheduler_enqueue(&worker->scheduler, actor);
+        return;
+    }
+
+    name = thorium_actor_name(actor);
+    status = STATUS_IDLE;
+    core_map_update_value(&worker->actors, &name, &status);
+}
+
+static int thorium_worker_has_quantum(struct thorium_worker *worker)
+{
+    return worker->quantum_messages > 1;
+}
+
+/* This can be called by the node and by other workers.
  */
 int thorium_worker_enqueue_actor(struct thorium_worker *worker, struct thorium_actor *actor)
 {
     int value;
 
+    core_lock_lock(&worker->actors_to_schedule_lock);
+    value = thorium_worker_push_actor(worker, actor);
+    core_lock_unlock(&worker->actors_to_schedule_lock);
+
+    return value;
+}
+
+/*
+ * The caller holds actors_to_schedule_lock.
+ */
+static int thorium_worker_push_actor(struct thorium_worker *worker, struct thorium_actor *actor)
+{
+    int value;
+
     CORE_DEBUGGER_ASSERT(actor != NULL);
 
     value = core_fast_ring_push_from_producer(&worker->actors_to_schedule, &actor);
@@ -925,6 +1376,12 @@ void thorium_worker_evict_actor(struct thorium_worker *worker, int actor_name)
 
             core_fast_queue_enqueue(&saved_actors,
                             &actor);
+
+        /*
+         * The new worker will queue it again.
+         */
+        } else if (core_bitmap_get_bit_uint32_t(&worker->flags, FLAG_ENABLE_WORK_STEALING)) {
+            thorium_actor_set_scheduling_state(actor, THORIUM_ACTOR_SCHEDULING_STATE_IDLE);
         }
     }
 
@@ -937,6 +1394,8 @@ void thorium_worker_evict_actor(struct thorium_worker *worker, int actor_name)
     /* Evict the actor from the ring
      */
 
+    core_lock_lock(&worker->actors_to_schedule_lock);
+
     count = core_fast_ring_size_from_consumer(&worker->actors_to_schedule);
 
     while (count-- && core_fast_ring_pop_from_consumer(&worker->actors_to_schedule,
@@ -956,6 +1415,8 @@ void thorium_worker_evict_actor(struct thorium_worker *worker, int actor_name)
         }
     }
 
+    core_lock_unlock(&worker->actors_to_schedule_lock);
+
     core_map_iterator_destroy(&worker->actor_iterator);
     core_map_iterator_init(&worker->actor_iterator, &worker->actors);
 }
@@ -1132,6 +1593,9 @@ void thorium_worker_free_message(struct thorium_worker *worker, struct thorium_m
 {
     int source_worker;
     void *buffer;
+#ifdef THORIUM_WORKER_ENABLE_REMOTE_FREE
+    struct thorium_worker *owner;
+#endif
 
     buffer = thorium_message_buffer(message);
     source_worker = thorium_message_worker(message);
@@ -1145,6 +1609,24 @@ void thorium_worker_free_message(struct thorium_worker *worker, struct thorium_m
         ++worker->counter_freed_outbound_buffers_from_self;
 #endif
 
+#ifdef THORIUM_WORKER_ENABLE_REMOTE_FREE
+    } else if (source_worker >= 0) {
+
+        /* This is from another fellow local worker.
+         * Give the buffer back to its owner without
+         * going through the node.
+         */
+        CORE_DEBUGGER_ASSERT(buffer != NULL);
+
+        owner = thorium_worker_pool_get_worker(thorium_node_get_worker_pool(worker->node),
+                        source_worker);
+        thorium_worker_return_outbound_buffer(owner, buffer);
+
+#ifdef THORIUM_WORKER_DEBUG_INJECTION
+        ++worker->counter_injected_outbound_buffers_other_local_workers;
+#endif
+#endif
+
     } else {
 
         /* This is from another fellow local worker
@@ -1156,6 +1638,50 @@ void thorium_worker_free_message(struct thorium_worker *worker, struct thorium_m
     }
 }
 
+/*
+ * Called by any worker of the node.
+ */
+void thorium_worker_return_outbound_buffer(struct thorium_worker *self, void *buffer)
+{
+    core_lock_free_stack_push(&self->returned_outbound_buffers, buffer);
+}
+
+/*
+ * Called by the node with buffers linked with core_lock_free_stack_set_next.
+ */
+void thorium_worker_return_outbound_buffers(struct thorium_worker *self, void *first, void *last)
+{
+    core_lock_free_stack_push_chain(&self->returned_outbound_buffers, first, last);
+}
+
+/*
+ * Called by the owner.
+ */
+static void thorium_worker_free_returned_outbound_buffers(struct thorium_worker *self)
+{
+    void *buffer;
+    void *next;
+
+    if (core_lock_free_stack_empty(&self->returned_outbound_buffers)) {
+        return;
+    }
+
+    buffer = core_lock_free_stack_pop_all(&self->returned_outbound_buffers);
+
+    while (buffer != NULL) {
+
+        next = core_lock_free_stack_next(buffer);
+
+        core_memory_pool_free(&self->outbound_message_memory_pool, buffer);
+
+#ifdef THORIUM_WORKER_DEBUG_INJECTION
+        ++self->counter_freed_outbound_buffers_from_other_workers;
+#endif
+
+        buffer = next;
+    }
+}
+
 int thorium_worker_enqueue_message_for_triage(struct thorium_worker *worker, struct thorium_message *message)
 {
 #ifdef THORIUM_WORKER_DEBUG_INJECTION
@@ -1341,6 +1867,14 @@ void thorium_worker_run(struct thorium_worker *worker)
          */
         thorium_worker_work(worker, actor);
 
+        if (core_bitmap_get_bit_uint32_t(&worker->flags, FLAG_ENABLE_WORK_STEALING)) {
+            thorium_worker_release_actor(worker, actor);
+
+        } else if (core_bitmap_get_bit_uint32_t(&worker->flags, FLAG_REQUEUE_ACTOR)) {
+            core_bitmap_clear_bit_uint32_t(&worker->flags, FLAG_REQUEUE_ACTOR);
+            thorium_worker_requeue_actor(worker, actor);
+        }
+
         core_bitmap_clear_bit_uint32_t(&worker->flags, FLAG_BUSY);
 
 #ifdef THORIUM_NODE_ENABLE_INSTRUMENTATION
@@ -1387,6 +1921,11 @@ void thorium_worker_run(struct thorium_worker *worker)
     }
 #endif
 
+    /*
+     * Free outbound buffers returned directly by other workers.
+     */
+    thorium_worker_free_returned_outbound_buffers(worker);
+
     /*
      * Transfer messages for triage
      */
@@ -1406,6 +1945,8 @@ void thorium_worker_work(struct thorium_worker *worker, struct thorium_actor *ac
 {
     int dead;
     int actor_name;
+    int processed_messages;
+    uint64_t virtual_runtime;
 
 #ifdef THORIUM_WORKER_DEBUG
     int tag;
@@ -1458,9 +1999,29 @@ void thorium_worker_work(struct thorium_worker *worker, struct thorium_actor *ac
      */
     thorium_actor_set_worker(actor, worker);
 
-    thorium_actor_work(actor);
+    /*
+     * Process up to a quantum of messages while the actor
+     * is hot in the cache. The time limit uses the virtual runtime
+     * of the actor, which is what the CFS scheduler sees.
+     */
+    processed_messages = 0;
+    virtual_runtime = actor->virtual_runtime;
+
+    while (thorium_actor_work(actor)) {
+        ++processed_messages;
+
+        if (processed_messages >= worker->quantum_messages
+                        || thorium_actor_dead(actor)) {
+            break;
+        }
+
+        if (worker->quantum_nanoseconds > 0
+                    && actor->virtual_runtime - virtual_runtime >= worker->quantum_nanoseconds) {
+            break;
+        }
+    }
 
-    /* Free ephemeral memory
+    /* Free ephemeral memory, once for the whole quantum
      */
     core_memory_pool_free_all(&worker->ephemeral_memory);
 
@@ -1515,9 +2076,29 @@ void thorium_worker_wait(struct thorium_worker *worker)
         return;
     }
 
+    /*
+     * An actor pushed after this point sends a signal, and an actor
+     * pushed before it is seen by thorium_worker_has_pending_work.
+     */
+    core_thread_prepare_to_wait(&worker->thread);
+
+    if (thorium_worker_has_pending_work(worker)) {
+        core_thread_cancel_wait(&worker->thread);
+        return;
+    }
+
     core_thread_wait(&worker->thread);
 }
 
+static int thorium_worker_has_pending_work(struct thorium_worker *self)
+{
+    return core_bitmap_get_bit_uint32_t(&self->flags, FLAG_DEAD)
+            || !core_fast_ring_is_empty_from_consumer(&self->actors_to_schedule)
+            || thorium_scheduler_size(&self->scheduler) > 0
+            || core_fast_queue_size(&self->outbound_message_queue_buffer) > 0
+            || core_fast_queue_size(&self->clean_message_queue_for_triage) > 0;
+}
+
 void thorium_worker_signal(struct thorium_worker *worker)
 {
     if (!worker->started_in_thread) {
@@ -1527,6 +2108,13 @@ void thorium_worker_signal(struct thorium_worker *worker)
     core_thread_signal(&worker->thread);
 }
 
+#ifdef THORIUM_NODE_USE_COUNTERS
+struct core_counter *thorium_worker_counter(struct thorium_worker *worker)
+{
+    return &worker->counter;
+}
+#endif
+
 uint64_t thorium_worker_get_epoch_wake_up_count(struct thorium_worker *worker)
 {
     return core_thread_get_wake_up_count(&worker->thread) - worker->last_wake_up_count;
@@ -1537,6 +2125,24 @@ uint64_t thorium_worker_get_loop_wake_up_count(struct thorium_worker *worker)
     return core_thread_get_wake_up_count(&worker->thread);
 }
 
+uint64_t thorium_worker_get_average_wake_up_latency(struct thorium_worker *worker)
+{
+    uint64_t count;
+
+    count = core_thread_get_wake_up_count(&worker->thread);
+
+    if (count == 0) {
+        return 0;
+    }
+
+    return core_thread_get_wake_up_latency(&worker->thread) / count;
+}
+
+uint64_t thorium_worker_get_maximum_wake_up_latency(struct thorium_worker *worker)
+{
+    return core_thread_get_maximum_wake_up_latency(&worker->thread);
+}
+
 void thorium_worker_enable_waiting(struct thorium_worker *worker)
 {
     worker->waiting_is_enabled = 1;
@@ -1544,12 +2150,9 @@ void thorium_worker_enable_waiting(struct thorium_worker *worker)
 
 void thorium_worker_check_production(struct thorium_worker *worker, int value, int name)
 {
-    uint64_t time;
-    uint64_t elapsed;
     struct thorium_actor *other_actor;
     int mailbox_size;
     int status;
-    uint64_t threshold;
 
     /*
      * If no actor is scheduled to run, things are getting out of hand
@@ -1561,6 +2164,7 @@ void thorium_worker_check_production(struct thorium_worker *worker, int value, i
         ++worker->ticks_without_production;
     } else {
         worker->ticks_without_production = 0;
+        worker->waiting_start_time = 0;
     }
 
     /*
@@ -1582,7 +2186,16 @@ void thorium_worker_check_production(struct thorium_worker *worker, int value, i
                 mailbox_size = thorium_actor_get_mailbox_size(other_actor);
             }
 
-            if (mailbox_size > 0) {
+            if (core_bitmap_get_bit_uint32_t(&worker->flags, FLAG_ENABLE_WORK_STEALING)) {
+
+                if (mailbox_size > 0
+                            && thorium_actor_change_scheduling_state(other_actor,
+                                THORIUM_ACTOR_SCHEDULING_STATE_IDLE,
+                                THORIUM_ACTOR_SCHEDULING_STATE_QUEUED)) {
+                    thorium_scheduler_enqueue(&worker->scheduler, other_actor);
+                }
+
+            } else if (mailbox_size > 0) {
                 thorium_scheduler_enqueue(&worker->scheduler, other_actor);
 
                 status = STATUS_QUEUED;
@@ -1608,48 +2221,49 @@ void thorium_worker_check_production(struct thorium_worker *worker, int value, i
      * - IBM Compute Node Kernel (CNK) on IBM Blue Gene/Q),
      */
         if (worker->waiting_is_enabled) {
+            thorium_worker_idle(worker);
+        }
+    }
+}
 
-            /* This is a first warning
-             */
-            if (worker->waiting_start_time == 0) {
-                worker->waiting_start_time = core_timer_get_nanoseconds(&worker->timer);
+static void thorium_worker_idle(struct thorium_worker *worker)
+{
+    uint64_t time;
+    uint64_t elapsed;
 
-            } else {
+    time = core_timer_get_nanoseconds(&worker->timer);
 
-                time = core_timer_get_nanoseconds(&worker->timer);
+    /* This is a first warning
+     */
+    if (worker->waiting_start_time == 0) {
+        worker->waiting_start_time = time;
+        return;
+    }
 
-                elapsed = time - worker->waiting_start_time;
+    elapsed = time - worker->waiting_start_time;
 
-                threshold = THORIUM_WORKER_UNPRODUCTIVE_MICROSECONDS_FOR_WAIT;
+    if (elapsed < worker->spin_nanoseconds) {
+        core_thread_pause();
 
-                /* Convert microseconds to nanoseconds
-                 */
-                threshold *= 1000;
+    } else if (elapsed < worker->spin_nanoseconds + worker->yield_nanoseconds) {
+        core_thread_yield();
 
-                /* Verify the elapsed time.
-                 * There are 1000 nanoseconds in 1 microsecond.
-                 */
-                if (elapsed >= threshold) {
-                    /*
-                     * Here, the worker will wait until it receives a signal.
-                     * Such a signal will mean that something is ready to be consumed.
-                     */
+    } else {
+        /*
+         * Here, the worker will wait until it receives a signal.
+         * Such a signal will mean that something is ready to be consumed.
+         */
 
-                    /* Reset the time
-                     */
-                    worker->waiting_start_time = 0;
+        /* Reset the time
+         */
+        worker->waiting_start_time = 0;
 
 #ifdef THORIUM_WORKER_DEBUG_WAIT_SIGNAL
-                    printf("DEBUG worker/%d will wait, elapsed %d\n",
-                                    worker->name, (int)elapsed);
+        printf("DEBUG worker/%d will wait, elapsed %d\n",
+                        worker->name, (int)elapsed);
 #endif
 
-                    /*
-                     */
-                    thorium_worker_wait(worker);
-                }
-            }
-        }
+        thorium_worker_wait(worker);
     }
 }
 
@@ -1751,6 +2365,14 @@ void *thorium_worker_allocate(struct thorium_worker *self, size_t count)
     buffer = (char *)core_memory_pool_allocate(&self->outbound_message_memory_pool,
                     all * sizeof(char));
 
+    /*
+     * The previous buffer was not sent yet, and it can still be
+     * sent without a copy.
+     */
+    if (self->zero_copy_buffer != NULL) {
+        core_set_add(&self->transferable_buffers, &self->zero_copy_buffer);
+    }
+
     self->zero_copy_buffer = buffer;
 
     return buffer;
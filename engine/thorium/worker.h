@@ -11,12 +11,14 @@
 
 #include <core/structures/fast_ring.h>
 #include <core/structures/fast_queue.h>
+#include <core/structures/lock_free_stack.h>
 #include <core/structures/set.h>
 #include <core/structures/map.h>
 #include <core/structures/map_iterator.h>
 
 #include <core/file_storage/output/buffered_file_writer.h>
 
+#include <core/system/counter.h>
 #include <core/system/memory_pool.h>
 #include <core/system/timer.h>
 #include <core/system/thread.h>
@@ -48,6 +50,27 @@ struct thorium_balancer;
 */
 #define THORIUM_WORKER_ENABLE_WAIT
 
+/*
+ * Idle strategy of a worker with waiting enabled: spin with a pause,
+ * then yield the processor, then park until a signal.
+ * Giving one of these options also enables waiting on a single node.
+ */
+#define THORIUM_WORKER_SPIN_MICROSECONDS_OPTION "-worker-spin-microseconds"
+#define THORIUM_WORKER_YIELD_MICROSECONDS_OPTION "-worker-yield-microseconds"
+
+/*
+ * Workers deliver messages for live local actors directly
+ * in their mailboxes instead of going through the node thread.
+ */
+#define THORIUM_WORKER_ENABLE_DIRECT_DELIVERY
+
+/*
+ * Workers return buffers of other local workers directly on the
+ * lock-free return list of the owner instead of going through
+ * the triage of the node thread.
+ */
+#define THORIUM_WORKER_ENABLE_REMOTE_FREE
+
 #define THORIUM_WORKER_NONE (-99)
 
 /*
@@ -87,9 +110,18 @@ struct thorium_worker {
     char waiting_is_enabled;
 
     /*
-     * Buffer for zero-copy send.
+     * Buffers for zero-copy send: the last buffer allocated, and
+     * the other buffers allocated by actors and not sent yet.
      */
     void *zero_copy_buffer;
+    struct core_set transferable_buffers;
+
+#ifdef THORIUM_NODE_USE_COUNTERS
+    /*
+     * Messages delivered directly to local actors by this worker.
+     */
+    struct core_counter counter;
+#endif
 
     uint64_t tick_count;
     uint64_t last_elapsed_nanoseconds;
@@ -100,6 +132,12 @@ struct thorium_worker {
      */
     struct core_fast_ring actors_to_schedule;
 
+    /*
+     * Lock for the producer side of actors_to_schedule
+     * (the node and the other workers).
+     */
+    struct core_lock actors_to_schedule_lock;
+
 #ifdef THORIUM_NODE_INJECT_CLEAN_WORKER_BUFFERS
     struct core_fast_ring injected_clean_outbound_buffers;
 
@@ -107,8 +145,28 @@ struct thorium_worker {
     struct core_fast_queue clean_message_queue_for_triage;
 #endif
 
+    /*
+     * Outbound buffers freed by other local workers. Any worker
+     * pushes on it and this worker drains it in bulk.
+     */
+    struct core_lock_free_stack returned_outbound_buffers;
+
     struct thorium_scheduler scheduler;
 
+    /*
+     * The last worker from which an actor was stolen.
+     */
+    int victim;
+
+    /*
+     * Quantum of an actor activation: the worker processes up to
+     * quantum_messages messages of the same actor, and stops earlier
+     * once the actor used quantum_nanoseconds of virtual runtime
+     * (0 means no time limit).
+     */
+    int quantum_messages;
+    uint64_t quantum_nanoseconds;
+
     struct core_fast_ring outbound_message_queue;
     struct core_fast_queue outbound_message_queue_buffer;
 
@@ -153,6 +211,8 @@ struct thorium_worker {
     uint64_t last_wake_up_count;
 
     uint64_t waiting_start_time;
+    uint64_t spin_nanoseconds;
+    uint64_t yield_nanoseconds;
 
 #ifdef THORIUM_WORKER_DEBUG_INJECTION
     int counter_allocated_outbound_buffers;
@@ -219,9 +279,19 @@ void thorium_worker_free_message(struct thorium_worker *self, struct thorium_mes
 void thorium_worker_wait(struct thorium_worker *self);
 void thorium_worker_signal(struct thorium_worker *self);
 
+#ifdef THORIUM_NODE_USE_COUNTERS
+struct core_counter *thorium_worker_counter(struct thorium_worker *self);
+#endif
+
 uint64_t thorium_worker_get_epoch_wake_up_count(struct thorium_worker *self);
 uint64_t thorium_worker_get_loop_wake_up_count(struct thorium_worker *self);
 
+/*
+ * Time between a signal and the wake-up of the worker, in nanoseconds.
+ */
+uint64_t thorium_worker_get_average_wake_up_latency(struct thorium_worker *self);
+uint64_t thorium_worker_get_maximum_wake_up_latency(struct thorium_worker *self);
+
 void thorium_worker_enable_waiting(struct thorium_worker *self);
 time_t thorium_worker_get_last_report_time(struct thorium_worker *self);
 void thorium_worker_check_production(struct thorium_worker *self, int value, int name);
@@ -231,6 +301,8 @@ void thorium_worker_check_production(struct thorium_worker *self, int value, int
  */
 int thorium_worker_inject_clean_outbound_buffer(struct thorium_worker *self, void *buffer);
 int thorium_worker_fetch_clean_outbound_buffer(struct thorium_worker *self, void **buffer);
+void thorium_worker_return_outbound_buffer(struct thorium_worker *self, void *buffer);
+void thorium_worker_return_outbound_buffers(struct thorium_worker *self, void *first, void *last);
 int thorium_worker_enqueue_message_for_triage(struct thorium_worker *worker, struct thorium_message *message);
 int thorium_worker_dequeue_message_for_triage(struct thorium_worker *worker, struct thorium_message *message);
 
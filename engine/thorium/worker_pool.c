@@ -14,6 +14,7 @@
 #include <core/structures/set_iterator.h>
 #include <core/structures/vector_iterator.h>
 
+#include <core/system/command.h>
 #include <core/system/debugger.h>
 #include <core/system/memory.h>
 
@@ -59,6 +60,9 @@
 void thorium_worker_pool_init(struct thorium_worker_pool *pool, int workers,
                 struct thorium_node *node)
 {
+    int argc;
+    char **argv;
+
     pool->debug_mode = 0;
     pool->node = node;
     pool->waiting_is_enabled = 0;
@@ -92,9 +96,14 @@ void thorium_worker_pool_init(struct thorium_worker_pool *pool, int workers,
 
     /*
      * Enable the wait/notify algorithm if running on more than
-     * one node.
+     * one node, or if the idle strategy is tuned.
      */
-    if (thorium_node_nodes(pool->node) >= 2) {
+    argc = thorium_node_argc(pool->node);
+    argv = thorium_node_argv(pool->node);
+
+    if (thorium_node_nodes(pool->node) >= 2
+                    || core_command_has_argument(argc, argv, THORIUM_WORKER_SPIN_MICROSECONDS_OPTION)
+                    || core_command_has_argument(argc, argv, THORIUM_WORKER_YIELD_MICROSECONDS_OPTION)) {
         pool->waiting_is_enabled = 1;
     }
 
@@ -271,10 +280,12 @@ void thorium_worker_pool_print_load(struct thorium_worker_pool *self, int type)
     char *buffer;
     char *buffer_for_wake_up_events;
     char *buffer_for_future_timeline;
+    char *buffer_for_wake_up_latency;
     int allocated;
     int offset;
     int offset_for_wake_up;
     int offset_for_future;
+    int offset_for_latency;
     int extra;
     time_t current_time;
     int elapsed;
@@ -307,10 +318,12 @@ void thorium_worker_pool_print_load(struct thorium_worker_pool *self, int type)
     buffer = core_memory_allocate(allocated, MEMORY_WORKER_POOL_KEY);
     buffer_for_wake_up_events = core_memory_allocate(allocated, MEMORY_WORKER_POOL_KEY);
     buffer_for_future_timeline = core_memory_allocate(allocated, MEMORY_WORKER_POOL_KEY);
+    buffer_for_wake_up_latency = core_memory_allocate(2 * allocated, MEMORY_WORKER_POOL_KEY);
     node_name = thorium_node_name(self->node);
     offset = 0;
     offset_for_wake_up = 0;
     offset_for_future = 0;
+    offset_for_latency = 0;
     i = 0;
     sum = 0;
 
@@ -349,6 +362,14 @@ void thorium_worker_pool_print_load(struct thorium_worker_pool *self, int type)
         offset_for_future += sprintf(buffer_for_future_timeline + offset_for_future, " %d",
                         thorium_worker_get_scheduled_actor_count(worker));
 
+        /*
+         * Average and maximum, in microseconds.
+         */
+        offset_for_latency += sprintf(buffer_for_wake_up_latency + offset_for_latency,
+                        " %" PRIu64 "/%" PRIu64 "",
+                        thorium_worker_get_average_wake_up_latency(worker) / 1000,
+                        thorium_worker_get_maximum_wake_up_latency(worker) / 1000);
+
         sum += selected_load;
 
         ++i;
@@ -371,9 +392,15 @@ void thorium_worker_pool_print_load(struct thorium_worker_pool *self, int type)
                     description, elapsed,
                     buffer_for_wake_up_events);
 
+    printf("thorium_worker_pool: node/%d %s WAKE_UP_LATENCY %d s %s\n",
+                    node_name,
+                    description, elapsed,
+                    buffer_for_wake_up_latency);
+
     core_memory_free(buffer, MEMORY_WORKER_POOL_KEY);
     core_memory_free(buffer_for_wake_up_events, MEMORY_WORKER_POOL_KEY);
     core_memory_free(buffer_for_future_timeline, MEMORY_WORKER_POOL_KEY);
+    core_memory_free(buffer_for_wake_up_latency, MEMORY_WORKER_POOL_KEY);
 }
 
 void thorium_worker_pool_toggle_debug_mode(struct thorium_worker_pool *self)
@@ -478,6 +505,13 @@ int thorium_worker_pool_give_message_to_actor(struct thorium_worker_pool *pool,
             worker_index = thorium_balancer_get_actor_worker(&pool->balancer, name);
         }
 
+        /*
+         * Workers read this to deliver messages directly.
+         */
+        if (thorium_actor_get_assigned_worker(actor) != worker_index) {
+            thorium_actor_set_assigned_worker(actor, worker_index);
+        }
+
         affinity_worker = thorium_worker_pool_get_worker(pool, worker_index);
 
         /*
@@ -20,8 +20,10 @@ GENOMICS_OBJECTS += genomics/input/input_command.o
 GENOMICS_OBJECTS += genomics/input/mega_block.o
 
 GENOMICS_OBJECTS += genomics/data/dna_sequence.o
+GENOMICS_OBJECTS += genomics/data/dna_sequence_block.o
 GENOMICS_OBJECTS += genomics/data/dna_kmer.o
 GENOMICS_OBJECTS += genomics/data/dna_kmer_block.o
+GENOMICS_OBJECTS += genomics/data/dna_kmer_extractor.o
 GENOMICS_OBJECTS += genomics/data/dna_kmer_frequency_block.o
 GENOMICS_OBJECTS += genomics/data/coverage_distribution.o
 GENOMICS_OBJECTS += genomics/data/dna_codec.o
@@ -21,6 +21,7 @@
 
 #include <core/helpers/message_helper.h>
 #include <core/system/memory.h>
+#include <core/system/command.h>
 
 #include <core/structures/vector.h>
 #include <core/structures/vector_iterator.h>
@@ -40,6 +41,13 @@
 #define MEMORY_POOL_NAME_OTHER             0x8b5b96d6
 #define MEMORY_POOL_NAME_GRAPH_STORE       0x89e9235d
 
+#define CONTROL_BYTES_OPTION "-enable-control-bytes"
+
+static int biosal_assembly_graph_store_pack_key(struct thorium_actor *self,
+                struct biosal_dna_kmer *kmer, void *key);
+static void biosal_assembly_graph_store_unpack_key(struct thorium_actor *self,
+                void *key, struct biosal_dna_kmer *kmer);
+
 struct thorium_script biosal_assembly_graph_store_script = {
     .identifier = SCRIPT_ASSEMBLY_GRAPH_STORE,
     .name = "biosal_assembly_graph_store",
@@ -68,6 +76,7 @@ void biosal_assembly_graph_store_init(struct thorium_actor *self)
     concrete_self->consumed_canonical_vertex_count = 0;
 
     concrete_self->kmer_length = -1;
+    concrete_self->use_inline_keys = 0;
     concrete_self->received = 0;
 
     biosal_assembly_graph_summary_init(&concrete_self->graph_summary);
@@ -107,6 +116,12 @@ void biosal_assembly_graph_store_init(struct thorium_actor *self)
     thorium_actor_add_action(self, ACTION_ASSEMBLY_GET_VERTEX,
                     biosal_assembly_graph_store_get_vertex);
 
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_PREFETCH_VERTEX,
+                    biosal_assembly_graph_store_prefetch_vertex);
+
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_EXTEND_UNITIG,
+                    biosal_assembly_graph_store_extend_unitig);
+
     thorium_actor_add_action(self, ACTION_ASSEMBLY_GET_STARTING_KMER,
                     biosal_assembly_graph_store_get_starting_vertex);
 
@@ -172,11 +187,18 @@ void biosal_assembly_graph_store_receive(struct thorium_actor *self, struct thor
 
         thorium_message_unpack_int(message, 0, &concrete_self->kmer_length);
 
-        biosal_dna_kmer_init_mock(&kmer, concrete_self->kmer_length,
+        if (concrete_self->kmer_length <= BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH) {
+            concrete_self->use_inline_keys = 1;
+            concrete_self->key_length_in_bytes =
+                    biosal_dna_kmer_inline_key_size(concrete_self->kmer_length);
+
+        } else {
+            biosal_dna_kmer_init_mock(&kmer, concrete_self->kmer_length,
                         &concrete_self->storage_codec, thorium_actor_get_ephemeral_memory(self));
-        concrete_self->key_length_in_bytes = biosal_dna_kmer_pack_size(&kmer,
+            concrete_self->key_length_in_bytes = biosal_dna_kmer_pack_size(&kmer,
                         concrete_self->kmer_length, &concrete_self->storage_codec);
-        biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(self));
+            biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(self));
+        }
 
         big_key_size = concrete_self->key_length_in_bytes;
         big_value_size = sizeof(struct biosal_assembly_vertex);
@@ -193,6 +215,15 @@ void biosal_assembly_graph_store_receive(struct thorium_actor *self, struct thor
          */
         core_map_disable_deletion_support(&concrete_self->table);
 
+        if (core_command_has_argument(thorium_actor_argc(self), thorium_actor_argv(self),
+                                CONTROL_BYTES_OPTION)) {
+            core_map_enable_control_bytes(&concrete_self->table);
+        }
+
+        if (concrete_self->use_inline_keys) {
+            core_map_enable_integer_keys(&concrete_self->table);
+        }
+
         /*
          * The threshold of the map is not very important because
          * requests that hit the map have to first arrive as messages,
@@ -291,10 +322,7 @@ void biosal_assembly_graph_store_print(struct thorium_actor *self)
     while (core_map_iterator_has_next(&iterator)) {
         core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, key, concrete_self->kmer_length,
-                        thorium_actor_get_ephemeral_memory(self),
-                        &concrete_self->storage_codec);
+        biosal_assembly_graph_store_unpack_key(self, key, &kmer);
 
         length = biosal_dna_kmer_length(&kmer, concrete_self->kmer_length);
 
@@ -319,10 +347,7 @@ void biosal_assembly_graph_store_print(struct thorium_actor *self)
     while (core_map_iterator_has_next(&iterator)) {
         core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, key, concrete_self->kmer_length,
-                        thorium_actor_get_ephemeral_memory(self),
-                        &concrete_self->storage_codec);
+        biosal_assembly_graph_store_unpack_key(self, key, &kmer);
 
         biosal_dna_kmer_get_sequence(&kmer, sequence, concrete_self->kmer_length,
                         &concrete_self->storage_codec);
@@ -398,10 +423,7 @@ void biosal_assembly_graph_store_yield_reply(struct thorium_actor *self, struct
 
         core_map_iterator_next(&concrete_self->iterator, (void **)&key, (void **)&value);
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, key, concrete_self->kmer_length,
-                        ephemeral_memory,
-                        &concrete_self->storage_codec);
+        biosal_assembly_graph_store_unpack_key(self, key, &kmer);
 
         coverage = biosal_assembly_vertex_coverage_depth(value);
 
@@ -478,10 +500,8 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
     struct biosal_dna_kmer kmer;
     void *buffer;
     int count;
-    struct biosal_dna_kmer encoded_kmer;
     char *raw_kmer;
     int period;
-    struct biosal_dna_kmer *kmer_pointer;
     int *frequency;
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
@@ -524,34 +544,17 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
          */
         core_map_iterator_next(&iterator, (void **)&packed_kmer, (void **)&frequency);
 
-        /* Store the kmer in 2 bit encoding
+        /*
+         * The packed form of a k-mer is its encoded data.
          */
+        kmer.encoded_data = packed_kmer;
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, packed_kmer, concrete_self->kmer_length,
-                    ephemeral_memory,
-                    &concrete_self->transport_codec);
+        biosal_assembly_graph_store_pack_key(self, &kmer, key);
 
-        kmer_pointer = &kmer;
-
-        if (concrete_self->codec_are_different) {
-            /*
-             * Get a copy of the sequence
-             */
-            biosal_dna_kmer_get_sequence(kmer_pointer, raw_kmer, concrete_self->kmer_length,
+#ifdef BIOSAL_DEBUG_ISSUE_540
+        biosal_dna_kmer_get_sequence(&kmer, raw_kmer, concrete_self->kmer_length,
                         &concrete_self->transport_codec);
 
-
-            biosal_dna_kmer_init(&encoded_kmer, raw_kmer, &concrete_self->storage_codec,
-                        thorium_actor_get_ephemeral_memory(self));
-            kmer_pointer = &encoded_kmer;
-        }
-
-        biosal_dna_kmer_pack_store_key(kmer_pointer, key,
-                        concrete_self->kmer_length, &concrete_self->storage_codec,
-                        thorium_actor_get_ephemeral_memory(self));
-
-#ifdef BIOSAL_DEBUG_ISSUE_540
         if (strcmp(raw_kmer, "AGCTGGTAGTCATCACCAGACTGGAACAG") == 0
                         || strcmp(raw_kmer, "CGCGATCTGTTGCTGGGCCTAACGTGGTA") == 0
                         || strcmp(raw_kmer, "TACCACGTTAGGCCCAGCAACAGATCGCG") == 0) {
@@ -572,18 +575,11 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
 
 #if 0
             printf("DEBUG303 ADD_KEY");
-            biosal_dna_kmer_print(&encoded_kmer, concrete_self->kmer_length,
-                            &concrete_self->storage_codec, ephemeral_memory);
+            biosal_dna_kmer_print(&kmer, concrete_self->kmer_length,
+                            &concrete_self->transport_codec, ephemeral_memory);
 #endif
         }
 
-        if (concrete_self->codec_are_different) {
-            biosal_dna_kmer_destroy(&encoded_kmer,
-                        thorium_actor_get_ephemeral_memory(self));
-        }
-
-        biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
-
         biosal_assembly_vertex_increase_coverage_depth(bucket, *frequency);
 
         if (concrete_self->received >= concrete_self->last_received + period) {
@@ -620,7 +616,6 @@ void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, stru
     struct biosal_assembly_arc *arc;
     struct core_memory_pool *ephemeral_memory;
     struct core_vector *input_arcs;
-    char *sequence;
     void *key;
 
 #if 0
@@ -634,8 +629,6 @@ void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, stru
     concrete_self = thorium_actor_concrete_actor(self);
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
 
-    sequence = core_memory_pool_allocate(ephemeral_memory, concrete_self->kmer_length + 1);
-
     ++concrete_self->received_arc_block_count;
 
     count = thorium_message_count(message);
@@ -664,7 +657,7 @@ void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, stru
         arc = core_vector_at(input_arcs, i);
 
 #ifdef BIOSAL_ASSEMBLY_ADD_ARCS
-        biosal_assembly_graph_store_add_arc(self, arc, sequence, key);
+        biosal_assembly_graph_store_add_arc(self, arc, key);
 #endif
 
         ++concrete_self->received_arc_count;
@@ -680,21 +673,16 @@ void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, stru
      */
 
     thorium_actor_send_reply_empty(self, ACTION_ASSEMBLY_PUSH_ARC_BLOCK_REPLY);
-
-    core_memory_pool_free(ephemeral_memory, sequence);
 }
 
 void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
-                struct biosal_assembly_arc *arc, char *sequence,
-                void *key)
+                struct biosal_assembly_arc *arc, void *key)
 {
     struct biosal_assembly_graph_store *concrete_self;
     struct biosal_dna_kmer *source;
-    struct biosal_dna_kmer real_source;
     int destination;
     int type;
     struct biosal_assembly_vertex *vertex;
-    struct core_memory_pool *ephemeral_memory;
     int is_canonical;
 
 #if 0
@@ -708,9 +696,11 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
 
 #ifdef BIOSAL_ASSEMBLY_GRAPH_STORE_DEBUG_ARC
     int verbose;
-#endif
+    struct core_memory_pool *ephemeral_memory;
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+#endif
+
     concrete_self = thorium_actor_concrete_actor(self);
 
 #ifdef BIOSAL_ASSEMBLY_GRAPH_STORE_DEBUG_ARC
@@ -732,22 +722,7 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
     destination = biosal_assembly_arc_destination(arc);
     type = biosal_assembly_arc_type(arc);
 
-    /*
-     * Don't convert the data if the transport codec and the
-     * storage codec are the same.
-     */
-    if (concrete_self->codec_are_different) {
-        biosal_dna_kmer_get_sequence(source, sequence, concrete_self->kmer_length,
-                        &concrete_self->transport_codec);
-        biosal_dna_kmer_init(&real_source, sequence, &concrete_self->storage_codec,
-                        ephemeral_memory);
-
-        source = &real_source;
-    }
-
-    biosal_dna_kmer_pack_store_key(source, key,
-                        concrete_self->kmer_length, &concrete_self->storage_codec,
-                        ephemeral_memory);
+    is_canonical = biosal_assembly_graph_store_pack_key(self, source, key);
 
     vertex = core_map_get(&concrete_self->table, key);
 
@@ -771,9 +746,6 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
     /*
      * Inverse the arc if the source is not canonical
      */
-    is_canonical = biosal_dna_kmer_is_canonical(source, concrete_self->kmer_length,
-                    &concrete_self->storage_codec);
-
     if (!is_canonical) {
 
         if (type == BIOSAL_ARC_TYPE_PARENT) {
@@ -802,10 +774,6 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
         biosal_assembly_vertex_print(vertex);
     }
 #endif
-
-    if (concrete_self->codec_are_different) {
-        biosal_dna_kmer_destroy(&real_source, ephemeral_memory);
-    }
 }
 
 void biosal_assembly_graph_store_get_summary(struct thorium_actor *self, struct thorium_message *message)
@@ -969,6 +937,223 @@ void biosal_assembly_graph_store_get_vertex(struct thorium_actor *self, struct t
     thorium_message_destroy(&new_message);
 }
 
+void biosal_assembly_graph_store_prefetch_vertex(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_assembly_vertex vertex;
+    struct biosal_dna_kmer kmer;
+    void *buffer;
+    struct biosal_assembly_graph_store *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct thorium_message new_message;
+    int new_count;
+    char *new_buffer;
+    int count;
+
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    buffer = thorium_message_buffer(message);
+    count = thorium_message_count(message);
+
+    biosal_dna_kmer_init_empty(&kmer);
+
+    biosal_dna_kmer_unpack(&kmer, buffer, concrete_self->kmer_length,
+                ephemeral_memory,
+                &concrete_self->transport_codec);
+
+    biosal_assembly_graph_store_get_oriented_vertex(self, &kmer, &vertex);
+
+    biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+
+    /*
+     * The request is sent back as is, followed by the vertex.
+     */
+    new_count = count + biosal_assembly_vertex_pack_size(&vertex);
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    core_memory_copy(new_buffer, buffer, count);
+    biosal_assembly_vertex_pack(&vertex, new_buffer + count);
+
+    biosal_assembly_vertex_destroy(&vertex);
+
+    thorium_message_init(&new_message, ACTION_ASSEMBLY_PREFETCH_VERTEX_REPLY,
+                    new_count, new_buffer);
+
+    thorium_actor_send_reply(self, &new_message);
+
+    thorium_message_destroy(&new_message);
+}
+
+/*
+ * Extend a unitig path without leaving the graph store.
+ *
+ * The request contains:
+ *
+ * - the kmer of the next vertex of the path, which is in this store;
+ * - the symbol code of this kmer;
+ * - the starting kmer of the path;
+ * - the direction (0 for children, 1 for parents);
+ * - the path index;
+ * - the index of this store and the number of stores;
+ * - the maximum number of vertices to take.
+ *
+ * A vertex is taken if it is in this store, is a unitig vertex, is not
+ * used and is not the starting vertex. The next one is tried as long
+ * as the last one has exactly one arc in each direction. Every vertex
+ * that is taken is marked like with ACTION_MARK_VERTEX_AS_VISITED.
+ *
+ * The reply contains the number of vertices that were taken, their
+ * symbol codes and, if this number is not 0, the last kmer and its
+ * vertex. The walker continues from there.
+ */
+void biosal_assembly_graph_store_extend_unitig(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer next_kmer;
+    struct biosal_dna_kmer starting_kmer;
+    struct biosal_assembly_vertex vertex;
+    struct biosal_assembly_vertex *canonical_vertex;
+    struct core_vector codes;
+    struct thorium_message new_message;
+    char *buffer;
+    char *new_buffer;
+    int new_count;
+    int position;
+    int operation;
+    int path_index;
+    int store_index;
+    int store_count;
+    int maximum;
+    int source;
+    int count;
+    int code;
+    int has_vertex;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    buffer = thorium_message_buffer(message);
+    source = thorium_message_source(message);
+
+    biosal_dna_kmer_init_empty(&next_kmer);
+    biosal_dna_kmer_init_empty(&starting_kmer);
+
+    position = 0;
+    position += biosal_dna_kmer_unpack(&next_kmer, buffer + position, concrete_self->kmer_length,
+                ephemeral_memory, &concrete_self->transport_codec);
+    position += thorium_message_unpack_int(message, position, &code);
+    position += biosal_dna_kmer_unpack(&starting_kmer, buffer + position, concrete_self->kmer_length,
+                ephemeral_memory, &concrete_self->transport_codec);
+    position += thorium_message_unpack_int(message, position, &operation);
+    position += thorium_message_unpack_int(message, position, &path_index);
+    position += thorium_message_unpack_int(message, position, &store_index);
+    position += thorium_message_unpack_int(message, position, &store_count);
+    position += thorium_message_unpack_int(message, position, &maximum);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, thorium_message_count(message));
+
+    core_vector_init(&codes, sizeof(int));
+    core_vector_set_memory_pool(&codes, ephemeral_memory);
+
+    has_vertex = 0;
+
+    while (core_vector_size(&codes) < maximum) {
+
+        /*
+         * The next vertex must be here.
+         */
+        if (biosal_dna_kmer_store_index(&next_kmer, store_count, concrete_self->kmer_length,
+                                &concrete_self->transport_codec, ephemeral_memory) != store_index
+                        || biosal_dna_kmer_equals(&next_kmer, &starting_kmer, concrete_self->kmer_length,
+                                &concrete_self->transport_codec)) {
+            break;
+        }
+
+        canonical_vertex = biosal_assembly_graph_store_find_vertex(self, &next_kmer);
+
+        /*
+         * A used vertex requires the walker (cycles and competition
+         * between walkers).
+         */
+        if (canonical_vertex == NULL
+                        || !biosal_assembly_vertex_get_flag(canonical_vertex, BIOSAL_VERTEX_FLAG_UNITIG)
+                        || biosal_assembly_vertex_get_flag(canonical_vertex, BIOSAL_VERTEX_FLAG_USED)) {
+            break;
+        }
+
+        biosal_assembly_graph_store_mark_as_used(self, canonical_vertex, source, path_index);
+        core_vector_push_back(&codes, &code);
+
+        /*
+         * Take the vertex.
+         */
+        if (has_vertex) {
+            biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+            biosal_assembly_vertex_destroy(&vertex);
+        }
+
+        kmer = next_kmer;
+        biosal_dna_kmer_init_empty(&next_kmer);
+        biosal_assembly_graph_store_get_oriented_vertex(self, &kmer, &vertex);
+        has_vertex = 1;
+
+        if (biosal_assembly_vertex_child_count(&vertex) != 1
+                        || biosal_assembly_vertex_parent_count(&vertex) != 1) {
+            break;
+        }
+
+        if (operation == 0) {
+            code = biosal_assembly_vertex_get_child(&vertex, 0);
+            biosal_dna_kmer_init_as_child(&next_kmer, &kmer, code, concrete_self->kmer_length,
+                            ephemeral_memory, &concrete_self->transport_codec);
+        } else {
+            code = biosal_assembly_vertex_get_parent(&vertex, 0);
+            biosal_dna_kmer_init_as_parent(&next_kmer, &kmer, code, concrete_self->kmer_length,
+                            ephemeral_memory, &concrete_self->transport_codec);
+        }
+    }
+
+    count = core_vector_size(&codes);
+
+    new_count = sizeof(count) + count * sizeof(int);
+
+    if (has_vertex) {
+        new_count += biosal_dna_kmer_pack_size(&kmer, concrete_self->kmer_length,
+                        &concrete_self->transport_codec);
+        new_count += biosal_assembly_vertex_pack_size(&vertex);
+    }
+
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    position = 0;
+    core_memory_copy(new_buffer + position, &count, sizeof(count));
+    position += sizeof(count);
+
+    if (has_vertex) {
+        core_memory_copy(new_buffer + position, core_vector_at(&codes, 0), count * sizeof(int));
+        position += count * sizeof(int);
+
+        position += biosal_dna_kmer_pack(&kmer, new_buffer + position, concrete_self->kmer_length,
+                        &concrete_self->transport_codec);
+        position += biosal_assembly_vertex_pack(&vertex, new_buffer + position);
+
+        biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+        biosal_assembly_vertex_destroy(&vertex);
+    }
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, new_count);
+
+    biosal_dna_kmer_destroy(&next_kmer, ephemeral_memory);
+    biosal_dna_kmer_destroy(&starting_kmer, ephemeral_memory);
+    core_vector_destroy(&codes);
+
+    thorium_message_init(&new_message, ACTION_ASSEMBLY_EXTEND_UNITIG_REPLY,
+                    new_count, new_buffer);
+    thorium_actor_send_reply(self, &new_message);
+    thorium_message_destroy(&new_message);
+}
+
 void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self, struct thorium_message *message)
 {
     struct biosal_assembly_graph_store *concrete_self;
@@ -1012,10 +1197,7 @@ void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self,
         core_debugger_examine(storage_key, concrete_self->key_length_in_bytes);
 #endif
 
-        biosal_dna_kmer_init_empty(&storage_kmer);
-        biosal_dna_kmer_unpack(&storage_kmer, storage_key, concrete_self->kmer_length,
-                        ephemeral_memory,
-                        &concrete_self->storage_codec);
+        biosal_assembly_graph_store_unpack_key(self, storage_key, &storage_kmer);
 
 #ifdef BIOSAL_ASSEMBLY_GRAPH_STORE_DEBUG_GET_STARTING_VERTEX
         printf("DEBUG starting kmer Storage kmer hash %" PRIu64 "\n",
@@ -1199,10 +1381,8 @@ void biosal_assembly_graph_store_mark_vertex_as_visited(struct thorium_actor *se
     char *buffer;
     int source;
     int path_index;
-    char *sequence;
     struct core_memory_pool *ephemeral_memory;
     struct biosal_dna_kmer kmer;
-    struct biosal_dna_kmer storage_kmer;
     struct biosal_assembly_vertex *canonical_vertex;
     int position;
     void *key;
@@ -1222,26 +1402,18 @@ void biosal_assembly_graph_store_mark_vertex_as_visited(struct thorium_actor *se
 
     position += biosal_dna_kmer_unpack(&kmer, buffer, concrete_self->kmer_length,
                 ephemeral_memory, &concrete_self->transport_codec);
-    sequence = core_memory_pool_allocate(ephemeral_memory, concrete_self->kmer_length + 1);
-    biosal_dna_kmer_get_sequence(&kmer, sequence, concrete_self->kmer_length,
-                        &concrete_self->transport_codec);
-    biosal_dna_kmer_init(&storage_kmer, sequence, &concrete_self->storage_codec,
-                        ephemeral_memory);
 
     /*
      * Get store key
      */
     key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length_in_bytes);
-    biosal_dna_kmer_pack_store_key(&storage_kmer, key, concrete_self->kmer_length, &concrete_self->storage_codec,
-                        ephemeral_memory);
+    biosal_assembly_graph_store_pack_key(self, &kmer, key);
 
     /* Get vertex. */
     canonical_vertex = core_map_get(&concrete_self->table, key);
 
     biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
-    biosal_dna_kmer_destroy(&storage_kmer, ephemeral_memory);
     core_memory_pool_free(ephemeral_memory, key);
-    core_memory_pool_free(ephemeral_memory, sequence);
 
     position += thorium_message_unpack_int(message, position, &path_index);
     /*
@@ -1313,47 +1485,141 @@ struct biosal_assembly_vertex *biosal_assembly_graph_store_find_vertex(struct th
 {
     struct core_memory_pool *ephemeral_memory;
     struct biosal_assembly_graph_store *concrete_self;
-    char *sequence;
-    struct biosal_dna_kmer storage_kmer;
     char *key;
     struct biosal_assembly_vertex *canonical_vertex;
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     concrete_self = thorium_actor_concrete_actor(self);
 
-    sequence = core_memory_pool_allocate(ephemeral_memory, concrete_self->kmer_length + 1);
-
-    biosal_dna_kmer_get_sequence(kmer, sequence, concrete_self->kmer_length,
-                        &concrete_self->transport_codec);
-
-    biosal_dna_kmer_init(&storage_kmer, sequence, &concrete_self->storage_codec,
-                        ephemeral_memory);
-
     key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length_in_bytes);
 
-    biosal_dna_kmer_pack_store_key(&storage_kmer, key,
-                        concrete_self->kmer_length, &concrete_self->storage_codec,
-                        ephemeral_memory);
+    biosal_assembly_graph_store_pack_key(self, kmer, key);
 
     canonical_vertex = core_map_get(&concrete_self->table, key);
 
 #ifdef CORE_DEBUGGER_ASSERT
     if (canonical_vertex == NULL) {
 
-        printf("not found Seq = %s name %d kmerlength %d key_length %d hash %" PRIu64 "\n", sequence,
+        printf("not found name %d kmerlength %d key_length %d hash %" PRIu64 "\n",
                         thorium_actor_name(self),
                         concrete_self->kmer_length,
                         concrete_self->key_length_in_bytes,
-                        biosal_dna_kmer_hash(&storage_kmer, concrete_self->kmer_length,
-                                &concrete_self->storage_codec));
+                        biosal_dna_kmer_hash(kmer, concrete_self->kmer_length,
+                                &concrete_self->transport_codec));
+
+        biosal_dna_kmer_print(kmer, concrete_self->kmer_length,
+                        &concrete_self->transport_codec, ephemeral_memory);
     }
 #endif
 
     CORE_DEBUGGER_ASSERT(canonical_vertex != NULL);
 
-    core_memory_pool_free(ephemeral_memory, sequence);
     core_memory_pool_free(ephemeral_memory, key);
-    biosal_dna_kmer_destroy(&storage_kmer, ephemeral_memory);
 
     return canonical_vertex;
 }
+
+/*
+ * Build the key of a k-mer encoded with the transport codec.
+ *
+ * \return 1 if the k-mer is canonical, 0 otherwise.
+ */
+static int biosal_assembly_graph_store_pack_key(struct thorium_actor *self,
+                struct biosal_dna_kmer *kmer, void *key)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer storage_kmer;
+    char *sequence;
+    int is_canonical;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    /*
+     * Inline keys don't need the storage codec.
+     */
+    if (concrete_self->use_inline_keys) {
+        return biosal_dna_kmer_pack_inline_key(kmer, key, concrete_self->kmer_length,
+                        &concrete_self->transport_codec);
+    }
+
+    /*
+     * Don't convert the data if the transport codec and the
+     * storage codec are the same.
+     */
+    if (!concrete_self->codec_are_different) {
+        is_canonical = biosal_dna_kmer_is_canonical(kmer, concrete_self->kmer_length,
+                        &concrete_self->storage_codec);
+        biosal_dna_kmer_pack_store_key(kmer, key,
+                        concrete_self->kmer_length, &concrete_self->storage_codec,
+                        ephemeral_memory);
+
+        return is_canonical;
+    }
+
+    sequence = core_memory_pool_allocate(ephemeral_memory, concrete_self->kmer_length + 1);
+
+    biosal_dna_kmer_get_sequence(kmer, sequence, concrete_self->kmer_length,
+                        &concrete_self->transport_codec);
+    biosal_dna_kmer_init(&storage_kmer, sequence, &concrete_self->storage_codec,
+                        ephemeral_memory);
+
+    is_canonical = biosal_dna_kmer_is_canonical(&storage_kmer, concrete_self->kmer_length,
+                    &concrete_self->storage_codec);
+    biosal_dna_kmer_pack_store_key(&storage_kmer, key,
+                        concrete_self->kmer_length, &concrete_self->storage_codec,
+                        ephemeral_memory);
+
+    biosal_dna_kmer_destroy(&storage_kmer, ephemeral_memory);
+    core_memory_pool_free(ephemeral_memory, sequence);
+
+    return is_canonical;
+}
+
+/*
+ * Get a k-mer from a key. The k-mer is encoded with the storage
+ * codec and must be destroyed with the ephemeral memory.
+ */
+static void biosal_assembly_graph_store_unpack_key(struct thorium_actor *self,
+                void *key, struct biosal_dna_kmer *kmer)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    if (concrete_self->use_inline_keys) {
+        biosal_dna_kmer_init_from_inline_key(kmer, key, concrete_self->kmer_length,
+                        thorium_actor_get_ephemeral_memory(self),
+                        &concrete_self->storage_codec);
+        return;
+    }
+
+    biosal_dna_kmer_init_empty(kmer);
+    biosal_dna_kmer_unpack(kmer, key, concrete_self->kmer_length,
+                    thorium_actor_get_ephemeral_memory(self),
+                    &concrete_self->storage_codec);
+}
+
+/*
+ * Get a copy of the vertex of a kmer, with the arcs in the orientation
+ * of the kmer.
+ */
+void biosal_assembly_graph_store_get_oriented_vertex(struct thorium_actor *self,
+                struct biosal_dna_kmer *kmer, struct biosal_assembly_vertex *vertex)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+    struct biosal_assembly_vertex *canonical_vertex;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    canonical_vertex = biosal_assembly_graph_store_find_vertex(self, kmer);
+
+    biosal_assembly_vertex_init_copy(vertex, canonical_vertex);
+
+    if (!biosal_dna_kmer_is_canonical(kmer, concrete_self->kmer_length,
+                            &concrete_self->transport_codec)) {
+
+        biosal_assembly_vertex_invert_arcs(vertex);
+    }
+}
@@ -41,6 +41,21 @@ struct biosal_dna_kmer;
 #define ACTION_ASSEMBLY_GET_VERTEX 0x0000491e
 #define ACTION_ASSEMBLY_GET_VERTEX_REPLY 0x00007724
 
+/*
+ * Like ACTION_ASSEMBLY_GET_VERTEX, but the reply starts with the
+ * request as is (the packed kmer, and anything the client appended
+ * to it). This allows a client to have many requests in flight.
+ */
+#define ACTION_ASSEMBLY_PREFETCH_VERTEX 0x00003f6b
+#define ACTION_ASSEMBLY_PREFETCH_VERTEX_REPLY 0x00001f2e
+
+/*
+ * Extend a unitig path locally, as long as the next vertex is in the
+ * same graph store. See biosal_assembly_graph_store_extend_unitig.
+ */
+#define ACTION_ASSEMBLY_EXTEND_UNITIG 0x00002c71
+#define ACTION_ASSEMBLY_EXTEND_UNITIG_REPLY 0x00005e3a
+
 #define ACTION_MARK_VERTEX_AS_VISITED 0x002e0b8a
 #define ACTION_MARK_VERTEX_AS_VISITED_REPLY 0x002b4b17
 
@@ -60,6 +75,11 @@ struct biosal_assembly_graph_store {
     struct biosal_dna_codec storage_codec;
     int kmer_length;
     int key_length_in_bytes;
+
+    /*
+     * Keys are inline (1 or 2 words) when k <= 64.
+     */
+    int use_inline_keys;
     int unitig_vertex_count;
 
     int customer;
@@ -108,7 +128,7 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
 void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, struct thorium_message *message);
 
 void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
-                struct biosal_assembly_arc *arc, char *sequence, void *key);
+                struct biosal_assembly_arc *arc, void *key);
 
 void biosal_assembly_graph_store_get_summary(struct thorium_actor *self, struct thorium_message *message);
 
@@ -119,6 +139,8 @@ void biosal_assembly_graph_store_yield_reply_summary(struct thorium_actor *self,
  * It returns a packed biosal_assembly_vertex.
  */
 void biosal_assembly_graph_store_get_vertex(struct thorium_actor *self, struct thorium_message *message);
+void biosal_assembly_graph_store_prefetch_vertex(struct thorium_actor *self, struct thorium_message *message);
+void biosal_assembly_graph_store_extend_unitig(struct thorium_actor *self, struct thorium_message *message);
 void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self, struct thorium_message *message);
 
 int biosal_assembly_graph_store_get_store_count_per_node(struct thorium_actor *self);
@@ -133,5 +155,7 @@ void biosal_assembly_graph_store_set_vertex_flag(struct thorium_actor *self,
                 struct thorium_message *message);
 struct biosal_assembly_vertex *biosal_assembly_graph_store_find_vertex(struct thorium_actor *self,
                 struct biosal_dna_kmer *kmer);
+void biosal_assembly_graph_store_get_oriented_vertex(struct thorium_actor *self,
+                struct biosal_dna_kmer *kmer, struct biosal_assembly_vertex *vertex);
 
 #endif
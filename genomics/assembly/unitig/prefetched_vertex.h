@@ -0,0 +1,29 @@
+#ifndef BIOSAL_PREFETCHED_VERTEX_H
+#define BIOSAL_PREFETCHED_VERTEX_H
+
+#include <genomics/assembly/assembly_vertex.h>
+
+/*
+ * A vertex in the prefetch cache of a unitig walker.
+ *
+ * - ready is 0 until the first reply;
+ * - depth is the number of levels still to fetch beyond this vertex;
+ * - step is the last step of the walker that needed the vertex;
+ * - request_step is the step of the last request;
+ * - reply_step is the step of the newest request that was answered.
+ *
+ * The arcs of a vertex do not change during the walk, but its flags
+ * and its last actor do. So a vertex is only consumed when
+ * reply_step is the current step, and older replies are only used
+ * for the topology.
+ */
+struct biosal_prefetched_vertex {
+    int ready;
+    int depth;
+    int step;
+    int request_step;
+    int reply_step;
+    struct biosal_assembly_vertex vertex;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "unitig_walker.h"
 
 #include "path_status.h"
+#include "prefetched_vertex.h"
 
 #include "../assembly_graph_store.h"
 #include "../assembly_vertex.h"
@@ -18,6 +19,8 @@
 
 #include <core/hash/hash.h>
 
+#include <core/structures/map_iterator.h>
+
 #include <core/system/command.h>
 #include <core/system/debugger.h>
 
@@ -82,6 +85,15 @@
 
 #define MEMORY_POOL_NAME_WALKER 0x78e238cd
 
+#define PREFETCH_DEPTH_OPTION "-unitig-walker-prefetch-depth"
+
+/*
+ * Let the graph stores extend linear stretches locally.
+ */
+#define BIOSAL_UNITIG_WALKER_USE_EXTENSION
+
+#define MAXIMUM_EXTENSION_LENGTH 2048
+
 struct thorium_script biosal_unitig_walker_script = {
     .identifier = SCRIPT_UNITIG_WALKER,
     .name = "biosal_unitig_walker",
@@ -127,6 +139,34 @@ void biosal_unitig_walker_init(struct thorium_actor *self)
     argv = thorium_actor_argv(self);
     */
 
+    concrete_self->prefetch_depth = 0;
+
+    if (core_command_has_argument(thorium_actor_argc(self), thorium_actor_argv(self),
+                            PREFETCH_DEPTH_OPTION)) {
+        concrete_self->prefetch_depth = core_command_get_argument_value_int(thorium_actor_argc(self),
+                        thorium_actor_argv(self), PREFETCH_DEPTH_OPTION);
+
+        if (concrete_self->prefetch_depth < 0) {
+            concrete_self->prefetch_depth = 0;
+        }
+    }
+
+    concrete_self->prefetch_step = 0;
+    concrete_self->prefetch_issued = 0;
+    concrete_self->prefetch_waiting = 0;
+    concrete_self->prefetch_requests = 0;
+    concrete_self->prefetch_waits = 0;
+
+    concrete_self->extension_attempted = 0;
+    concrete_self->extension_requests = 0;
+    concrete_self->extended_vertices = 0;
+
+    /*
+     * The key length is not known yet.
+     */
+    core_map_init(&concrete_self->prefetched_vertices, sizeof(int),
+                    sizeof(struct biosal_prefetched_vertex));
+
     core_set_init(&concrete_self->visited, 0);
 
     core_vector_init(&concrete_self->graph_stores, sizeof(int));
@@ -155,6 +195,10 @@ void biosal_unitig_walker_init(struct thorium_actor *self)
 
     thorium_actor_add_action(self, ACTION_NOTIFY, biosal_unitig_walker_notify);
     thorium_actor_add_action(self, ACTION_NOTIFY_REPLY, biosal_unitig_walker_notify_reply);
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_PREFETCH_VERTEX_REPLY,
+                    biosal_unitig_walker_prefetch_vertex_reply);
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_EXTEND_UNITIG_REPLY,
+                    biosal_unitig_walker_extend_unitig_reply);
 
     core_vector_init(&concrete_self->left_path, sizeof(int));
     core_vector_set_memory_pool(&concrete_self->left_path, &concrete_self->memory_pool);
@@ -248,10 +292,28 @@ void biosal_unitig_walker_destroy(struct thorium_actor *self)
 
     biosal_unitig_heuristic_destroy(&concrete_self->heuristic);
 
+    /*
+     * Discard everything.
+     */
+    ++concrete_self->prefetch_step;
+    biosal_unitig_walker_discard_prefetched_vertices(self);
+    core_map_destroy(&concrete_self->prefetched_vertices);
+
     printf("DEBUG unitig_walker skipped_at_start_used %d skipped_at_start_not_unitig %d\n",
                     concrete_self->skipped_at_start_used,
                     concrete_self->skipped_at_start_not_unitig);
 
+    printf("DEBUG unitig_walker extension_requests %d extended_vertices %d\n",
+                    concrete_self->extension_requests,
+                    concrete_self->extended_vertices);
+
+    if (concrete_self->prefetch_depth > 0) {
+        printf("DEBUG unitig_walker prefetch_depth %d prefetch_requests %d prefetch_waits %d\n",
+                    concrete_self->prefetch_depth,
+                    concrete_self->prefetch_requests,
+                    concrete_self->prefetch_waits);
+    }
+
     /*
      * Destroy the memory pool at the end.
      */
@@ -319,6 +381,12 @@ void biosal_unitig_walker_receive(struct thorium_actor *self, struct thorium_mes
          */
         core_set_init(&concrete_self->visited, concrete_self->key_length);
 
+        core_map_destroy(&concrete_self->prefetched_vertices);
+        core_map_init(&concrete_self->prefetched_vertices, concrete_self->key_length,
+                        sizeof(struct biosal_prefetched_vertex));
+        core_map_set_memory_pool(&concrete_self->prefetched_vertices,
+                        &concrete_self->memory_pool);
+
         biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
 
 #if 0
@@ -651,6 +719,21 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
         }
     }
 
+#ifdef BIOSAL_UNITIG_WALKER_USE_EXTENSION
+    if (biosal_unitig_walker_extend(self)) {
+        return;
+    }
+#endif
+
+    /*
+     * With prefetching, all the vertices are requested at once.
+     */
+    if (concrete_self->prefetch_depth > 0) {
+
+        biosal_unitig_walker_get_prefetched_vertices(self);
+        return;
+    }
+
     /* Fetch a child vertex.
      */
     if (concrete_self->current_child < child_count) {
@@ -773,13 +856,6 @@ void biosal_unitig_walker_get_vertex_reply(struct thorium_actor *self, struct th
     void *buffer;
     struct biosal_unitig_walker *concrete_self;
     struct biosal_assembly_vertex vertex;
-    int last_actor;
-    int last_path_index;
-    int name;
-    int length;
-    int new_count;
-    char *new_buffer;
-    int position;
 
     concrete_self = thorium_actor_concrete_actor(self);
     buffer = thorium_message_buffer(message);
@@ -811,55 +887,81 @@ void biosal_unitig_walker_get_vertex_reply(struct thorium_actor *self, struct th
     /*
      * Check for competition.
      */
+    if (!biosal_unitig_walker_notify_last_actor(self, &vertex)) {
+
+        thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
+    }
+}
+
+/*
+ * If another actor used the vertex, ask it about it with ACTION_NOTIFY.
+ *
+ * \return 1 if ACTION_NOTIFY was sent, 0 otherwise
+ */
+int biosal_unitig_walker_notify_last_actor(struct thorium_actor *self, struct biosal_assembly_vertex *vertex)
+{
+#ifdef BIOSAL_UNITIG_WALKER_DEBUG
+    struct biosal_unitig_walker *concrete_self;
+#endif
+    int last_actor;
+    int last_path_index;
+    int name;
+    int length;
+    int new_count;
+    char *new_buffer;
+    int position;
 
-    last_actor = biosal_assembly_vertex_last_actor(&vertex);
+#ifdef BIOSAL_UNITIG_WALKER_DEBUG
+    concrete_self = thorium_actor_concrete_actor(self);
+#endif
+
+    last_actor = biosal_assembly_vertex_last_actor(vertex);
     name = thorium_actor_name(self);
 
-    if (biosal_assembly_vertex_get_flag(&vertex, BIOSAL_VERTEX_FLAG_USED)
-                    && last_actor != name) {
+    if (!(biosal_assembly_vertex_get_flag(vertex, BIOSAL_VERTEX_FLAG_USED)
+                    && last_actor != name)) {
+        return 0;
+    }
 
-        last_path_index = biosal_assembly_vertex_last_path_index(&vertex);
+    last_path_index = biosal_assembly_vertex_last_path_index(vertex);
 #if 0
-        /* ask the other actor about it.
-         */
-        printf("actor/%d needs to ask actor/%d for solving BIOSAL_VERTEX_FLAG_USED\n",
-                        thorium_actor_name(self), actor);
+    /* ask the other actor about it.
+     */
+    printf("actor/%d needs to ask actor/%d for solving BIOSAL_VERTEX_FLAG_USED\n",
+                    thorium_actor_name(self), actor);
 #endif
 
-        length = biosal_unitig_walker_get_current_length(self);
+    length = biosal_unitig_walker_get_current_length(self);
 
-        new_count = 0;
-        new_count += sizeof(last_path_index);
-        new_count += sizeof(length);
+    new_count = 0;
+    new_count += sizeof(last_path_index);
+    new_count += sizeof(length);
 
-        new_buffer = thorium_actor_allocate(self, new_count);
+    new_buffer = thorium_actor_allocate(self, new_count);
 
-        position = 0;
-        core_memory_copy(new_buffer + position, &last_path_index, sizeof(last_path_index));
-        position += sizeof(last_path_index);
-        core_memory_copy(new_buffer + position, &length, sizeof(length));
-        position += sizeof(length);
+    position = 0;
+    core_memory_copy(new_buffer + position, &last_path_index, sizeof(last_path_index));
+    position += sizeof(last_path_index);
+    core_memory_copy(new_buffer + position, &length, sizeof(length));
+    position += sizeof(length);
 
 #ifdef BIOSAL_UNITIG_WALKER_DEBUG
-        printf("%d sends to %d ACTION_NOTIFY last_path_index %d current_path %d length %d\n",
-                        thorium_actor_name(self),
-                        last_actor, last_path_index,
-                        concrete_self->path_index, length);
+    printf("%d sends to %d ACTION_NOTIFY last_path_index %d current_path %d length %d\n",
+                    thorium_actor_name(self),
+                    last_actor, last_path_index,
+                    concrete_self->path_index, length);
 #endif
 
-        CORE_DEBUGGER_ASSERT(last_path_index >= 0);
+    CORE_DEBUGGER_ASSERT(last_path_index >= 0);
 
-        /*
-         * Ask the owner about it.
-         */
-
-        thorium_actor_send_buffer(self, last_actor, ACTION_NOTIFY, new_count,
-                        new_buffer);
+    /*
+     * Ask the owner about it.
+     */
 
-    } else {
+    thorium_actor_send_buffer(self, last_actor, ACTION_NOTIFY, new_count,
+                    new_buffer);
 
-        thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
-    }
+    return 1;
 }
 
 void biosal_unitig_walker_notify(struct thorium_actor *self, struct thorium_message *message)
@@ -1073,9 +1175,17 @@ void biosal_unitig_walker_clear(struct thorium_actor *self)
     for (i = 0; i < child_count; i++) {
 
         kmer = core_vector_at(&concrete_self->child_kmers, i);
-        vertex = core_vector_at(&concrete_self->child_vertices, i);
-
         biosal_dna_kmer_destroy(kmer, &concrete_self->memory_pool);
+    }
+
+    /*
+     * Vertices may not all be fetched (ACTION_ASSEMBLY_EXTEND_UNITIG).
+     */
+    child_count = core_vector_size(&concrete_self->child_vertices);
+
+    for (i = 0; i < child_count; i++) {
+
+        vertex = core_vector_at(&concrete_self->child_vertices, i);
         biosal_assembly_vertex_destroy(vertex);
     }
 
@@ -1091,15 +1201,26 @@ void biosal_unitig_walker_clear(struct thorium_actor *self)
     for (i = 0; i < parent_count; i++) {
 
         kmer = core_vector_at(&concrete_self->parent_kmers, i);
-        vertex = core_vector_at(&concrete_self->parent_vertices, i);
-
         biosal_dna_kmer_destroy(kmer, &concrete_self->memory_pool);
+    }
+
+    parent_count = core_vector_size(&concrete_self->parent_vertices);
+
+    for (i = 0; i < parent_count; i++) {
+
+        vertex = core_vector_at(&concrete_self->parent_vertices, i);
         biosal_assembly_vertex_destroy(vertex);
     }
 
     concrete_self->current_parent =0;
     core_vector_clear(&concrete_self->parent_kmers);
     core_vector_clear(&concrete_self->parent_vertices);
+
+    /*
+     * The next step will prefetch its own vertices.
+     */
+    concrete_self->prefetch_issued = 0;
+    concrete_self->extension_attempted = 0;
 }
 
 void biosal_unitig_walker_dump_path(struct thorium_actor *self)
@@ -2301,3 +2422,575 @@ void biosal_unitig_walker_select_strand(struct thorium_actor *self, int length,
 }
 
 
+
+/*
+ * Get the vertices of the current step from the prefetch cache.
+ *
+ * The first call of a step requests all the child and parent vertices
+ * at once (along with the neighbourhoods of the candidates if the
+ * prefetch depth allows it) and discards everything that is not
+ * reachable anymore from the current vertex, which are the vertices
+ * of mispredicted branches.
+ *
+ * The vertices of the step are requested again even if they are in
+ * the cache, because their flags and their last actor may have changed
+ * since. The cached copies only give the topology for the expansion.
+ *
+ * The vertices are then consumed in the same order as without
+ * prefetching, and ACTION_NOTIFY is still sent for each used vertex.
+ */
+void biosal_unitig_walker_get_prefetched_vertices(struct thorium_actor *self)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_prefetched_vertex *entry;
+    struct biosal_assembly_vertex vertex;
+    struct biosal_dna_kmer *kmer;
+    struct core_vector *kmers;
+    struct core_vector *vertices;
+    int *current;
+    char *key;
+    int child_depth;
+    int parent_depth;
+    int complete;
+    int i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    if (!concrete_self->prefetch_issued) {
+
+        concrete_self->prefetch_issued = 1;
+        ++concrete_self->prefetch_step;
+
+        /*
+         * Only the candidates in the direction of the walk are expanded.
+         */
+        child_depth = 0;
+        parent_depth = 0;
+
+        if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+            child_depth = concrete_self->prefetch_depth - 1;
+        } else {
+            parent_depth = concrete_self->prefetch_depth - 1;
+        }
+
+        for (i = 0; i < core_vector_size(&concrete_self->child_kmers); ++i) {
+            kmer = core_vector_at(&concrete_self->child_kmers, i);
+            biosal_unitig_walker_prefetch(self, kmer, child_depth, 1);
+        }
+
+        for (i = 0; i < core_vector_size(&concrete_self->parent_kmers); ++i) {
+            kmer = core_vector_at(&concrete_self->parent_kmers, i);
+            biosal_unitig_walker_prefetch(self, kmer, parent_depth, 1);
+        }
+
+        biosal_unitig_walker_discard_prefetched_vertices(self);
+    }
+
+    key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length);
+    complete = 1;
+
+    while (complete) {
+
+        if (concrete_self->current_child < core_vector_size(&concrete_self->child_kmers)) {
+            kmers = &concrete_self->child_kmers;
+            vertices = &concrete_self->child_vertices;
+            current = &concrete_self->current_child;
+            concrete_self->fetch_operation = OPERATION_FETCH_CHILDREN;
+
+        } else if (concrete_self->current_parent < core_vector_size(&concrete_self->parent_kmers)) {
+            kmers = &concrete_self->parent_kmers;
+            vertices = &concrete_self->parent_vertices;
+            current = &concrete_self->current_parent;
+            concrete_self->fetch_operation = OPERATION_FETCH_PARENTS;
+
+        } else {
+            break;
+        }
+
+        kmer = core_vector_at(kmers, *current);
+        biosal_dna_kmer_pack(kmer, key, concrete_self->kmer_length, &concrete_self->codec);
+        entry = core_map_get(&concrete_self->prefetched_vertices, key);
+
+        /*
+         * Wait for ACTION_ASSEMBLY_PREFETCH_VERTEX_REPLY.
+         */
+        if (entry == NULL || !entry->ready
+                        || entry->reply_step != concrete_self->prefetch_step) {
+
+            if (entry == NULL || entry->request_step != concrete_self->prefetch_step) {
+                biosal_unitig_walker_prefetch(self, kmer, 0, 1);
+            }
+
+            if (!concrete_self->prefetch_waiting) {
+                ++concrete_self->prefetch_waits;
+            }
+
+            concrete_self->prefetch_waiting = 1;
+            complete = 0;
+            break;
+        }
+
+        concrete_self->prefetch_waiting = 0;
+
+        biosal_assembly_vertex_init_copy(&vertex, &entry->vertex);
+        core_vector_push_back(vertices, &vertex);
+        ++*current;
+
+        /*
+         * Continue when ACTION_NOTIFY_REPLY is received.
+         */
+        if (biosal_unitig_walker_notify_last_actor(self, &vertex)) {
+            complete = 0;
+        }
+    }
+
+    core_memory_pool_free(ephemeral_memory, key);
+
+    if (complete) {
+        biosal_unitig_walker_make_decision(self);
+    }
+}
+
+/*
+ * Request a vertex, unless it is already in the cache.
+ *
+ * depth is the number of levels to fetch beyond this vertex. The
+ * entries that are reached again are kept for the current step.
+ * With fresh, a cached vertex is requested again (once per step)
+ * because it will be consumed.
+ */
+void biosal_unitig_walker_prefetch(struct thorium_actor *self, struct biosal_dna_kmer *kmer, int depth,
+                int fresh)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_prefetched_vertex *entry;
+    struct biosal_assembly_vertex vertex;
+    struct thorium_message new_message;
+    char *new_buffer;
+    int new_count;
+    int store_index;
+    int store;
+    char *key;
+    int send;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length);
+    biosal_dna_kmer_pack(kmer, key, concrete_self->kmer_length, &concrete_self->codec);
+
+    entry = core_map_get(&concrete_self->prefetched_vertices, key);
+    send = 0;
+
+    if (entry != NULL) {
+
+        entry->step = concrete_self->prefetch_step;
+
+        if (fresh && entry->request_step != concrete_self->prefetch_step) {
+            entry->request_step = concrete_self->prefetch_step;
+            send = 1;
+        }
+
+        if (depth > entry->depth) {
+            entry->depth = depth;
+        }
+
+        if (entry->ready && depth > 0) {
+            /*
+             * The map may grow during the expansion.
+             */
+            biosal_assembly_vertex_init_copy(&vertex, &entry->vertex);
+            biosal_unitig_walker_prefetch_neighbours(self, kmer, &vertex, depth);
+            biosal_assembly_vertex_destroy(&vertex);
+        }
+
+        if (!send) {
+            core_memory_pool_free(ephemeral_memory, key);
+            return;
+        }
+
+    } else {
+        entry = core_map_add(&concrete_self->prefetched_vertices, key);
+        entry->ready = 0;
+        entry->depth = depth;
+        entry->step = concrete_self->prefetch_step;
+        entry->request_step = concrete_self->prefetch_step;
+        entry->reply_step = -1;
+    }
+
+    store_index = biosal_dna_kmer_store_index(kmer,
+                core_vector_size(&concrete_self->graph_stores),
+                concrete_self->kmer_length,
+                &concrete_self->codec, ephemeral_memory);
+    store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
+
+    ++concrete_self->prefetch_requests;
+
+    /*
+     * The step is sent back by the graph store after the kmer.
+     */
+    new_count = concrete_self->key_length + sizeof(concrete_self->prefetch_step);
+    new_buffer = thorium_actor_allocate(self, new_count);
+    core_memory_copy(new_buffer, key, concrete_self->key_length);
+    core_memory_copy(new_buffer + concrete_self->key_length, &concrete_self->prefetch_step,
+                    sizeof(concrete_self->prefetch_step));
+    core_memory_pool_free(ephemeral_memory, key);
+
+    thorium_message_init(&new_message, ACTION_ASSEMBLY_PREFETCH_VERTEX, new_count, new_buffer);
+    thorium_actor_send(self, store, &new_message);
+    thorium_message_destroy(&new_message);
+}
+
+/*
+ * Prefetch the children and parents of a vertex. The ones in the
+ * direction of the walk are the candidates of the next step, and they
+ * are expanded further.
+ */
+void biosal_unitig_walker_prefetch_neighbours(struct thorium_actor *self, struct biosal_dna_kmer *kmer,
+                struct biosal_assembly_vertex *vertex, int depth)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct biosal_dna_kmer neighbour;
+    int child_depth;
+    int parent_depth;
+    int count;
+    int code;
+    int i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    child_depth = 0;
+    parent_depth = 0;
+
+    if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+        child_depth = depth - 1;
+    } else {
+        parent_depth = depth - 1;
+    }
+
+    count = biosal_assembly_vertex_child_count(vertex);
+
+    for (i = 0; i < count; ++i) {
+
+        code = biosal_assembly_vertex_get_child(vertex, i);
+        biosal_dna_kmer_init_as_child(&neighbour, kmer, code, concrete_self->kmer_length,
+                        &concrete_self->memory_pool, &concrete_self->codec);
+
+        biosal_unitig_walker_prefetch(self, &neighbour, child_depth, 0);
+
+        biosal_dna_kmer_destroy(&neighbour, &concrete_self->memory_pool);
+    }
+
+    count = biosal_assembly_vertex_parent_count(vertex);
+
+    for (i = 0; i < count; ++i) {
+
+        code = biosal_assembly_vertex_get_parent(vertex, i);
+        biosal_dna_kmer_init_as_parent(&neighbour, kmer, code, concrete_self->kmer_length,
+                        &concrete_self->memory_pool, &concrete_self->codec);
+
+        biosal_unitig_walker_prefetch(self, &neighbour, parent_depth, 0);
+
+        biosal_dna_kmer_destroy(&neighbour, &concrete_self->memory_pool);
+    }
+}
+
+void biosal_unitig_walker_prefetch_vertex_reply(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_prefetched_vertex *entry;
+    struct biosal_assembly_vertex vertex;
+    struct biosal_dna_kmer kmer;
+    char *buffer;
+    int was_ready;
+    int depth;
+    int step;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    buffer = thorium_message_buffer(message);
+
+    entry = core_map_get(&concrete_self->prefetched_vertices, buffer);
+
+    /*
+     * The vertex was on a branch that was not selected.
+     */
+    if (entry == NULL) {
+        return;
+    }
+
+    core_memory_copy(&step, buffer + concrete_self->key_length, sizeof(step));
+
+    was_ready = entry->ready;
+
+    /*
+     * A late reply to a request of an earlier step is older than
+     * the vertex already in the cache.
+     */
+    if (was_ready && step < entry->reply_step) {
+        return;
+    }
+
+    if (was_ready) {
+        biosal_assembly_vertex_destroy(&entry->vertex);
+    }
+
+    biosal_assembly_vertex_init(&entry->vertex);
+    biosal_assembly_vertex_unpack(&entry->vertex, buffer + concrete_self->key_length + sizeof(step));
+    entry->ready = 1;
+    entry->reply_step = step;
+
+    depth = entry->depth;
+
+    if (!was_ready && depth > 0) {
+
+        biosal_assembly_vertex_init_copy(&vertex, &entry->vertex);
+
+        biosal_dna_kmer_init_empty(&kmer);
+        biosal_dna_kmer_unpack(&kmer, buffer, concrete_self->kmer_length,
+                        ephemeral_memory, &concrete_self->codec);
+
+        biosal_unitig_walker_prefetch_neighbours(self, &kmer, &vertex, depth);
+
+        biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+        biosal_assembly_vertex_destroy(&vertex);
+    }
+
+    if (concrete_self->prefetch_waiting) {
+        biosal_unitig_walker_get_prefetched_vertices(self);
+    }
+}
+
+/*
+ * Remove the vertices that were not needed by the current step.
+ */
+void biosal_unitig_walker_discard_prefetched_vertices(struct thorium_actor *self)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct core_map_iterator iterator;
+    struct biosal_prefetched_vertex *entry;
+    struct core_vector keys;
+    void *key;
+    int i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    core_vector_init(&keys, core_map_get_key_size(&concrete_self->prefetched_vertices));
+    core_vector_set_memory_pool(&keys, ephemeral_memory);
+
+    core_map_iterator_init(&iterator, &concrete_self->prefetched_vertices);
+
+    while (core_map_iterator_next(&iterator, &key, (void **)&entry)) {
+
+        if (entry->step == concrete_self->prefetch_step) {
+            continue;
+        }
+
+        if (entry->ready) {
+            biosal_assembly_vertex_destroy(&entry->vertex);
+        }
+
+        core_vector_push_back(&keys, key);
+    }
+
+    core_map_iterator_destroy(&iterator);
+
+    for (i = 0; i < core_vector_size(&keys); ++i) {
+        core_map_delete(&concrete_self->prefetched_vertices, core_vector_at(&keys, i));
+    }
+
+    core_vector_destroy(&keys);
+}
+
+/*
+ * Ask the graph store of the next vertex to extend the path locally.
+ *
+ * This is only done when the current vertex has exactly one arc in each
+ * direction and is not the starting vertex, so that its only neighbour
+ * behind is the previous vertex of the path. Otherwise, and if the store
+ * can not take the next vertex, the step is done one vertex at a time.
+ *
+ * \return 1 if ACTION_ASSEMBLY_EXTEND_UNITIG was sent, 0 otherwise
+ */
+int biosal_unitig_walker_extend(struct thorium_actor *self)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer *kmer;
+    struct core_vector *path;
+    struct thorium_message new_message;
+    char *new_buffer;
+    int new_count;
+    int position;
+    int operation;
+    int code;
+    int store_index;
+    int store_count;
+    int store;
+    int maximum;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    if (concrete_self->extension_attempted
+                    || concrete_self->current_child > 0
+                    || concrete_self->current_parent > 0
+                    || biosal_assembly_vertex_child_count(&concrete_self->current_vertex) != 1
+                    || biosal_assembly_vertex_parent_count(&concrete_self->current_vertex) != 1) {
+        return 0;
+    }
+
+    if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+        operation = 0;
+        path = &concrete_self->right_path;
+        kmer = core_vector_at(&concrete_self->child_kmers, 0);
+        code = biosal_assembly_vertex_get_child(&concrete_self->current_vertex, 0);
+    } else {
+        operation = 1;
+        path = &concrete_self->left_path;
+        kmer = core_vector_at(&concrete_self->parent_kmers, 0);
+        code = biosal_assembly_vertex_get_parent(&concrete_self->current_vertex, 0);
+    }
+
+    if (core_vector_size(path) == 0) {
+        return 0;
+    }
+
+    concrete_self->extension_attempted = 1;
+    ++concrete_self->extension_requests;
+
+    store_count = core_vector_size(&concrete_self->graph_stores);
+    store_index = biosal_dna_kmer_store_index(kmer, store_count,
+                concrete_self->kmer_length,
+                &concrete_self->codec, ephemeral_memory);
+    store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
+    maximum = MAXIMUM_EXTENSION_LENGTH;
+
+    new_count = 2 * concrete_self->key_length + 6 * sizeof(int);
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    position = 0;
+    position += biosal_dna_kmer_pack(kmer, new_buffer + position,
+                concrete_self->kmer_length, &concrete_self->codec);
+    core_memory_copy(new_buffer + position, &code, sizeof(code));
+    position += sizeof(code);
+    position += biosal_dna_kmer_pack(&concrete_self->starting_kmer, new_buffer + position,
+                concrete_self->kmer_length, &concrete_self->codec);
+    core_memory_copy(new_buffer + position, &operation, sizeof(operation));
+    position += sizeof(operation);
+    core_memory_copy(new_buffer + position, &concrete_self->path_index, sizeof(concrete_self->path_index));
+    position += sizeof(concrete_self->path_index);
+    core_memory_copy(new_buffer + position, &store_index, sizeof(store_index));
+    position += sizeof(store_index);
+    core_memory_copy(new_buffer + position, &store_count, sizeof(store_count));
+    position += sizeof(store_count);
+    core_memory_copy(new_buffer + position, &maximum, sizeof(maximum));
+    position += sizeof(maximum);
+
+    CORE_DEBUGGER_ASSERT(position == new_count);
+
+    thorium_message_init(&new_message, ACTION_ASSEMBLY_EXTEND_UNITIG, new_count, new_buffer);
+    thorium_actor_send(self, store, &new_message);
+    thorium_message_destroy(&new_message);
+
+    return 1;
+}
+
+void biosal_unitig_walker_extend_unitig_reply(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer next_kmer;
+    struct biosal_assembly_vertex vertex;
+    struct core_vector *path;
+    char *buffer;
+    void *key;
+    int position;
+    int count;
+    int code;
+    int i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    buffer = thorium_message_buffer(message);
+
+    position = 0;
+    position += thorium_message_unpack_int(message, position, &count);
+
+    /*
+     * Do the step one vertex at a time.
+     */
+    if (count == 0) {
+        thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
+        return;
+    }
+
+    concrete_self->extended_vertices += count;
+
+    if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+        path = &concrete_self->right_path;
+    } else {
+        path = &concrete_self->left_path;
+    }
+
+    /*
+     * The graph store marked the vertices. Add them to the path and
+     * to the visited set, like biosal_unitig_walker_make_decision does.
+     */
+    key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length);
+
+    biosal_dna_kmer_init_copy(&kmer, &concrete_self->current_kmer,
+                    concrete_self->kmer_length, &concrete_self->memory_pool,
+                    &concrete_self->codec);
+
+    for (i = 0; i < count; ++i) {
+
+        position += thorium_message_unpack_int(message, position, &code);
+
+        if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+            biosal_dna_kmer_init_as_child(&next_kmer, &kmer, code, concrete_self->kmer_length,
+                            &concrete_self->memory_pool, &concrete_self->codec);
+        } else {
+            biosal_dna_kmer_init_as_parent(&next_kmer, &kmer, code, concrete_self->kmer_length,
+                            &concrete_self->memory_pool, &concrete_self->codec);
+        }
+
+        biosal_dna_kmer_destroy(&kmer, &concrete_self->memory_pool);
+        kmer = next_kmer;
+
+        core_vector_push_back(path, &code);
+
+        biosal_dna_kmer_pack(&kmer, key, concrete_self->kmer_length, &concrete_self->codec);
+        core_set_add(&concrete_self->visited, key);
+    }
+
+    biosal_dna_kmer_destroy(&kmer, &concrete_self->memory_pool);
+    core_memory_pool_free(ephemeral_memory, key);
+
+    /*
+     * Continue from the last vertex.
+     */
+    biosal_dna_kmer_init_empty(&kmer);
+    position += biosal_dna_kmer_unpack(&kmer, buffer + position, concrete_self->kmer_length,
+                    &concrete_self->memory_pool, &concrete_self->codec);
+
+    biosal_assembly_vertex_init(&vertex);
+    position += biosal_assembly_vertex_unpack(&vertex, buffer + position);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, thorium_message_count(message));
+
+    biosal_unitig_walker_set_current(self, &kmer, &vertex);
+    biosal_unitig_walker_clear(self);
+
+    biosal_dna_kmer_destroy(&kmer, &concrete_self->memory_pool);
+    biosal_assembly_vertex_destroy(&vertex);
+
+    thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
+}
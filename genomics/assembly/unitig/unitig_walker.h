@@ -81,6 +81,30 @@ struct biosal_unitig_walker {
 
     int writer_process;
     int start_messages;
+
+    /*
+     * Speculative lookahead (-unitig-walker-prefetch-depth).
+     *
+     * With a depth of 1, the vertices of a step are fetched
+     * all at once instead of one at a time. With a greater depth,
+     * the neighbourhoods of the candidates are also fetched
+     * while the decision is pending. 0 disables prefetching.
+     */
+    int prefetch_depth;
+    int prefetch_step;
+    int prefetch_issued;
+    int prefetch_waiting;
+    int prefetch_requests;
+    int prefetch_waits;
+    struct core_map prefetched_vertices;
+
+    /*
+     * Linear stretches are extended by the graph stores
+     * with ACTION_ASSEMBLY_EXTEND_UNITIG.
+     */
+    int extension_attempted;
+    int extension_requests;
+    int extended_vertices;
 };
 
 extern struct thorium_script biosal_unitig_walker_script;
@@ -123,6 +147,18 @@ void biosal_unitig_walker_notify(struct thorium_actor *self, struct thorium_mess
 void biosal_unitig_walker_notify_reply(struct thorium_actor *self, struct thorium_message *message);
 
 void biosal_unitig_walker_mark_vertex(struct thorium_actor *self, struct biosal_dna_kmer *kmer);
+int biosal_unitig_walker_notify_last_actor(struct thorium_actor *self, struct biosal_assembly_vertex *vertex);
+
+void biosal_unitig_walker_get_prefetched_vertices(struct thorium_actor *self);
+void biosal_unitig_walker_prefetch(struct thorium_actor *self, struct biosal_dna_kmer *kmer, int depth,
+                int fresh);
+void biosal_unitig_walker_prefetch_neighbours(struct thorium_actor *self, struct biosal_dna_kmer *kmer,
+                struct biosal_assembly_vertex *vertex, int depth);
+void biosal_unitig_walker_prefetch_vertex_reply(struct thorium_actor *self, struct thorium_message *message);
+void biosal_unitig_walker_discard_prefetched_vertices(struct thorium_actor *self);
+
+int biosal_unitig_walker_extend(struct thorium_actor *self);
+void biosal_unitig_walker_extend_unitig_reply(struct thorium_actor *self, struct thorium_message *message);
 
 int biosal_unitig_walker_select_old_version(struct thorium_actor *self, int *output_status);
 void biosal_unitig_walker_normalize_cycle(struct thorium_actor *self, int length, char *sequence);
@@ -13,42 +13,66 @@
 
 #include <stdint.h>
 
+/*
+ * The AVX2 kernel is compiled with a target attribute and is only
+ * used if the processor supports it.
+ */
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+#define BIOSAL_DNA_CODEC_HAS_SSE2_KERNEL
+#define BIOSAL_DNA_CODEC_HAS_AVX2_KERNEL
+#endif
+
 #define BITS_PER_NUCLEOTIDE 2
 #define BITS_PER_BYTE 8
 
 #define BIOSAL_DNA_CODEC_MINIMUM_NODE_COUNT_FOR_TWO_BIT 2
 
-/*
- * Fast implemention of reverse complement in place
- * in 2-bit format.
- */
-/*
-*/
-#define FAST_REVERSE_COMPLEMENT
+static void biosal_dna_codec_generate_tables(struct biosal_dna_codec *self);
+static void biosal_dna_codec_encode_scalar(struct biosal_dna_codec *self,
+                int start, int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence);
+static int biosal_dna_codec_encode_swar(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence);
+static int biosal_dna_codec_decode_swar(int length_in_nucleotides, uint8_t *encoded_sequence,
+                char *dna_sequence);
+static void biosal_dna_codec_reverse_complement_swar(uint8_t *bytes, int *left, int *right);
+static int biosal_dna_codec_remove_padding_swar(uint8_t *bytes, int used_bytes, int shift);
+
+#ifdef BIOSAL_DNA_CODEC_HAS_SSE2_KERNEL
+static int biosal_dna_codec_encode_sse2(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence);
+#endif
 
-#define MEMORY_CODEC 0x9687799e
+#ifdef BIOSAL_DNA_CODEC_HAS_AVX2_KERNEL
+static int biosal_dna_codec_encode_avx2(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence);
+#endif
 
 void biosal_dna_codec_init(struct biosal_dna_codec *self)
 {
+    int backend;
+
     /* 4 * 2 = 8 bits = 1 byte
      */
     self->block_length = 4;
 
     self->use_two_bit_encoding = 0;
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-    core_memory_pool_init(&self->pool, 0, MEMORY_CODEC);
-
-    core_map_init(&self->encoding_lookup_table, self->block_length, 1);
-    core_map_set_memory_pool(&self->encoding_lookup_table, &self->pool);
-#endif
+    biosal_dna_codec_generate_tables(self);
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-    core_map_init(&self->decoding_lookup_table, 1, self->block_length);
-    core_map_set_memory_pool(&self->decoding_lookup_table, &self->pool);
+    /*
+     * Pick the fastest backend supported by the processor.
+     */
+    self->backend = BIOSAL_DNA_CODEC_BACKEND_SCALAR;
 
-    biosal_dna_codec_generate_blocks(self);
-#endif
+    for (backend = BIOSAL_DNA_CODEC_BACKEND_AVX2; backend > BIOSAL_DNA_CODEC_BACKEND_SCALAR;
+                    --backend) {
+        if (biosal_dna_codec_has_backend(backend)) {
+            self->backend = backend;
+            break;
+        }
+    }
 
 #ifdef BIOSAL_DNA_CODEC_FORCE_TWO_BIT_ENCODING_DISABLE_000
     biosal_dna_codec_enable_two_bit_encoding(self);
@@ -57,76 +81,103 @@ void biosal_dna_codec_init(struct biosal_dna_codec *self)
 
 void biosal_dna_codec_destroy(struct biosal_dna_codec *self)
 {
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-    core_map_destroy(&self->encoding_lookup_table);
-#endif
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-    core_map_destroy(&self->decoding_lookup_table);
-
-    core_memory_pool_destroy(&self->pool);
-#endif
-
     self->block_length = 0;
+    self->backend = BIOSAL_DNA_CODEC_BACKEND_SCALAR;
 }
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-void biosal_dna_codec_generate_blocks(struct biosal_dna_codec *self)
+/*
+ * Generate the flat lookup tables:
+ *
+ * - encoding_table: symbol -> 2-bit code
+ * - decoding_table: byte -> 4 symbols
+ * - reverse_complement_table: byte -> reverse complement of the 4 codes in the byte
+ */
+static void biosal_dna_codec_generate_tables(struct biosal_dna_codec *self)
 {
-    char *block;
+    int i;
+    int j;
+    int code;
+    int reverse_complement;
+
+    for (i = 0; i < 256; ++i) {
+        self->encoding_table[i] = biosal_dna_codec_get_code((char)i);
+    }
+
+    for (i = 0; i < 256; ++i) {
+
+        reverse_complement = 0;
+
+        for (j = 0; j < self->block_length; ++j) {
+            code = (i >> (j * BITS_PER_NUCLEOTIDE)) & BIOSAL_NUCLEOTIDE_CODE_T;
 
-    block = core_memory_allocate(self->block_length + 1, MEMORY_CODEC);
+            self->decoding_table[i][j] = biosal_dna_codec_get_nucleotide_from_code(code);
 
-    biosal_dna_codec_generate_block(self, -1, 'X', block);
+            reverse_complement |= (BIOSAL_NUCLEOTIDE_CODE_T - code)
+                    << ((self->block_length - 1 - j) * BITS_PER_NUCLEOTIDE);
+        }
 
-    core_memory_free(block, MEMORY_CODEC);
+        self->reverse_complement_table[i] = reverse_complement;
+    }
 }
 
-void biosal_dna_codec_generate_block(struct biosal_dna_codec *self, int position, char symbol,
-                char *block)
+int biosal_dna_codec_has_backend(int backend)
 {
-    char buffer[10];
-    void *bucket;
+    uint32_t value;
 
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-    printf("DEBUG position %d symbol %c\n", position, symbol);
-#endif
+    if (backend == BIOSAL_DNA_CODEC_BACKEND_SCALAR) {
+        return 1;
 
-    if (position >= 0) {
-        block[position] = symbol;
-    }
+    } else if (backend == BIOSAL_DNA_CODEC_BACKEND_SWAR) {
 
-    position++;
+        /*
+         * The SWAR kernel loads 8 symbols in a word, so it needs the
+         * first symbol in the low byte.
+         */
+        value = 1;
+        return *(uint8_t *)&value == 1;
 
-    if (position < self->block_length && symbol != '\0') {
+#ifdef BIOSAL_DNA_CODEC_HAS_SSE2_KERNEL
+    } else if (backend == BIOSAL_DNA_CODEC_BACKEND_SSE2) {
+        return __builtin_cpu_supports("sse2");
+#endif
 
-        biosal_dna_codec_generate_block(self, position, 'A', block);
-        biosal_dna_codec_generate_block(self, position, 'T', block);
-        biosal_dna_codec_generate_block(self, position, 'G', block);
-        biosal_dna_codec_generate_block(self, position, 'C', block);
-        /*biosal_dna_codec_generate_block(self, position, '\0', block);*/
-    } else {
+#ifdef BIOSAL_DNA_CODEC_HAS_AVX2_KERNEL
+    } else if (backend == BIOSAL_DNA_CODEC_BACKEND_AVX2) {
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
 
-        while (position < self->block_length + 1) {
+    return 0;
+}
 
-            block[position] = '\0';
-            position++;
-        }
+int biosal_dna_codec_get_backend(struct biosal_dna_codec *self)
+{
+    return self->backend;
+}
 
-        biosal_dna_codec_encode_default(self, self->block_length, block, buffer);
+int biosal_dna_codec_set_backend(struct biosal_dna_codec *self, int backend)
+{
+    if (!biosal_dna_codec_has_backend(backend)) {
+        return 0;
+    }
 
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-        printf("BLOCK %s (%d) value %d\n", block, self->block_length, (int)buffer[0]);
-#endif
+    self->backend = backend;
 
-        bucket = core_map_add(&self->encoding_lookup_table, block);
-        core_memory_copy(bucket, buffer, 1);
+    return 1;
+}
 
-        bucket = core_map_add(&self->decoding_lookup_table, buffer);
-        core_memory_copy(bucket, block, self->block_length);
+const char *biosal_dna_codec_backend_name(int backend)
+{
+    if (backend == BIOSAL_DNA_CODEC_BACKEND_SWAR) {
+        return "swar";
+    } else if (backend == BIOSAL_DNA_CODEC_BACKEND_SSE2) {
+        return "sse2";
+    } else if (backend == BIOSAL_DNA_CODEC_BACKEND_AVX2) {
+        return "avx2";
     }
 
+    return "scalar";
 }
-#endif
 
 int biosal_dna_codec_encoded_length(struct biosal_dna_codec *self, int length_in_nucleotides)
 {
@@ -158,71 +209,394 @@ void biosal_dna_codec_encode(struct biosal_dna_codec *self,
 {
     if (self->use_two_bit_encoding) {
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-        biosal_dna_codec_encode_with_blocks(self, length_in_nucleotides, dna_sequence, encoded_sequence);
-#else
-        biosal_dna_codec_encode_default(self, length_in_nucleotides, dna_sequence, encoded_sequence);
-#endif
+        biosal_dna_codec_encode_with_tables(self, length_in_nucleotides, dna_sequence, encoded_sequence);
     } else {
         strcpy(encoded_sequence, dna_sequence);
     }
 }
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-void biosal_dna_codec_encode_with_blocks(struct biosal_dna_codec *self,
+void biosal_dna_codec_encode_with_tables(struct biosal_dna_codec *self,
                 int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
 {
+    int encoded_length;
+    int done;
+    int used_bytes;
+
+    done = 0;
 
-#if 0
-    biosal_dna_codec_encode_default(length_in_nucleotides, dna_sequence, encoded_sequence);
+    if (self->backend == BIOSAL_DNA_CODEC_BACKEND_SWAR) {
+        done = biosal_dna_codec_encode_swar(self, length_in_nucleotides, dna_sequence,
+                        encoded_sequence);
+
+#ifdef BIOSAL_DNA_CODEC_HAS_SSE2_KERNEL
+    } else if (self->backend == BIOSAL_DNA_CODEC_BACKEND_SSE2) {
+        done = biosal_dna_codec_encode_sse2(self, length_in_nucleotides, dna_sequence,
+                        encoded_sequence);
 #endif
-    int position;
+
+#ifdef BIOSAL_DNA_CODEC_HAS_AVX2_KERNEL
+    } else if (self->backend == BIOSAL_DNA_CODEC_BACKEND_AVX2) {
+        done = biosal_dna_codec_encode_avx2(self, length_in_nucleotides, dna_sequence,
+                        encoded_sequence);
+#endif
+    }
+
+    /*
+     * The scalar code does the tail.
+     */
+    biosal_dna_codec_encode_scalar(self, done, length_in_nucleotides, dna_sequence,
+                    encoded_sequence);
+
+    /*
+     * Clear the padding.
+     */
+    encoded_length = biosal_dna_codec_encoded_length_default(self, length_in_nucleotides);
+    used_bytes = (length_in_nucleotides + self->block_length - 1) / self->block_length;
+
+    if (used_bytes < encoded_length) {
+        memset((uint8_t *)encoded_sequence + used_bytes, 0, encoded_length - used_bytes);
+    }
+}
+
+/*
+ * Encode nucleotides from start (a multiple of 4) to the end with the
+ * encoding table.
+ */
+static void biosal_dna_codec_encode_scalar(struct biosal_dna_codec *self,
+                int start, int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence)
+{
+    int i;
+    int j;
+    int limit;
     uint8_t byte;
-    char data[5];
-    int remaining;
-    char *block;
-    int byte_position;
+    uint8_t *symbols;
+    uint8_t *table;
 
-    byte_position = 0;
-    position = 0;
+    symbols = (uint8_t *)dna_sequence;
+    table = self->encoding_table;
 
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-    printf("DEBUG encoding %s\n", dna_sequence);
-#endif
+    for (i = start; i < length_in_nucleotides; i += 4) {
 
-    while (position < length_in_nucleotides) {
+        limit = length_in_nucleotides - i;
 
+        if (limit >= 4) {
+            byte = table[symbols[i]]
+                    | (table[symbols[i + 1]] << 2)
+                    | (table[symbols[i + 2]] << 4)
+                    | (table[symbols[i + 3]] << 6);
+        } else {
+            byte = 0;
 
-        remaining = length_in_nucleotides - position;
-        block = dna_sequence + position;
+            for (j = 0; j < limit; ++j) {
+                byte |= table[symbols[i + j]] << (j * BITS_PER_NUCLEOTIDE);
+            }
+        }
 
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-        printf("DEBUG position %d remaining %d block_length %d\n",
-                        position, remaining, self->block_length);
-#endif
+        encoded_sequence[i / 4] = byte;
+    }
+}
+
+/*
+ * For A (0x41), C (0x43), G (0x47) and T (0x54),
+ * ((symbol >> 1) ^ (symbol >> 2)) & 3 is the 2-bit code.
+ *
+ * Any other symbol is encoded as A by biosal_dna_codec_get_code, so
+ * the vector kernels only process blocks which contain A, C, G and T and
+ * leave the other blocks to the encoding table.
+ */
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_LOW_BITS 0x7f7f7f7f7f7f7f7fULL
+#define SWAR_HIGH_BITS 0x8080808080808080ULL
+
+/*
+ * Return 0x80 in each byte equal to zero.
+ */
+#define SWAR_ZERO_BYTES(word) \
+        (~((((word) & SWAR_LOW_BITS) + SWAR_LOW_BITS) | (word) | SWAR_LOW_BITS))
+
+static int biosal_dna_codec_encode_swar(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence)
+{
+    int i;
+    uint64_t word;
+    uint64_t valid;
+    uint64_t codes;
+    int limit;
 
-        /* a buffer is required when less than block size
-         * nucleotides remain
+    limit = length_in_nucleotides - (length_in_nucleotides % 8);
+
+    for (i = 0; i < limit; i += 8) {
+
+        memcpy(&word, dna_sequence + i, sizeof(word));
+
+        valid = SWAR_ZERO_BYTES(word ^ (SWAR_ONES * BIOSAL_NUCLEOTIDE_SYMBOL_A))
+                | SWAR_ZERO_BYTES(word ^ (SWAR_ONES * BIOSAL_NUCLEOTIDE_SYMBOL_C))
+                | SWAR_ZERO_BYTES(word ^ (SWAR_ONES * BIOSAL_NUCLEOTIDE_SYMBOL_G))
+                | SWAR_ZERO_BYTES(word ^ (SWAR_ONES * BIOSAL_NUCLEOTIDE_SYMBOL_T));
+
+        if (valid != SWAR_HIGH_BITS) {
+            biosal_dna_codec_encode_scalar(self, i, i + 8, dna_sequence, encoded_sequence);
+            continue;
+        }
+
+        codes = ((word >> 1) ^ (word >> 2)) & (SWAR_ONES * BIOSAL_NUCLEOTIDE_CODE_T);
+
+        /*
+         * Gather the 4 codes of each half in its low byte.
          */
-        if (remaining < self->block_length) {
+        codes |= codes >> 6;
+        codes |= codes >> 12;
+
+        encoded_sequence[i / 4] = codes;
+        encoded_sequence[i / 4 + 1] = codes >> 32;
+    }
+
+    return limit;
+}
+
+/*
+ * Decode 2 bytes (8 nucleotides) at a time, and return the number of
+ * bytes that were decoded.
+ *
+ * This is the encoder in reverse: the 4 codes of a byte are spread to the
+ * 4 bytes of a 32-bit half, and each code c (bits c1 c0) becomes the
+ * symbol 'A' + 2 * c0 + 6 * c1 + 11 * (c0 & c1), that is A, C, G or T.
+ * No byte overflows, so the additions are done on the whole word.
+ */
+static int biosal_dna_codec_decode_swar(int length_in_nucleotides, uint8_t *encoded_sequence,
+                char *dna_sequence)
+{
+    int i;
+    int limit;
+    uint64_t codes;
+    uint64_t low_bits;
+    uint64_t high_bits;
+    uint64_t symbols;
+
+    limit = length_in_nucleotides / 8 * 2;
+
+    for (i = 0; i < limit; i += 2) {
+
+        codes = encoded_sequence[i] | ((uint64_t)encoded_sequence[i + 1] << 32);
+
+        codes |= codes << 12;
+        codes |= codes << 6;
+        codes &= SWAR_ONES * BIOSAL_NUCLEOTIDE_CODE_T;
+
+        low_bits = codes & SWAR_ONES;
+        high_bits = (codes >> 1) & SWAR_ONES;
 
-            /* A is 00, so it is the same as nothing
-             */
-            memset(data, 'A', self->block_length);
-            core_memory_copy(data, block, remaining);
-            block = data;
+        symbols = SWAR_ONES * BIOSAL_NUCLEOTIDE_SYMBOL_A
+                + 2 * low_bits + 6 * high_bits + 11 * (low_bits & high_bits);
+
+        memcpy(dna_sequence + i * 4, &symbols, sizeof(symbols));
+    }
+
+    return limit;
+}
+
+/*
+ * Reverse the order of the 32 codes of a word and complement them
+ * (the complement of a code is ~code).
+ */
+static inline uint64_t biosal_dna_codec_reverse_complement_word(uint64_t word)
+{
+    word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+    word = ((word >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((word & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    word = ((word >> 8) & 0x00ff00ff00ff00ffULL) | ((word & 0x00ff00ff00ff00ffULL) << 8);
+    word = ((word >> 16) & 0x0000ffff0000ffffULL) | ((word & 0x0000ffff0000ffffULL) << 16);
+    word = (word >> 32) | (word << 32);
+
+    return ~word;
+}
+
+/*
+ * Swap and reverse-complement 8 bytes from each end at a time. left and
+ * right are the first and last bytes that are left for the table.
+ */
+static void biosal_dna_codec_reverse_complement_swar(uint8_t *bytes, int *left, int *right)
+{
+    uint64_t first;
+    uint64_t last;
+
+    while (*right - *left + 1 >= 16) {
+
+        memcpy(&first, bytes + *left, sizeof(first));
+        memcpy(&last, bytes + *right - 7, sizeof(last));
+
+        first = biosal_dna_codec_reverse_complement_word(first);
+        last = biosal_dna_codec_reverse_complement_word(last);
+
+        memcpy(bytes + *left, &last, sizeof(last));
+        memcpy(bytes + *right - 7, &first, sizeof(first));
+
+        *left += 8;
+        *right -= 8;
+    }
+}
+
+/*
+ * Shift the codes toward the first nucleotide, 8 bytes at a time.
+ * The byte after each word is read before it is changed. Return the
+ * number of bytes that were shifted.
+ */
+static int biosal_dna_codec_remove_padding_swar(uint8_t *bytes, int used_bytes, int shift)
+{
+    int i;
+    uint64_t word;
+
+    for (i = 0; i + 8 < used_bytes; i += 8) {
+
+        memcpy(&word, bytes + i, sizeof(word));
+
+        word = (word >> shift) | ((uint64_t)bytes[i + 8] << (64 - shift));
+
+        memcpy(bytes + i, &word, sizeof(word));
+    }
+
+    return i;
+}
+
+#ifdef BIOSAL_DNA_CODEC_HAS_SSE2_KERNEL
+
+/*
+ * Encode 16 symbols. Each 32-bit lane gets its encoded byte in the low 8 bits.
+ */
+static inline __m128i biosal_dna_codec_encode_sse2_vector(__m128i symbols, int *valid)
+{
+    __m128i matches;
+    __m128i codes;
+
+    matches = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_A)),
+                            _mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_C))),
+                    _mm_or_si128(_mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_G)),
+                            _mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_T))));
+
+    *valid &= _mm_movemask_epi8(matches) == 0xffff;
+
+    /*
+     * 16-bit shifts are fine since only the 2 low bits of each byte are kept.
+     */
+    codes = _mm_and_si128(_mm_xor_si128(_mm_srli_epi16(symbols, 1), _mm_srli_epi16(symbols, 2)),
+                    _mm_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_T));
+
+    codes = _mm_or_si128(codes, _mm_srli_epi32(codes, 6));
+    codes = _mm_or_si128(codes, _mm_srli_epi32(codes, 12));
+
+    return _mm_and_si128(codes, _mm_set1_epi32(0xff));
+}
+
+static int biosal_dna_codec_encode_sse2(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence)
+{
+    int i;
+    int limit;
+    int valid;
+    __m128i a;
+    __m128i b;
+    __m128i c;
+    __m128i d;
+    __m128i bytes;
+
+    limit = length_in_nucleotides - (length_in_nucleotides % 64);
+
+    for (i = 0; i < limit; i += 64) {
+
+        valid = 1;
+
+        a = biosal_dna_codec_encode_sse2_vector(
+                        _mm_loadu_si128((__m128i *)(dna_sequence + i)), &valid);
+        b = biosal_dna_codec_encode_sse2_vector(
+                        _mm_loadu_si128((__m128i *)(dna_sequence + i + 16)), &valid);
+        c = biosal_dna_codec_encode_sse2_vector(
+                        _mm_loadu_si128((__m128i *)(dna_sequence + i + 32)), &valid);
+        d = biosal_dna_codec_encode_sse2_vector(
+                        _mm_loadu_si128((__m128i *)(dna_sequence + i + 48)), &valid);
+
+        if (!valid) {
+            biosal_dna_codec_encode_scalar(self, i, i + 64, dna_sequence, encoded_sequence);
+            continue;
         }
 
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-        printf("DEBUG block %c%c%c%c\n", block[0], block[1], block[2], block[3]);
+        bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+
+        _mm_storeu_si128((__m128i *)(encoded_sequence + i / 4), bytes);
+    }
+
+    return limit;
+}
 #endif
 
-        byte = *(char *)core_map_get(&self->encoding_lookup_table, block);
-        ((char *)encoded_sequence)[byte_position] = byte;
+#ifdef BIOSAL_DNA_CODEC_HAS_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+static inline __m256i biosal_dna_codec_encode_avx2_vector(__m256i symbols, int *valid)
+{
+    __m256i matches;
+    __m256i codes;
+
+    matches = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_A)),
+                            _mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_C))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_G)),
+                            _mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_T))));
+
+    *valid &= _mm256_movemask_epi8(matches) == -1;
+
+    codes = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi16(symbols, 1), _mm256_srli_epi16(symbols, 2)),
+                    _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_T));
+
+    codes = _mm256_or_si256(codes, _mm256_srli_epi32(codes, 6));
+    codes = _mm256_or_si256(codes, _mm256_srli_epi32(codes, 12));
+
+    return _mm256_and_si256(codes, _mm256_set1_epi32(0xff));
+}
+
+__attribute__((target("avx2")))
+static int biosal_dna_codec_encode_avx2(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, uint8_t *encoded_sequence)
+{
+    int i;
+    int limit;
+    int valid;
+    __m256i a;
+    __m256i b;
+    __m256i c;
+    __m256i d;
+    __m256i bytes;
+
+    limit = length_in_nucleotides - (length_in_nucleotides % 128);
+
+    for (i = 0; i < limit; i += 128) {
+
+        valid = 1;
+
+        a = biosal_dna_codec_encode_avx2_vector(
+                        _mm256_loadu_si256((__m256i *)(dna_sequence + i)), &valid);
+        b = biosal_dna_codec_encode_avx2_vector(
+                        _mm256_loadu_si256((__m256i *)(dna_sequence + i + 32)), &valid);
+        c = biosal_dna_codec_encode_avx2_vector(
+                        _mm256_loadu_si256((__m256i *)(dna_sequence + i + 64)), &valid);
+        d = biosal_dna_codec_encode_avx2_vector(
+                        _mm256_loadu_si256((__m256i *)(dna_sequence + i + 96)), &valid);
+
+        if (!valid) {
+            biosal_dna_codec_encode_scalar(self, i, i + 128, dna_sequence, encoded_sequence);
+            continue;
+        }
+
+        /*
+         * The packs work within 128-bit lanes, so the 32-bit groups
+         * need to be put back in order.
+         */
+        bytes = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
 
-        byte_position++;
-        position += self->block_length;
+        _mm256_storeu_si256((__m256i *)(encoded_sequence + i / 4), bytes);
     }
+
+    return limit;
 }
 #endif
 
@@ -259,50 +633,42 @@ void biosal_dna_codec_decode(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
 {
     if (codec->use_two_bit_encoding) {
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-        biosal_dna_codec_decode_with_blocks(codec, length_in_nucleotides, encoded_sequence, dna_sequence);
-#else
-        biosal_dna_codec_decode_default(codec, length_in_nucleotides, encoded_sequence, dna_sequence);
-
-#endif
+        biosal_dna_codec_decode_with_tables(codec, length_in_nucleotides, encoded_sequence, dna_sequence);
     } else {
         strcpy(dna_sequence, encoded_sequence);
     }
 }
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-void biosal_dna_codec_decode_with_blocks(struct biosal_dna_codec *self,
+void biosal_dna_codec_decode_with_tables(struct biosal_dna_codec *self,
                 int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
 {
-    char byte;
-    int nucleotide_position;
-    int encoded_position;
-    int remaining;
-    void *encoded_block;
-    int to_copy;
-
-    encoded_position = 0;
-    nucleotide_position = 0;
+    int i;
+    int limit;
+    uint8_t *bytes;
 
-    while (nucleotide_position < length_in_nucleotides) {
+    bytes = encoded_sequence;
+    limit = length_in_nucleotides / 4;
+    i = 0;
 
-        remaining = length_in_nucleotides - nucleotide_position;
-        byte = ((char *)encoded_sequence)[encoded_position];
-        encoded_block = core_map_get(&self->decoding_lookup_table, &byte);
-        to_copy = self->block_length;
+    /*
+     * There is no vector decoder, so the vector backends
+     * use the SWAR decoder too.
+     */
+    if (self->backend != BIOSAL_DNA_CODEC_BACKEND_SCALAR) {
+        i = biosal_dna_codec_decode_swar(length_in_nucleotides, bytes, dna_sequence);
+    }
 
-        if (to_copy > remaining) {
-            to_copy = remaining;
-        }
-        core_memory_copy(dna_sequence + nucleotide_position, encoded_block, to_copy);
+    for (; i < limit; ++i) {
+        memcpy(dna_sequence + i * 4, self->decoding_table[bytes[i]], 4);
+    }
 
-        nucleotide_position += self->block_length;
-        encoded_position++;
+    if (length_in_nucleotides % 4 != 0) {
+        memcpy(dna_sequence + limit * 4, self->decoding_table[bytes[limit]],
+                        length_in_nucleotides % 4);
     }
 
     dna_sequence[length_in_nucleotides] = '\0';
 }
-#endif
 
 void biosal_dna_codec_decode_default(struct biosal_dna_codec *codec, int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
 {
@@ -463,24 +829,25 @@ char biosal_dna_codec_get_nucleotide_from_code(uint64_t code)
     return BIOSAL_NUCLEOTIDE_SYMBOL_A;
 }
 
-/* this would be diccult to do because the padding at the end is not
- * always a multiple of block_length
+/*
+ * The reverse complement is done 8 bytes at a time with SWAR, and one
+ * byte at a time with the reverse_complement_table for the middle of the
+ * sequence (or everywhere with the scalar backend). When the length is
+ * not a multiple of 4, the padding ends up at the beginning, so the bytes
+ * are then shifted toward the first nucleotide.
  */
 void biosal_dna_codec_reverse_complement_in_place(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, void *encoded_sequence)
 {
-#ifdef FAST_REVERSE_COMPLEMENT
+    uint8_t *bytes;
+    uint8_t *table;
+    uint8_t saved;
+    int used_bytes;
     int encoded_length;
-    int i;
-    uint64_t byte_value;
-    int middle;
-    char left_nucleotide;
     int left;
     int right;
-    char right_nucleotide;
-    int tail;
-    char blank;
-    int total_length;
+    int shift;
+    int i;
 
     /* Abort if the 2 bit encoding is not being used.
      */
@@ -489,105 +856,61 @@ void biosal_dna_codec_reverse_complement_in_place(struct biosal_dna_codec *codec
         return;
     }
 
+    bytes = encoded_sequence;
+    table = codec->reverse_complement_table;
+    used_bytes = (length_in_nucleotides + codec->block_length - 1) / codec->block_length;
 
-#if 0
-    char *sequence;
-
-    sequence = b212sal_memory_allocate(length_in_nucleotides + 1);
-    biosal_dna_codec_decode(codec, length_in_nucleotides, encoded_sequence, sequence);
-    printf("INPUT: %s\n", sequence);
-    core_memory_free(sequence);
-#endif
-
-    encoded_length = biosal_dna_codec_encoded_length(codec, length_in_nucleotides);
-
-    i = 0;
-
-    /* Complement all the nucleotides
+    /*
+     * Reverse the order of the bytes and reverse-complement each of them.
      */
-    while (i < encoded_length) {
-        byte_value = ((uint8_t*)encoded_sequence)[i];
+    left = 0;
+    right = used_bytes - 1;
 
-        /*
-         * \see http://stackoverflow.com/questions/6508585/how-to-use-inverse-in-c
-         */
-        byte_value = ~byte_value;
-        ((uint8_t*)encoded_sequence)[i] = byte_value;
-
-        ++i;
+    if (codec->backend != BIOSAL_DNA_CODEC_BACKEND_SCALAR) {
+        biosal_dna_codec_reverse_complement_swar(bytes, &left, &right);
     }
-#if 0
-#endif
-
-    /*
-     * Reverse the order
-     */
-    i = 0;
-    middle = length_in_nucleotides / 2;
-    while (i < middle) {
-        left = i;
-        left_nucleotide = biosal_dna_codec_get_nucleotide(codec, encoded_sequence, left);
 
-#if 0
-        printf("%i %c\n", i, left_nucleotide);
-#endif
+    while (left < right) {
+        saved = bytes[left];
+        bytes[left] = table[bytes[right]];
+        bytes[right] = table[saved];
 
-        right = length_in_nucleotides - 1 - i;
-        right_nucleotide = biosal_dna_codec_get_nucleotide(codec, encoded_sequence, right);
-/*
-        printf("left %d %c right %d %c\n", left, left_nucleotide,
-                        right, right_nucleotide);
-*/
-        biosal_dna_codec_set_nucleotide(codec, encoded_sequence, left, right_nucleotide);
-        biosal_dna_codec_set_nucleotide(codec, encoded_sequence, right, left_nucleotide);
+        ++left;
+        --right;
+    }
 
-        ++i;
+    if (left == right) {
+        bytes[left] = table[bytes[left]];
     }
 
     /*
-     * Fix the tail.
+     * Remove the padding which is now at the beginning.
      */
+    shift = (used_bytes * codec->block_length - length_in_nucleotides) * BITS_PER_NUCLEOTIDE;
 
-    total_length = encoded_length * 4;
-
-    tail = total_length - length_in_nucleotides;
-
-#if 0
-    printf("length_in_nucleotides %d\n", length_in_nucleotides);
-
-    printf("Padding tail %d\n", tail);
-#endif
+    if (shift != 0) {
 
-    if (tail != 0) {
         i = 0;
-        blank = BIOSAL_NUCLEOTIDE_SYMBOL_A;
-        while (i < tail) {
-            biosal_dna_codec_set_nucleotide(codec, encoded_sequence, length_in_nucleotides + i, blank);
-            ++i;
-        }
-    }
-
-#if 0
-    sequence = bs2al_memory_allocate(length_in_nucleotides + 1);
-    biosal_dna_codec_decode(codec, length_in_nucleotides, encoded_sequence, sequence);
-    printf("INPUT after: %s\n", sequence);
-    core_memory_free(sequence);
-#endif
 
+        if (codec->backend != BIOSAL_DNA_CODEC_BACKEND_SCALAR) {
+            i = biosal_dna_codec_remove_padding_swar(bytes, used_bytes, shift);
+        }
 
-#else
-    char *sequence;
-
-    sequence = core_memory_allocate(length_in_nucleotides + 1);
-
-    biosal_dna_codec_decode(codec, length_in_nucleotides, encoded_sequence, sequence);
+        for (; i < used_bytes - 1; ++i) {
+            bytes[i] = (bytes[i] >> shift) | (bytes[i + 1] << (BITS_PER_BYTE - shift));
+        }
 
-    biosal_dna_helper_reverse_complement_in_place(sequence);
+        bytes[used_bytes - 1] >>= shift;
+    }
 
-    biosal_dna_codec_encode(codec, length_in_nucleotides, sequence, encoded_sequence);
+    /*
+     * Clear the tail.
+     */
+    encoded_length = biosal_dna_codec_encoded_length(codec, length_in_nucleotides);
 
-    core_memory_free(sequence);
-#endif
+    if (used_bytes < encoded_length) {
+        memset(bytes + used_bytes, 0, encoded_length - used_bytes);
+    }
 }
 
 void biosal_dna_codec_enable_two_bit_encoding(struct biosal_dna_codec *codec)
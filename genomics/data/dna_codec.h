@@ -4,8 +4,6 @@
 
 #include <stdint.h>
 
-#include <core/system/memory_pool.h>
-#include <core/structures/map.h>
 
 #define BIOSAL_DNA_CODEC_HAS_REVERSE_COMPLEMENT_IMPLEMENTATION
 
@@ -23,29 +21,31 @@
 #define BIOSAL_NUCLEOTIDE_SYMBOL_T 'T'
 
 /*
- * use block encoder (faster or not ?)
-#define BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
- */
-
-/*
- * use block decoder (faster or not ?)
-#define BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
+ * Backends for the 2-bit encoder.
+ *
+ * The encoder uses SIMD (SSE2 or AVX2) or SWAR (SIMD within a register)
+ * kernels when they are available. Decoding and reverse complement use
+ * SWAR kernels with every backend except the scalar one, which uses flat
+ * lookup tables. The backend is selected at runtime in
+ * biosal_dna_codec_init.
  */
+#define BIOSAL_DNA_CODEC_BACKEND_SCALAR 0
+#define BIOSAL_DNA_CODEC_BACKEND_SWAR 1
+#define BIOSAL_DNA_CODEC_BACKEND_SSE2 2
+#define BIOSAL_DNA_CODEC_BACKEND_AVX2 3
 
 /*
  * A class to encode and decode DNA data.
  */
 struct biosal_dna_codec {
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-    struct core_map encoding_lookup_table;
-#endif
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-    struct core_map decoding_lookup_table;
-#endif
+    uint8_t encoding_table[256];
+    uint8_t reverse_complement_table[256];
+    char decoding_table[256][4];
+
+    int backend;
     int block_length;
 
     int use_two_bit_encoding;
-    struct core_memory_pool pool;
 };
 
 void biosal_dna_codec_init(struct biosal_dna_codec *self);
@@ -67,20 +67,15 @@ int biosal_dna_codec_encoded_length_default(struct biosal_dna_codec *self, int l
 void biosal_dna_codec_decode_default(struct biosal_dna_codec *self, int length_in_nucleotides, void *encoded_sequence, char *dna_sequence);
 void biosal_dna_codec_encode_default(struct biosal_dna_codec *self, int length_in_nucleotides, char *dna_sequence, void *encoded_sequence);
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-void biosal_dna_codec_encode_with_blocks(struct biosal_dna_codec *self,
+void biosal_dna_codec_encode_with_tables(struct biosal_dna_codec *self,
                 int length_in_nucleotides, char *dna_sequence, void *encoded_sequence);
-
-void biosal_dna_codec_generate_blocks(struct biosal_dna_codec *self);
-
-void biosal_dna_codec_generate_block(struct biosal_dna_codec *self, int position, char symbol,
-                char *block);
-#endif
-
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-void biosal_dna_codec_decode_with_blocks(struct biosal_dna_codec *self,
+void biosal_dna_codec_decode_with_tables(struct biosal_dna_codec *self,
                 int length_in_nucleotides, void *encoded_sequence, char *dna_sequence);
-#endif
+
+int biosal_dna_codec_get_backend(struct biosal_dna_codec *self);
+int biosal_dna_codec_set_backend(struct biosal_dna_codec *self, int backend);
+int biosal_dna_codec_has_backend(int backend);
+const char *biosal_dna_codec_backend_name(int backend);
 
 void biosal_dna_codec_reverse_complement_in_place(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, void *encoded_sequence);
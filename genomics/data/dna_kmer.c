@@ -19,6 +19,12 @@
 
 #include <inttypes.h>
 
+#define NUCLEOTIDES_PER_WORD 32
+
+static uint64_t biosal_dna_kmer_reverse_nucleotides(uint64_t word);
+static int biosal_dna_kmer_words_are_lower_or_equal(uint64_t *words1, uint64_t *words2,
+                int word_count);
+
 /*
 #define BIOSAL_DNA_SEQUENCE_DEBUG
 */
@@ -82,6 +88,190 @@ int biosal_dna_kmer_pack_store_key(struct biosal_dna_kmer *self,
     return bytes;
 }
 
+int biosal_dna_kmer_inline_key_size(int kmer_length)
+{
+    if (kmer_length <= NUCLEOTIDES_PER_WORD) {
+        return sizeof(uint64_t);
+
+    } else if (kmer_length <= BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH) {
+        return 2 * sizeof(uint64_t);
+    }
+
+    return 0;
+}
+
+/*
+ * Pack the canonical k-mer in an inline key. No memory is allocated:
+ * the reverse complement is computed with word operations.
+ *
+ * \return 1 if the k-mer itself is canonical, 0 if its reverse complement
+ * was stored.
+ */
+int biosal_dna_kmer_pack_inline_key(struct biosal_dna_kmer *self,
+                void *key, int kmer_length, struct biosal_dna_codec *codec)
+{
+    uint64_t forward[2];
+    uint64_t reverse_complement[2];
+    int word_count;
+    int shift;
+    int is_canonical;
+    int i;
+    int encoded_length;
+    uint8_t *bytes;
+    char *symbols;
+
+    CORE_DEBUGGER_ASSERT(kmer_length > 0);
+    CORE_DEBUGGER_ASSERT(kmer_length <= BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH);
+
+    word_count = biosal_dna_kmer_inline_key_size(kmer_length) / sizeof(uint64_t);
+    forward[0] = 0;
+    forward[1] = 0;
+
+    if (codec->use_two_bit_encoding) {
+        bytes = self->encoded_data;
+        encoded_length = (kmer_length + 3) / 4;
+
+        for (i = 0; i < encoded_length; ++i) {
+            forward[i / 8] |= ((uint64_t)bytes[i]) << ((i % 8) * 8);
+        }
+
+    } else {
+        symbols = self->encoded_data;
+
+        for (i = 0; i < kmer_length; ++i) {
+            forward[i / NUCLEOTIDES_PER_WORD] |= biosal_dna_codec_get_code(symbols[i])
+                    << ((i % NUCLEOTIDES_PER_WORD) * 2);
+        }
+    }
+
+    /*
+     * Complement and reverse the whole key, then align
+     * the first nucleotide at bit 0.
+     */
+    shift = word_count * 64 - 2 * kmer_length;
+
+    if (word_count == 1) {
+        if (shift > 0) {
+            forward[0] &= (((uint64_t)1) << (2 * kmer_length)) - 1;
+        }
+
+        reverse_complement[0] = biosal_dna_kmer_reverse_nucleotides(~forward[0]) >> shift;
+        reverse_complement[1] = 0;
+
+    } else {
+        if (shift > 0) {
+            forward[1] &= (((uint64_t)1) << (2 * kmer_length - 64)) - 1;
+        }
+
+        reverse_complement[0] = biosal_dna_kmer_reverse_nucleotides(~forward[1]);
+        reverse_complement[1] = biosal_dna_kmer_reverse_nucleotides(~forward[0]);
+
+        if (shift > 0) {
+            reverse_complement[0] = (reverse_complement[0] >> shift)
+                    | (reverse_complement[1] << (64 - shift));
+            reverse_complement[1] >>= shift;
+        }
+    }
+
+    is_canonical = biosal_dna_kmer_words_are_lower_or_equal(forward, reverse_complement,
+                    word_count);
+
+    if (is_canonical) {
+        core_memory_copy(key, forward, word_count * sizeof(uint64_t));
+    } else {
+        core_memory_copy(key, reverse_complement, word_count * sizeof(uint64_t));
+    }
+
+    return is_canonical;
+}
+
+void biosal_dna_kmer_init_from_inline_key(struct biosal_dna_kmer *self,
+                void *key, int kmer_length, struct core_memory_pool *memory,
+                struct biosal_dna_codec *codec)
+{
+    uint64_t words[2];
+    int encoded_length;
+    int i;
+    uint8_t *bytes;
+    char *symbols;
+
+    CORE_DEBUGGER_ASSERT(kmer_length > 0);
+    CORE_DEBUGGER_ASSERT(kmer_length <= BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH);
+
+    words[1] = 0;
+    core_memory_copy(words, key, biosal_dna_kmer_inline_key_size(kmer_length));
+
+    encoded_length = biosal_dna_codec_encoded_length(codec, kmer_length);
+    self->encoded_data = core_memory_pool_allocate(memory, encoded_length);
+
+    if (codec->use_two_bit_encoding) {
+        bytes = self->encoded_data;
+        memset(bytes, 0, encoded_length);
+
+        for (i = 0; i < (kmer_length + 3) / 4; ++i) {
+            bytes[i] = words[i / 8] >> ((i % 8) * 8);
+        }
+
+        return;
+    }
+
+    symbols = self->encoded_data;
+
+    for (i = 0; i < kmer_length; ++i) {
+        symbols[i] = biosal_dna_codec_get_nucleotide_from_code(
+                        (words[i / NUCLEOTIDES_PER_WORD] >> ((i % NUCLEOTIDES_PER_WORD) * 2)) & 3);
+    }
+
+    symbols[kmer_length] = '\0';
+}
+
+/*
+ * Reverse the order of the 32 nucleotides (2-bit groups) in a word.
+ */
+static uint64_t biosal_dna_kmer_reverse_nucleotides(uint64_t word)
+{
+    word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+    word = ((word >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((word & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    word = ((word >> 8) & 0x00ff00ff00ff00ffULL) | ((word & 0x00ff00ff00ff00ffULL) << 8);
+    word = ((word >> 16) & 0x0000ffff0000ffffULL) | ((word & 0x0000ffff0000ffffULL) << 16);
+    word = (word >> 32) | (word << 32);
+
+    return word;
+}
+
+/*
+ * Compare 2 k-mers in the word layout in lexicographic order.
+ * Nucleotide 0 is in the low bits, so the first differing
+ * nucleotide is the lowest differing 2-bit digit.
+ */
+static int biosal_dna_kmer_words_are_lower_or_equal(uint64_t *words1, uint64_t *words2,
+                int word_count)
+{
+    int i;
+    uint64_t difference;
+    uint64_t lowest_bit;
+    uint64_t mask;
+
+    for (i = 0; i < word_count; ++i) {
+        difference = words1[i] ^ words2[i];
+
+        if (difference == 0) {
+            continue;
+        }
+
+        lowest_bit = difference & (~difference + 1);
+        mask = lowest_bit | (lowest_bit << 1);
+
+        if ((lowest_bit & 0x5555555555555555ULL) == 0) {
+            mask = lowest_bit | (lowest_bit >> 1);
+        }
+
+        return (words1[i] & mask) < (words2[i] & mask);
+    }
+
+    return 1;
+}
+
 int biosal_dna_kmer_pack(struct biosal_dna_kmer *sequence,
                 void *buffer, int kmer_length, struct biosal_dna_codec *codec)
 {
@@ -8,6 +8,15 @@
 
 #include <stdint.h>
 
+/*
+ * K-mers with up to 64 nucleotides can be stored as
+ * fixed-width inline keys: 1 word (k <= 32) or 2 words (k <= 64)
+ * with 2 bits per nucleotide. Nucleotide i lives at bits 2 * (i % 32)
+ * of word i / 32. These keys are canonical and they are hashed and
+ * compared as integers by core_hash_table.
+ */
+#define BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH 64
+
 struct biosal_dna_kmer {
     void *encoded_data;
 };
@@ -53,6 +62,13 @@ int biosal_dna_kmer_pack_store_key(struct biosal_dna_kmer *self,
                 void *buffer, int kmer_length, struct biosal_dna_codec *codec, struct core_memory_pool *memory);
 int biosal_dna_kmer_pack_store_key_size(struct biosal_dna_kmer *self, int kmer_length);
 
+int biosal_dna_kmer_inline_key_size(int kmer_length);
+int biosal_dna_kmer_pack_inline_key(struct biosal_dna_kmer *self,
+                void *key, int kmer_length, struct biosal_dna_codec *codec);
+void biosal_dna_kmer_init_from_inline_key(struct biosal_dna_kmer *self,
+                void *key, int kmer_length, struct core_memory_pool *memory,
+                struct biosal_dna_codec *codec);
+
 uint64_t biosal_dna_kmer_hash(struct biosal_dna_kmer *self, int kmer_length, struct biosal_dna_codec *codec);
 
 void biosal_dna_kmer_reverse_complement_self(struct biosal_dna_kmer *self, int kmer_length,
@@ -0,0 +1,271 @@
+
+#include "dna_kmer_extractor.h"
+
+#include "dna_codec.h"
+#include "dna_sequence.h"
+
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+#include <string.h>
+
+#define NUCLEOTIDES_PER_WORD 32
+#define BITS_PER_NUCLEOTIDE 2
+#define BITS_PER_BYTE 8
+#define BYTES_PER_WORD 8
+
+#define NUCLEOTIDE_MASK ((uint64_t)3)
+
+static int biosal_dna_kmer_extractor_get_code(struct biosal_dna_kmer_extractor *self,
+                int position);
+static void biosal_dna_kmer_extractor_push(struct biosal_dna_kmer_extractor *self,
+                uint64_t code);
+static void biosal_dna_kmer_extractor_write(struct biosal_dna_kmer_extractor *self,
+                uint64_t *words, void *encoded_kmer);
+
+void biosal_dna_kmer_extractor_init(struct biosal_dna_kmer_extractor *self,
+                int kmer_length, struct biosal_dna_codec *codec,
+                struct core_memory_pool *memory)
+{
+    int remainder;
+    int bytes;
+
+    CORE_DEBUGGER_ASSERT(kmer_length > 0);
+
+    self->kmer_length = kmer_length;
+    self->codec = codec;
+    self->memory = memory;
+    self->use_two_bit_encoding = codec->use_two_bit_encoding;
+    self->encoded_length = biosal_dna_codec_encoded_length(codec, kmer_length);
+
+    /*
+     * The 2-bit encoded length may have a trailing padding byte,
+     * so the words must cover it too.
+     */
+    self->word_count = (kmer_length + NUCLEOTIDES_PER_WORD - 1) / NUCLEOTIDES_PER_WORD;
+
+    if (self->word_count * BYTES_PER_WORD < self->encoded_length) {
+        self->word_count = (self->encoded_length + BYTES_PER_WORD - 1) / BYTES_PER_WORD;
+    }
+
+    remainder = kmer_length % NUCLEOTIDES_PER_WORD;
+    self->last_word_mask = ~(uint64_t)0;
+
+    if (remainder != 0) {
+        self->last_word_mask = (((uint64_t)1) << (remainder * BITS_PER_NUCLEOTIDE)) - 1;
+    }
+
+    bytes = self->word_count * sizeof(uint64_t);
+
+    self->forward = core_memory_pool_allocate(memory, bytes);
+    self->reverse_complement = core_memory_pool_allocate(memory, bytes);
+
+    memset(self->forward, 0, bytes);
+    memset(self->reverse_complement, 0, bytes);
+
+    self->sequence = NULL;
+    self->sequence_length = 0;
+    self->position = 0;
+}
+
+void biosal_dna_kmer_extractor_destroy(struct biosal_dna_kmer_extractor *self)
+{
+    core_memory_pool_free(self->memory, self->forward);
+    core_memory_pool_free(self->memory, self->reverse_complement);
+
+    self->forward = NULL;
+    self->reverse_complement = NULL;
+    self->sequence = NULL;
+    self->sequence_length = 0;
+    self->position = 0;
+    self->kmer_length = 0;
+    self->word_count = 0;
+}
+
+void biosal_dna_kmer_extractor_start(struct biosal_dna_kmer_extractor *self,
+                struct biosal_dna_sequence *sequence)
+{
+    int bytes;
+    int limit;
+
+    self->sequence = sequence->encoded_data;
+    self->sequence_length = biosal_dna_sequence_length(sequence);
+    self->position = 0;
+
+    bytes = self->word_count * sizeof(uint64_t);
+    memset(self->forward, 0, bytes);
+    memset(self->reverse_complement, 0, bytes);
+
+    /*
+     * Load the first k - 1 nucleotides. The first call to
+     * biosal_dna_kmer_extractor_next completes the first k-mer.
+     */
+    limit = self->kmer_length - 1;
+
+    if (limit > self->sequence_length) {
+        limit = self->sequence_length;
+    }
+
+    while (self->position < limit) {
+        biosal_dna_kmer_extractor_push(self,
+                        biosal_dna_kmer_extractor_get_code(self, self->position));
+        ++self->position;
+    }
+}
+
+int biosal_dna_kmer_extractor_next(struct biosal_dna_kmer_extractor *self)
+{
+    if (self->position >= self->sequence_length) {
+        return 0;
+    }
+
+    biosal_dna_kmer_extractor_push(self,
+                    biosal_dna_kmer_extractor_get_code(self, self->position));
+    ++self->position;
+
+    return 1;
+}
+
+int biosal_dna_kmer_extractor_is_canonical(struct biosal_dna_kmer_extractor *self)
+{
+    int i;
+    uint64_t difference;
+    uint64_t lowest_bit;
+    uint64_t mask;
+
+    /*
+     * Nucleotide 0 is in the low bits, so the first differing
+     * nucleotide is the lowest differing 2-bit digit.
+     */
+    for (i = 0; i < self->word_count; ++i) {
+
+        difference = self->forward[i] ^ self->reverse_complement[i];
+
+        if (difference == 0) {
+            continue;
+        }
+
+        lowest_bit = difference & (~difference + 1);
+
+        /*
+         * Align the mask on the nucleotide.
+         */
+        mask = lowest_bit | (lowest_bit << 1);
+
+        if ((lowest_bit & 0x5555555555555555ULL) == 0) {
+            mask = lowest_bit | (lowest_bit >> 1);
+        }
+
+        return (self->forward[i] & mask) < (self->reverse_complement[i] & mask);
+    }
+
+    /*
+     * The k-mer is its own reverse complement.
+     */
+    return 1;
+}
+
+int biosal_dna_kmer_extractor_encoded_length(struct biosal_dna_kmer_extractor *self)
+{
+    return self->encoded_length;
+}
+
+void biosal_dna_kmer_extractor_get_forward(struct biosal_dna_kmer_extractor *self,
+                void *encoded_kmer)
+{
+    biosal_dna_kmer_extractor_write(self, self->forward, encoded_kmer);
+}
+
+void biosal_dna_kmer_extractor_get_reverse_complement(struct biosal_dna_kmer_extractor *self,
+                void *encoded_kmer)
+{
+    biosal_dna_kmer_extractor_write(self, self->reverse_complement, encoded_kmer);
+}
+
+void biosal_dna_kmer_extractor_get_canonical(struct biosal_dna_kmer_extractor *self,
+                void *encoded_kmer)
+{
+    if (biosal_dna_kmer_extractor_is_canonical(self)) {
+        biosal_dna_kmer_extractor_get_forward(self, encoded_kmer);
+    } else {
+        biosal_dna_kmer_extractor_get_reverse_complement(self, encoded_kmer);
+    }
+}
+
+static int biosal_dna_kmer_extractor_get_code(struct biosal_dna_kmer_extractor *self,
+                int position)
+{
+    if (self->use_two_bit_encoding) {
+        return (self->sequence[position / 4] >> ((position % 4) * BITS_PER_NUCLEOTIDE))
+                & NUCLEOTIDE_MASK;
+    }
+
+    return biosal_dna_codec_get_code(self->sequence[position]);
+}
+
+/*
+ * Shift in one nucleotide.
+ *
+ * The forward k-mer drops its first nucleotide (a right shift of the words)
+ * and gets the new one at position k - 1. The reverse complement gets the
+ * complement of the new nucleotide at position 0 (a left shift of the words).
+ */
+static void biosal_dna_kmer_extractor_push(struct biosal_dna_kmer_extractor *self,
+                uint64_t code)
+{
+    int i;
+    int last;
+    int top;
+    uint64_t *forward;
+    uint64_t *reverse_complement;
+
+    forward = self->forward;
+    reverse_complement = self->reverse_complement;
+    top = self->kmer_length - 1;
+    last = top / NUCLEOTIDES_PER_WORD;
+
+    for (i = 0; i < last; ++i) {
+        forward[i] = (forward[i] >> BITS_PER_NUCLEOTIDE)
+                | (forward[i + 1] << (64 - BITS_PER_NUCLEOTIDE));
+    }
+
+    forward[last] >>= BITS_PER_NUCLEOTIDE;
+    forward[last] |= code << ((top % NUCLEOTIDES_PER_WORD) * BITS_PER_NUCLEOTIDE);
+
+    for (i = last; i > 0; --i) {
+        reverse_complement[i] = (reverse_complement[i] << BITS_PER_NUCLEOTIDE)
+                | (reverse_complement[i - 1] >> (64 - BITS_PER_NUCLEOTIDE));
+    }
+
+    reverse_complement[0] <<= BITS_PER_NUCLEOTIDE;
+    reverse_complement[0] |= (~code) & NUCLEOTIDE_MASK;
+    reverse_complement[last] &= self->last_word_mask;
+}
+
+static void biosal_dna_kmer_extractor_write(struct biosal_dna_kmer_extractor *self,
+                uint64_t *words, void *encoded_kmer)
+{
+    int i;
+    uint8_t *bytes;
+    char *symbols;
+    uint64_t code;
+
+    if (self->use_two_bit_encoding) {
+        bytes = encoded_kmer;
+
+        for (i = 0; i < self->encoded_length; ++i) {
+            bytes[i] = words[i / BYTES_PER_WORD] >> ((i % BYTES_PER_WORD) * BITS_PER_BYTE);
+        }
+
+        return;
+    }
+
+    symbols = encoded_kmer;
+
+    for (i = 0; i < self->kmer_length; ++i) {
+        code = words[i / NUCLEOTIDES_PER_WORD] >> ((i % NUCLEOTIDES_PER_WORD) * BITS_PER_NUCLEOTIDE);
+        symbols[i] = biosal_dna_codec_get_nucleotide_from_code(code & NUCLEOTIDE_MASK);
+    }
+
+    symbols[self->kmer_length] = '\0';
+}
@@ -0,0 +1,65 @@
+
+#ifndef BIOSAL_DNA_KMER_EXTRACTOR_H
+#define BIOSAL_DNA_KMER_EXTRACTOR_H
+
+#include <stdint.h>
+
+struct biosal_dna_codec;
+struct biosal_dna_sequence;
+struct core_memory_pool;
+
+/*
+ * A rolling k-mer extractor.
+ *
+ * The extractor walks an encoded DNA sequence (2-bit or not) and
+ * shifts in one nucleotide per step. The forward k-mer and its
+ * reverse complement are kept current in words of 64 bits
+ * (32 nucleotides per word), so extracting all the k-mers of a read
+ * of length L costs O(L) instead of O(L * k).
+ *
+ * In the words, nucleotide i of a k-mer lives at bits
+ * 2 * (i % 32) of word i / 32, which is also the layout used by
+ * the 2-bit codec in bytes.
+ */
+struct biosal_dna_kmer_extractor {
+    uint64_t *forward;
+    uint64_t *reverse_complement;
+    uint64_t last_word_mask;
+
+    int kmer_length;
+    int word_count;
+    int encoded_length;
+
+    /*
+     * The sequence being walked.
+     */
+    uint8_t *sequence;
+    int sequence_length;
+    int position;
+
+    int use_two_bit_encoding;
+
+    struct biosal_dna_codec *codec;
+    struct core_memory_pool *memory;
+};
+
+void biosal_dna_kmer_extractor_init(struct biosal_dna_kmer_extractor *self,
+                int kmer_length, struct biosal_dna_codec *codec,
+                struct core_memory_pool *memory);
+void biosal_dna_kmer_extractor_destroy(struct biosal_dna_kmer_extractor *self);
+
+void biosal_dna_kmer_extractor_start(struct biosal_dna_kmer_extractor *self,
+                struct biosal_dna_sequence *sequence);
+int biosal_dna_kmer_extractor_next(struct biosal_dna_kmer_extractor *self);
+
+int biosal_dna_kmer_extractor_is_canonical(struct biosal_dna_kmer_extractor *self);
+int biosal_dna_kmer_extractor_encoded_length(struct biosal_dna_kmer_extractor *self);
+
+void biosal_dna_kmer_extractor_get_forward(struct biosal_dna_kmer_extractor *self,
+                void *encoded_kmer);
+void biosal_dna_kmer_extractor_get_reverse_complement(struct biosal_dna_kmer_extractor *self,
+                void *encoded_kmer);
+void biosal_dna_kmer_extractor_get_canonical(struct biosal_dna_kmer_extractor *self,
+                void *encoded_kmer);
+
+#endif
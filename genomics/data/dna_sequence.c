@@ -71,6 +71,31 @@ int biosal_dna_sequence_unpack(struct biosal_dna_sequence *sequence,
     return biosal_dna_sequence_pack_unpack(sequence, buffer, CORE_PACKER_OPERATION_UNPACK, memory, codec);
 }
 
+int biosal_dna_sequence_unpack_view(struct biosal_dna_sequence *sequence,
+                void *buffer, struct biosal_dna_codec *codec)
+{
+    int offset;
+
+    /*
+     * Same layout as biosal_dna_sequence_pack_unpack
+     */
+    core_memory_copy(&sequence->length_in_nucleotides, buffer,
+                    sizeof(sequence->length_in_nucleotides));
+    offset = sizeof(sequence->length_in_nucleotides);
+
+    CORE_DEBUGGER_ASSERT(sequence->length_in_nucleotides > 0);
+
+    sequence->encoded_data = NULL;
+    sequence->pair = -1;
+
+    if (sequence->length_in_nucleotides > 0) {
+        sequence->encoded_data = (char *)buffer + offset;
+        offset += biosal_dna_codec_encoded_length(codec, sequence->length_in_nucleotides);
+    }
+
+    return offset;
+}
+
 int biosal_dna_sequence_pack(struct biosal_dna_sequence *sequence,
                 void *buffer, struct biosal_dna_codec *codec)
 {
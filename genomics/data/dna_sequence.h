@@ -22,6 +22,16 @@ int biosal_dna_sequence_unpack(struct biosal_dna_sequence *sequence,
 int biosal_dna_sequence_pack(struct biosal_dna_sequence *sequence,
                 void *buffer, struct biosal_dna_codec *codec);
 int biosal_dna_sequence_pack_size(struct biosal_dna_sequence *sequence, struct biosal_dna_codec *codec);
+
+/*
+ * Unpack a sequence without copying it: the encoded data points
+ * in the buffer, which must outlive the sequence. Such a sequence
+ * is not destroyed.
+ *
+ * \return number of bytes used in the buffer
+ */
+int biosal_dna_sequence_unpack_view(struct biosal_dna_sequence *sequence,
+                void *buffer, struct biosal_dna_codec *codec);
 int biosal_dna_sequence_pack_unpack(struct biosal_dna_sequence *sequence,
                 void *buffer, int operation, struct core_memory_pool *memory,
                 struct biosal_dna_codec *codec);
@@ -0,0 +1,91 @@
+
+#include "dna_sequence_block.h"
+
+#include "dna_codec.h"
+
+#include <genomics/helpers/dna_helper.h>
+
+#include <core/system/memory.h>
+
+#include <string.h>
+
+void biosal_dna_sequence_block_init(struct biosal_dna_sequence_block *self)
+{
+    core_vector_init(&self->data, sizeof(char));
+    core_vector_init(&self->offsets, sizeof(int));
+}
+
+void biosal_dna_sequence_block_destroy(struct biosal_dna_sequence_block *self)
+{
+    core_vector_destroy(&self->data);
+    core_vector_destroy(&self->offsets);
+}
+
+void biosal_dna_sequence_block_clear(struct biosal_dna_sequence_block *self)
+{
+    core_vector_clear(&self->data);
+    core_vector_clear(&self->offsets);
+}
+
+void biosal_dna_sequence_block_add(struct biosal_dna_sequence_block *self,
+                char *sequence, struct biosal_dna_codec *codec)
+{
+    int length_in_nucleotides;
+    int encoded_length;
+    int offset;
+    int new_size;
+    char *destination;
+
+    biosal_dna_helper_normalize(sequence);
+
+    length_in_nucleotides = strlen(sequence);
+    encoded_length = 0;
+
+    if (length_in_nucleotides > 0) {
+        encoded_length = biosal_dna_codec_encoded_length(codec, length_in_nucleotides);
+    }
+
+    offset = core_vector_size(&self->data);
+    new_size = offset + sizeof(length_in_nucleotides) + encoded_length;
+
+    /*
+     * core_vector_resize grows to the exact size, so grow
+     * geometrically here.
+     */
+    if (new_size > core_vector_capacity(&self->data)) {
+        core_vector_reserve(&self->data, 2 * new_size);
+    }
+
+    core_vector_resize(&self->data, new_size);
+
+    destination = core_vector_at(&self->data, offset);
+
+    core_memory_copy(destination, &length_in_nucleotides, sizeof(length_in_nucleotides));
+
+    if (length_in_nucleotides > 0) {
+        biosal_dna_codec_encode(codec, length_in_nucleotides, sequence,
+                        destination + sizeof(length_in_nucleotides));
+    }
+
+    core_vector_push_back(&self->offsets, &offset);
+}
+
+int biosal_dna_sequence_block_count(struct biosal_dna_sequence_block *self)
+{
+    return core_vector_size(&self->offsets);
+}
+
+int biosal_dna_sequence_block_size(struct biosal_dna_sequence_block *self)
+{
+    return core_vector_size(&self->data);
+}
+
+void *biosal_dna_sequence_block_data(struct biosal_dna_sequence_block *self)
+{
+    return core_vector_at(&self->data, 0);
+}
+
+int biosal_dna_sequence_block_offset(struct biosal_dna_sequence_block *self, int index)
+{
+    return *(int *)core_vector_at(&self->offsets, index);
+}
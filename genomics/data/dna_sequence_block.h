@@ -0,0 +1,51 @@
+
+#ifndef BIOSAL_DNA_SEQUENCE_BLOCK_H
+#define BIOSAL_DNA_SEQUENCE_BLOCK_H
+
+#include <core/structures/vector.h>
+
+struct biosal_dna_codec;
+
+/*
+ * A contiguous block of encoded DNA sequences.
+ *
+ * Each sequence is stored like biosal_dna_sequence_pack stores it
+ * (the length in nucleotides followed by the encoded nucleotides),
+ * so the block can be copied as is where packed sequences are
+ * expected. The offsets vector gives the position of each sequence
+ * in the block.
+ *
+ * Sequences are encoded directly in the block: there is no
+ * allocation per sequence, and the memory is reused after
+ * biosal_dna_sequence_block_clear.
+ */
+struct biosal_dna_sequence_block {
+    struct core_vector data;
+    struct core_vector offsets;
+};
+
+void biosal_dna_sequence_block_init(struct biosal_dna_sequence_block *self);
+void biosal_dna_sequence_block_destroy(struct biosal_dna_sequence_block *self);
+void biosal_dna_sequence_block_clear(struct biosal_dna_sequence_block *self);
+
+/*
+ * Normalize and encode a null-terminated sequence at the end of
+ * the block. The sequence is normalized in place.
+ */
+void biosal_dna_sequence_block_add(struct biosal_dna_sequence_block *self,
+                char *sequence, struct biosal_dna_codec *codec);
+
+int biosal_dna_sequence_block_count(struct biosal_dna_sequence_block *self);
+
+/*
+ * \return number of bytes in the block
+ */
+int biosal_dna_sequence_block_size(struct biosal_dna_sequence_block *self);
+void *biosal_dna_sequence_block_data(struct biosal_dna_sequence_block *self);
+
+/*
+ * \return the position of a sequence in the block
+ */
+int biosal_dna_sequence_block_offset(struct biosal_dna_sequence_block *self, int index);
+
+#endif
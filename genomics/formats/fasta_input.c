@@ -38,7 +38,7 @@ void core_fasta_input_init(struct biosal_input_format *input)
     core_buffered_reader_init(&fasta->reader, file, offset);
 
     fasta->buffer = NULL;
-    fasta->next_header = NULL;
+    fasta->next_header_length = 0;
     fasta->has_header = 0;
 
     fasta->has_first = 0;
@@ -55,11 +55,6 @@ void core_fasta_input_destroy(struct biosal_input_format *input)
         core_memory_free(fasta->buffer, MEMORY_FASTA);
         fasta->buffer = NULL;
     }
-
-    if (fasta->next_header != NULL) {
-        core_memory_free(fasta->next_header, MEMORY_FASTA);
-        fasta->next_header= NULL;
-    }
 }
 
 uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
@@ -73,47 +68,45 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
     int lines;
     int total;
     int position_in_sequence;
-    int is_header;
     int block_length;
+    char *line;
 
     fasta = (struct core_fasta_input *)biosal_input_format_implementation(input);
 
-    if (fasta->buffer == NULL) {
-        fasta->buffer = core_memory_allocate(maximum_sequence_length + 1, MEMORY_FASTA);
-        fasta->next_header= core_memory_allocate(maximum_sequence_length + 1, MEMORY_FASTA);
-
-        fasta->buffer[0] = '\0';
-        fasta->next_header[0] = '\0';
-    }
-
     value = 0;
     total = 0;
     lines = 0;
 
     /*
      * Read name
+     *
+     * Lines are read as views in the buffer of the reader. Only the
+     * sequence lines are copied.
      */
 
     if (fasta->has_header) {
 
-        strcpy(fasta->buffer, fasta->next_header);
-
-        value = strlen(fasta->buffer);
+        value = fasta->next_header_length;
 
         fasta->has_header = 0;
 
     } else {
-        value = core_buffered_reader_read_line(&fasta->reader, fasta->buffer,
-                    maximum_sequence_length);
+        value = core_buffered_reader_read_line_view(&fasta->reader, &line);
 
         /* Make sure that this is an identifier.
          */
         if (!fasta->has_first) {
 
-            while (!core_fasta_input_check_header(input, fasta->buffer)) {
+            if (fasta->buffer == NULL) {
+                fasta->buffer = core_memory_allocate(maximum_sequence_length + 1, MEMORY_FASTA);
+            }
+
+            core_fasta_input_copy_line(fasta->buffer, line, value, maximum_sequence_length);
+
+            while (value > 0 && !core_fasta_input_check_header(input, fasta->buffer)) {
 
-                value = core_buffered_reader_read_line(&fasta->reader, fasta->buffer,
-                    maximum_sequence_length);
+                value = core_buffered_reader_read_line_view(&fasta->reader, &line);
+                core_fasta_input_copy_line(fasta->buffer, line, value, maximum_sequence_length);
             }
 
             fasta->has_first = 1;
@@ -138,25 +131,14 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
     position_in_sequence = 0;
 
     while (1) {
-        value = core_buffered_reader_read_line(&fasta->reader, fasta->buffer,
-                    maximum_sequence_length);
+        value = core_buffered_reader_read_line_view(&fasta->reader, &line);
 
         if (value == 0) {
             break;
         }
 
-        is_header = 0;
-
-        if (strlen(fasta->buffer) > 0
-                        && fasta->buffer[0] == '>') {
-
-            is_header = 1;
-        }
-
-        if (is_header) {
-            sequence[position_in_sequence] = '\0';
-
-            strcpy(fasta->next_header, fasta->buffer);
+        if (line[0] == '>') {
+            fasta->next_header_length = value;
             fasta->has_header = 1;
             break;
         }
@@ -165,26 +147,33 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
          * Otherwise, add the sequence.
          */
 
-        if (value) {
-            ++lines;
-        }
+        ++lines;
 
-        block_length = strlen(fasta->buffer);
+        block_length = value;
 
         /*
          * Remove the new line.
          */
-        if (fasta->buffer[block_length - 1] == '\n') {
+        if (line[block_length - 1] == '\n') {
             --block_length;
         }
 
+        /*
+         * Keep room for the null character.
+         */
+        if (position_in_sequence + block_length > maximum_sequence_length - 1) {
+            block_length = maximum_sequence_length - 1 - position_in_sequence;
+        }
+
         core_memory_copy(sequence + position_in_sequence,
-                        fasta->buffer,
+                        line,
                         block_length);
 
         position_in_sequence += block_length;
     }
 
+    sequence[position_in_sequence] = '\0';
+
     return total;
 }
 
@@ -238,3 +227,22 @@ int core_fasta_input_check_header(struct biosal_input_format *self, const char *
 
     return 1;
 }
+
+int core_fasta_input_copy_line(char *buffer, const char *line, int length, int maximum_length)
+{
+    if (length > 0 && line[length - 1] == '\n') {
+        --length;
+    }
+
+    if (length > maximum_length) {
+        length = maximum_length;
+    }
+
+    if (length > 0) {
+        core_memory_copy(buffer, line, length);
+    }
+
+    buffer[length] = '\0';
+
+    return length;
+}
@@ -18,7 +18,12 @@ struct core_fasta_input {
     struct core_buffered_reader reader;
 
     char *buffer;
-    char *next_header;
+
+    /*
+     * The header of the next entry was already read
+     * by the previous call.
+     */
+    int next_header_length;
     int has_header;
 
     int has_first;
@@ -35,4 +40,10 @@ uint64_t core_fasta_input_get_offset(struct biosal_input_format *self);
 
 int core_fasta_input_check_header(struct biosal_input_format *self, const char *line);
 
+/*
+ * Copy a line view without its new line symbol, and add a null character.
+ * \return number of bytes copied
+ */
+int core_fasta_input_copy_line(char *buffer, const char *line, int length, int maximum_length);
+
 #endif
@@ -75,20 +75,21 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
     int maximum_sequence_length = BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH;
     int value;
     int length;
+    char *line;
 
     fastq = (struct core_fastq_input *)biosal_input_format_implementation(input);
 
-    if (fastq->buffer == NULL) {
-        fastq->buffer = (char *)core_memory_allocate(maximum_sequence_length + 1, MEMORY_FASTQ);
-    }
-
     value = 0;
 
+    /*
+     * Lines are read as views in the buffer of the reader. Only the
+     * DNA sequence is copied.
+     */
+
     /*
      * Read name
      */
-    value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
+    value += core_buffered_reader_read_line_view(&fastq->reader, &line);
 
 #ifdef FIND_IDENTIFIER
     /*
@@ -97,10 +98,19 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
      */
     if (!fastq->has_first) {
 
-        while (!core_fastq_input_is_identifier(input, fastq->buffer)) {
+        if (fastq->buffer == NULL) {
+            fastq->buffer = (char *)core_memory_allocate(maximum_sequence_length + 1, MEMORY_FASTQ);
+        }
 
-            value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
+        length = value;
+        core_fastq_input_copy_line(fastq->buffer, line, length, maximum_sequence_length);
+
+        while (length > 0 && !core_fastq_input_is_identifier(input, fastq->buffer)) {
+
+            length = core_buffered_reader_read_line_view(&fastq->reader, &line);
+            core_fastq_input_copy_line(fastq->buffer, line, length, maximum_sequence_length);
+
+            value += length;
         }
 
         fastq->has_first = 1;
@@ -108,39 +118,31 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
 #endif
 
     /*
-     * Read DNA sequence
+     * Read DNA sequence, without the new line symbol.
      */
-    length = core_buffered_reader_read_line(&fastq->reader, sequence,
-                    maximum_sequence_length);
+    length = core_buffered_reader_read_line_view(&fastq->reader, &line);
+
+    core_fastq_input_copy_line(sequence, line, length, maximum_sequence_length - 1);
 
 #ifdef BIOSAL_FASTQ_INPUT_DEBUG_READ_LINE
     printf("FASTQ ReadLine <<%s>>\n", sequence);
 #endif
 
-    if (sequence[length - 1] == '\n') {
-        /*
-         * Remove new line symbol.
-         */
-        sequence[length - 1] = '\0';
-    }
-
     value += length;
 
 #ifdef BIOSAL_FASTQ_INPUT_DEBUG2
-    printf("DEBUG core_fastq_input_get_sequence %s\n", buffer);
+    printf("DEBUG core_fastq_input_get_sequence %s\n", sequence);
 #endif
 
     /*
      * Read the + symbol
      */
-    value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
+    value += core_buffered_reader_read_line_view(&fastq->reader, &line);
 
     /*
      * Read quality string.
      */
-    value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
+    value += core_buffered_reader_read_line_view(&fastq->reader, &line);
 
     return value;
 }
@@ -324,3 +326,22 @@ int core_fastq_input_is_identifier_mock(struct biosal_input_format *self, const
 
     return 1;
 }
+
+int core_fastq_input_copy_line(char *buffer, const char *line, int length, int maximum_length)
+{
+    if (length > 0 && line[length - 1] == '\n') {
+        --length;
+    }
+
+    if (length > maximum_length) {
+        length = maximum_length;
+    }
+
+    if (length > 0) {
+        core_memory_copy(buffer, line, length);
+    }
+
+    buffer[length] = '\0';
+
+    return length;
+}
@@ -33,4 +33,10 @@ uint64_t core_fastq_input_get_offset(struct biosal_input_format *self);
 int core_fastq_input_is_identifier(struct biosal_input_format *self, const char *line);
 int core_fastq_input_is_identifier_mock(struct biosal_input_format *self, const char *line);
 
+/*
+ * Copy a line view without its new line symbol, and add a null character.
+ * \return number of bytes copied
+ */
+int core_fastq_input_copy_line(char *buffer, const char *line, int length, int maximum_length);
+
 #endif
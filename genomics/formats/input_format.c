@@ -2,6 +2,8 @@
 #include "input_format.h"
 #include "input_format_interface.h"
 
+#include <genomics/data/dna_sequence_block.h>
+
 #include <core/system/debugger.h>
 
 #include <stdlib.h>
@@ -106,6 +108,49 @@ int biosal_input_format_get_sequence(struct biosal_input_format *input,
     return value;
 }
 
+int biosal_input_format_get_sequences(struct biosal_input_format *input,
+                struct biosal_dna_sequence_block *block, int maximum,
+                char *buffer, struct biosal_dna_codec *codec)
+{
+    biosal_input_format_interface_get_sequence_fn_t handler;
+    biosal_input_format_interface_get_offset_fn_t get_offset;
+    int count;
+
+    if (!biosal_input_format_valid(input)) {
+        return 0;
+    }
+
+    handler = biosal_input_format_interface_get_sequence(input->operations);
+    get_offset = input->operations->get_offset;
+    count = 0;
+
+    /*
+     * Each sequence is encoded right after it is parsed, while it is
+     * still in the cache.
+     */
+    while (count < maximum) {
+
+        /*
+         * Check if the end offset has been reached.
+         */
+        if (get_offset(input) > input->end_offset) {
+            break;
+        }
+
+        if (!handler(input, buffer)) {
+            break;
+        }
+
+        biosal_dna_sequence_block_add(block, buffer, codec);
+
+        ++count;
+    }
+
+    input->sequences += count;
+
+    return count;
+}
+
 uint64_t biosal_input_format_size(struct biosal_input_format *input)
 {
     return input->sequences;
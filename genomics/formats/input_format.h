@@ -16,6 +16,8 @@
 #define BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH 524288
 
 struct biosal_dna_sequence;
+struct biosal_dna_sequence_block;
+struct biosal_dna_codec;
 struct biosal_input_format_interface;
 
 #include <stdint.h>
@@ -42,6 +44,17 @@ void biosal_input_format_destroy(struct biosal_input_format *self);
 
 int biosal_input_format_get_sequence(struct biosal_input_format *self,
                 char *sequence);
+
+/*
+ * Parse up to maximum sequences and encode them in a block.
+ * The buffer is used to parse one sequence at a time and needs
+ * BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH bytes.
+ *
+ * \return number of sequences added to the block
+ */
+int biosal_input_format_get_sequences(struct biosal_input_format *self,
+                struct biosal_dna_sequence_block *block, int maximum,
+                char *buffer, struct biosal_dna_codec *codec);
 char *biosal_input_format_file(struct biosal_input_format *self);
 uint64_t biosal_input_format_size(struct biosal_input_format *self);
 uint64_t biosal_input_format_start_offset(struct biosal_input_format *self);
@@ -52,6 +52,14 @@ int biosal_input_proxy_get_sequence(struct biosal_input_proxy *proxy,
     return value;
 }
 
+int biosal_input_proxy_get_sequences(struct biosal_input_proxy *proxy,
+                struct biosal_dna_sequence_block *block, int maximum,
+                char *buffer, struct biosal_dna_codec *codec)
+{
+    return biosal_input_format_get_sequences(&proxy->input, block, maximum,
+                    buffer, codec);
+}
+
 void biosal_input_proxy_destroy(struct biosal_input_proxy *proxy)
 {
 #ifdef BIOSAL_INPUT_PROXY_DEBUG
@@ -23,6 +23,9 @@ void biosal_input_proxy_init(struct biosal_input_proxy *proxy,
                 char *file, uint64_t offset, uint64_t maximum_offset);
 int biosal_input_proxy_get_sequence(struct biosal_input_proxy *proxy,
                 char *sequence);
+int biosal_input_proxy_get_sequences(struct biosal_input_proxy *proxy,
+                struct biosal_dna_sequence_block *block, int maximum,
+                char *buffer, struct biosal_dna_codec *codec);
 void biosal_input_proxy_destroy(struct biosal_input_proxy *proxy);
 uint64_t biosal_input_proxy_size(struct biosal_input_proxy *proxy);
 uint64_t biosal_input_proxy_offset(struct biosal_input_proxy *proxy);
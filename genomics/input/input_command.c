@@ -2,6 +2,7 @@
 #include "input_command.h"
 
 #include <core/system/packer.h>
+#include <core/system/memory.h>
 #include <core/structures/vector_iterator.h>
 #include <genomics/data/dna_sequence.h>
 
@@ -74,6 +75,70 @@ int biosal_input_command_unpack(struct biosal_input_command *self, void *buffer,
     return biosal_input_command_pack_unpack(self, buffer, CORE_PACKER_OPERATION_UNPACK, memory, codec);
 }
 
+int biosal_input_command_unpack_header(struct biosal_input_command *self, void *buffer,
+                int64_t *entries)
+{
+    struct core_packer packer;
+    int offset;
+
+    core_packer_init(&packer, CORE_PACKER_OPERATION_UNPACK, buffer);
+
+    /*
+     * Same layout as biosal_input_command_pack_unpack
+     */
+    core_packer_process(&packer, &self->store_name, sizeof(self->store_name));
+    core_packer_process(&packer, &self->store_first, sizeof(self->store_first));
+    core_packer_process(&packer, &self->store_last, sizeof(self->store_last));
+    core_packer_process(&packer, entries, sizeof(*entries));
+
+    offset = core_packer_get_byte_count(&packer);
+    core_packer_destroy(&packer);
+
+    return offset;
+}
+
+int biosal_input_command_pack_block_size(struct biosal_input_command *self,
+                struct biosal_dna_sequence_block *block)
+{
+    return biosal_input_command_pack_block(self, block, NULL);
+}
+
+int biosal_input_command_pack_block(struct biosal_input_command *self,
+                struct biosal_dna_sequence_block *block, void *buffer)
+{
+    struct core_packer packer;
+    int64_t entries;
+    int offset;
+    int size;
+
+    core_packer_init(&packer, buffer == NULL ? CORE_PACKER_OPERATION_PACK_SIZE :
+                    CORE_PACKER_OPERATION_PACK, buffer);
+
+    entries = biosal_dna_sequence_block_count(block);
+
+    /*
+     * Same layout as biosal_input_command_pack_unpack
+     */
+    core_packer_process(&packer, &self->store_name, sizeof(self->store_name));
+    core_packer_process(&packer, &self->store_first, sizeof(self->store_first));
+    core_packer_process(&packer, &self->store_last, sizeof(self->store_last));
+    core_packer_process(&packer, &entries, sizeof(entries));
+
+    offset = core_packer_get_byte_count(&packer);
+    core_packer_destroy(&packer);
+
+    /*
+     * The sequences in the block are already packed.
+     */
+    size = biosal_dna_sequence_block_size(block);
+
+    if (buffer != NULL && size > 0) {
+        core_memory_copy((char *)buffer + offset, biosal_dna_sequence_block_data(block), size);
+    }
+
+    return offset + size;
+}
+
 uint64_t biosal_input_command_store_first(struct biosal_input_command *self)
 {
     return self->store_first;
@@ -6,6 +6,7 @@
 
 #include <genomics/data/dna_codec.h>
 #include <genomics/data/dna_sequence.h>
+#include <genomics/data/dna_sequence_block.h>
 
 #include <core/structures/vector.h>
 
@@ -34,6 +35,24 @@ int biosal_input_command_pack(struct biosal_input_command *self, void *buffer, s
 int biosal_input_command_unpack(struct biosal_input_command *self, void *buffer,
                 struct core_memory_pool *memory, struct biosal_dna_codec *codec);
 
+/*
+ * Unpack only the store fields of a packed command. The entries
+ * are not unpacked.
+ *
+ * \return the position of the first packed entry in the buffer
+ */
+int biosal_input_command_unpack_header(struct biosal_input_command *self, void *buffer,
+                int64_t *entries);
+
+/*
+ * Pack the command with the sequences of a block instead of its entries.
+ * The result is unpacked with biosal_input_command_unpack.
+ */
+int biosal_input_command_pack_block_size(struct biosal_input_command *self,
+                struct biosal_dna_sequence_block *block);
+int biosal_input_command_pack_block(struct biosal_input_command *self,
+                struct biosal_dna_sequence_block *block, void *buffer);
+
 int biosal_input_command_pack_unpack(struct biosal_input_command *self, void *buffer,
                 int operation, struct core_memory_pool *memory,
                 struct biosal_dna_codec *codec);
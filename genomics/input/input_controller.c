@@ -458,6 +458,15 @@ void biosal_input_controller_receive(struct thorium_actor *actor, struct thorium
 	/* if all streams failed, notice supervisor */
         if (concrete_actor->counted == core_vector_size(&concrete_actor->files)) {
 
+            /*
+             * The last error can arrive after the other streams
+             * finished counting.
+             */
+            if (core_map_size(&concrete_actor->mega_blocks) > 0) {
+                thorium_actor_send_to_self_empty(actor, ACTION_INPUT_CONTROLLER_SPAWN_READING_STREAMS);
+                return;
+            }
+
 #ifdef BIOSAL_INPUT_CONTROLLER_DEBUG_LEVEL_2
 #endif
             printf("DEBUG %d: Error all streams failed.\n",
@@ -8,6 +8,7 @@
 #include <genomics/storage/sequence_store.h>
 
 #include <core/file_storage/file.h>
+#include <core/file_storage/input/gzip_index.h>
 
 #include <core/helpers/message_helper.h>
 
@@ -82,6 +83,8 @@ void biosal_input_stream_init(struct thorium_actor *actor)
 
     core_vector_init(&concrete_self->mega_blocks, sizeof(struct biosal_mega_block));
 
+    biosal_dna_sequence_block_init(&concrete_self->sequence_block);
+
     thorium_actor_add_action(actor, ACTION_INPUT_STREAM_SET_START_OFFSET, biosal_input_stream_set_start_offset);
     thorium_actor_add_action(actor, ACTION_INPUT_STREAM_SET_END_OFFSET, biosal_input_stream_set_end_offset);
 
@@ -158,6 +161,8 @@ void biosal_input_stream_destroy(struct thorium_actor *actor)
 
     core_vector_destroy(&concrete_self->mega_blocks);
 
+    biosal_dna_sequence_block_destroy(&concrete_self->sequence_block);
+
     concrete_self->total_entries = 0;
     concrete_self->finished_parallel_stream_count = 0;
 
@@ -527,10 +532,6 @@ void biosal_input_stream_push_sequences(struct thorium_actor *actor,
     int new_count;
     struct thorium_message new_message;
     void *buffer_for_sequence;
-    struct biosal_dna_sequence dna_sequence;
-    /*struct core_vector *command_entries;*/
-    int has_sequence;
-    int i;
     struct biosal_input_stream *concrete_self;
 
 #ifdef BIOSAL_INPUT_STREAM_DEBUG
@@ -541,7 +542,6 @@ void biosal_input_stream_push_sequences(struct thorium_actor *actor,
     /* answer immediately
      */
     thorium_actor_send_reply_empty(actor, ACTION_INPUT_PUSH_SEQUENCES_READY);
-    has_sequence = 1;
 
 #ifdef BIOSAL_INPUT_STREAM_DEBUG
     printf("DEBUG stream/%d biosal_input_stream_push_sequences entering...\n",
@@ -562,7 +562,7 @@ void biosal_input_stream_push_sequences(struct thorium_actor *actor,
     printf("DEBUG biosal_input_stream_push_sequences after unpack, count %d:\n",
                     count);
 
-    biosal_input_command_print(&command);
+    biosal_input_command_print(&command, &concrete_self->codec);
 #endif
 
     store_name = biosal_input_command_store_name(&command);
@@ -575,7 +575,7 @@ void biosal_input_stream_push_sequences(struct thorium_actor *actor,
     printf("DEBUG biosal_input_stream_push_sequences received ACTION_INPUT_PUSH_SEQUENCES\n");
     printf("DEBUG Command before sending it\n");
 
-    biosal_input_command_print(&command);
+    biosal_input_command_print(&command, &concrete_self->codec);
 #endif
 
     /*
@@ -583,44 +583,28 @@ void biosal_input_stream_push_sequences(struct thorium_actor *actor,
      */
 
     buffer_for_sequence = concrete_self->buffer_for_sequence;
-    /*command_entries = biosal_input_command_entries(&command);*/
 
-    i = 0;
-    /* TODO: actually load something
+    /*
+     * Parse and encode all the sequences in one contiguous block, and
+     * pack the command around it.
      */
-    while (sequences_to_read-- && has_sequence) {
-        has_sequence = biosal_input_proxy_get_sequence(&concrete_self->proxy,
-                            buffer_for_sequence);
-
-        biosal_dna_sequence_init(&dna_sequence, buffer_for_sequence,
-                        &concrete_self->codec, thorium_actor_get_ephemeral_memory(actor));
+    biosal_dna_sequence_block_clear(&concrete_self->sequence_block);
 
-        biosal_input_command_add_entry(&command, &dna_sequence, &concrete_self->codec,
-                        thorium_actor_get_ephemeral_memory(actor));
-
-        biosal_dna_sequence_destroy(&dna_sequence, thorium_actor_get_ephemeral_memory(actor));
-
-        i++;
-    }
+    biosal_input_proxy_get_sequences(&concrete_self->proxy,
+                    &concrete_self->sequence_block, sequences_to_read,
+                    buffer_for_sequence, &concrete_self->codec);
 
 #ifdef BIOSAL_INPUT_STREAM_DEBUG
     printf("DEBUG prepared %d sequences for command\n",
-                    i);
-    biosal_input_command_print(&command);
+                    biosal_dna_sequence_block_count(&concrete_self->sequence_block));
 #endif
 
-    new_count = biosal_input_command_pack_size(&command,
-                    &concrete_self->codec);
+    new_count = biosal_input_command_pack_block_size(&command,
+                    &concrete_self->sequence_block);
 
     new_buffer = thorium_actor_allocate(actor, new_count);
 
-    biosal_input_command_pack(&command, new_buffer, &concrete_self->codec);
-
-#ifdef BIOSAL_INPUT_STREAM_DEBUG
-    actual_count = biosal_input_command_pack(&command, new_buffer);
-    printf("DEBUG123 new_count %d actual_count %d\n", new_count,
-                    actual_count);
-#endif
+    biosal_input_command_pack_block(&command, &concrete_self->sequence_block, new_buffer);
 
     thorium_message_init(&new_message, ACTION_PUSH_SEQUENCE_DATA_BLOCK,
                     new_count, new_buffer);
@@ -643,23 +627,8 @@ void biosal_input_stream_push_sequences(struct thorium_actor *actor,
     /* free memory
      */
 
-#ifdef BIOSAL_INPUT_STREAM_DEBUG
-    printf("DEBUG freeing %d entries\n",
-                    (int)core_vector_size(command_entries));
-#endif
-
     biosal_input_command_destroy(&command, thorium_actor_get_ephemeral_memory(actor));
 
-#if 0
-    for (i = 0; i < core_vector_size(command_entries); i++) {
-        a_sequence = (struct biosal_dna_sequence *)core_vector_at(command_entries, i);
-
-        biosal_dna_sequence_destroy(a_sequence, thorium_actor_get_ephemeral_memory(actor));
-    }
-
-    core_vector_destroy(command_entries);
-#endif
-
 #ifdef BIOSAL_INPUT_STREAM_DEBUG
     printf("DEBUG biosal_input_stream_push_sequences EXIT\n");
 #endif
@@ -709,6 +678,7 @@ void biosal_input_stream_count_in_parallel(struct thorium_actor *self, struct th
     int i;
     int size;
     uint64_t parallel_block_size;
+    struct core_gzip_index index;
 
     /*
      * The block size for deciding when to spawn new actors for
@@ -739,6 +709,21 @@ void biosal_input_stream_count_in_parallel(struct thorium_actor *self, struct th
 
     file_size = core_file_get_size(file);
 
+    /*
+     * The offsets of a gzip file are in uncompressed bytes. Getting the
+     * index here also builds its cache once for all the streams;
+     * the streams only load that cache.
+     */
+    if (core_gzip_index_detect(file)) {
+        core_gzip_index_init(&index);
+
+        if (core_gzip_index_get(&index, file)) {
+            file_size = core_gzip_index_uncompressed_size(&index);
+        }
+
+        core_gzip_index_destroy(&index);
+    }
+
     printf("COUNT_IN_PARALLEL %s %" PRIu64 "\n",
                     file, file_size);
 
@@ -5,6 +5,7 @@
 #include <genomics/formats/input_proxy.h>
 
 #include <genomics/data/dna_codec.h>
+#include <genomics/data/dna_sequence_block.h>
 
 #include <engine/thorium/actor.h>
 
@@ -20,6 +21,12 @@ struct biosal_input_stream {
     int proxy_ready;
     char *buffer_for_sequence;
     int maximum_sequence_length;
+
+    /*
+     * Sequences for ACTION_PUSH_SEQUENCE_DATA_BLOCK, reused
+     * between blocks.
+     */
+    struct biosal_dna_sequence_block sequence_block;
     int open;
     int controller;
     int error;
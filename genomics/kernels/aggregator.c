@@ -9,17 +9,22 @@
 #include <genomics/kernels/dna_kmer_counter_kernel.h>
 #include <genomics/storage/kmer_store.h>
 
+#include <engine/thorium/node.h>
+
 #include <core/helpers/message_helper.h>
 #include <core/helpers/vector_helper.h>
 
 #include <core/system/packer.h>
+#include <core/system/command.h>
 
 #include <core/structures/vector_iterator.h>
+#include <core/structures/concurrent_counting_table.h>
 
 #include <core/system/debugger.h>
 #include <core/system/memory.h>
 
 #include <stdio.h>
+#include <stdint.h>
 #include <inttypes.h>
 
 /* debugging options
@@ -44,6 +49,8 @@
 #define BIOSAL_AGGREGATOR_DEBUG_FLUSHING
 */
 
+static void biosal_aggregator_request_shared_tables(struct thorium_actor *self);
+
 struct thorium_script biosal_aggregator_script = {
     .identifier = SCRIPT_AGGREGATOR,
     .name = "biosal_aggregator",
@@ -79,6 +86,10 @@ void biosal_aggregator_init(struct thorium_actor *self)
 
     concrete_actor->forced = BIOSAL_FALSE;
 
+    core_vector_init(&concrete_actor->shared_tables, sizeof(void *));
+    concrete_actor->shared_table_requests = -1;
+    concrete_actor->shared_table_replies = 0;
+
     thorium_actor_add_action(self, ACTION_AGGREGATE_KERNEL_OUTPUT,
                     biosal_aggregator_aggregate_kernel_output);
 
@@ -108,7 +119,7 @@ void biosal_aggregator_destroy(struct thorium_actor *self)
     core_fast_queue_destroy(&concrete_actor->stalled_producers);
 
     core_vector_destroy(&concrete_actor->consumers);
-
+    core_vector_destroy(&concrete_actor->shared_tables);
 }
 
 void biosal_aggregator_receive(struct thorium_actor *self, struct thorium_message *message)
@@ -119,6 +130,8 @@ void biosal_aggregator_receive(struct thorium_actor *self, struct thorium_messag
     int source;
     int consumer_index_index;
     int *bucket;
+    uint64_t address;
+    void *shared_table;
 
     if (thorium_actor_take_action(self, message)) {
         return;
@@ -167,6 +180,16 @@ void biosal_aggregator_receive(struct thorium_actor *self, struct thorium_messag
         if (!concrete_actor->forced) {
             biosal_aggregator_verify(self, message);
         }
+
+    } else if (tag == ACTION_KMER_STORE_GET_SHARED_TABLE_REPLY) {
+
+        thorium_message_unpack_uint64_t(message, 0, &address);
+        shared_table = (void *)(uintptr_t)address;
+
+        consumer_index_index = core_vector_index_of(&concrete_actor->consumers, &source);
+        core_vector_set(&concrete_actor->shared_tables, consumer_index_index, &shared_table);
+
+        concrete_actor->shared_table_replies++;
     }
 }
 
@@ -197,6 +220,14 @@ void biosal_aggregator_flush(struct thorium_actor *self, int customer_index, str
 
     CORE_DEBUGGER_ASSERT(customer_block_pointer != NULL);
 
+    /*
+     * Nothing to send when all the k-mers of this consumer went to
+     * its shared table.
+     */
+    if (core_map_size(biosal_dna_kmer_frequency_block_kmers(customer_block_pointer)) == 0) {
+        return;
+    }
+
     count = biosal_dna_kmer_frequency_block_pack_size(customer_block_pointer,
                     &concrete_actor->codec);
 
@@ -301,6 +332,11 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
     void *buffer;
     int customer_index;
     struct core_vector_iterator iterator;
+    int use_shared_tables;
+    struct core_concurrent_counting_table *shared_table;
+    struct core_vector shared_counts;
+    uint64_t key[2];
+    int *shared_count;
 
     concrete_actor = (struct biosal_aggregator *)thorium_actor_concrete_actor(self);
 
@@ -310,6 +346,13 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
         return;
     }
 
+    if (concrete_actor->shared_table_requests == -1) {
+        biosal_aggregator_request_shared_tables(self);
+    }
+
+    use_shared_tables = concrete_actor->shared_table_requests > 0
+            && concrete_actor->shared_table_replies == concrete_actor->shared_table_requests;
+
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     source = thorium_message_source(message);
     buffer = thorium_message_buffer(message);
@@ -351,6 +394,18 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
 
     concrete_actor->customer_block_size = (entries / customer_count) * 2;
 
+    if (use_shared_tables) {
+        CORE_DEBUGGER_ASSERT(biosal_dna_kmer_inline_key_size(concrete_actor->kmer_length)
+                        <= (int)sizeof(key));
+
+        core_vector_init(&shared_counts, sizeof(int));
+        core_vector_resize(&shared_counts, customer_count);
+
+        for (i = 0; i < customer_count; i++) {
+            core_vector_set_int(&shared_counts, i, 0);
+        }
+    }
+
     /*
      * Reserve entries
      */
@@ -377,6 +432,26 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
         customer_index = biosal_dna_kmer_store_index(kmer, customer_count, concrete_actor->kmer_length,
                         &concrete_actor->codec, thorium_actor_get_ephemeral_memory(self));
 
+        /*
+         * Count the kmer directly if its consumer is on this node.
+         * A full table falls back to messages.
+         */
+        if (use_shared_tables) {
+            shared_table = core_vector_at_as_void_pointer(&concrete_actor->shared_tables,
+                            customer_index);
+
+            if (shared_table != NULL) {
+                biosal_dna_kmer_pack_inline_key(kmer, key, concrete_actor->kmer_length,
+                                &concrete_actor->codec);
+
+                if (core_concurrent_counting_table_add(shared_table, key, 1)) {
+                    shared_count = (int *)core_vector_at(&shared_counts, customer_index);
+                    (*shared_count)++;
+                    continue;
+                }
+            }
+        }
+
         customer_block_pointer = (struct biosal_dna_kmer_frequency_block *)core_vector_at(&buffers,
                         customer_index);
 
@@ -435,6 +510,24 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
      */
     biosal_dna_kmer_block_destroy(&input_block, thorium_actor_get_ephemeral_memory(self));
 
+    /*
+     * The totals are only increased once the kmers are in the
+     * tables, so that the stores never report kmers that
+     * are not there yet.
+     */
+    if (use_shared_tables) {
+        for (i = 0; i < customer_count; i++) {
+            shared_count = (int *)core_vector_at(&shared_counts, i);
+
+            if (*shared_count > 0) {
+                shared_table = core_vector_at_as_void_pointer(&concrete_actor->shared_tables, i);
+                core_concurrent_counting_table_increase_total(shared_table, *shared_count);
+            }
+        }
+
+        core_vector_destroy(&shared_counts);
+    }
+
 #ifdef BIOSAL_AGGREGATOR_DEBUG
         BIOSAL_DEBUG_MARKER("aggregator marker EXIT");
 #endif
@@ -548,6 +641,59 @@ int biosal_aggregator_set_consumers(struct thorium_actor *actor, void *buffer)
     return bytes;
 }
 
+/*
+ * Ask the consumers on this node for their shared table.
+ * The shared tables are not packed because the pointers are only
+ * valid on this node.
+ */
+static void biosal_aggregator_request_shared_tables(struct thorium_actor *self)
+{
+    struct biosal_aggregator *concrete_actor;
+    struct thorium_node *node;
+    void *shared_table;
+    int consumer;
+    int size;
+    int i;
+
+    concrete_actor = (struct biosal_aggregator *)thorium_actor_concrete_actor(self);
+    node = thorium_actor_node(self);
+    size = core_vector_size(&concrete_actor->consumers);
+
+    shared_table = NULL;
+    core_vector_resize(&concrete_actor->shared_tables, size);
+
+    concrete_actor->shared_table_requests = 0;
+    concrete_actor->shared_table_replies = 0;
+
+    for (i = 0; i < size; i++) {
+        core_vector_set(&concrete_actor->shared_tables, i, &shared_table);
+    }
+
+    /*
+     * The stores only have a shared table with this option,
+     * and inline keys are required.
+     */
+    if (!core_command_has_argument(thorium_actor_argc(self), thorium_actor_argv(self),
+                            BIOSAL_KMER_STORE_SHARED_TABLE_BUCKETS_OPTION)) {
+        return;
+    }
+
+    if (concrete_actor->kmer_length > BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH) {
+        return;
+    }
+
+    for (i = 0; i < size; i++) {
+        consumer = core_vector_at_as_int(&concrete_actor->consumers, i);
+
+        if (thorium_node_actor_node(node, consumer) != thorium_actor_node_name(self)) {
+            continue;
+        }
+
+        thorium_actor_send_empty(self, consumer, ACTION_KMER_STORE_GET_SHARED_TABLE);
+        concrete_actor->shared_table_requests++;
+    }
+}
+
 int biosal_aggregator_pack_unpack(struct thorium_actor *actor, int operation, void *buffer)
 {
     struct core_packer packer;
@@ -33,6 +33,16 @@ struct biosal_aggregator {
     int forced;
 
     struct biosal_dna_codec codec;
+
+    /*
+     * Shared tables of the consumers on the same node
+     * (NULL for the others). They are requested with the
+     * first kernel output, and used once all the replies
+     * are in.
+     */
+    struct core_vector shared_tables;
+    int shared_table_requests;
+    int shared_table_replies;
 };
 
 /* message tags
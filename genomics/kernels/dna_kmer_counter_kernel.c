@@ -7,6 +7,7 @@
 
 #include <genomics/data/dna_kmer.h>
 #include <genomics/data/dna_kmer_block.h>
+#include <genomics/data/dna_kmer_extractor.h>
 #include <genomics/data/dna_sequence.h>
 
 #include <genomics/input/input_command.h>
@@ -576,19 +577,16 @@ void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_acto
     int consumer;
     int i;
     struct biosal_dna_sequence *sequence;
-    char *sequence_data;
+    void *kmer_data;
     struct core_vector *command_entries;
     int sequence_length;
     int new_count;
     void *new_buffer;
     struct thorium_message new_message;
-    int j;
-    int limit;
-    char saved;
     struct core_timer timer;
     struct biosal_dna_kmer_block block;
+    struct biosal_dna_kmer_extractor extractor;
     int to_reserve;
-    int maximum_length;
     struct core_memory_pool *ephemeral_memory;
     int kmers_for_sequence;
 
@@ -640,75 +638,68 @@ void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_acto
 
     to_reserve = 0;
 
-    maximum_length = 0;
-
     for (i = 0; i < entries; i++) {
 
         sequence = (struct biosal_dna_sequence *)core_vector_at(command_entries, i);
 
         sequence_length = biosal_dna_sequence_length(sequence);
 
-        if (sequence_length > maximum_length) {
-            maximum_length = sequence_length;
-        }
-
         to_reserve += (sequence_length - concrete_actor->kmer_length + 1);
     }
 
     biosal_dna_kmer_block_init(&block, concrete_actor->kmer_length, source_index, to_reserve);
 
-    sequence_data = core_memory_pool_allocate(ephemeral_memory, maximum_length + 1);
+    biosal_dna_kmer_extractor_init(&extractor, concrete_actor->kmer_length,
+                    &concrete_actor->codec, ephemeral_memory);
+
+    kmer_data = core_memory_pool_allocate(ephemeral_memory,
+                    biosal_dna_kmer_extractor_encoded_length(&extractor));
 
-    /* extract kmers
+    /*
+     * The kmer only wraps the extractor output. It is copied by
+     * biosal_dna_kmer_block_add_kmer.
+     */
+    biosal_dna_kmer_init_empty(&kmer);
+    kmer.encoded_data = kmer_data;
+
+    /* extract kmers with a rolling window on the encoded sequence.
+     * The canonical orientation is emitted since the kmer stores only
+     * keep canonical kmers anyway.
      */
     for (i = 0; i < entries; i++) {
 
-        /* TODO improve this */
         sequence = (struct biosal_dna_sequence *)core_vector_at(command_entries, i);
 
-        biosal_dna_sequence_get_sequence(sequence, sequence_data,
-                        &concrete_actor->codec);
-
-        sequence_length = biosal_dna_sequence_length(sequence);
-        limit = sequence_length - concrete_actor->kmer_length + 1;
+        biosal_dna_kmer_extractor_start(&extractor, sequence);
 
         kmers_for_sequence = 0;
 
-        for (j = 0; j < limit; j++) {
-            saved = sequence_data[j + concrete_actor->kmer_length];
-            sequence_data[j + concrete_actor->kmer_length] = '\0';
+        while (biosal_dna_kmer_extractor_next(&extractor)) {
 
-            biosal_dna_kmer_init(&kmer, sequence_data + j,
-                            &concrete_actor->codec, thorium_actor_get_ephemeral_memory(actor));
-
-#ifdef BIOSAL_KMER_COUNTER_KERNEL_DEBUG_LEVEL_2
-            printf("KERNEL kmer %d,%d %s\n", i, j, sequence_data + j);
-#endif
+            biosal_dna_kmer_extractor_get_canonical(&extractor, kmer_data);
 
             /*
              * add kmer in block
              */
-            biosal_dna_kmer_block_add_kmer(&block, &kmer, thorium_actor_get_ephemeral_memory(actor),
+            biosal_dna_kmer_block_add_kmer(&block, &kmer, ephemeral_memory,
                             &concrete_actor->codec);
 
-            biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(actor));
-
-            sequence_data[j + concrete_actor->kmer_length] = saved;
-
             ++kmers_for_sequence;
         }
 
 #ifdef BIOSAL_PRIVATE_DEBUG_EMIT
         printf("DEBUG EMIT KMERS INPUT: %d nucleotides, k: %d output %d kmers\n",
-                        sequence_length, concrete_actor->kmer_length,
+                        biosal_dna_sequence_length(sequence), concrete_actor->kmer_length,
                         kmers_for_sequence);
 #endif
 
         concrete_actor->kmers += kmers_for_sequence;
     }
 
-    core_memory_pool_free(ephemeral_memory, sequence_data);
-    sequence_data = NULL;
+    core_memory_pool_free(ephemeral_memory, kmer_data);
+    kmer_data = NULL;
+
+    biosal_dna_kmer_extractor_destroy(&extractor);
 
 #ifdef BIOSAL_KMER_COUNTER_KERNEL_DEBUG
     BIOSAL_DEBUG_MARKER("after generating kmers\n");
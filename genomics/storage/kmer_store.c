@@ -12,6 +12,7 @@
 #include <core/helpers/message_helper.h>
 
 #include <core/system/memory.h>
+#include <core/system/command.h>
 
 #include <core/structures/vector.h>
 #include <core/structures/vector_iterator.h>
@@ -23,6 +24,14 @@
 
 #define MEMORY_KMER_STORE 0x51daca18
 
+#define CONTROL_BYTES_OPTION "-enable-control-bytes"
+
+static void biosal_kmer_store_pack_key(struct thorium_actor *self, void *packed_kmer,
+                void *key, char *raw_kmer);
+static void biosal_kmer_store_unpack_key(struct thorium_actor *self, void *key,
+                struct biosal_dna_kmer *kmer);
+static void biosal_kmer_store_merge_shared_table(struct thorium_actor *self);
+
 struct thorium_script biosal_kmer_store_script = {
     .identifier = SCRIPT_KMER_STORE,
     .init = biosal_kmer_store_init,
@@ -40,6 +49,8 @@ void biosal_kmer_store_init(struct thorium_actor *self)
 
     core_memory_pool_init(&concrete_actor->persistent_memory, 0, MEMORY_KMER_STORE);
     concrete_actor->kmer_length = -1;
+    concrete_actor->use_inline_keys = 0;
+    concrete_actor->use_shared_table = 0;
     concrete_actor->received = 0;
 
     biosal_dna_codec_init(&concrete_actor->transport_codec);
@@ -80,6 +91,11 @@ void biosal_kmer_store_destroy(struct thorium_actor *self)
         core_map_destroy(&concrete_actor->table);
     }
 
+    if (concrete_actor->use_shared_table) {
+        core_concurrent_counting_table_destroy(&concrete_actor->shared_table);
+        concrete_actor->use_shared_table = 0;
+    }
+
     biosal_dna_codec_destroy(&concrete_actor->transport_codec);
     biosal_dna_codec_destroy(&concrete_actor->storage_codec);
 
@@ -99,15 +115,16 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
     struct core_map_iterator iterator;
     double value;
     struct biosal_dna_kmer kmer;
-    struct biosal_dna_kmer *kmer_pointer;
     void *packed_kmer;
     int *frequency;
     int *bucket;
     struct core_memory_pool *ephemeral_memory;
     int customer;
     int period;
-    struct biosal_dna_kmer encoded_kmer;
     char *raw_kmer;
+    int buckets;
+    uint64_t entries;
+    struct core_concurrent_counting_table *shared_table;
 
 #ifdef BIOSAL_KMER_STORE_DEBUG
     int name;
@@ -126,11 +143,18 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
 
         thorium_message_unpack_int(message, 0, &concrete_actor->kmer_length);
 
-        biosal_dna_kmer_init_mock(&kmer, concrete_actor->kmer_length,
+        if (concrete_actor->kmer_length <= BIOSAL_DNA_KMER_MAXIMUM_INLINE_KEY_LENGTH) {
+            concrete_actor->use_inline_keys = 1;
+            concrete_actor->key_length_in_bytes =
+                    biosal_dna_kmer_inline_key_size(concrete_actor->kmer_length);
+
+        } else {
+            biosal_dna_kmer_init_mock(&kmer, concrete_actor->kmer_length,
                         &concrete_actor->storage_codec, thorium_actor_get_ephemeral_memory(self));
-        concrete_actor->key_length_in_bytes = biosal_dna_kmer_pack_size(&kmer,
+            concrete_actor->key_length_in_bytes = biosal_dna_kmer_pack_size(&kmer,
                         concrete_actor->kmer_length, &concrete_actor->storage_codec);
-        biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(self));
+            biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(self));
+        }
 
 #ifdef BIOSAL_KMER_STORE_DEBUG
         name = thorium_actor_name(self);
@@ -149,6 +173,15 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
          */
         core_map_disable_deletion_support(&concrete_actor->table);
 
+        if (core_command_has_argument(thorium_actor_argc(self), thorium_actor_argv(self),
+                                CONTROL_BYTES_OPTION)) {
+            core_map_enable_control_bytes(&concrete_actor->table);
+        }
+
+        if (concrete_actor->use_inline_keys) {
+            core_map_enable_integer_keys(&concrete_actor->table);
+        }
+
         /*
          * The threshold of the map is not very important because
          * requests that hit the map have to first arrive as messages,
@@ -156,6 +189,20 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
          */
         core_map_set_threshold(&concrete_actor->table, 0.95);
 
+        if (concrete_actor->use_inline_keys
+                        && core_command_has_argument(thorium_actor_argc(self), thorium_actor_argv(self),
+                                BIOSAL_KMER_STORE_SHARED_TABLE_BUCKETS_OPTION)) {
+
+            buckets = core_command_get_argument_value_int(thorium_actor_argc(self),
+                            thorium_actor_argv(self), BIOSAL_KMER_STORE_SHARED_TABLE_BUCKETS_OPTION);
+
+            if (buckets > 0) {
+                core_concurrent_counting_table_init(&concrete_actor->shared_table, buckets,
+                                concrete_actor->key_length_in_bytes);
+                concrete_actor->use_shared_table = 1;
+            }
+        }
+
         thorium_actor_send_reply_empty(self, ACTION_SET_KMER_LENGTH_REPLY);
 
     } else if (tag == ACTION_PUSH_KMER_BLOCK) {
@@ -190,37 +237,7 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
              */
             core_map_iterator_next(&iterator, (void **)&packed_kmer, (void **)&frequency);
 
-            /* Store the kmer in 2 bit encoding
-             */
-
-            biosal_dna_kmer_init_empty(&kmer);
-            biosal_dna_kmer_unpack(&kmer, packed_kmer, concrete_actor->kmer_length,
-                        ephemeral_memory,
-                        &concrete_actor->transport_codec);
-
-            kmer_pointer = &kmer;
-
-            /*
-             * Get a copy of the sequence
-             */
-            biosal_dna_kmer_get_sequence(kmer_pointer, raw_kmer, concrete_actor->kmer_length,
-                            &concrete_actor->transport_codec);
-
-#if 0
-            printf("DEBUG raw_kmer %s\n", raw_kmer);
-#endif
-
-            biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
-
-            biosal_dna_kmer_init(&encoded_kmer, raw_kmer, &concrete_actor->storage_codec,
-                            thorium_actor_get_ephemeral_memory(self));
-
-            biosal_dna_kmer_pack_store_key(&encoded_kmer, key,
-                            concrete_actor->kmer_length, &concrete_actor->storage_codec,
-                            thorium_actor_get_ephemeral_memory(self));
-
-            biosal_dna_kmer_destroy(&encoded_kmer,
-                            thorium_actor_get_ephemeral_memory(self));
+            biosal_kmer_store_pack_key(self, packed_kmer, key, raw_kmer);
 
             bucket = (int *)core_map_get(&concrete_actor->table, key);
 
@@ -290,8 +307,25 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
 
     } else if (tag == ACTION_STORE_GET_ENTRY_COUNT) {
 
+        entries = concrete_actor->received;
+
+        if (concrete_actor->use_shared_table) {
+            entries += core_concurrent_counting_table_total(&concrete_actor->shared_table);
+        }
+
         thorium_actor_send_reply_uint64_t(self, ACTION_STORE_GET_ENTRY_COUNT_REPLY,
-                        concrete_actor->received);
+                        entries);
+
+    } else if (tag == ACTION_KMER_STORE_GET_SHARED_TABLE) {
+
+        shared_table = NULL;
+
+        if (concrete_actor->use_shared_table) {
+            shared_table = &concrete_actor->shared_table;
+        }
+
+        thorium_actor_send_reply_uint64_t(self, ACTION_KMER_STORE_GET_SHARED_TABLE_REPLY,
+                        (uint64_t)(uintptr_t)shared_table);
     }
 }
 
@@ -319,10 +353,7 @@ void biosal_kmer_store_print(struct thorium_actor *self)
     while (core_map_iterator_has_next(&iterator)) {
         core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, key, concrete_actor->kmer_length,
-                        thorium_actor_get_ephemeral_memory(self),
-                        &concrete_actor->storage_codec);
+        biosal_kmer_store_unpack_key(self, key, &kmer);
 
         length = biosal_dna_kmer_length(&kmer, concrete_actor->kmer_length);
 
@@ -347,10 +378,7 @@ void biosal_kmer_store_print(struct thorium_actor *self)
     while (core_map_iterator_has_next(&iterator)) {
         core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, key, concrete_actor->kmer_length,
-                        thorium_actor_get_ephemeral_memory(self),
-                        &concrete_actor->storage_codec);
+        biosal_kmer_store_unpack_key(self, key, &kmer);
 
         biosal_dna_kmer_get_sequence(&kmer, sequence, concrete_actor->kmer_length,
                         &concrete_actor->storage_codec);
@@ -378,6 +406,10 @@ void biosal_kmer_store_push_data(struct thorium_actor *self, struct thorium_mess
 
     core_map_init(&concrete_actor->coverage_distribution, sizeof(int), sizeof(uint64_t));
 
+    if (concrete_actor->use_shared_table) {
+        biosal_kmer_store_merge_shared_table(self);
+    }
+
     printf("kmer store %d: local table has %" PRIu64" canonical kmers (%" PRIu64 " kmers)\n",
                     name, core_map_size(&concrete_actor->table),
                     2 * core_map_size(&concrete_actor->table));
@@ -393,7 +425,6 @@ void biosal_kmer_store_push_data(struct thorium_actor *self, struct thorium_mess
 
 void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_message *message)
 {
-    struct biosal_dna_kmer kmer;
     void *key;
     int *value;
     int coverage;
@@ -403,11 +434,9 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
     int new_count;
     void *new_buffer;
     struct thorium_message new_message;
-    struct core_memory_pool *ephemeral_memory;
     int i;
     int max;
 
-    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     concrete_actor = (struct biosal_kmer_store *)thorium_actor_concrete_actor(self);
     customer = concrete_actor->customer;
 
@@ -426,11 +455,6 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
 
         core_map_iterator_next(&concrete_actor->iterator, (void **)&key, (void **)&value);
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, key, concrete_actor->kmer_length,
-                        ephemeral_memory,
-                        &concrete_actor->storage_codec);
-
         coverage = *value;
 
         count = (uint64_t *)core_map_get(&concrete_actor->coverage_distribution, &coverage);
@@ -445,8 +469,6 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
         /* increment for the lowest kmer (canonical) */
         (*count)++;
 
-        biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
-
         ++i;
     }
 
@@ -492,3 +514,122 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
     thorium_actor_send_empty(self, concrete_actor->source,
                             ACTION_PUSH_DATA_REPLY);
 }
+
+/*
+ * Build the key of a k-mer packed with the transport codec.
+ */
+static void biosal_kmer_store_pack_key(struct thorium_actor *self, void *packed_kmer,
+                void *key, char *raw_kmer)
+{
+    struct biosal_kmer_store *concrete_actor;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer encoded_kmer;
+
+    concrete_actor = (struct biosal_kmer_store *)thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    /*
+     * Inline keys are built directly from the packed k-mer
+     * (the packed form is the encoded data).
+     */
+    if (concrete_actor->use_inline_keys) {
+        kmer.encoded_data = packed_kmer;
+        biosal_dna_kmer_pack_inline_key(&kmer, key, concrete_actor->kmer_length,
+                        &concrete_actor->transport_codec);
+        return;
+    }
+
+    /* Store the kmer in the storage encoding
+     */
+    biosal_dna_kmer_init_empty(&kmer);
+    biosal_dna_kmer_unpack(&kmer, packed_kmer, concrete_actor->kmer_length,
+                ephemeral_memory,
+                &concrete_actor->transport_codec);
+
+    /*
+     * Get a copy of the sequence
+     */
+    biosal_dna_kmer_get_sequence(&kmer, raw_kmer, concrete_actor->kmer_length,
+                    &concrete_actor->transport_codec);
+
+    biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+
+    biosal_dna_kmer_init(&encoded_kmer, raw_kmer, &concrete_actor->storage_codec,
+                    ephemeral_memory);
+
+    biosal_dna_kmer_pack_store_key(&encoded_kmer, key,
+                    concrete_actor->kmer_length, &concrete_actor->storage_codec,
+                    ephemeral_memory);
+
+    biosal_dna_kmer_destroy(&encoded_kmer, ephemeral_memory);
+}
+
+/*
+ * Get a k-mer from a key. The k-mer is encoded with the storage
+ * codec and must be destroyed with the ephemeral memory.
+ */
+static void biosal_kmer_store_unpack_key(struct thorium_actor *self, void *key,
+                struct biosal_dna_kmer *kmer)
+{
+    struct biosal_kmer_store *concrete_actor;
+
+    concrete_actor = (struct biosal_kmer_store *)thorium_actor_concrete_actor(self);
+
+    if (concrete_actor->use_inline_keys) {
+        biosal_dna_kmer_init_from_inline_key(kmer, key, concrete_actor->kmer_length,
+                        thorium_actor_get_ephemeral_memory(self),
+                        &concrete_actor->storage_codec);
+        return;
+    }
+
+    biosal_dna_kmer_init_empty(kmer);
+    biosal_dna_kmer_unpack(kmer, key, concrete_actor->kmer_length,
+                    thorium_actor_get_ephemeral_memory(self),
+                    &concrete_actor->storage_codec);
+}
+
+/*
+ * Move the k-mers counted by aggregators in the shared table
+ * to the map. All the counts are in the table at this point because
+ * ACTION_STORE_GET_ENTRY_COUNT includes the total of the table.
+ */
+static void biosal_kmer_store_merge_shared_table(struct thorium_actor *self)
+{
+    struct biosal_kmer_store *concrete_actor;
+    struct core_concurrent_counting_table *shared_table;
+    uint64_t buckets;
+    uint64_t i;
+    void *key;
+    int count;
+    int *bucket;
+
+    concrete_actor = (struct biosal_kmer_store *)thorium_actor_concrete_actor(self);
+    shared_table = &concrete_actor->shared_table;
+    buckets = core_concurrent_counting_table_buckets(shared_table);
+
+    printf("kmer store %d merges %" PRId64 " kmers from its shared table\n",
+                    thorium_actor_name(self),
+                    core_concurrent_counting_table_total(shared_table));
+
+    for (i = 0; i < buckets; i++) {
+
+        if (!core_concurrent_counting_table_bucket(shared_table, i, &key, &count)) {
+            continue;
+        }
+
+        bucket = (int *)core_map_get(&concrete_actor->table, key);
+
+        if (bucket == NULL) {
+            bucket = (int *)core_map_add(&concrete_actor->table, key);
+            *bucket = 0;
+        }
+
+        (*bucket) += count;
+    }
+
+    concrete_actor->received += core_concurrent_counting_table_total(shared_table);
+
+    core_concurrent_counting_table_destroy(shared_table);
+    concrete_actor->use_shared_table = 0;
+}
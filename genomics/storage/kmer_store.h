@@ -10,6 +10,7 @@
 
 #include <core/structures/map_iterator.h>
 #include <core/structures/map.h>
+#include <core/structures/concurrent_counting_table.h>
 
 #include <core/system/memory_pool.h>
 
@@ -26,11 +27,25 @@ struct biosal_kmer_store {
     int kmer_length;
     int key_length_in_bytes;
 
+    /*
+     * Keys are inline (1 or 2 words) when k <= 64.
+     */
+    int use_inline_keys;
+
     int customer;
 
     uint64_t received;
     uint64_t last_received;
 
+    /*
+     * With inline keys, aggregators on the same node can count
+     * k-mers directly in this table instead of sending them
+     * in messages. The table is merged in the map before
+     * the coverage distribution is computed.
+     */
+    struct core_concurrent_counting_table shared_table;
+    int use_shared_table;
+
     struct core_memory_pool persistent_memory;
 
     struct core_map coverage_distribution;
@@ -43,6 +58,20 @@ struct biosal_kmer_store {
 #define ACTION_STORE_GET_ENTRY_COUNT 0x00007aad
 #define ACTION_STORE_GET_ENTRY_COUNT_REPLY 0x00002e6a
 
+/*
+ * The reply contains the address of the shared table
+ * as a uint64_t (0 if there is none). This is only meaningful
+ * for actors on the same node.
+ */
+#define ACTION_KMER_STORE_GET_SHARED_TABLE 0x00003b71
+#define ACTION_KMER_STORE_GET_SHARED_TABLE_REPLY 0x000061d4
+
+/*
+ * Each store has a shared table of this many buckets only
+ * with this option.
+ */
+#define BIOSAL_KMER_STORE_SHARED_TABLE_BUCKETS_OPTION "-shared-kmer-table-buckets"
+
 extern struct thorium_script biosal_kmer_store_script;
 
 void biosal_kmer_store_init(struct thorium_actor *actor);
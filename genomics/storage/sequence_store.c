@@ -54,6 +54,7 @@ void biosal_sequence_store_init(struct thorium_actor *actor)
     core_memory_pool_disable_tracking(&concrete_actor->persistent_memory);
 
     core_vector_init(&concrete_actor->sequences, sizeof(struct biosal_dna_sequence));
+    core_vector_init(&concrete_actor->retained_messages, sizeof(struct thorium_message));
     core_vector_set_memory_pool(&concrete_actor->sequences,
                     &concrete_actor->persistent_memory);
 
@@ -99,20 +100,25 @@ void biosal_sequence_store_init(struct thorium_actor *actor)
 void biosal_sequence_store_destroy(struct thorium_actor *actor)
 {
     struct biosal_sequence_store *concrete_actor;
-    struct core_vector_iterator iterator;
-    struct biosal_dna_sequence *sequence;
+    struct thorium_message *message;
+    int i;
+    int size;
 
     concrete_actor = thorium_actor_concrete_actor(actor);
 
-    core_vector_iterator_init(&iterator, &concrete_actor->sequences);
+    /*
+     * The sequences point in the retained messages.
+     */
+    core_vector_destroy(&concrete_actor->sequences);
 
-    while (core_vector_iterator_has_next(&iterator)) {
+    size = core_vector_size(&concrete_actor->retained_messages);
 
-        core_vector_iterator_next(&iterator, (void**)&sequence);
-        biosal_dna_sequence_destroy(sequence, &concrete_actor->persistent_memory);
+    for (i = 0; i < size; ++i) {
+        message = core_vector_at(&concrete_actor->retained_messages, i);
+        thorium_actor_release_message(actor, message);
     }
 
-    core_vector_destroy(&concrete_actor->sequences);
+    core_vector_destroy(&concrete_actor->retained_messages);
     biosal_dna_codec_destroy(&concrete_actor->codec);
 
     if (concrete_actor->iterator_started) {
@@ -210,20 +216,17 @@ void biosal_sequence_store_receive(struct thorium_actor *actor, struct thorium_m
 void biosal_sequence_store_push_sequence_data_block(struct thorium_actor *actor, struct thorium_message *message)
 {
     uint64_t first;
-    /*
-    uint64_t last;
-    */
-    struct core_vector *new_entries;
     struct biosal_input_command payload;
     struct biosal_sequence_store *concrete_actor;
     void *buffer;
+    int64_t entries;
     int64_t i;
+    int offset;
 
 #ifdef BIOSAL_SEQUENCE_STORE_DEBUG
     int count;
 #endif
 
-    struct biosal_dna_sequence *bucket_in_message;
     struct biosal_dna_sequence *bucket_in_store;
 
     buffer = thorium_message_buffer(message);
@@ -235,65 +238,35 @@ void biosal_sequence_store_push_sequence_data_block(struct thorium_actor *actor,
                     count);
 #endif
 
-    biosal_input_command_init_empty(&payload);
-    biosal_input_command_unpack(&payload, buffer, thorium_actor_get_ephemeral_memory(actor),
-                    &concrete_actor->codec);
-
-#ifdef BIOSAL_SEQUENCE_STORE_DEBUG
-    printf("DEBUG store %d biosal_sequence_store_receive command:\n",
-                    thorium_actor_name(actor));
+    /*
+     * The DNA sequences are already encoded in the message,
+     * so the store keeps the message buffer and its sequences point
+     * in it instead of being copied.
+     */
+    thorium_actor_retain_message(actor, message);
+    core_vector_push_back(&concrete_actor->retained_messages, message);
 
-    biosal_input_command_print(&payload);
-#endif
+    biosal_input_command_init_empty(&payload);
+    offset = biosal_input_command_unpack_header(&payload, buffer, &entries);
 
     first = biosal_input_command_store_first(&payload);
-    /*
-    last = biosal_input_command_store_last(&payload);
-    */
-    new_entries = biosal_input_command_entries(&payload);
 
 #ifdef BIOSAL_SEQUENCE_STORE_DEBUG
     printf("DEBUG store %d biosal_sequence_store_push_sequence_data_block entries %d\n",
-                    thorium_actor_name(actor),
-                    (int)core_vector_size(new_entries));
+                    thorium_actor_name(actor), (int)entries);
 #endif
 
-    for (i = 0; i < core_vector_size(new_entries); i++) {
+    for (i = 0; i < entries; i++) {
 
         if (concrete_actor->received % 1000000 == 0) {
             biosal_sequence_store_show_progress(actor, message);
         }
 
-        bucket_in_message = (struct biosal_dna_sequence *)core_vector_at(new_entries,
-                        i);
-
         bucket_in_store = (struct biosal_dna_sequence *)core_vector_at(&concrete_actor->sequences,
                         first + i);
 
-        /* join the bucket, this load DNA into the store
-         */
-        /*
-        *bucket_in_store = *bucket_in_message;
-        */
-
-#ifdef BIOSAL_SEQUENCE_STORE_DEBUG
-        if (i == 0) {
-            printf("DEBUG first in payload\n");
-            printf("DEBUG-thor i %d bucket_in_store %p bucket_in_message %p\n",
-                        (int)i,
-                        (void *)bucket_in_store, (void *)bucket_in_message);
-
-            printf("DEBUG i %d first %d size %d store size %d\n",
-                   (int)i, (int)first,
-                   (int)core_vector_size(new_entries),
-                   (int)core_vector_size(&concrete_actor->sequences));
-
-            biosal_dna_sequence_print(bucket_in_message);
-        }
-#endif
-
-        biosal_dna_sequence_init_copy(bucket_in_store, bucket_in_message,
-                        &concrete_actor->codec, &concrete_actor->persistent_memory);
+        offset += biosal_dna_sequence_unpack_view(bucket_in_store, (char *)buffer + offset,
+                        &concrete_actor->codec);
 
         concrete_actor->received++;
 
@@ -311,16 +284,6 @@ void biosal_sequence_store_push_sequence_data_block(struct thorium_actor *actor,
         }
     }
 
-#ifdef BIOSAL_SEQUENCE_STORE_DEBUG
-    printf("DONE.\n");
-#endif
-
-    /* The DNA sequences are kept and are not
-     * destroyed.
-     */
-    /* free payload
-     */
-
     biosal_input_command_destroy(&payload, thorium_actor_get_ephemeral_memory(actor));
 
     thorium_actor_send_reply_empty(actor, ACTION_PUSH_SEQUENCE_DATA_BLOCK_REPLY);
@@ -28,6 +28,11 @@ struct biosal_sequence_store {
 
     struct core_memory_pool persistent_memory;
 
+    /*
+     * Messages with the DNA sequences of the store.
+     */
+    struct core_vector retained_messages;
+
     int progress_supervisor;
 
     int required_kmers;
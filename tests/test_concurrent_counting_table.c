@@ -0,0 +1,201 @@
+
+#include <core/structures/concurrent_counting_table.h>
+
+#include <core/system/thread.h>
+
+#include "test.h"
+
+#include <stdint.h>
+
+#define THREAD_COUNT 4
+#define KEY_COUNT 4999
+#define ROUNDS 20
+
+struct test_adder {
+    struct core_concurrent_counting_table *table;
+    int name;
+    int failed;
+};
+
+/*
+ * All the threads add the same keys, in different orders.
+ * KEY_COUNT is prime, so each thread adds each key once per round.
+ */
+static void *add_keys(void *argument)
+{
+    struct test_adder *adder;
+    uint64_t key;
+    int round;
+    int i;
+
+    adder = argument;
+
+    for (round = 0; round < ROUNDS; ++round) {
+        for (i = 0; i < KEY_COUNT; ++i) {
+            key = (i * (adder->name + 1) + round) % KEY_COUNT;
+
+            if (!core_concurrent_counting_table_add(adder->table, &key, 1)) {
+                ++adder->failed;
+                continue;
+            }
+
+            core_concurrent_counting_table_increase_total(adder->table, 1);
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_concurrent_counting_table table;
+    uint64_t key;
+    uint64_t i;
+    uint64_t buckets;
+    void *bucket_key;
+    int count;
+    int result;
+    int found;
+    int64_t total;
+
+    core_concurrent_counting_table_init(&table, 1000, sizeof(key));
+
+    buckets = core_concurrent_counting_table_buckets(&table);
+    TEST_UINT64_T_EQUALS(buckets, 1024);
+
+    key = 42;
+    count = core_concurrent_counting_table_get(&table, &key);
+    TEST_INT_EQUALS(count, 0);
+
+    result = core_concurrent_counting_table_add(&table, &key, 1);
+    TEST_INT_EQUALS(result, 1);
+    result = core_concurrent_counting_table_add(&table, &key, 3);
+    TEST_INT_EQUALS(result, 1);
+
+    count = core_concurrent_counting_table_get(&table, &key);
+    TEST_INT_EQUALS(count, 4);
+
+    for (i = 0; i < 500; i++) {
+        key = i * 7919;
+        result = core_concurrent_counting_table_add(&table, &key, 2);
+        TEST_INT_EQUALS(result, 1);
+    }
+
+    for (i = 0; i < 500; i++) {
+        key = i * 7919;
+        count = core_concurrent_counting_table_get(&table, &key);
+        TEST_INT_EQUALS(count, 2);
+    }
+
+    /*
+     * Every key is in exactly one bucket.
+     */
+    found = 0;
+
+    for (i = 0; i < buckets; i++) {
+        if (core_concurrent_counting_table_bucket(&table, i, &bucket_key, &count)) {
+            ++found;
+        }
+    }
+
+    TEST_INT_EQUALS(found, 501);
+
+    core_concurrent_counting_table_increase_total(&table, 1004);
+    core_concurrent_counting_table_increase_total(&table, 2);
+    total = core_concurrent_counting_table_total(&table);
+    TEST_INT_EQUALS(total, 1006);
+
+    core_concurrent_counting_table_destroy(&table);
+
+    /*
+     * A full table refuses new keys.
+     */
+    core_concurrent_counting_table_init(&table, 2, sizeof(key));
+
+    key = 1;
+    result = core_concurrent_counting_table_add(&table, &key, 1);
+    TEST_INT_EQUALS(result, 1);
+    key = 2;
+    result = core_concurrent_counting_table_add(&table, &key, 1);
+    TEST_INT_EQUALS(result, 1);
+    key = 3;
+    result = core_concurrent_counting_table_add(&table, &key, 1);
+    TEST_INT_EQUALS(result, 0);
+
+    key = 1;
+    result = core_concurrent_counting_table_add(&table, &key, 1);
+    TEST_INT_EQUALS(result, 1);
+
+    core_concurrent_counting_table_destroy(&table);
+
+    /*
+     * Threads add overlapping keys at the same time.
+     */
+    {
+        struct core_thread threads[THREAD_COUNT];
+        struct test_adder adders[THREAD_COUNT];
+        int failed;
+        int wrong_counts;
+        int j;
+
+        core_concurrent_counting_table_init(&table, 4 * KEY_COUNT, sizeof(key));
+
+        for (j = 0; j < THREAD_COUNT; j++) {
+            adders[j].table = &table;
+            adders[j].name = j;
+            adders[j].failed = 0;
+
+            core_thread_init(threads + j, add_keys, adders + j);
+            core_thread_start(threads + j);
+        }
+
+        failed = 0;
+
+        for (j = 0; j < THREAD_COUNT; j++) {
+            core_thread_join(threads + j);
+            core_thread_destroy(threads + j);
+
+            failed += adders[j].failed;
+        }
+
+        TEST_INT_EQUALS(failed, 0);
+
+        /*
+         * Each key was added ROUNDS times by each thread, and it is
+         * in exactly one bucket.
+         */
+        wrong_counts = 0;
+
+        for (i = 0; i < KEY_COUNT; i++) {
+            key = i;
+
+            if (core_concurrent_counting_table_get(&table, &key) != THREAD_COUNT * ROUNDS) {
+                ++wrong_counts;
+            }
+        }
+
+        TEST_INT_EQUALS(wrong_counts, 0);
+
+        found = 0;
+        buckets = core_concurrent_counting_table_buckets(&table);
+
+        for (i = 0; i < buckets; i++) {
+            if (core_concurrent_counting_table_bucket(&table, i, &bucket_key, &count)) {
+                ++found;
+            }
+        }
+
+        TEST_INT_EQUALS(found, KEY_COUNT);
+
+        total = core_concurrent_counting_table_total(&table);
+        TEST_INT_EQUALS(total, THREAD_COUNT * ROUNDS * KEY_COUNT);
+
+        core_concurrent_counting_table_destroy(&table);
+    }
+
+    END_TESTS();
+
+    return 0;
+}
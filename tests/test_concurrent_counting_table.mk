@@ -0,0 +1,13 @@
+TEST_CONCURRENT_COUNTING_TABLE_NAME=concurrent_counting_table
+TEST_CONCURRENT_COUNTING_TABLE_EXECUTABLE=tests/test_$(TEST_CONCURRENT_COUNTING_TABLE_NAME)
+TEST_CONCURRENT_COUNTING_TABLE_OBJECTS=tests/test_$(TEST_CONCURRENT_COUNTING_TABLE_NAME).o
+TEST_EXECUTABLES+=$(TEST_CONCURRENT_COUNTING_TABLE_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_CONCURRENT_COUNTING_TABLE_OBJECTS)
+$(TEST_CONCURRENT_COUNTING_TABLE_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_CONCURRENT_COUNTING_TABLE_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS)
+TEST_CONCURRENT_COUNTING_TABLE_RUN=test_run_$(TEST_CONCURRENT_COUNTING_TABLE_NAME)
+$(TEST_CONCURRENT_COUNTING_TABLE_RUN): $(TEST_CONCURRENT_COUNTING_TABLE_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_CONCURRENT_COUNTING_TABLE_RUN)
+
@@ -0,0 +1,111 @@
+
+#include "test.h"
+
+#include <engine/thorium/dispatcher.h>
+#include <engine/thorium/message.h>
+#include <engine/thorium/actor.h>
+
+#define TAG_COUNT 1000
+
+static int last_handler;
+
+static void handler_1(struct thorium_actor *self, struct thorium_message *message)
+{
+    last_handler = 1;
+}
+
+static void handler_2(struct thorium_actor *self, struct thorium_message *message)
+{
+    last_handler = 2;
+}
+
+static void handler_3(struct thorium_actor *self, struct thorium_message *message)
+{
+    last_handler = 3;
+}
+
+static int dispatch(struct thorium_dispatcher *dispatcher, int tag, int source)
+{
+    struct thorium_message message;
+
+    last_handler = 0;
+
+    thorium_message_init(&message, tag, 0, NULL);
+    thorium_message_set_source(&message, source);
+
+    thorium_dispatcher_dispatch(dispatcher, NULL, &message);
+
+    thorium_message_destroy(&message);
+
+    return last_handler;
+}
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct thorium_dispatcher dispatcher;
+    int state;
+    int tag;
+    int valid;
+
+    thorium_dispatcher_init(&dispatcher);
+
+    /*
+     * Nothing is registered.
+     */
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 7), 0);
+
+    thorium_dispatcher_add_action(&dispatcher, 42, handler_1, THORIUM_ACTOR_ANYBODY, NULL, 0);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 7), 1);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 43, 7), 0);
+
+    /*
+     * A route for a source has priority.
+     */
+    thorium_dispatcher_add_action(&dispatcher, 42, handler_2, 7, NULL, 0);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 7), 2);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 8), 1);
+
+    /*
+     * A route with a satisfied condition has priority.
+     */
+    state = 0;
+    thorium_dispatcher_add_action(&dispatcher, 42, handler_3, THORIUM_ACTOR_ANYBODY, &state, 1);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 8), 1);
+    state = 1;
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 8), 3);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 7), 2);
+
+    /*
+     * Only a condition that is not satisfied.
+     */
+    thorium_dispatcher_add_action(&dispatcher, 44, handler_3, THORIUM_ACTOR_ANYBODY, &state, 2);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 44, 8), 0);
+    state = 2;
+    TEST_INT_EQUALS(dispatch(&dispatcher, 44, 8), 3);
+
+    /*
+     * Many tags.
+     */
+    for (tag = 0; tag < TAG_COUNT; ++tag) {
+        thorium_dispatcher_add_action(&dispatcher, 1000 + tag * 7919,
+                        (tag % 2) ? handler_1 : handler_2, THORIUM_ACTOR_ANYBODY, NULL, 0);
+    }
+
+    valid = 1;
+
+    for (tag = 0; tag < TAG_COUNT; ++tag) {
+        valid &= dispatch(&dispatcher, 1000 + tag * 7919, 5) == ((tag % 2) ? 1 : 2);
+        valid &= dispatch(&dispatcher, 1001 + tag * 7919, 5) == 0;
+    }
+
+    TEST_INT_EQUALS(valid, 1);
+    TEST_INT_EQUALS(dispatch(&dispatcher, 42, 7), 2);
+
+    thorium_dispatcher_destroy(&dispatcher);
+
+    END_TESTS();
+
+    return 0;
+}
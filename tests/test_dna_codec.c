@@ -146,6 +146,104 @@ int main(int argc, char **argv)
 
     }
 
+    /*
+     * All the backends must produce the same output as the
+     * nucleotide-by-nucleotide encoder.
+     */
+    {
+        struct biosal_dna_codec codec;
+        char symbols[] = "ACGTACGTACGTNacgt";
+        char *sequence;
+        char *decoded;
+        char *expected_sequence;
+        void *expected;
+        void *actual;
+        int backend;
+        int length;
+        int encoded_length;
+        int i;
+        int matches;
+        int decoded_matches;
+        int reverse_complement_matches;
+        int tests;
+
+        biosal_dna_codec_init(&codec);
+        biosal_dna_codec_enable_two_bit_encoding(&codec);
+
+        sequence = core_memory_allocate(1001, -1);
+        decoded = core_memory_allocate(1001, -1);
+        expected_sequence = core_memory_allocate(1001, -1);
+        expected = core_memory_allocate(1001, -1);
+        actual = core_memory_allocate(1001, -1);
+
+        srand(42);
+
+        for (backend = BIOSAL_DNA_CODEC_BACKEND_SCALAR; backend <= BIOSAL_DNA_CODEC_BACKEND_AVX2;
+                        ++backend) {
+
+            if (!biosal_dna_codec_set_backend(&codec, backend)) {
+                continue;
+            }
+
+            matches = 0;
+            decoded_matches = 0;
+            reverse_complement_matches = 0;
+            tests = 0;
+
+            for (length = 1; length <= 1000; length += 7) {
+
+                /*
+                 * Only some sequences have symbols other than A, C, G, T.
+                 */
+                for (i = 0; i < length; ++i) {
+                    sequence[i] = symbols[rand() % ((length % 3 == 0) ? 17 : 4)];
+                }
+                sequence[length] = '\0';
+
+                encoded_length = biosal_dna_codec_encoded_length(&codec, length);
+
+                memset(expected, 0xff, encoded_length);
+                memset(actual, 0xff, encoded_length);
+
+                biosal_dna_codec_encode_default(&codec, length, sequence, expected);
+                biosal_dna_codec_encode(&codec, length, sequence, actual);
+
+                if (memcmp(expected, actual, encoded_length) == 0) {
+                    ++matches;
+                }
+
+                biosal_dna_codec_decode_default(&codec, length, expected, expected_sequence);
+                biosal_dna_codec_decode(&codec, length, actual, decoded);
+
+                if (strcmp(decoded, expected_sequence) == 0) {
+                    ++decoded_matches;
+                }
+
+                biosal_dna_helper_reverse_complement_in_place(expected_sequence);
+                biosal_dna_codec_encode_default(&codec, length, expected_sequence, expected);
+                biosal_dna_codec_reverse_complement_in_place(&codec, length, actual);
+
+                if (memcmp(expected, actual, encoded_length) == 0) {
+                    ++reverse_complement_matches;
+                }
+
+                ++tests;
+            }
+
+            TEST_INT_EQUALS(matches, tests);
+            TEST_INT_EQUALS(decoded_matches, tests);
+            TEST_INT_EQUALS(reverse_complement_matches, tests);
+        }
+
+        core_memory_free(sequence, -1);
+        core_memory_free(decoded, -1);
+        core_memory_free(expected_sequence, -1);
+        core_memory_free(expected, -1);
+        core_memory_free(actual, -1);
+
+        biosal_dna_codec_destroy(&codec);
+    }
+
     END_TESTS();
 
     return 0;
@@ -18,6 +18,13 @@ int main(int argc, char **argv)
     struct core_memory_pool pool;
     int kmer_length;
     char sequence[] = "ATGATCTGCAGTACTGAC";
+    int lengths[] = { 1, 17, 31, 32, 33, 47, 64 };
+    int i;
+    int j;
+    int is_canonical;
+    uint64_t key[2];
+    uint64_t key2[2];
+    struct biosal_dna_kmer canonical_kmer;
 
     BEGIN_TESTS();
 
@@ -57,6 +64,52 @@ int main(int argc, char **argv)
     biosal_dna_kmer_destroy(&kmer, &pool);
     biosal_dna_kmer_destroy(&kmer2, &pool);
 
+    /*
+     * Inline keys: a k-mer and its reverse complement have the same
+     * key, and the key decodes to the canonical k-mer.
+     */
+    for (j = 0; j < 2; ++j) {
+
+        if (j == 1) {
+            biosal_dna_codec_disable_two_bit_encoding(&codec);
+        }
+
+        for (i = 0; i < (int)(sizeof(lengths) / sizeof(lengths[0])); ++i) {
+            kmer_length = lengths[i];
+
+            TEST_INT_EQUALS(biosal_dna_kmer_inline_key_size(kmer_length),
+                            (kmer_length <= 32 ? 1 : 2) * (int)sizeof(uint64_t));
+
+            biosal_dna_kmer_init_random(&kmer, kmer_length, &codec, &pool);
+            biosal_dna_kmer_init_copy(&kmer2, &kmer, kmer_length, &pool, &codec);
+            biosal_dna_kmer_reverse_complement_self(&kmer2, kmer_length, &codec, &pool);
+
+            key[1] = 0;
+            key2[1] = 0;
+            is_canonical = biosal_dna_kmer_pack_inline_key(&kmer, key, kmer_length, &codec);
+            biosal_dna_kmer_pack_inline_key(&kmer2, key2, kmer_length, &codec);
+
+            TEST_BOOLEAN_EQUALS(is_canonical,
+                            biosal_dna_kmer_is_canonical(&kmer, kmer_length, &codec));
+            TEST_INT_EQUALS(memcmp(key, key2, sizeof(key)), 0);
+
+            biosal_dna_kmer_init_from_inline_key(&canonical_kmer, key, kmer_length,
+                            &pool, &codec);
+
+            if (is_canonical) {
+                TEST_BOOLEAN_EQUALS(biosal_dna_kmer_equals(&canonical_kmer, &kmer,
+                                        kmer_length, &codec), 1);
+            } else {
+                TEST_BOOLEAN_EQUALS(biosal_dna_kmer_equals(&canonical_kmer, &kmer2,
+                                        kmer_length, &codec), 1);
+            }
+
+            biosal_dna_kmer_destroy(&canonical_kmer, &pool);
+            biosal_dna_kmer_destroy(&kmer, &pool);
+            biosal_dna_kmer_destroy(&kmer2, &pool);
+        }
+    }
+
     core_memory_pool_destroy(&pool);
     biosal_dna_codec_destroy(&codec);
 
@@ -0,0 +1,113 @@
+#include "test.h"
+
+#include <genomics/data/dna_kmer_extractor.h>
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_sequence.h>
+#include <genomics/data/dna_codec.h>
+
+#include <core/system/memory_pool.h>
+
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    struct biosal_dna_kmer_extractor extractor;
+    struct biosal_dna_sequence sequence;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer other;
+    struct biosal_dna_codec codec;
+    struct core_memory_pool pool;
+    char data[] = "TCCCGAGCGCAGGTAGGCCTCGGGATCGATGTCCGGGGTGTTGAGGATGTTGGACGTGTATTCGTGGTTGTACTGGGTCCAGTCCGCCACCGGGCGCCGC";
+    char copy[200];
+    char saved;
+    int kmer_lengths[] = { 1, 5, 31, 32, 33, 41, 64, 65 };
+    int kmer_length;
+    int length;
+    int encoded_length;
+    int two_bit;
+    int i;
+    int j;
+    int extracted;
+    int matches;
+    int canonical_matches;
+
+    BEGIN_TESTS();
+
+    core_memory_pool_init(&pool, 1000000, -1);
+    length = strlen(data);
+
+    for (two_bit = 0; two_bit < 2; ++two_bit) {
+
+        biosal_dna_codec_init(&codec);
+
+        if (two_bit) {
+            biosal_dna_codec_enable_two_bit_encoding(&codec);
+        }
+
+        strcpy(copy, data);
+        biosal_dna_sequence_init(&sequence, copy, &codec, &pool);
+
+        for (i = 0; i < (int)(sizeof(kmer_lengths) / sizeof(int)); ++i) {
+
+            kmer_length = kmer_lengths[i];
+            encoded_length = biosal_dna_codec_encoded_length(&codec, kmer_length);
+
+            biosal_dna_kmer_extractor_init(&extractor, kmer_length, &codec, &pool);
+            biosal_dna_kmer_extractor_start(&extractor, &sequence);
+
+            other.encoded_data = core_memory_pool_allocate(&pool, encoded_length);
+
+            extracted = 0;
+            matches = 0;
+            canonical_matches = 0;
+
+            while (biosal_dna_kmer_extractor_next(&extractor)) {
+
+                /*
+                 * Compare with the k-mer encoded from scratch.
+                 */
+                j = extracted;
+                strcpy(copy, data);
+                saved = copy[j + kmer_length];
+                copy[j + kmer_length] = '\0';
+                biosal_dna_kmer_init(&kmer, copy + j, &codec, &pool);
+                copy[j + kmer_length] = saved;
+
+                biosal_dna_kmer_extractor_get_forward(&extractor, other.encoded_data);
+
+                if (biosal_dna_kmer_equals(&kmer, &other, kmer_length, &codec)) {
+                    ++matches;
+                }
+
+                if (!biosal_dna_kmer_is_canonical(&kmer, kmer_length, &codec)) {
+                    biosal_dna_kmer_reverse_complement_self(&kmer, kmer_length, &codec, &pool);
+                }
+
+                biosal_dna_kmer_extractor_get_canonical(&extractor, other.encoded_data);
+
+                if (biosal_dna_kmer_equals(&kmer, &other, kmer_length, &codec)) {
+                    ++canonical_matches;
+                }
+
+                biosal_dna_kmer_destroy(&kmer, &pool);
+                ++extracted;
+            }
+
+            TEST_INT_EQUALS(extracted, length - kmer_length + 1);
+            TEST_INT_EQUALS(matches, extracted);
+            TEST_INT_EQUALS(canonical_matches, extracted);
+
+            core_memory_pool_free(&pool, other.encoded_data);
+            biosal_dna_kmer_extractor_destroy(&extractor);
+        }
+
+        biosal_dna_sequence_destroy(&sequence, &pool);
+        biosal_dna_codec_destroy(&codec);
+    }
+
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+
+#include "test.h"
+
+#include <genomics/data/dna_sequence_block.h>
+#include <genomics/data/dna_sequence.h>
+#include <genomics/data/dna_codec.h>
+#include <genomics/input/input_command.h>
+#include <genomics/helpers/dna_helper.h>
+
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define SEQUENCE_COUNT 1000
+
+static int check_block(struct biosal_dna_codec *codec, struct core_memory_pool *memory);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct biosal_dna_codec codec;
+    struct core_memory_pool memory;
+
+    core_memory_pool_init(&memory, 4194304, -1);
+    biosal_dna_codec_init(&codec);
+
+    /*
+     * Sequences are stored like biosal_dna_sequence_pack stores them,
+     * with or without 2-bit encoding.
+     */
+    TEST_INT_EQUALS(check_block(&codec, &memory), 1);
+
+    biosal_dna_codec_enable_two_bit_encoding(&codec);
+    TEST_INT_EQUALS(check_block(&codec, &memory), 1);
+
+    biosal_dna_codec_destroy(&codec);
+    core_memory_pool_destroy(&memory);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static void make_sequence(char *sequence, int index)
+{
+    int length;
+    int i;
+
+    length = 1 + (index * 37) % 250;
+
+    for (i = 0; i < length; ++i) {
+        sequence[i] = "ACGTacgtN"[(index + i * 7) % 9];
+    }
+
+    sequence[length] = '\0';
+}
+
+static int check_block(struct biosal_dna_codec *codec, struct core_memory_pool *memory)
+{
+    struct biosal_dna_sequence_block block;
+    struct biosal_input_command command;
+    struct biosal_input_command unpacked;
+    struct biosal_input_command expected_command;
+    struct biosal_input_command header;
+    struct biosal_dna_sequence sequence;
+    struct biosal_dna_sequence *entry;
+    char buffer[300];
+    char expected[300];
+    char actual[300];
+    void *packed;
+    void *expected_packed;
+    int size;
+    int expected_size;
+    int offset;
+    int64_t entries;
+    int valid;
+    int i;
+
+    valid = 1;
+
+    biosal_dna_sequence_block_init(&block);
+    biosal_input_command_init(&command, 42, 1000, 1000 + SEQUENCE_COUNT - 1);
+    biosal_input_command_init(&expected_command, 42, 1000, 1000 + SEQUENCE_COUNT - 1);
+
+    /*
+     * Clearing keeps the memory, but not the content.
+     */
+    make_sequence(buffer, 0);
+    biosal_dna_sequence_block_add(&block, buffer, codec);
+    biosal_dna_sequence_block_clear(&block);
+    valid &= biosal_dna_sequence_block_count(&block) == 0;
+    valid &= biosal_dna_sequence_block_size(&block) == 0;
+
+    for (i = 0; i < SEQUENCE_COUNT; ++i) {
+        make_sequence(buffer, i);
+        biosal_dna_sequence_block_add(&block, buffer, codec);
+
+        /*
+         * The same sequence, one at a time.
+         */
+        make_sequence(buffer, i);
+        biosal_dna_sequence_init(&sequence, buffer, codec, memory);
+        biosal_input_command_add_entry(&expected_command, &sequence, codec, memory);
+        biosal_dna_sequence_destroy(&sequence, memory);
+    }
+
+    valid &= biosal_dna_sequence_block_count(&block) == SEQUENCE_COUNT;
+    valid &= biosal_dna_sequence_block_offset(&block, 0) == 0;
+    valid &= biosal_dna_sequence_block_offset(&block, 1) ==
+            (int)sizeof(int) + biosal_dna_codec_encoded_length(codec, 1);
+
+    /*
+     * The packed command is the same.
+     */
+    size = biosal_input_command_pack_block_size(&command, &block);
+    expected_size = biosal_input_command_pack_size(&expected_command, codec);
+    valid &= size == expected_size;
+
+    packed = core_memory_allocate(size, -1);
+    expected_packed = core_memory_allocate(expected_size, -1);
+
+    valid &= biosal_input_command_pack_block(&command, &block, packed) == size;
+    biosal_input_command_pack(&expected_command, expected_packed, codec);
+
+    valid &= memcmp(packed, expected_packed, size) == 0;
+
+    /*
+     * And it can be unpacked.
+     */
+    biosal_input_command_unpack(&unpacked, packed, memory, codec);
+    valid &= biosal_input_command_store_name(&unpacked) == 42;
+    valid &= biosal_input_command_entry_count(&unpacked) == SEQUENCE_COUNT;
+
+    for (i = 0; i < SEQUENCE_COUNT && valid; ++i) {
+        make_sequence(expected, i);
+        biosal_dna_helper_normalize(expected);
+        entry = core_vector_at(biosal_input_command_entries(&unpacked), i);
+        biosal_dna_sequence_get_sequence(entry, actual, codec);
+
+        valid &= strcmp(actual, expected) == 0;
+    }
+
+    /*
+     * Or the sequences can point in the packed command.
+     */
+    biosal_input_command_init_empty(&header);
+    offset = biosal_input_command_unpack_header(&header, packed, &entries);
+    valid &= biosal_input_command_store_name(&header) == 42;
+    valid &= biosal_input_command_store_first(&header) == 1000;
+    valid &= entries == SEQUENCE_COUNT;
+
+    for (i = 0; i < entries && valid; ++i) {
+        make_sequence(expected, i);
+        biosal_dna_helper_normalize(expected);
+        offset += biosal_dna_sequence_unpack_view(&sequence, (char *)packed + offset, codec);
+        biosal_dna_sequence_get_sequence(&sequence, actual, codec);
+
+        valid &= strcmp(actual, expected) == 0;
+        valid &= (char *)sequence.encoded_data > (char *)packed;
+    }
+
+    valid &= offset == size;
+    biosal_input_command_destroy(&header, memory);
+
+    core_memory_free(packed, -1);
+    core_memory_free(expected_packed, -1);
+
+    biosal_input_command_destroy(&unpacked, memory);
+    biosal_input_command_destroy(&expected_command, memory);
+    biosal_input_command_destroy(&command, memory);
+    biosal_dna_sequence_block_destroy(&block);
+
+    return valid;
+}
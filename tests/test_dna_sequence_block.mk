@@ -0,0 +1,13 @@
+TEST_DNA_SEQUENCE_BLOCK_NAME=dna_sequence_block
+TEST_DNA_SEQUENCE_BLOCK_EXECUTABLE=tests/test_$(TEST_DNA_SEQUENCE_BLOCK_NAME)
+TEST_DNA_SEQUENCE_BLOCK_OBJECTS=tests/test_$(TEST_DNA_SEQUENCE_BLOCK_NAME).o
+TEST_EXECUTABLES+=$(TEST_DNA_SEQUENCE_BLOCK_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_DNA_SEQUENCE_BLOCK_OBJECTS)
+$(TEST_DNA_SEQUENCE_BLOCK_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_DNA_SEQUENCE_BLOCK_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS)
+TEST_DNA_SEQUENCE_BLOCK_RUN=test_run_$(TEST_DNA_SEQUENCE_BLOCK_NAME)
+$(TEST_DNA_SEQUENCE_BLOCK_RUN): $(TEST_DNA_SEQUENCE_BLOCK_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_DNA_SEQUENCE_BLOCK_RUN)
+
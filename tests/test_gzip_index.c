@@ -0,0 +1,260 @@
+
+#include <core/file_storage/input/gzip_index.h>
+#include <core/file_storage/input/gzip_index_reader.h>
+
+#include "test.h"
+
+#include <zlib.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DATA_SIZE 3000000
+#define SPAN 262144
+#define BGZF_BLOCK_SIZE 60000
+#define READ_SIZE 4096
+
+static void make_data(char *data, int size);
+static void write_gzip(const char *file, char *data, int size, int members);
+static void write_bgzf(const char *file, char *data, int size);
+static int check_file(const char *file, char *data, int size, int bgzf);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    char *data;
+    char file[256];
+    char cache[512];
+
+    data = malloc(DATA_SIZE);
+    make_data(data, DATA_SIZE);
+
+    snprintf(file, sizeof(file), "/tmp/test_gzip_index_%d.fastq.gz", (int)getpid());
+    snprintf(cache, sizeof(cache), "%s%s", file, CORE_GZIP_INDEX_SUFFIX);
+
+    TEST_INT_EQUALS(core_gzip_index_detect(file), 1);
+    TEST_INT_EQUALS(core_gzip_index_detect("reads.fastq"), 0);
+
+    /*
+     * One gzip member.
+     */
+    write_gzip(file, data, DATA_SIZE, 1);
+    TEST_INT_EQUALS(check_file(file, data, DATA_SIZE, 0), 1);
+
+    /*
+     * Many gzip members, like the output of cat a.gz b.gz
+     */
+    write_gzip(file, data, DATA_SIZE, 7);
+    TEST_INT_EQUALS(check_file(file, data, DATA_SIZE, 0), 1);
+
+    /*
+     * BGZF blocks.
+     */
+    write_bgzf(file, data, DATA_SIZE);
+    TEST_INT_EQUALS(check_file(file, data, DATA_SIZE, 1), 1);
+
+    remove(file);
+    remove(cache);
+    free(data);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static void make_data(char *data, int size)
+{
+    int i;
+    int position;
+    unsigned int state;
+    char line[128];
+    int length;
+
+    state = 42;
+    position = 0;
+    i = 0;
+
+    while (position < size) {
+        if (i % 2 == 0) {
+            length = snprintf(line, sizeof(line), "@read_%d\n", i / 2);
+        } else {
+            for (length = 0; length < 100; ++length) {
+                state = state * 1103515245 + 12345;
+                line[length] = "ACGT"[(state >> 16) & 3];
+            }
+            line[length++] = '\n';
+        }
+
+        if (position + length > size) {
+            length = size - position;
+        }
+
+        memcpy(data + position, line, length);
+        position += length;
+        ++i;
+    }
+}
+
+static void write_gzip(const char *file, char *data, int size, int members)
+{
+    gzFile descriptor;
+    int i;
+    int first;
+    int last;
+
+    remove(file);
+
+    for (i = 0; i < members; ++i) {
+        first = (int)((int64_t)size * i / members);
+        last = (int)((int64_t)size * (i + 1) / members);
+
+        /*
+         * gzopen with "ab" appends a new member.
+         */
+        descriptor = gzopen(file, "ab");
+        gzwrite(descriptor, data + first, last - first);
+        gzclose(descriptor);
+    }
+}
+
+static void write_bgzf_block(FILE *descriptor, char *data, int size)
+{
+    unsigned char header[18] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 0, 0};
+    unsigned char output[BGZF_BLOCK_SIZE + 1024];
+    unsigned char footer[8];
+    unsigned long crc;
+    z_stream stream;
+    int compressed;
+    int block_size;
+
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+
+    stream.next_in = (unsigned char *)data;
+    stream.avail_in = size;
+    stream.next_out = output;
+    stream.avail_out = sizeof(output);
+
+    deflate(&stream, Z_FINISH);
+    compressed = sizeof(output) - stream.avail_out;
+    deflateEnd(&stream);
+
+    block_size = sizeof(header) + compressed + sizeof(footer);
+    header[16] = (block_size - 1) & 255;
+    header[17] = (block_size - 1) >> 8;
+
+    crc = crc32(0, (unsigned char *)data, size);
+
+    footer[0] = crc & 255;
+    footer[1] = (crc >> 8) & 255;
+    footer[2] = (crc >> 16) & 255;
+    footer[3] = (crc >> 24) & 255;
+    footer[4] = size & 255;
+    footer[5] = (size >> 8) & 255;
+    footer[6] = (size >> 16) & 255;
+    footer[7] = (size >> 24) & 255;
+
+    fwrite(header, 1, sizeof(header), descriptor);
+    fwrite(output, 1, compressed, descriptor);
+    fwrite(footer, 1, sizeof(footer), descriptor);
+}
+
+static void write_bgzf(const char *file, char *data, int size)
+{
+    FILE *descriptor;
+    int position;
+    int length;
+
+    descriptor = fopen(file, "wb");
+    position = 0;
+
+    while (position < size) {
+        length = BGZF_BLOCK_SIZE;
+
+        if (position + length > size) {
+            length = size - position;
+        }
+
+        write_bgzf_block(descriptor, data + position, length);
+        position += length;
+    }
+
+    /*
+     * The BGZF end-of-file marker is an empty block.
+     */
+    write_bgzf_block(descriptor, data, 0);
+
+    fclose(descriptor);
+}
+
+static int check_offsets(struct core_gzip_index *index, const char *file, char *data, int size)
+{
+    struct core_gzip_index_reader reader;
+    char buffer[READ_SIZE];
+    uint64_t offsets[] = {0, 1, 100000, SPAN + 7, 1000000, 2 * SPAN, DATA_SIZE - 10, DATA_SIZE};
+    int count;
+    int expected;
+    int read;
+    int i;
+
+    count = sizeof(offsets) / sizeof(offsets[0]);
+
+    for (i = 0; i < count; ++i) {
+
+        if (!core_gzip_index_reader_open(&reader, index, file, offsets[i])) {
+            return 0;
+        }
+
+        expected = size - offsets[i];
+
+        if (expected > READ_SIZE) {
+            expected = READ_SIZE;
+        }
+
+        read = core_gzip_index_reader_read(&reader, buffer, READ_SIZE);
+
+        core_gzip_index_reader_close(&reader);
+
+        if (read != expected || memcmp(buffer, data + offsets[i], read) != 0) {
+            printf("Error: offset %d read %d expected %d\n", (int)offsets[i], read, expected);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int check_file(const char *file, char *data, int size, int bgzf)
+{
+    struct core_gzip_index index;
+    struct core_gzip_index loaded;
+    int valid;
+
+    valid = 1;
+
+    core_gzip_index_init(&index);
+    core_gzip_index_init(&loaded);
+
+    valid &= core_gzip_index_build(&index, file, SPAN);
+    valid &= core_gzip_index_uncompressed_size(&index) == (uint64_t)size;
+    valid &= core_gzip_index_is_bgzf(&index) == bgzf;
+    valid &= core_gzip_index_size(&index) > 2;
+    valid &= check_offsets(&index, file, data, size);
+
+    /*
+     * The cached copy gives the same results.
+     */
+    valid &= core_gzip_index_save(&index, file);
+    valid &= core_gzip_index_load(&loaded, file);
+    valid &= core_gzip_index_size(&loaded) == core_gzip_index_size(&index);
+    valid &= core_gzip_index_uncompressed_size(&loaded) == (uint64_t)size;
+    valid &= check_offsets(&loaded, file, data, size);
+
+    core_gzip_index_destroy(&index);
+    core_gzip_index_destroy(&loaded);
+
+    return valid;
+}
@@ -0,0 +1,13 @@
+TEST_GZIP_INDEX_NAME=gzip_index
+TEST_GZIP_INDEX_EXECUTABLE=tests/test_$(TEST_GZIP_INDEX_NAME)
+TEST_GZIP_INDEX_OBJECTS=tests/test_$(TEST_GZIP_INDEX_NAME).o
+TEST_EXECUTABLES+=$(TEST_GZIP_INDEX_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_GZIP_INDEX_OBJECTS)
+$(TEST_GZIP_INDEX_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_GZIP_INDEX_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS)
+TEST_GZIP_INDEX_RUN=test_run_$(TEST_GZIP_INDEX_NAME)
+$(TEST_GZIP_INDEX_RUN): $(TEST_GZIP_INDEX_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_GZIP_INDEX_RUN)
+
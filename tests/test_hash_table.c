@@ -2,6 +2,8 @@
 #include <core/structures/hash_table.h>
 #include <core/structures/hash_table_iterator.h>
 
+#include <core/system/memory.h>
+
 #include "test.h"
 
 int main(int argc, char **argv)
@@ -224,6 +226,122 @@ int main(int argc, char **argv)
         core_hash_table_destroy(&table);
     }
 
+    /*
+     * Layout with control bytes
+     */
+    {
+        struct core_hash_table table;
+        struct core_hash_table table2;
+        struct core_hash_table_iterator iterator;
+        int *key_bucket;
+        int *value_bucket;
+        int i;
+        int count;
+        int size;
+        void *buffer;
+
+        core_hash_table_init(&table, 1024, sizeof(int), sizeof(int));
+        core_hash_table_set_layout(&table, CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES);
+        TEST_INT_EQUALS(core_hash_table_layout(&table), CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES);
+
+        i = 0;
+        value_bucket = core_hash_table_get(&table, &i);
+        TEST_POINTER_EQUALS(value_bucket, NULL);
+
+        for (i = 0; i < 1000; i++) {
+            value_bucket = core_hash_table_add(&table, &i);
+            TEST_POINTER_NOT_EQUALS(value_bucket, NULL);
+
+            *value_bucket = 2 * i;
+        }
+
+        TEST_UINT64_T_EQUALS(core_hash_table_size(&table), 1000);
+
+        /*
+         * Adding a key again returns the same bucket.
+         */
+        i = 7;
+        value_bucket = core_hash_table_add(&table, &i);
+        TEST_INT_EQUALS(*value_bucket, 14);
+        TEST_UINT64_T_EQUALS(core_hash_table_size(&table), 1000);
+
+        for (i = 0; i < 1000; i += 2) {
+            core_hash_table_delete(&table, &i);
+        }
+
+        TEST_UINT64_T_EQUALS(core_hash_table_size(&table), 500);
+
+        for (i = 0; i < 1000; i++) {
+            value_bucket = core_hash_table_get(&table, &i);
+
+            if (i % 2 == 0) {
+                TEST_POINTER_EQUALS(value_bucket, NULL);
+            } else {
+                TEST_POINTER_NOT_EQUALS(value_bucket, NULL);
+                TEST_INT_EQUALS(*value_bucket, 2 * i);
+            }
+        }
+
+        core_hash_table_iterator_init(&iterator, &table);
+
+        count = 0;
+
+        while (core_hash_table_iterator_has_next(&iterator)) {
+
+            core_hash_table_iterator_next(&iterator, (void **)&key_bucket,
+                            (void **)&value_bucket);
+
+            TEST_INT_EQUALS(*value_bucket, 2 * *key_bucket);
+            count++;
+        }
+
+        TEST_INT_EQUALS(count, 500);
+
+        core_hash_table_iterator_destroy(&iterator);
+
+        size = core_hash_table_pack_size(&table);
+        buffer = core_memory_allocate(size, -1);
+        count = core_hash_table_pack(&table, buffer);
+        TEST_INT_EQUALS(count, size);
+
+        core_hash_table_init(&table2, 2, 0, 0);
+        count = core_hash_table_unpack(&table2, buffer);
+        TEST_INT_EQUALS(count, size);
+        TEST_INT_EQUALS(core_hash_table_layout(&table2), CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES);
+        TEST_UINT64_T_EQUALS(core_hash_table_size(&table2), 500);
+
+        for (i = 1; i < 1000; i += 2) {
+            value_bucket = core_hash_table_get(&table2, &i);
+            TEST_POINTER_NOT_EQUALS(value_bucket, NULL);
+            TEST_INT_EQUALS(*value_bucket, 2 * i);
+        }
+
+        core_memory_free(buffer, -1);
+        core_hash_table_destroy(&table2);
+        core_hash_table_destroy(&table);
+
+        /*
+         * A full table returns NULL.
+         */
+        core_hash_table_init(&table, 64, sizeof(int), sizeof(int));
+        core_hash_table_set_layout(&table, CORE_HASH_TABLE_LAYOUT_CONTROL_BYTES);
+
+        for (i = 0; i < 64; i++) {
+            value_bucket = core_hash_table_add(&table, &i);
+            TEST_POINTER_NOT_EQUALS(value_bucket, NULL);
+        }
+
+        value_bucket = core_hash_table_add(&table, &i);
+        TEST_POINTER_EQUALS(value_bucket, NULL);
+
+        for (i = 0; i < 64; i++) {
+            value_bucket = core_hash_table_get(&table, &i);
+            TEST_POINTER_NOT_EQUALS(value_bucket, NULL);
+        }
+
+        core_hash_table_destroy(&table);
+    }
+
     END_TESTS();
 
     return 0;
@@ -0,0 +1,88 @@
+
+#include <core/structures/lock_free_stack.h>
+
+#include "test.h"
+
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_lock_free_stack stack;
+    void *blocks[8];
+    void *block;
+    int i;
+    int count;
+    int empty;
+
+    core_lock_free_stack_init(&stack);
+
+    empty = core_lock_free_stack_empty(&stack);
+    TEST_BOOLEAN_EQUALS(empty, 1);
+
+    block = core_lock_free_stack_pop_all(&stack);
+    TEST_POINTER_EQUALS(block, NULL);
+
+    for (i = 0; i < 8; i++) {
+        blocks[i] = malloc(32);
+        core_lock_free_stack_push(&stack, blocks[i]);
+    }
+
+    empty = core_lock_free_stack_empty(&stack);
+    TEST_BOOLEAN_EQUALS(empty, 0);
+
+    /*
+     * The blocks come back in LIFO order.
+     */
+    block = core_lock_free_stack_pop_all(&stack);
+    count = 0;
+
+    while (block != NULL) {
+        TEST_POINTER_EQUALS(block, blocks[7 - count]);
+        ++count;
+        block = core_lock_free_stack_next(block);
+    }
+
+    TEST_INT_EQUALS(count, 8);
+
+    empty = core_lock_free_stack_empty(&stack);
+    TEST_BOOLEAN_EQUALS(empty, 1);
+
+    /*
+     * The stack can be reused after a pop_all.
+     */
+    core_lock_free_stack_push(&stack, blocks[3]);
+    block = core_lock_free_stack_pop_all(&stack);
+    TEST_POINTER_EQUALS(block, blocks[3]);
+    TEST_POINTER_EQUALS(core_lock_free_stack_next(block), NULL);
+
+    /*
+     * A chain is pushed as a whole, on top of the current blocks.
+     */
+    core_lock_free_stack_push(&stack, blocks[0]);
+    core_lock_free_stack_set_next(blocks[1], blocks[2]);
+    core_lock_free_stack_set_next(blocks[2], blocks[3]);
+    core_lock_free_stack_push_chain(&stack, blocks[1], blocks[3]);
+
+    block = core_lock_free_stack_pop_all(&stack);
+    count = 0;
+
+    while (block != NULL) {
+        TEST_POINTER_EQUALS(block, blocks[(count + 1) % 4]);
+        ++count;
+        block = core_lock_free_stack_next(block);
+    }
+
+    TEST_INT_EQUALS(count, 4);
+
+    for (i = 0; i < 8; i++) {
+        free(blocks[i]);
+    }
+
+    core_lock_free_stack_destroy(&stack);
+
+    END_TESTS();
+
+    return 0;
+}
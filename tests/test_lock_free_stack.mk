@@ -0,0 +1,13 @@
+TEST_LOCK_FREE_STACK_NAME=lock_free_stack
+TEST_LOCK_FREE_STACK_EXECUTABLE=tests/test_$(TEST_LOCK_FREE_STACK_NAME)
+TEST_LOCK_FREE_STACK_OBJECTS=tests/test_$(TEST_LOCK_FREE_STACK_NAME).o
+TEST_EXECUTABLES+=$(TEST_LOCK_FREE_STACK_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_LOCK_FREE_STACK_OBJECTS)
+$(TEST_LOCK_FREE_STACK_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_LOCK_FREE_STACK_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS)
+TEST_LOCK_FREE_STACK_RUN=test_run_$(TEST_LOCK_FREE_STACK_NAME)
+$(TEST_LOCK_FREE_STACK_RUN): $(TEST_LOCK_FREE_STACK_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_LOCK_FREE_STACK_RUN)
+
@@ -228,6 +228,126 @@ int main(int argc, char **argv)
         core_map_destroy(&map);
 
     }
+
+    /*
+     * Map with control bytes, with resizing.
+     */
+    {
+        struct core_map map;
+        struct core_map map2;
+        struct core_map_iterator iterator;
+        int i;
+        int key;
+        int value;
+        int count;
+        int size;
+        void *buffer;
+
+        core_map_init(&map, sizeof(int), sizeof(int));
+        core_map_enable_control_bytes(&map);
+
+        count = 30000;
+
+        for (i = 0; i < count; ++i) {
+            value = 3 * i;
+            core_map_add_value(&map, &i, &value);
+        }
+
+        TEST_UINT64_T_EQUALS(core_map_size(&map), (uint64_t)count);
+
+        for (i = 0; i < count; ++i) {
+            TEST_BOOLEAN_EQUALS(core_map_get_value(&map, &i, &value), 1);
+            TEST_INT_EQUALS(value, 3 * i);
+        }
+
+        core_map_iterator_init(&iterator, &map);
+
+        i = 0;
+
+        while (core_map_iterator_get_next_key_and_value(&iterator, &key, &value)) {
+            TEST_INT_EQUALS(value, 3 * key);
+            ++i;
+        }
+
+        TEST_INT_EQUALS(i, count);
+
+        core_map_iterator_destroy(&iterator);
+
+        size = core_map_pack_size(&map);
+        buffer = core_memory_allocate(size, -1);
+        core_map_pack(&map, buffer);
+
+        core_map_init(&map2, 0, 0);
+        core_map_unpack(&map2, buffer);
+
+        TEST_UINT64_T_EQUALS(core_map_size(&map2), (uint64_t)count);
+
+        for (i = 0; i < count; ++i) {
+            TEST_BOOLEAN_EQUALS(core_map_get_value(&map2, &i, &value), 1);
+            TEST_INT_EQUALS(value, 3 * i);
+        }
+
+        core_memory_free(buffer, -1);
+        core_map_destroy(&map2);
+        core_map_destroy(&map);
+    }
+
+    /*
+     * Map with 2-word integer keys, with resizing.
+     */
+    {
+        struct core_map map;
+        struct core_map map2;
+        uint64_t key[2];
+        uint64_t i;
+        uint64_t count;
+        int value;
+        int size;
+        void *buffer;
+
+        core_map_init(&map, sizeof(key), sizeof(int));
+        core_map_enable_integer_keys(&map);
+
+        count = 30000;
+
+        for (i = 0; i < count; ++i) {
+            key[0] = i;
+            key[1] = ~i;
+            value = 3 * i;
+            core_map_add_value(&map, key, &value);
+        }
+
+        TEST_UINT64_T_EQUALS(core_map_size(&map), count);
+
+        for (i = 0; i < count; ++i) {
+            key[0] = i;
+            key[1] = ~i;
+            TEST_BOOLEAN_EQUALS(core_map_get_value(&map, key, &value), 1);
+            TEST_INT_EQUALS(value, (int)(3 * i));
+        }
+
+        key[0] = 0;
+        key[1] = 0;
+        TEST_POINTER_EQUALS(core_map_get(&map, key), NULL);
+
+        size = core_map_pack_size(&map);
+        buffer = core_memory_allocate(size, -1);
+        core_map_pack(&map, buffer);
+
+        core_map_init(&map2, 0, 0);
+        core_map_unpack(&map2, buffer);
+
+        for (i = 0; i < count; ++i) {
+            key[0] = i;
+            key[1] = ~i;
+            TEST_BOOLEAN_EQUALS(core_map_get_value(&map2, key, &value), 1);
+            TEST_INT_EQUALS(value, (int)(3 * i));
+        }
+
+        core_memory_free(buffer, -1);
+        core_map_destroy(&map2);
+        core_map_destroy(&map);
+    }
     END_TESTS();
 
     return 0;
@@ -0,0 +1,184 @@
+
+#include <core/file_storage/input/buffered_reader.h>
+#include <core/file_storage/input/mapped_buffered_reader.h>
+#include <core/file_storage/input/raw_buffered_reader.h>
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LINE_COUNT 10000
+#define BUFFER_SIZE 4096
+
+static int write_file(const char *file);
+static int read_all(struct core_buffered_reader *reader, const char *data, int size, int offset);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_buffered_reader reader;
+    char file[256];
+    char buffer[BUFFER_SIZE];
+    char *data;
+    char *line;
+    FILE *descriptor;
+    int size;
+    int length;
+    int middle;
+
+    snprintf(file, sizeof(file), "/tmp/test_mapped_buffered_reader_%d.fastq", (int)getpid());
+
+    size = write_file(file);
+
+    data = malloc(size);
+    descriptor = fopen(file, "rb");
+    TEST_INT_EQUALS(fread(data, 1, size, descriptor), size);
+    fclose(descriptor);
+
+    TEST_INT_EQUALS(core_mapped_buffered_reader_detect(file), 1);
+    TEST_INT_EQUALS(core_mapped_buffered_reader_detect("/tmp"), 0);
+    TEST_INT_EQUALS(core_mapped_buffered_reader_detect("/nonexistent/file"), 0);
+
+    /*
+     * Read everything with views.
+     */
+    core_buffered_reader_init(&reader, file, 0);
+    TEST_POINTER_EQUALS(reader.interface, &core_mapped_buffered_reader_implementation);
+    TEST_INT_EQUALS(read_all(&reader, data, size, 0), LINE_COUNT);
+    TEST_UINT64_T_EQUALS(core_buffered_reader_get_offset(&reader), size);
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * Start at an offset.
+     */
+    middle = size / 2;
+
+    while (data[middle - 1] != '\n') {
+        ++middle;
+    }
+
+    core_buffered_reader_init(&reader, file, middle);
+    TEST_INT_IS_GREATER_THAN(read_all(&reader, data, size, middle), 0);
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * Copies keep the new line, like the raw reader.
+     */
+    core_buffered_reader_init(&reader, file, 0);
+    length = core_buffered_reader_read_line(&reader, buffer, BUFFER_SIZE);
+    TEST_INT_EQUALS(length, (strchr(data, '\n') - data) + 1);
+    TEST_INT_EQUALS(memcmp(buffer, data, length), 0);
+    TEST_INT_EQUALS(buffer[length], '\0');
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * A line longer than the buffer is truncated, and the null
+     * character stays in the buffer.
+     */
+    middle = strchr(data, '\n') - data + 1;
+    core_buffered_reader_init(&reader, file, middle);
+    buffer[8] = 'X';
+    length = core_buffered_reader_read_line(&reader, buffer, 8);
+    TEST_INT_EQUALS(length, 7);
+    TEST_INT_EQUALS(memcmp(buffer, data + middle, length), 0);
+    TEST_INT_EQUALS(buffer[7], '\0');
+    TEST_INT_EQUALS(buffer[8], 'X');
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * The raw reader gives the same views.
+     */
+    reader.interface = &core_raw_buffered_reader_implementation;
+    reader.concrete_self = malloc(reader.interface->size);
+    reader.interface->init(&reader, file, 0);
+    TEST_INT_EQUALS(read_all(&reader, data, size, 0), LINE_COUNT);
+    reader.interface->destroy(&reader);
+    free(reader.concrete_self);
+
+    /*
+     * The last line has no new line.
+     */
+    core_buffered_reader_init(&reader, file, size - 5);
+    length = core_buffered_reader_read_line_view(&reader, &line);
+    TEST_INT_EQUALS(length, 5);
+    TEST_INT_EQUALS(memcmp(line, data + size - 5, 5), 0);
+    TEST_INT_EQUALS(core_buffered_reader_read_line_view(&reader, &line), 0);
+    core_buffered_reader_destroy(&reader);
+
+    remove(file);
+    free(data);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static int write_file(const char *file)
+{
+    FILE *descriptor;
+    int i;
+    int j;
+    int size;
+    int length;
+
+    descriptor = fopen(file, "w");
+    size = 0;
+
+    for (i = 0; i < LINE_COUNT; ++i) {
+
+        length = (i * 7919) % 300;
+
+        for (j = 0; j < length; ++j) {
+            fputc("ACGT"[(i + j) % 4], descriptor);
+        }
+
+        size += length;
+
+        if (i != LINE_COUNT - 1) {
+            fputc('\n', descriptor);
+            ++size;
+        }
+    }
+
+    /*
+     * Make sure that the last line is not empty.
+     */
+    fputs("GATTA", descriptor);
+    size += 5;
+
+    fclose(descriptor);
+
+    return size;
+}
+
+/*
+ * \return number of lines, or -1 if a view is not the expected one
+ */
+static int read_all(struct core_buffered_reader *reader, const char *data, int size, int offset)
+{
+    char *line;
+    int length;
+    int lines;
+
+    lines = 0;
+
+    while ((length = core_buffered_reader_read_line_view(reader, &line)) > 0) {
+
+        if (offset + length > size || memcmp(line, data + offset, length) != 0) {
+            return -1;
+        }
+
+        offset += length;
+        ++lines;
+    }
+
+    if (offset != size) {
+        return -1;
+    }
+
+    return lines;
+}
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <inttypes.h>
+#include <string.h>
 
 void test_allocator(struct core_memory_pool *memory)
 {
@@ -78,6 +79,73 @@ int main(int argc, char **argv)
         core_memory_pool_destroy(&memory);
     }
 
+    /*
+     * Slab mode
+     */
+    {
+        struct core_memory_pool memory;
+        void *pointer;
+        void *other_pointer;
+        void *large_pointer;
+        uint64_t allocated;
+
+        core_memory_pool_init(&memory, 1048576, -1);
+        core_memory_pool_enable_slab_mode(&memory);
+
+        test_allocator(&memory);
+
+        /*
+         * A freed segment is reused for the same size class.
+         */
+        pointer = core_memory_pool_allocate(&memory, 100);
+        TEST_POINTER_NOT_EQUALS(pointer, NULL);
+        TEST_INT_EQUALS((uintptr_t)pointer % 16, 0);
+        core_memory_pool_free(&memory, pointer);
+
+        other_pointer = core_memory_pool_allocate(&memory, 90);
+        TEST_POINTER_EQUALS(other_pointer, pointer);
+
+        /*
+         * Not the same size class.
+         */
+        pointer = core_memory_pool_allocate(&memory, 300);
+        TEST_POINTER_NOT_EQUALS(pointer, other_pointer);
+
+        core_memory_pool_free(&memory, pointer);
+        core_memory_pool_free(&memory, other_pointer);
+
+        large_pointer = core_memory_pool_allocate(&memory, 2000000);
+        TEST_POINTER_NOT_EQUALS(large_pointer, NULL);
+        memset(large_pointer, 0, 2000000);
+        core_memory_pool_free(&memory, large_pointer);
+
+        TEST_INT_EQUALS(core_memory_pool_profile_balance_count(&memory), 0);
+
+        /*
+         * The header is not rounded with the payload.
+         */
+        allocated = memory.profile_allocated_byte_count;
+        pointer = core_memory_pool_allocate(&memory, 4096);
+        TEST_UINT64_T_EQUALS(memory.profile_allocated_byte_count - allocated, 4096 + 16);
+        core_memory_pool_free(&memory, pointer);
+
+        /*
+         * Ephemeral memory
+         */
+        core_memory_pool_disable_tracking(&memory);
+        core_memory_pool_enable_ephemeral_mode(&memory);
+
+        pointer = core_memory_pool_allocate(&memory, 1000);
+        large_pointer = core_memory_pool_allocate(&memory, 3000000);
+        core_memory_pool_free_all(&memory);
+
+        other_pointer = core_memory_pool_allocate(&memory, 1000);
+        TEST_POINTER_NOT_EQUALS(other_pointer, NULL);
+        core_memory_pool_free_all(&memory);
+
+        core_memory_pool_destroy(&memory);
+    }
+
     END_TESTS();
 
     return 0;
@@ -0,0 +1,182 @@
+
+#include <core/structures/mpsc_ring.h>
+
+#include <core/system/thread.h>
+
+#include "test.h"
+
+#define PRODUCER_COUNT 4
+#define ELEMENTS_PER_PRODUCER 100000
+
+struct test_element {
+    int producer;
+    int sequence;
+};
+
+struct test_producer {
+    struct core_mpsc_ring *ring;
+    int name;
+};
+
+static void *produce(void *argument)
+{
+    struct test_producer *producer;
+    struct test_element element;
+    int i;
+
+    producer = argument;
+    element.producer = producer->name;
+
+    for (i = 0; i < ELEMENTS_PER_PRODUCER; ++i) {
+        element.sequence = i;
+
+        /*
+         * The ring is full.
+         */
+        while (!core_mpsc_ring_push(producer->ring, &element)) {
+            core_thread_yield();
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_mpsc_ring ring;
+    int capacity = 100;
+    int i;
+    int value;
+    int expected;
+
+    core_mpsc_ring_init(&ring, capacity, sizeof(int));
+
+    capacity = core_mpsc_ring_capacity(&ring);
+
+    TEST_INT_EQUALS(capacity, 128);
+    TEST_INT_EQUALS(core_mpsc_ring_size(&ring), 0);
+    TEST_BOOLEAN_EQUALS(core_mpsc_ring_empty(&ring), 1);
+    TEST_BOOLEAN_EQUALS(core_mpsc_ring_pop(&ring, &value), 0);
+
+    for (i = 0; i < capacity; i++) {
+        TEST_BOOLEAN_EQUALS(core_mpsc_ring_push(&ring, &i), 1);
+        TEST_INT_EQUALS(core_mpsc_ring_size(&ring), i + 1);
+    }
+
+    /*
+     * The ring is full.
+     */
+    value = core_mpsc_ring_push(&ring, &i);
+    TEST_BOOLEAN_EQUALS(value, 0);
+    value = core_mpsc_ring_push(&ring, &i);
+    TEST_BOOLEAN_EQUALS(value, 0);
+
+    value = core_mpsc_ring_rejected_count(&ring);
+    TEST_INT_EQUALS(value, 2);
+
+    for (i = 0; i < capacity; i++) {
+        TEST_BOOLEAN_EQUALS(core_mpsc_ring_pop(&ring, &value), 1);
+        TEST_INT_EQUALS(value, i);
+    }
+
+    TEST_BOOLEAN_EQUALS(core_mpsc_ring_empty(&ring), 1);
+    TEST_BOOLEAN_EQUALS(core_mpsc_ring_pop(&ring, &value), 0);
+
+    /*
+     * Wrap around the cells many times.
+     */
+    expected = 0;
+
+    for (i = 0; i < 10 * capacity; i++) {
+        TEST_BOOLEAN_EQUALS(core_mpsc_ring_push(&ring, &i), 1);
+
+        if (i % 2 == 0) {
+            continue;
+        }
+
+        while (core_mpsc_ring_pop(&ring, &value)) {
+            TEST_INT_EQUALS(value, expected);
+            ++expected;
+        }
+    }
+
+    TEST_INT_EQUALS(expected, 10 * capacity);
+    TEST_INT_EQUALS(core_mpsc_ring_size(&ring), 0);
+
+    core_mpsc_ring_destroy(&ring);
+
+    /*
+     * Many producer threads and one consumer. The elements of each
+     * producer must arrive in order, and none may be lost.
+     */
+    {
+        struct core_thread threads[PRODUCER_COUNT];
+        struct test_producer producers[PRODUCER_COUNT];
+        int next_sequences[PRODUCER_COUNT];
+        struct test_element element;
+        int received;
+        int out_of_order;
+
+        core_mpsc_ring_init(&ring, 64, sizeof(struct test_element));
+
+        for (i = 0; i < PRODUCER_COUNT; ++i) {
+            producers[i].ring = &ring;
+            producers[i].name = i;
+            next_sequences[i] = 0;
+
+            core_thread_init(threads + i, produce, producers + i);
+            core_thread_start(threads + i);
+        }
+
+        received = 0;
+        out_of_order = 0;
+
+        while (received < PRODUCER_COUNT * ELEMENTS_PER_PRODUCER) {
+
+            if (!core_mpsc_ring_pop(&ring, &element)) {
+                core_thread_yield();
+                continue;
+            }
+
+            /*
+             * Keep consuming after an error, otherwise the producers
+             * would wait forever on a full ring.
+             */
+            ++received;
+
+            if (element.producer < 0 || element.producer >= PRODUCER_COUNT) {
+                ++out_of_order;
+                continue;
+            }
+
+            if (element.sequence != next_sequences[element.producer]) {
+                ++out_of_order;
+            }
+
+            next_sequences[element.producer] = element.sequence + 1;
+        }
+
+        for (i = 0; i < PRODUCER_COUNT; ++i) {
+            core_thread_join(threads + i);
+            core_thread_destroy(threads + i);
+        }
+
+        TEST_INT_EQUALS(out_of_order, 0);
+        TEST_INT_EQUALS(received, PRODUCER_COUNT * ELEMENTS_PER_PRODUCER);
+
+        for (i = 0; i < PRODUCER_COUNT; ++i) {
+            TEST_INT_EQUALS(next_sequences[i], ELEMENTS_PER_PRODUCER);
+        }
+
+        TEST_BOOLEAN_EQUALS(core_mpsc_ring_empty(&ring), 1);
+        TEST_BOOLEAN_EQUALS(core_mpsc_ring_pop(&ring, &element), 0);
+
+        core_mpsc_ring_destroy(&ring);
+    }
+
+    END_TESTS();
+
+    return 0;
+}
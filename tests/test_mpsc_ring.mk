@@ -0,0 +1,13 @@
+TEST_MPSC_RING_NAME=mpsc_ring
+TEST_MPSC_RING_EXECUTABLE=tests/test_$(TEST_MPSC_RING_NAME)
+TEST_MPSC_RING_OBJECTS=tests/test_$(TEST_MPSC_RING_NAME).o
+TEST_EXECUTABLES+=$(TEST_MPSC_RING_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_MPSC_RING_OBJECTS)
+$(TEST_MPSC_RING_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_MPSC_RING_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS)
+TEST_MPSC_RING_RUN=test_run_$(TEST_MPSC_RING_NAME)
+$(TEST_MPSC_RING_RUN): $(TEST_MPSC_RING_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_MPSC_RING_RUN)
+
@@ -0,0 +1,107 @@
+
+#include <engine/thorium/transport/shared_memory/shared_memory_ring.h>
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct thorium_shared_memory_ring ring;
+    void *memory;
+    char input[2048];
+    char output[1024];
+    int capacity;
+    int maximum;
+    int count;
+    int result;
+    int i;
+
+    capacity = 4096;
+    memory = malloc(thorium_shared_memory_ring_footprint(capacity));
+
+    thorium_shared_memory_ring_init(&ring, memory, capacity);
+    thorium_shared_memory_ring_clear(&ring);
+
+    for (i = 0; i < 2048; i++) {
+        input[i] = i % 127;
+    }
+
+    count = thorium_shared_memory_ring_peek(&ring);
+    TEST_INT_EQUALS(count, -1);
+
+    maximum = thorium_shared_memory_ring_maximum_count(&ring);
+    TEST_INT_EQUALS(maximum, capacity / 2 - 8);
+
+    result = thorium_shared_memory_ring_push(&ring, input, maximum + 1);
+    TEST_INT_EQUALS(result, 0);
+
+    /*
+     * Records come back in FIFO order.
+     */
+    result = thorium_shared_memory_ring_push(&ring, input, 100);
+    TEST_INT_EQUALS(result, 1);
+    result = thorium_shared_memory_ring_push(&ring, input + 1, 13);
+    TEST_INT_EQUALS(result, 1);
+
+    count = thorium_shared_memory_ring_peek(&ring);
+    TEST_INT_EQUALS(count, 100);
+    thorium_shared_memory_ring_pop(&ring, output);
+    TEST_INT_EQUALS(memcmp(output, input, 100), 0);
+
+    count = thorium_shared_memory_ring_peek(&ring);
+    TEST_INT_EQUALS(count, 13);
+    thorium_shared_memory_ring_pop(&ring, output);
+    TEST_INT_EQUALS(memcmp(output, input + 1, 13), 0);
+
+    count = thorium_shared_memory_ring_peek(&ring);
+    TEST_INT_EQUALS(count, -1);
+
+    /*
+     * Fill the ring, then check that records still fit after the
+     * end of the ring is reached.
+     */
+    i = 0;
+
+    while (thorium_shared_memory_ring_push(&ring, input, 1000)) {
+        ++i;
+    }
+
+    /*
+     * The 4th record would need a padding marker at the end of the ring.
+     */
+    TEST_INT_EQUALS(i, 3);
+
+    while (thorium_shared_memory_ring_peek(&ring) >= 0) {
+        thorium_shared_memory_ring_pop(&ring, output);
+    }
+
+    for (i = 0; i < 100; i++) {
+        result = thorium_shared_memory_ring_push(&ring, input + i, 1000 + i % 17);
+        TEST_INT_EQUALS(result, 1);
+        result = thorium_shared_memory_ring_push(&ring, input, 7);
+        TEST_INT_EQUALS(result, 1);
+
+        count = thorium_shared_memory_ring_peek(&ring);
+        TEST_INT_EQUALS(count, 1000 + i % 17);
+        thorium_shared_memory_ring_pop(&ring, output);
+        TEST_INT_EQUALS(memcmp(output, input + i, count), 0);
+
+        count = thorium_shared_memory_ring_peek(&ring);
+        TEST_INT_EQUALS(count, 7);
+        thorium_shared_memory_ring_pop(&ring, output);
+    }
+
+    count = thorium_shared_memory_ring_peek(&ring);
+    TEST_INT_EQUALS(count, -1);
+
+    thorium_shared_memory_ring_destroy(&ring);
+    free(memory);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_SHARED_MEMORY_RING_NAME=shared_memory_ring
+TEST_SHARED_MEMORY_RING_EXECUTABLE=tests/test_$(TEST_SHARED_MEMORY_RING_NAME)
+TEST_SHARED_MEMORY_RING_OBJECTS=tests/test_$(TEST_SHARED_MEMORY_RING_NAME).o
+TEST_EXECUTABLES+=$(TEST_SHARED_MEMORY_RING_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_SHARED_MEMORY_RING_OBJECTS)
+$(TEST_SHARED_MEMORY_RING_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_SHARED_MEMORY_RING_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS)
+TEST_SHARED_MEMORY_RING_RUN=test_run_$(TEST_SHARED_MEMORY_RING_NAME)
+$(TEST_SHARED_MEMORY_RING_RUN): $(TEST_SHARED_MEMORY_RING_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_SHARED_MEMORY_RING_RUN)
+
@@ -0,0 +1,210 @@
+
+#include <core/structures/work_stealing_deque.h>
+
+#include <core/system/thread.h>
+#include <core/system/atomic.h>
+#include <core/system/memory.h>
+
+#include "test.h"
+
+#include <string.h>
+
+#define THIEF_COUNT 3
+#define ELEMENT_COUNT 200000
+
+struct test_thief {
+    struct core_work_stealing_deque *deque;
+    int *done;
+    char *seen;
+};
+
+/*
+ * Each thief counts the elements that it stole in its own array.
+ */
+static void *steal(void *argument)
+{
+    struct test_thief *thief;
+    int value;
+
+    thief = argument;
+
+    while (1) {
+
+        if (core_work_stealing_deque_steal(thief->deque, &value)) {
+            ++thief->seen[value];
+            continue;
+        }
+
+        if (core_atomic_read_int(thief->done)
+                        && core_work_stealing_deque_size(thief->deque) == 0) {
+            break;
+        }
+
+        core_thread_yield();
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_work_stealing_deque deque;
+    int capacity = 64;
+    int i;
+    int value;
+    int elements;
+
+    core_work_stealing_deque_init(&deque, capacity, sizeof(int));
+
+    capacity = core_work_stealing_deque_capacity(&deque);
+
+    TEST_INT_EQUALS(capacity, 64);
+    TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 0);
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_pop(&deque, &value), 0);
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_steal(&deque, &value), 0);
+
+    elements = 0;
+
+    for (i = 0; i < capacity; i++) {
+        TEST_BOOLEAN_EQUALS(core_work_stealing_deque_push(&deque, &i), 1);
+        elements++;
+
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), elements);
+    }
+
+    /*
+     * The deque is full.
+     */
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_push(&deque, &i), 0);
+
+    /*
+     * The owner pops in LIFO order and thieves steal in FIFO order.
+     */
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_pop(&deque, &value), 1);
+    TEST_INT_EQUALS(value, capacity - 1);
+
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_steal(&deque, &value), 1);
+    TEST_INT_EQUALS(value, 0);
+
+    elements -= 2;
+    TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), elements);
+
+    for (i = 1; i < capacity - 1; i++) {
+        TEST_BOOLEAN_EQUALS(core_work_stealing_deque_steal(&deque, &value), 1);
+        TEST_INT_EQUALS(value, i);
+    }
+
+    TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 0);
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_pop(&deque, &value), 0);
+    TEST_BOOLEAN_EQUALS(core_work_stealing_deque_steal(&deque, &value), 0);
+
+    /*
+     * Wrap around the cells many times with the last-element race path.
+     */
+    for (i = 0; i < 10 * capacity; i++) {
+        TEST_BOOLEAN_EQUALS(core_work_stealing_deque_push(&deque, &i), 1);
+
+        if (i % 2 == 0) {
+            TEST_BOOLEAN_EQUALS(core_work_stealing_deque_pop(&deque, &value), 1);
+        } else {
+            TEST_BOOLEAN_EQUALS(core_work_stealing_deque_steal(&deque, &value), 1);
+        }
+
+        TEST_INT_EQUALS(value, i);
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 0);
+    }
+
+    core_work_stealing_deque_destroy(&deque);
+
+    /*
+     * The owner pushes and pops while thieves steal. Each element
+     * must be taken exactly once.
+     */
+    {
+        struct core_thread threads[THIEF_COUNT];
+        struct test_thief thieves[THIEF_COUNT];
+        char *seen;
+        int done;
+        int next;
+        int total;
+        int lost;
+        int duplicated;
+        int j;
+
+        core_work_stealing_deque_init(&deque, 256, sizeof(int));
+
+        done = 0;
+        seen = core_memory_allocate(ELEMENT_COUNT * (THIEF_COUNT + 1), -1);
+        memset(seen, 0, ELEMENT_COUNT * (THIEF_COUNT + 1));
+
+        for (i = 0; i < THIEF_COUNT; ++i) {
+            thieves[i].deque = &deque;
+            thieves[i].done = &done;
+            thieves[i].seen = seen + (i + 1) * ELEMENT_COUNT;
+
+            core_thread_init(threads + i, steal, thieves + i);
+            core_thread_start(threads + i);
+        }
+
+        next = 0;
+
+        while (next < ELEMENT_COUNT) {
+
+            /*
+             * Push a few elements, then pop one.
+             */
+            for (j = 0; j < 3 && next < ELEMENT_COUNT; ++j) {
+                if (!core_work_stealing_deque_push(&deque, &next)) {
+                    break;
+                }
+
+                ++next;
+            }
+
+            if (core_work_stealing_deque_pop(&deque, &value)) {
+                ++seen[value];
+            }
+        }
+
+        while (core_work_stealing_deque_pop(&deque, &value)) {
+            ++seen[value];
+        }
+
+        core_atomic_compare_and_swap_int(&done, 0, 1);
+
+        for (i = 0; i < THIEF_COUNT; ++i) {
+            core_thread_join(threads + i);
+            core_thread_destroy(threads + i);
+        }
+
+        lost = 0;
+        duplicated = 0;
+
+        for (i = 0; i < ELEMENT_COUNT; ++i) {
+            total = 0;
+
+            for (j = 0; j < THIEF_COUNT + 1; ++j) {
+                total += seen[j * ELEMENT_COUNT + i];
+            }
+
+            if (total == 0) {
+                ++lost;
+            } else if (total > 1) {
+                ++duplicated;
+            }
+        }
+
+        TEST_INT_EQUALS(lost, 0);
+        TEST_INT_EQUALS(duplicated, 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 0);
+
+        core_memory_free(seen, -1);
+        core_work_stealing_deque_destroy(&deque);
+    }
+
+    END_TESTS();
+
+    return 0;
+}